@@ -10,8 +10,7 @@
 #define MUSE_APPLY_HPP
 
 #include <kerat/kerat.hpp>
-#include <sys/types.h>
-#include <regex.h>
+#include <muse/source_matcher.hpp>
 #include <map>
 
 namespace muse {
@@ -41,7 +40,7 @@ namespace muse {
         private:
             bool is_bundle_matching(const libkerat::bundle_handle & bundle);
 
-            regex_t m_regex;
+            internals::source_matcher m_matcher;
             bool m_free_adaptors;
             adaptor_vector m_adaptors;
 
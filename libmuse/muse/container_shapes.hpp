@@ -0,0 +1,257 @@
+/**
+ * \file      container_shapes.hpp
+ * \brief     Provides the precomputed container shapes and point broadphase used by the container aggregators
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:01 UTC
+ * \copyright BSD
+ */
+
+#ifndef MUSE_CONTAINER_SHAPES_HPP
+#define MUSE_CONTAINER_SHAPES_HPP
+
+#include <kerat/kerat.hpp>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+namespace muse {
+    namespace internals {
+
+        //! \brief Axis aligned box, conservative enclosure of the points a shape may contain
+        struct bounding_box {
+            double min_x;
+            double min_y;
+            double max_x;
+            double max_y;
+
+            inline bool contains(const libkerat::coord_t x, const libkerat::coord_t y) const {
+                return (x >= min_x) && (x <= max_x) && (y >= min_y) && (y <= max_y);
+            }
+        };
+
+        /**
+         * \brief Convex hull precomputed for the point-in-container tests
+         *
+         * The hull edges are kept as contiguous arrays along with the bounding
+         * box and bounding circle of the points the hull may contain. The test
+         * gives the same result as \ref inside_convex_polygonal_container,
+         * including its tolerance of the points lying close to the edges.
+         */
+        class convex_shape {
+        public:
+
+            //! \brief Creates empty, invalid shape
+            convex_shape();
+
+            /**
+             * \brief Precomputes the given hull
+             * \param hull - the hull points, in either clockwise or counter-clockwise order
+             */
+            explicit convex_shape(const libkerat::message::convex_hull::point_2d_list & hull);
+
+            /**
+             * \brief Gets the hull check result
+             * \return 0 if the hull is valid, negative number as \ref inside_convex_polygonal_container otherwise
+             */
+            inline int get_error() const { return m_error; }
+            inline bool is_valid() const { return m_error == 0; }
+
+            inline const bounding_box & get_bounds() const { return m_bounds; }
+
+            //! \brief Checks the bounding box and circle, false means the point is surely outside
+            bool may_contain(const libkerat::coord_t x, const libkerat::coord_t y) const;
+
+            //! \brief Checks whether the point is inside, invalid hull contains no points
+            bool contains(const libkerat::coord_t x, const libkerat::coord_t y) const;
+
+            /**
+             * \brief Classifies many points against this hull at once
+             *
+             * Uses SSE, if available, to test four points at a time.
+             *
+             * \param xs - X coordinates of the points
+             * \param ys - Y coordinates of the points
+             * \param count - count of the points
+             * \param inside - [out] set to non-zero for the points inside, zero otherwise
+             */
+            void classify(const libkerat::coord_t * xs, const libkerat::coord_t * ys, size_t count, unsigned char * inside) const;
+
+        private:
+
+            typedef std::vector<libkerat::coord_t> coord_vector;
+
+            int m_error;
+            // orientation of the hull, +1 or -1
+            libkerat::coord_t m_orientation;
+
+            // edge i goes from (m_first_x[i], m_first_y[i]) to (m_second_x[i], m_second_y[i])
+            coord_vector m_first_x;
+            coord_vector m_first_y;
+            coord_vector m_second_x;
+            coord_vector m_second_y;
+
+            bounding_box m_bounds;
+            double m_center_x;
+            double m_center_y;
+            double m_radius_squared;
+        };
+
+        /**
+         * \brief Bounds inner ellipse precomputed for the point-in-container tests
+         *
+         * Gives the same result as the per-message computation, the rotation
+         * and foci are computed only once.
+         */
+        class ellipse_shape {
+        public:
+
+            //! \brief Creates empty, invalid shape
+            ellipse_shape();
+
+            //! \brief Precomputes the bounding box inner ellipse of the given bounds
+            explicit ellipse_shape(const libkerat::message::bounds & bound);
+
+            inline bool is_valid() const { return m_valid; }
+
+            inline const bounding_box & get_bounds() const { return m_bounds; }
+
+            //! \brief Checks the bounding box and circle, false means the point is surely outside
+            bool may_contain(const libkerat::coord_t x, const libkerat::coord_t y) const;
+
+            //! \brief Checks whether the point is inside the ellipse
+            bool contains(const libkerat::coord_t x, const libkerat::coord_t y) const;
+
+            //! \brief Classifies many points against this ellipse at once, see \ref convex_shape::classify
+            void classify(const libkerat::coord_t * xs, const libkerat::coord_t * ys, size_t count, unsigned char * inside) const;
+
+        private:
+
+            bool m_valid;
+            libkerat::helpers::point_2d m_center;
+            double m_cos;
+            double m_sin;
+            libkerat::helpers::point_2d m_focus_1;
+            libkerat::helpers::point_2d m_focus_2;
+            double m_major_axis;
+
+            bounding_box m_bounds;
+            double m_radius_squared;
+        };
+
+        /**
+         * \brief Points of single frame with uniform grid broadphase
+         *
+         * The points are kept as contiguous coordinate arrays, the grid buckets
+         * them by cells so only the points near a container are tested.
+         */
+        class point_batch {
+        public:
+
+            typedef std::vector<size_t> index_vector;
+
+            point_batch();
+
+            //! \brief Removes all the points, the storage is kept for the next frame
+            void clear();
+
+            //! \brief Adds the point, returns its index
+            size_t add(const libkerat::helpers::point_2d & point);
+
+            inline size_t size() const { return m_x.size(); }
+            inline const libkerat::coord_t * get_x() const { return m_x.empty()?NULL:&m_x[0]; }
+            inline const libkerat::coord_t * get_y() const { return m_y.empty()?NULL:&m_y[0]; }
+
+            /**
+             * \brief Buckets the points added so far
+             * \param cell_size - grid cell size, values below 1 are taken as 1
+             */
+            void build_grid(double cell_size);
+
+            /**
+             * \brief Finds the points inside the box, in no particular order
+             * \param box - box to look in
+             * \param found - [out] indices of the points found
+             */
+            void query(const bounding_box & box, index_vector & found) const;
+
+        private:
+
+            typedef std::pair<int32_t, int32_t> grid_cell;
+            typedef std::map<grid_cell, index_vector> cell_map;
+
+            int32_t get_cell(double coord) const;
+
+            std::vector<libkerat::coord_t> m_x;
+            std::vector<libkerat::coord_t> m_y;
+
+            double m_cell_size;
+            cell_map m_grid;
+        };
+
+        /**
+         * \brief Finds the first container containing each of the points
+         *
+         * The containers are tried in the order of the map and a point never
+         * matches the container of its own session id, as the aggregators did
+         * when testing each point against all the containers.
+         *
+         * \param shapes - map of session id to the container shape
+         * \param points - points to match, the grid is rebuilt
+         * \param owners - session ids of the points
+         * \param matches - [out] the matched container for each point, shapes.end() if none
+         */
+        template <typename shape_map>
+        void match_containers(const shape_map & shapes, point_batch & points, const std::vector<libkerat::session_id_t> & owners, std::vector<typename shape_map::const_iterator> & matches){
+            typedef typename shape_map::const_iterator iterator;
+
+            matches.assign(points.size(), shapes.end());
+
+            // size the cells by the average container
+            double extent = 0;
+            size_t valid = 0;
+            for (iterator i = shapes.begin(); i != shapes.end(); ++i){
+                if (!i->second.is_valid()){ continue; }
+                const bounding_box & box = i->second.get_bounds();
+                extent += std::max(box.max_x - box.min_x, box.max_y - box.min_y);
+                ++valid;
+            }
+            if ((valid == 0) || (points.size() == 0)){ return; }
+            points.build_grid(extent / valid);
+
+            point_batch::index_vector candidates;
+            std::vector<libkerat::coord_t> xs;
+            std::vector<libkerat::coord_t> ys;
+            std::vector<unsigned char> inside;
+
+            for (iterator shape = shapes.begin(); shape != shapes.end(); ++shape){
+                if (!shape->second.is_valid()){ continue; }
+
+                points.query(shape->second.get_bounds(), candidates);
+
+                // drop the points already matched by the previous containers
+                xs.clear();
+                ys.clear();
+                size_t count = 0;
+                for (point_batch::index_vector::const_iterator i = candidates.begin(); i != candidates.end(); ++i){
+                    const libkerat::coord_t x = points.get_x()[*i];
+                    const libkerat::coord_t y = points.get_y()[*i];
+                    if ((matches[*i] != shapes.end()) || (owners[*i] == shape->first) || !shape->second.may_contain(x, y)){ continue; }
+
+                    candidates[count++] = *i;
+                    xs.push_back(x);
+                    ys.push_back(y);
+                }
+                if (count == 0){ continue; }
+
+                inside.resize(count);
+                shape->second.classify(&xs[0], &ys[0], count, &inside[0]);
+                for (size_t i = 0; i < count; ++i){
+                    if (inside[i]){ matches[candidates[i]] = shape; }
+                }
+            }
+        }
+
+    }
+}
+
+#endif // MUSE_CONTAINER_SHAPES_HPP
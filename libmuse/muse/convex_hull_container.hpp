@@ -10,8 +10,8 @@
 #define CONVEX_HULL_CONTAINER_HPP
 
 #include <kerat/kerat.hpp>
-#include <sys/types.h>
-#include <regex.h>
+#include <muse/container_shapes.hpp>
+#include <muse/source_matcher.hpp>
 #include <map>
 
 namespace muse {
@@ -44,12 +44,12 @@ namespace muse {
 
                 bool operator<(const sid_cid_pair & second) const { return (sid < second.sid) || ((sid == second.sid) && (cid < second.cid)); }
             };
-            typedef std::map<libkerat::session_id_t, libkerat::message::convex_hull> hull_map;
+            typedef std::map<libkerat::session_id_t, internals::convex_shape> hull_map;
             typedef std::map<libkerat::component_id_t, libkerat::helpers::point_2d> cid_point_map;
             typedef std::map<libkerat::session_id_t, cid_point_map> sid_cid_point_map;
             typedef std::map<libkerat::session_id_t, libkerat::message::container_association> sid_coa_map;
             
-            static bool inside_hull(const libkerat::message::convex_hull & hull, const libkerat::helpers::point_2d & point);
+            static internals::convex_shape make_shape(const libkerat::message::convex_hull & hull);
             bool is_bundle_matching(const libkerat::bundle_handle & bundle);
 
             int process_container_frame(const libkerat::bundle_handle & to_process);
@@ -61,13 +61,14 @@ namespace muse {
             void process_ala(const libkerat::message::alive_associations & alive_assoc);
             void process_coa(const libkerat::message::container_association & coa, libkerat::bundle_handle & output_frame);
 
-            regex_t m_regex;
+            internals::source_matcher m_matcher;
             libkerat::slot_t m_slot;
             bool m_cascade;
 
             sid_coa_map m_containers;
             hull_map m_hulls;
             sid_cid_point_map m_points_buffer;
+            internals::point_batch m_points;
             libkerat::session_set m_ala_ids;
             libkerat::session_set m_alives;
             bool m_was_ala;
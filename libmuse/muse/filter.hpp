@@ -10,8 +10,7 @@
 #define MUSE_FILTER_HPP
 
 #include <kerat/kerat.hpp>
-#include <sys/types.h>
-#include <regex.h>
+#include <muse/source_matcher.hpp>
 #include <map>
 
 namespace muse {
@@ -42,7 +41,7 @@ namespace muse {
 
             bool is_bundle_matching(const libkerat::bundle_handle & bundle);
 
-            regex_t m_regex;
+            internals::source_matcher m_matcher;
             libkerat::listener * m_sink;
             bool m_tell_sink;
 
@@ -0,0 +1,125 @@
+/**
+ * \file      instrumented_module.hpp
+ * \brief     Provides the wrapper measuring the throughput and latency of a module
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:38 UTC
+ * \copyright BSD
+ */
+
+#ifndef MUSE_INSTRUMENTED_MODULE_HPP
+#define MUSE_INSTRUMENTED_MODULE_HPP
+
+#include <kerat/kerat.hpp>
+#include <muse/latency_histogram.hpp>
+#include <muse/latency_tracer.hpp>
+
+namespace muse {
+
+    //! \brief Runtime statistics of single module
+    struct module_statistics {
+        module_statistics();
+
+        //! \brief Count of bundles the module was notified about
+        uint64_t bundles_in;
+        //! \brief Count of bundles the module has passed to its listeners
+        uint64_t bundles_out;
+        //! \brief Count of messages in the bundles the module was notified about
+        uint64_t messages_in;
+        //! \brief Count of messages in the bundles the module has passed to its listeners
+        uint64_t messages_out;
+        //! \brief Length of the notifier's stack on the last notification
+        size_t backlog;
+        //! \brief Greatest length of the notifier's stack seen
+        size_t backlog_max;
+        /**
+         * \brief Wall time of notify or process_bundle, in nanoseconds
+         *
+         * The time the listeners of the module spend processing its output
+         * is not included.
+         */
+        latency_histogram latency;
+    };
+
+    /**
+     * \brief Wraps the module and measures what goes through it
+     *
+     * The wrapper takes place of the module in the chain, the listeners
+     * connect to the wrapper while the module itself notifies just the
+     * wrapper's probe. Thus the time spent by the module is measured apart
+     * from the time spent by the modules that follow.
+     *
+     * The statistics are updated by the thread running the module and may be
+     * read from any thread, the snapshot might be slightly inconsistent then.
+     */
+    class instrumented_module: public libkerat::adaptor {
+    public:
+
+        /**
+         * \brief Wraps the module
+         * \param module - module to measure, the wrapper takes over its ownership
+         */
+        explicit instrumented_module(libkerat::adaptor * module);
+
+        //! \brief Deletes the wrapped module
+        ~instrumented_module();
+
+        //! \brief Gets the wrapped module
+        inline libkerat::adaptor * get_module() const { return m_module; }
+
+        //! \brief Gets the snapshot of the statistics
+        module_statistics get_statistics() const;
+
+        //! \brief Resets the statistics
+        void reset_statistics();
+
+        /**
+         * \brief Stamps the output of the module to the tracer
+         * \param tracer - tracer to stamp to, NULL disables the tracing
+         * \param point - trace point identifier obtained from the tracer
+         */
+        void set_trace_point(latency_tracer * tracer, size_t point);
+
+        void notify(const libkerat::client * notifier);
+
+        int process_bundle(const libkerat::bundle_handle & to_process, libkerat::bundle_handle & output_bundle);
+
+        libkerat::bundle_stack get_stack() const;
+
+        void purge();
+
+    private:
+
+        //! \brief Listener of the wrapped module, forwards its output
+        class probe: public libkerat::listener {
+        public:
+            probe(instrumented_module & owner);
+            void notify(const libkerat::client * notifier);
+        private:
+            instrumented_module & m_owner;
+        };
+
+        instrumented_module(const instrumented_module &);
+        instrumented_module & operator=(const instrumented_module &);
+
+        //! \brief Counts the bundles and messages of the stack
+        static size_t count_messages(libkerat::bundle_stack & stack, size_t & bundles);
+
+        //! \brief Records the latency of the notification in progress, once
+        void finish_measurement();
+
+        libkerat::adaptor * m_module;
+        probe m_probe;
+
+        struct timespec m_started;
+        bool m_measuring;
+
+        module_statistics m_statistics;
+
+        latency_tracer * m_tracer;
+        size_t m_trace_point;
+
+    }; // cls instrumented_module
+
+} // ns muse
+
+#endif // MUSE_INSTRUMENTED_MODULE_HPP
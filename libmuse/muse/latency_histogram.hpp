@@ -0,0 +1,81 @@
+/**
+ * \file      latency_histogram.hpp
+ * \brief     Provides the logarithmic histogram of the latencies
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:38 UTC
+ * \copyright BSD
+ */
+
+#ifndef MUSE_LATENCY_HISTOGRAM_HPP
+#define MUSE_LATENCY_HISTOGRAM_HPP
+
+#include <kerat/typedefs.hpp>
+#include <vector>
+
+namespace muse {
+
+    /**
+     * \brief Histogram of the latencies with constant relative precision
+     *
+     * The values are sorted into buckets by their highest set bit, each such
+     * bucket is further split into \ref SUB_BUCKETS linear sub-buckets (as
+     * in the HDR histogram), so any value is kept with at most 1/16 relative
+     * error over the whole 64 bit range. Recording is constant time and
+     * allocation free.
+     */
+    class latency_histogram {
+    public:
+
+        //! \brief Count of the linear sub-buckets per power of two
+        static const unsigned int SUB_BUCKETS = 16;
+
+        latency_histogram();
+
+        /**
+         * \brief Records single value
+         * \param value - latency, typically in nanoseconds
+         */
+        void record(uint64_t value);
+
+        //! \brief Adds all the values recorded in the other histogram
+        void merge(const latency_histogram & other);
+
+        //! \brief Forgets all recorded values
+        void clear();
+
+        //! \brief Gets the count of recorded values
+        inline uint64_t get_count() const { return m_count; }
+
+        //! \brief Gets the smallest recorded value, 0 if empty
+        inline uint64_t get_min() const { return (m_count > 0)?m_min:0; }
+
+        //! \brief Gets the greatest recorded value
+        inline uint64_t get_max() const { return m_max; }
+
+        //! \brief Gets the arithmetic mean of the recorded values, 0 if empty
+        uint64_t get_mean() const;
+
+        /**
+         * \brief Gets the value at given percentile
+         * \param percentile - 0 to 100
+         * \return upper bound of the bucket the percentile falls into,
+         * capped by the greatest recorded value, 0 if empty
+         */
+        uint64_t get_percentile(double percentile) const;
+
+    private:
+
+        static size_t bucket_index(uint64_t value);
+        static uint64_t bucket_upper_bound(size_t index);
+
+        std::vector<uint64_t> m_buckets;
+        uint64_t m_count;
+        uint64_t m_sum;
+        uint64_t m_min;
+        uint64_t m_max;
+
+    }; // cls latency_histogram
+
+} // ns muse
+
+#endif // MUSE_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,157 @@
+/**
+ * \file      latency_tracer.hpp
+ * \brief     Provides the end-to-end latency tracing of the TUIO frames
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:41 UTC
+ * \copyright BSD
+ */
+
+#ifndef MUSE_LATENCY_TRACER_HPP
+#define MUSE_LATENCY_TRACER_HPP
+
+#include <kerat/kerat.hpp>
+#include <kerat/delta_encoding.hpp>
+#include <muse/latency_histogram.hpp>
+#include <pthread.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace muse {
+
+    /**
+     * \brief Measures how old the frames are as they go through the chain
+     *
+     * The bundles are stamped at the trace points, typically on receive,
+     * after each module and on final delivery. The points are expected to be
+     * added in the order the bundles go through them. At each point and for
+     * each source, two latencies are recorded:
+     * \li since sensor - the local time minus the frame timetag set by the
+     * tracker, thus valid only as long as the clocks are synchronised
+     * \li since previous - the time since the same frame was stamped at the
+     * nearest preceding point
+     *
+     * The tracer may be used from several threads at once.
+     */
+    class latency_tracer {
+    public:
+
+        //! \brief Identifies the TUIO source by its frame message
+        typedef libkerat::internals::source_key source_key;
+
+        //! \brief Latencies of a single trace point, in nanoseconds
+        struct point_statistics {
+            point_statistics();
+
+            //! \brief Name of the trace point
+            std::string point;
+            latency_histogram since_sensor;
+            latency_histogram since_previous;
+            //! \brief Count of frames older than the budget at this point
+            uint64_t over_budget;
+        };
+
+        typedef std::vector<point_statistics> statistics_list;
+
+        latency_tracer();
+        ~latency_tracer();
+
+        /**
+         * \brief Adds a new trace point
+         * \param name - point name used in the statistics
+         * \return identifier of the point to pass to \ref stamp
+         */
+        size_t add_point(const std::string & name);
+
+        //! \brief Gets the count of the trace points
+        size_t get_points_count() const;
+
+        /**
+         * \brief Sets the latency budget
+         * \param budget - sensor to point latency in nanoseconds, 0 disables the budget
+         */
+        void set_budget(uint64_t budget);
+
+        //! \brief Gets the latency budget in nanoseconds
+        inline uint64_t get_budget() const { return m_budget; }
+
+        /**
+         * \brief Records that the bundle has reached the trace point
+         *
+         * Bundles without frame message are not traced.
+         * \param point - identifier returned by \ref add_point
+         * \param bundle - bundle to stamp
+         */
+        void stamp(size_t point, const libkerat::bundle_handle & bundle);
+
+        //! \brief Stamps all the bundles of the stack
+        void stamp(size_t point, const libkerat::bundle_stack & stack);
+
+        //! \brief Gets the sources traced so far
+        void get_sources(std::vector<source_key> & sources) const;
+
+        /**
+         * \brief Gets the latencies of the source at all the points
+         * \param source - traced source
+         * \param statistics - output, in the order of the points
+         */
+        void get_statistics(const source_key & source, statistics_list & statistics) const;
+
+        //! \brief Gets the latencies at all the points, merged for all the sources
+        void get_statistics(statistics_list & statistics) const;
+
+        //! \brief Forgets all the recorded latencies, the points are kept
+        void reset();
+
+    private:
+
+        //! \brief Last frame seen by the point along with the stamp
+        struct point_trace {
+            point_trace();
+
+            bool valid;
+            libkerat::frame_id_t frame;
+            struct timespec stamped;
+
+            latency_histogram since_sensor;
+            latency_histogram since_previous;
+            uint64_t over_budget;
+        };
+
+        typedef std::vector<point_trace> source_trace;
+        typedef std::map<source_key, source_trace> source_map;
+
+        latency_tracer(const latency_tracer &);
+        latency_tracer & operator=(const latency_tracer &);
+
+        void fill_statistics(const source_trace & trace, statistics_list & statistics) const;
+
+        mutable pthread_mutex_t m_mutex;
+
+        std::vector<std::string> m_points;
+        source_map m_sources;
+        uint64_t m_budget;
+
+    }; // cls latency_tracer
+
+    //! \brief Listener that stamps all the bundles it is notified about
+    class trace_probe: public libkerat::listener {
+    public:
+
+        /**
+         * \param tracer - tracer to stamp to
+         * \param name - name of the trace point to add
+         */
+        trace_probe(latency_tracer & tracer, const std::string & name);
+
+        void notify(const libkerat::client * notifier);
+
+    private:
+        latency_tracer & m_tracer;
+        size_t m_point;
+    };
+
+} // ns muse
+
+#endif // MUSE_LATENCY_TRACER_HPP
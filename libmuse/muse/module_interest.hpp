@@ -0,0 +1,110 @@
+/**
+ * \file      module_interest.hpp
+ * \brief     Provides the declaration of the message types the module reads and modifies
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:15 UTC
+ * \copyright BSD
+ */
+
+#ifndef MUSE_MODULE_INTEREST_HPP
+#define MUSE_MODULE_INTEREST_HPP
+
+#include <kerat/kerat.hpp>
+#include <typeinfo>
+#include <string>
+#include <list>
+#include <set>
+
+namespace muse {
+
+    /**
+     * \brief Message types the module reads and modifies
+     *
+     * The types are the exact message classes of libkerat and dTUIO, the
+     * frame message is always passed to the module and needs no declaration.
+     * The messages of other types, unknown to this class, are always
+     * considered touched.
+     */
+    class module_interest {
+    public:
+
+        module_interest();
+
+        /**
+         * \brief Declares the message type the module inspects
+         *
+         * The read types are the ones the chain needs to receive, see
+         * \ref get_unused_paths.
+         */
+        void add_read(const std::type_info & type);
+
+        //! \brief Declares the message type the module inspects
+        template <class MESSAGE>
+        inline void add_read(){ add_read(typeid(MESSAGE)); }
+
+        /**
+         * \brief Declares the message type the module changes, drops or produces
+         *
+         * The module might not read the type, eg. the recognizers only
+         * produce their results.
+         */
+        void add_modified(const std::type_info & type);
+
+        //! \brief Declares the message type the module changes, drops or produces
+        template <class MESSAGE>
+        inline void add_modified(){ add_modified(typeid(MESSAGE)); }
+
+        /**
+         * \brief Declares that the module changes messages of all types, eg. remaps their session ids
+         *
+         * Such module may still read just few of the types.
+         */
+        inline void set_modifies_all(bool flag){ m_modifies_all = flag; }
+
+        //! \brief Checks whether the module changes messages of all types
+        inline bool get_modifies_all() const { return m_modifies_all; }
+
+        bool is_read(const std::type_info & type) const;
+        bool is_modified(const std::type_info & type) const;
+
+        /**
+         * \brief Checks whether the messages of given type have to go through the module
+         * \return true if the type is read or modified or not known
+         */
+        bool is_touched(const std::type_info & type) const;
+
+        //! \brief Adds the types declared by other module, eg. to get the interest of the chain
+        void merge(const module_interest & other);
+
+        //! \brief Gets the OSC paths of the types read
+        void get_read_paths(std::list<std::string> & paths) const;
+
+        /**
+         * \brief Gets the OSC paths of the known types not read
+         *
+         * The frame and alive messages are never listed, every bundle needs them.
+         */
+        void get_unused_paths(std::list<std::string> & paths) const;
+
+        //! \brief Checks whether the type is one of the libkerat or dTUIO messages
+        static bool is_known(const std::type_info & type);
+
+    private:
+
+        //! \brief Orders the types, the type_info instances can't be compared by address
+        struct type_less {
+            inline bool operator()(const std::type_info * first, const std::type_info * second) const {
+                return first->before(*second);
+            }
+        };
+
+        typedef std::set<const std::type_info *, type_less> type_set;
+
+        type_set m_read;
+        type_set m_modified;
+        bool m_modifies_all;
+    };
+
+} // ns muse
+
+#endif // MUSE_MODULE_INTEREST_HPP
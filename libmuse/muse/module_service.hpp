@@ -1,6 +1,11 @@
 #ifndef MUSE_MODULE_SERVICE
 #define MUSE_MODULE_SERVICE
 #include <kerat/kerat.hpp>
+#include <muse/pipeline_stage.hpp>
+#include <muse/instrumented_module.hpp>
+#include <muse/latency_tracer.hpp>
+#include <muse/module_interest.hpp>
+#include <muse/routed_module.hpp>
 #include <tinyxml.h>
 #include <vector>
 #include <map>
@@ -16,6 +21,18 @@ namespace muse {
         virtual ~module_container(){ ; }
         
         virtual int create_module_instance(muse_module ** module, const TiXmlElement * module_config) const = 0;
+
+        /**
+         * \brief Gets the message types the module configured so reads and modifies
+         *
+         * Declare the interest only for the modules processing each bundle
+         * by the process_bundle alone, see \ref routed_module.
+         *
+         * \param module_config - configuration the module would be created with
+         * \param interest - output, the declared types
+         * \return false if the module might touch any message, the default
+         */
+        virtual bool get_module_interest(const TiXmlElement * module_config __attribute__((unused)), module_interest & interest __attribute__((unused))) const { return false; }
     };
 
     class module_service {
@@ -23,6 +40,9 @@ namespace muse {
         virtual ~module_service();
         
         typedef std::vector<std::pair<muse_module *, TiXmlElement *> > module_chain;
+
+        //! \brief Statistics of the instrumented modules along with their chain elements
+        typedef std::vector<std::pair<const TiXmlElement *, module_statistics> > statistics_list;
         
         static module_service * get_instance();
 
@@ -31,18 +51,122 @@ namespace muse {
 
         bool has_module(const std::string & module_path);
 
+        //! \brief Gets the interest of the module, see \ref module_container::get_module_interest
+        bool get_module_interest(const std::string & module_path, const TiXmlElement * module_config, module_interest & interest);
+
         int register_module_container(const std::string & module_path, module_container * module_templ);
         module_container * unregister_module_container(const std::string & module_path);
         
+        /**
+         * \brief Creates the modules of the chain and connects them
+         *
+         * By default, every module consumes the output of the module declared
+         * before it. A module may be named by the "id" attribute and consumed
+         * by any number of modules declared later on, listed in their "after"
+         * attribute (comma or space separated). The shared part of the graph
+         * thus runs once and its bundles are passed to all the consumers by
+         * reference. Once created, every element of the resulting chain
+         * carries the resolved "id" and "after" attributes.
+         *
+         * With &lt;chain threading="pipeline"&gt; a \ref pipeline_stage is put
+         * in front of every group of modules, so each group, and thus each
+         * branch of the graph, runs on its own worker thread once
+         * \ref start_module_chain is called. A module with the same "stage"
+         * attribute as its only upstream module joins its group, other
+         * modules are groups on their own. The "queue_capacity" attribute
+         * of the chain sets the capacity of the queues between the stages.
+         *
+         * The modules declaring the message types they touch are wrapped by
+         * \ref routed_module, so the messages of other types are passed
+         * around them by reference. The "routing" attribute of the chain set
+         * to false disables this.
+         *
+         * The modules are wrapped by \ref instrumented_module if the
+         * instrumentation is enabled, see \ref set_instrumentation, or if the
+         * chain has the "instrumentation" attribute set.
+         */
         int create_module_chain(const TiXmlElement * chain_root, module_chain & resulting_chain);
+
+        //! \brief Starts the worker threads of the pipelined chain, no-op for serial chains
+        int start_module_chain(module_chain & chain);
+
+        //! \brief Stops the worker threads of the pipelined chain
+        void stop_module_chain(module_chain & chain);
+
         void free_module_chain(module_chain & chain);
 
+        /**
+         * \brief Gets the modules whose output is not consumed within the chain
+         *
+         * In pipelined chains, each of the sinks notifies its listeners from
+         * the worker thread of its own stage.
+         *
+         * \param chain - chain created by \ref create_module_chain
+         * \param sinks - output, the modules to connect the listeners to
+         */
+        void get_chain_sinks(const module_chain & chain, std::vector<muse_module *> & sinks);
+
+        /**
+         * \brief Gets the message types the modules of the chain read and modify
+         *
+         * The chain reads no other types, thus the client may skip decoding
+         * them, see \ref module_interest::get_unused_paths.
+         *
+         * \param chain - chain created by \ref create_module_chain
+         * \param interest - output, the types of all the modules merged
+         * \return false if any of the modules has not declared its interest
+         */
+        bool get_chain_interest(const module_chain & chain, module_interest & interest);
+
+        //! \brief Path of the stages inserted into the pipelined chains
+        static const char * PIPELINE_STAGE_PATH;
+
+        /**
+         * \brief Enables or disables the instrumentation of the chains created from now on
+         *
+         * Chains created with instrumentation disabled contain the modules
+         * themselves and thus bear no overhead at all.
+         */
+        inline void set_instrumentation(bool enabled){ m_instrumentation = enabled; }
+
+        //! \brief Checks whether the new chains are instrumented
+        inline bool get_instrumentation() const { return m_instrumentation; }
+
+        /**
+         * \brief Gets the statistics of all the instrumented modules of the chain
+         * \param chain - chain created by \ref create_module_chain
+         * \param statistics - output, in the chain order
+         */
+        void get_chain_statistics(const module_chain & chain, statistics_list & statistics);
+
+        /**
+         * \brief Sets the tracer to stamp the output of the modules of the chains created from now on
+         *
+         * The modules of the traced chains are instrumented, the trace points
+         * are added in the chain order and named by the module id and path.
+         * \param tracer - tracer to use, NULL disables the tracing, the tracer
+         * must outlive the chains
+         */
+        inline void set_tracer(latency_tracer * tracer){ m_tracer = tracer; }
+
+        //! \brief Gets the tracer used for the new chains
+        inline latency_tracer * get_tracer() const { return m_tracer; }
+
     private:
         typedef std::map<std::string, module_container *> module_map;
 
+        //! \brief Upstream modules of each module, indexes to the chain
+        typedef std::vector<std::vector<size_t> > module_links;
+
+        int resolve_module_links(const module_chain & chain, module_links & links);
+        void store_module_links(module_chain & chain, const module_links & links);
+        void insert_pipeline_stages(module_chain & chain, module_links & links, size_t queue_capacity);
+
         module_service();
 
         module_map m_registered_modules;
+        bool m_instrumentation;
+        latency_tracer * m_tracer;
         static module_service * s_ms_instance;
     };
 }
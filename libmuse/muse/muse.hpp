@@ -14,6 +14,11 @@
 //#include <dtuio/dtuio.hpp>
 
 #include <muse/module_service.hpp>
+#include <muse/pipeline_stage.hpp>
+#include <muse/instrumented_module.hpp>
+#include <muse/routed_module.hpp>
+#include <muse/module_interest.hpp>
+#include <muse/latency_tracer.hpp>
 #include <muse/bounds_container.hpp>
 #include <muse/convex_hull_container.hpp>
 #include <muse/primitive_touch.hpp>
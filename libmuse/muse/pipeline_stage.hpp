@@ -0,0 +1,165 @@
+/**
+ * \file      pipeline_stage.hpp
+ * \brief     Provides the boundary that runs the following modules on a worker thread
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:34 UTC
+ * \copyright BSD
+ */
+
+#ifndef MUSE_PIPELINE_STAGE_HPP
+#define MUSE_PIPELINE_STAGE_HPP
+
+#include <kerat/kerat.hpp>
+#include <kerat/spsc_queue.hpp>
+#include <pthread.h>
+#include <time.h>
+#include <string>
+
+namespace muse {
+
+    /**
+     * \brief Pipeline boundary between two groups of modules
+     *
+     * The bundles the stage is notified about are put into a bounded queue.
+     * A worker thread takes them out one by one and notifies the listeners,
+     * so the modules connected behind the stage run on the worker thread
+     * while the modules in front of it already process the next frame.
+     * When the queue is full, the notifying thread waits for the worker,
+     * no bundles are dropped. The stage may be notified by several modules
+     * running on different threads, the notifications are serialised.
+     *
+     * Until \ref start is called, or after \ref stop, the stage just passes
+     * the bundles through on the notifying thread.
+     */
+    class pipeline_stage: public libkerat::adaptor {
+    public:
+
+        //! \brief Runtime statistics of the stage
+        struct statistics {
+            statistics();
+
+            //! \brief Count of bundles the listeners were notified about
+            uint64_t processed;
+            //! \brief Count of bundles the notifying thread had to wait with for free slot
+            uint64_t blocked;
+            //! \brief Count of bundles dropped because the stage was being stopped
+            uint64_t dropped;
+            //! \brief Greatest count of bundles waiting in the queue
+            size_t max_depth;
+            //! \brief Total time the bundles spent in the queue, in nanoseconds
+            uint64_t queue_latency_total;
+            //! \brief Longest time a bundle spent in the queue, in nanoseconds
+            uint64_t queue_latency_max;
+            //! \brief Total time spent by the listeners processing the bundles, in nanoseconds
+            uint64_t processing_total;
+            //! \brief Longest time spent by the listeners processing single bundle, in nanoseconds
+            uint64_t processing_max;
+        };
+
+        //! \brief Default queue capacity
+        static const size_t DEFAULT_QUEUE_CAPACITY = 64;
+
+        /**
+         * \brief Creates a new, stopped pipeline stage
+         * \param name - stage name used in diagnostics
+         * \param queue_capacity - maximal count of bundles waiting for the worker
+         */
+        pipeline_stage(const std::string & name, size_t queue_capacity = DEFAULT_QUEUE_CAPACITY);
+
+        //! \brief Stops the worker thread and releases the bundles still queued
+        ~pipeline_stage();
+
+        /**
+         * \brief Starts the worker thread
+         * \return true if the thread is running
+         */
+        bool start();
+
+        /**
+         * \brief Stops the worker thread, waits for it to terminate
+         *
+         * The bundles still queued are dropped.
+         */
+        void stop();
+
+        //! \brief Checks whether the worker thread is running
+        bool is_running() const;
+
+        //! \brief Gets the stage name
+        inline const std::string & get_name() const { return m_name; }
+
+        //! \brief Gets the count of bundles currently waiting in the queue
+        inline size_t get_queue_depth() const { return m_queue.size(); }
+
+        //! \brief Gets the queue capacity
+        inline size_t get_queue_capacity() const { return m_queue.capacity(); }
+
+        /**
+         * \brief Gets the stage statistics
+         * \return consistent snapshot of the statistics, safe to call from any thread
+         */
+        statistics get_statistics() const;
+
+        void notify(const libkerat::client * notifier);
+
+        int process_bundle(const libkerat::bundle_handle & to_process, libkerat::bundle_handle & output_bundle);
+
+        libkerat::bundle_stack get_stack() const;
+
+        void purge();
+
+    private:
+
+        //! \brief Queued bundle along with the time it was queued at
+        struct queued_bundle {
+            libkerat::bundle_handle * bundle;
+            struct timespec queued;
+        };
+
+        typedef libkerat::internals::spsc_queue<queued_bundle *> bundle_queue;
+
+        pipeline_stage(const pipeline_stage &);
+        pipeline_stage & operator=(const pipeline_stage &);
+
+        static void * worker_thread(void * self);
+
+        //! \brief Queues the bundle, waits for free slot if necessary
+        void enqueue(queued_bundle * item);
+
+        //! \brief Takes the bundle out of the queue and notifies the listeners
+        void dispatch(queued_bundle * item);
+
+        //! \brief Releases all the queued bundles
+        void drain();
+
+        //! \brief Counts the bundle dropped while stopping
+        void count_dropped();
+
+        std::string m_name;
+
+        bundle_queue m_queue;
+
+        pthread_t m_thread;
+        //! \brief Nonzero while the worker runs, accessed by atomic operations only
+        volatile int m_running;
+
+        //! \brief Serialises the notifying threads
+        pthread_mutex_t m_producer_mutex;
+
+        pthread_mutex_t m_wait_mutex;
+        pthread_cond_t m_data_cond;
+        pthread_cond_t m_space_cond;
+        volatile int m_worker_waiting;
+        volatile int m_producer_waiting;
+
+        libkerat::bundle_stack m_received_frames;
+
+        //! \brief Guards the statistics, updated by both the notifying and the worker thread
+        mutable pthread_mutex_t m_statistics_mutex;
+        statistics m_statistics;
+
+    }; // cls pipeline_stage
+
+} // ns muse
+
+#endif // MUSE_PIPELINE_STAGE_HPP
@@ -10,6 +10,7 @@
 #define MUSE_PRIMITIVE_VIRTUAL_TOUCH_HPP
 
 #include <kerat/kerat.hpp>
+#include <deque>
 
 namespace muse {
     namespace virtual_sensors {
@@ -75,9 +76,33 @@ namespace muse {
                 libkerat::instance_id_t instance;
             };
 
+            //! \brief Released contact waiting to be joined, the slot is reused once joined or expired
+            struct join_candidate {
+                join_candidate():sequence(0), used(false){ ; }
+
+                alv_stamp stamp;
+                //! \brief Order of release, the oldest matching candidate is joined first
+                uint64_t sequence;
+                bool used;
+            };
+
+            //! \brief Candidate slot along with the sequence it was filled with
+            typedef std::pair<size_t, uint64_t> candidate_ref;
+
+            //! \brief Candidates released within the same time window
+            struct time_bucket {
+                libkerat::timetag_t oldest;
+                libkerat::timetag_t newest;
+                std::vector<candidate_ref> candidates;
+            };
+
             typedef std::map<libkerat::session_id_t, id_stamp> internal_session_id_map;
             typedef std::map<source_key_type, internal_session_id_map> session_id_map;
-            typedef std::vector<alv_stamp> free_vector;
+            typedef std::vector<join_candidate> candidate_vector;
+            //! \brief Uniform grid cell, the cell size is the join treshold
+            typedef std::pair<int32_t, int32_t> grid_cell;
+            typedef std::map<grid_cell, std::vector<size_t> > candidate_grid;
+            typedef std::deque<time_bucket> bucket_queue;
             typedef std::map<libkerat::session_id_t, libkerat::helpers::point_2d> sid_point_map;
             typedef std::set<libkerat::client *> client_set;
 
@@ -91,14 +116,37 @@ namespace muse {
 
             void clean_idmap();
 
+            //! \brief Adds the released contact to the spatial index and to the newest time bucket
+            void add_join_candidate(const alv_stamp & stamp);
+
+            //! \brief Removes the candidate from the spatial index, the time bucket entry turns stale
+            void remove_join_candidate(size_t slot);
+
+            //! \brief Gets the grid cell containing the point
+            grid_cell get_grid_cell(libkerat::coord_t x, libkerat::coord_t y) const;
+
+            //! \brief Sets up the grid and bucket sizes from the tresholds
+            void init_join_index();
+
             bool m_updates_waiting;
 
             uint32_t m_join_treshold_squared;
             libkerat::timetag_t m_delta_time;
 
-            free_vector m_avail_to_join;
+            // contacts available to join, indexed by position and by release time
+            candidate_vector m_candidates;
+            std::vector<size_t> m_free_candidates;
+            size_t m_candidates_count;
+            uint64_t m_candidates_sequence;
+            candidate_grid m_grid;
+            libkerat::coord_t m_cell_size;
+            bucket_queue m_buckets;
+            libkerat::timetag_t m_bucket_width;
+
             session_id_map m_mapping;
             sid_point_map m_objects;
+            //! \brief Mapped and waiting ids, the content of the alive message
+            libkerat::session_set m_alives;
 
             libkerat::bundle_stack m_processed_frames;
         };
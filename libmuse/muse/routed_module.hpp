@@ -0,0 +1,78 @@
+/**
+ * \file      routed_module.hpp
+ * \brief     Provides the wrapper passing the messages the module does not touch around it
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:15 UTC
+ * \copyright BSD
+ */
+
+#ifndef MUSE_ROUTED_MODULE_HPP
+#define MUSE_ROUTED_MODULE_HPP
+
+#include <kerat/kerat.hpp>
+#include <muse/module_interest.hpp>
+
+namespace muse {
+
+    /**
+     * \brief Wraps the module and gives it just the messages it reads or modifies
+     *
+     * The module gets the frame message and the messages of the touched
+     * types, shared with the received bundle. The messages of other types
+     * are shared into the module's output just before its alive message,
+     * or at its end, so the module never copies them. Bundles with nothing
+     * touched but the frame are passed on as they are.
+     *
+     * The wrapped module has to process each bundle by \ref process_bundle
+     * alone, producing exactly one bundle for it.
+     */
+    class routed_module: public libkerat::adaptor {
+    public:
+
+        /**
+         * \brief Wraps the module
+         * \param module - module to route the messages around, the wrapper takes over its ownership
+         * \param interest - message types the module reads and modifies
+         */
+        routed_module(libkerat::adaptor * module, const module_interest & interest);
+
+        //! \brief Deletes the wrapped module
+        ~routed_module();
+
+        //! \brief Gets the wrapped module
+        inline libkerat::adaptor * get_module() const { return m_module; }
+
+        inline const module_interest & get_interest() const { return m_interest; }
+
+        //! \brief Gets the count of bundles passed on without running the module
+        inline uint64_t get_bypassed_count() const { return m_bypassed; }
+
+        //! \brief Gets the count of messages passed around the module by reference
+        inline uint64_t get_routed_count() const { return m_routed; }
+
+        void notify(const libkerat::client * notifier);
+
+        int process_bundle(const libkerat::bundle_handle & to_process, libkerat::bundle_handle & output_bundle);
+
+        libkerat::bundle_stack get_stack() const;
+
+        void purge();
+
+    private:
+
+        routed_module(const routed_module &);
+        routed_module & operator=(const routed_module &);
+
+        libkerat::adaptor * m_module;
+        module_interest m_interest;
+
+        libkerat::bundle_stack m_processed_frames;
+
+        uint64_t m_bypassed;
+        uint64_t m_routed;
+
+    }; // cls routed_module
+
+} // ns muse
+
+#endif // MUSE_ROUTED_MODULE_HPP
@@ -0,0 +1,98 @@
+/**
+ * \file      source_matcher.hpp
+ * \brief     Provides the cached matching of the bundle sources against regular expression
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:03 UTC
+ * \copyright BSD
+ */
+
+#ifndef MUSE_SOURCE_MATCHER_HPP
+#define MUSE_SOURCE_MATCHER_HPP
+
+#include <kerat/kerat.hpp>
+#include <kerat/delta_encoding.hpp>
+#include <sys/types.h>
+#include <regex.h>
+#include <string>
+#include <map>
+
+namespace muse {
+    namespace internals {
+
+        /**
+         * \brief Gets the identity of the source the regular expressions are matched against
+         *
+         * The identity has the form "app_name:address/instance". The string is
+         * formatted once per source and shared by all the modules, the table is
+         * never shrunk as the count of the sources is small.
+         *
+         * \param source - the source to get the identity of
+         * \return identity string, valid for the whole program run
+         */
+        const std::string & get_source_identity(const libkerat::internals::source_key & source);
+
+        /**
+         * \brief Matches the bundle sources against regular expression
+         *
+         * The source of a bundle changes rarely, thus the decision is
+         * remembered for each source seen and the regular expression is only
+         * run for the sources not seen before. Changing the regular expression
+         * forgets all the decisions made.
+         */
+        class source_matcher {
+        public:
+
+            /**
+             * \brief Creates new matcher
+             * \param matching_regex - POSIX extended regular expression, see \ref set_regex
+             */
+            explicit source_matcher(const std::string & matching_regex = ".*");
+            ~source_matcher();
+
+            /**
+             * \brief Sets the regular expression to match the sources against
+             *
+             * If the expression is invalid, an error is reported and no source
+             * matches until a valid one is set.
+             *
+             * \param matching_regex - POSIX extended regular expression
+             * \return true if the expression has been compiled
+             */
+            bool set_regex(const std::string & matching_regex);
+
+            inline const std::string & get_regex() const { return m_pattern; }
+            inline bool is_valid() const { return m_valid; }
+
+            /**
+             * \brief Checks whether the bundle comes from a matching source
+             * \param bundle - bundle containing extended frame message
+             * \return true if the source matches, false if not or if the frame is missing or not extended
+             */
+            bool is_matching(const libkerat::bundle_handle & bundle);
+
+            //! \brief Checks whether the source of the frame matches
+            bool is_matching(const libkerat::message::frame & frame);
+
+            //! \brief Gets the count of the sources with the decision remembered
+            inline size_t get_cached_count() const { return m_decisions.size(); }
+
+        private:
+
+            typedef std::map<libkerat::internals::source_key, bool> decision_map;
+
+            source_matcher(const source_matcher &);
+            source_matcher & operator=(const source_matcher &);
+
+            regex_t m_regex;
+            bool m_valid;
+            std::string m_pattern;
+
+            decision_map m_decisions;
+            // the decision used last, most bundles come from the same source
+            decision_map::const_iterator m_last;
+        };
+
+    }
+}
+
+#endif // MUSE_SOURCE_MATCHER_HPP
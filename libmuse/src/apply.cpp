@@ -23,28 +23,12 @@ namespace muse {
     namespace aggregators {
 
         apply::apply(const std::string & matching_regex, const apply::adaptor_vector & adaptors_to_apply, bool free_adaptors)
-            :m_free_adaptors(free_adaptors)
+            :m_matcher(matching_regex), m_free_adaptors(free_adaptors)
         {
-            memset(&m_regex, 0, sizeof(m_regex));
-
-            int rslt = regcomp(&m_regex, matching_regex.c_str(), REG_EXTENDED | REG_NOSUB);
-            if (rslt != 0){
-                //! \todo throw
-                const size_t REGEX_ERROR_BUFFSIZE = 2048;
-                char * regex_error = new char[REGEX_ERROR_BUFFSIZE];
-                memset(regex_error, 0, REGEX_ERROR_BUFFSIZE);
-                regerror(rslt, &m_regex, regex_error, REGEX_ERROR_BUFFSIZE-1);
-                std::cerr << "Regex: '" << matching_regex << "' is invalid due to :" << regex_error << std::endl;
-                delete regex_error;
-                regex_error = NULL;
-                regfree(&m_regex);
-            }
-            
             set_adaptors(adaptors_to_apply);
         }
 
         apply::~apply(){
-            regfree(&m_regex);
             for (
                 adaptor_vector::iterator adaptor_instance = m_adaptors.begin();
                 adaptor_instance != m_adaptors.end();
@@ -95,18 +79,7 @@ namespace muse {
         }
 
         bool apply::is_bundle_matching(const libkerat::bundle_handle& bundle){
-
-            const libkerat::message::frame * msg_frame = bundle.get_frame();
-            assert(msg_frame != NULL);
-            if (msg_frame == NULL){ return false; }
-            assert(msg_frame->is_extended());
-            if (!msg_frame->is_extended()){ return false; }
-
-            std::stringstream sx;
-            sx << msg_frame->get_app_name() << ":" << libkerat::ipv4_to_str(msg_frame->get_address()) << "/" << msg_frame->get_instance();
-            std::string tmp;
-            std::getline(sx, tmp);
-            return !regexec(&m_regex, tmp.c_str(), 0, NULL, 0);
+            return m_matcher.is_matching(bundle);
         }
         
         void apply::notify(const libkerat::client * cl){
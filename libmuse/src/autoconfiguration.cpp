@@ -119,11 +119,13 @@ namespace muse {
         int autoremapper::translate_bundle(const autoremapper::i_primitive * sensor, libkerat::bundle_handle& to_process){
             // process intermediate messages
             for (handle_iterator i = bm_handle_begin(to_process); i != bm_handle_end(to_process); ++i){
+                // the message may be shared with other bundles, translate private copy
+                libkerat::kerat_message * current = bm_handle_detach(to_process, i);
 
                 { // position corrections
-                    libkerat::helpers::point_2d * hp_2point = dynamic_cast<libkerat::helpers::point_2d*>(*i);
+                    libkerat::helpers::point_2d * hp_2point = dynamic_cast<libkerat::helpers::point_2d*>(current);
                     if (hp_2point != NULL){
-                        libkerat::helpers::point_3d * hp_3point = dynamic_cast<libkerat::helpers::point_3d*>(*i);
+                        libkerat::helpers::point_3d * hp_3point = dynamic_cast<libkerat::helpers::point_3d*>(current);
                         libkerat::helpers::point_3d tmp = compensate_drift_3d(
                             sensor->m_correction_azimuth, 
                             sensor->m_correction_altitude, 
@@ -141,9 +143,9 @@ namespace muse {
                 }
 
                 { // velocity corrections
-                    libkerat::helpers::velocity_2d * hp_2velocity = dynamic_cast<libkerat::helpers::velocity_2d*>(*i);
+                    libkerat::helpers::velocity_2d * hp_2velocity = dynamic_cast<libkerat::helpers::velocity_2d*>(current);
                     if (hp_2velocity != NULL){
-                        libkerat::helpers::velocity_3d * hp_3velocity = dynamic_cast<libkerat::helpers::velocity_3d*>(*i);
+                        libkerat::helpers::velocity_3d * hp_3velocity = dynamic_cast<libkerat::helpers::velocity_3d*>(current);
 
                         libkerat::helpers::point_3d tmp(hp_2velocity->get_x_velocity(), hp_2velocity->get_y_velocity(), 0);
                         if (hp_3velocity != NULL){ tmp.set_z(hp_3velocity->get_z_velocity()); }
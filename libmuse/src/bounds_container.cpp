@@ -24,68 +24,10 @@ namespace muse {
     namespace aggregators {
 
         bounds_container::bounds_container(const std::string & matching_regex, libkerat::slot_t container_slot, bool container_cascade)
-            :m_slot(container_slot), m_cascade(container_cascade), m_was_ala(false)
-        {
-            memset(&m_regex, 0, sizeof(m_regex));
-
-            int rslt = regcomp(&m_regex, matching_regex.c_str(), REG_EXTENDED | REG_NOSUB);
-            if (rslt != 0){
-                //! \todo throw
-                const size_t REGEX_ERROR_BUFFSIZE = 2048;
-                char * regex_error = new char[REGEX_ERROR_BUFFSIZE];
-                memset(regex_error, 0, REGEX_ERROR_BUFFSIZE);
-                regerror(rslt, &m_regex, regex_error, REGEX_ERROR_BUFFSIZE-1);
-                std::cerr << "Regex: '" << matching_regex << "' is invalid due to :" << regex_error << std::endl;
-                delete regex_error;
-                regex_error = NULL;
-                regfree(&m_regex);
-            }
-        }
-
-        bounds_container::~bounds_container(){
-            regfree(&m_regex);
-        }
-
-        libkerat::helpers::point_2d bounds_container::rotate_with_center(const libkerat::helpers::point_2d & point, const libkerat::helpers::point_2d & center, const libkerat::helpers::angle_2d & angle){
-
-            using libkerat::helpers::point_2d;
-
-            point_2d retval = point - center;
-
-            // rotating the bounding box inner ellipse for the main axis to match x axis
-            double tmp_cos = cos(-angle.get_angle());
-            double tmp_sin = sin(-angle.get_angle());
-
-            retval = point_2d(
-                (tmp_cos * retval.get_x()) + (tmp_sin*retval.get_y()),
-                ((-tmp_sin)*retval.get_x()) + (tmp_cos*retval.get_y())
-            );
-
-            retval += center;
-            return retval;
-        }
-
-        bool bounds_container::inside_bound_ellipse(const libkerat::message::bounds & bound, const libkerat::helpers::point_2d & point){
-
-            using libkerat::helpers::point_2d;
-            point_2d rotated_point = rotate_with_center(point, bound, bound);
+            :m_matcher(matching_regex), m_slot(container_slot), m_cascade(container_cascade), m_was_ala(false)
+        { ; }
 
-            double a = bound.get_width()/2;
-            double b = bound.get_height()/2;
-
-            // from now on, consider a to be the main axis
-            assert(a >= b);
-
-            double a_squared = (a * a);
-            double b_squared = (b * b);
-
-            double focus = sqrt(a_squared - b_squared);
-
-            point_2d f1(bound.get_x() - focus, bound.get_y());
-            point_2d f2(bound.get_x() + focus, bound.get_y());
-
-            return ((libkerat::distance(f1, rotated_point) + libkerat::distance(f2, rotated_point)) < (2*a));
-        }
+        bounds_container::~bounds_container(){ ; }
 
         int bounds_container::process_container_frame(const libkerat::bundle_handle& to_process){
             //clear_bounds();
@@ -99,9 +41,9 @@ namespace muse {
                     bounds_map::iterator bnd = m_bounds.find(sid);
 
                     if (bnd != m_bounds.end()){
-                        bnd->second = *msg_bound;
+                        bnd->second = internals::ellipse_shape(*msg_bound);
                     } else {
-                        m_bounds.insert(bounds_map::value_type(sid, *msg_bound));
+                        m_bounds.insert(bounds_map::value_type(sid, internals::ellipse_shape(*msg_bound)));
                     }
 
                     m_alives.insert(sid);
@@ -198,22 +140,36 @@ namespace muse {
             }
             m_ala_ids = alas;
 
+            // find the first bound containing each of the received points at once
+            std::vector<libkerat::session_id_t> owners;
+            m_points.clear();
+            for (sid_cid_point_map::const_iterator cid_map = m_points_buffer.begin(); cid_map != m_points_buffer.end(); cid_map++){
+                for (cid_point_map::const_iterator pt = cid_map->second.begin(); pt != cid_map->second.end(); pt++){
+                    m_points.add(pt->second);
+                    owners.push_back(cid_map->first);
+                }
+            }
+            std::vector<bounds_map::const_iterator> matches;
+            internals::match_containers(m_bounds, m_points, owners, matches);
+
             sid_coa_map tmp_containers = m_containers;
             // commit all received points
+            size_t point_index = 0;
             for (sid_cid_point_map::const_iterator cid_map = m_points_buffer.begin(); cid_map != m_points_buffer.end(); cid_map++){
-                for (cid_point_map::const_iterator pt = cid_map->second.begin(); pt != cid_map->second.end(); pt++){
+                for (cid_point_map::const_iterator pt = cid_map->second.begin(); pt != cid_map->second.end(); pt++, point_index++){
                     bool is_inside = false;
                     bool record_found = false;
                     // find previous association
                     if (!m_cascade){
                         for (sid_coa_map::iterator prev_bnd = tmp_containers.begin(); !(is_inside|record_found) && (tmp_containers.end() != prev_bnd); prev_bnd++){
-                            libkerat::session_set coa_assoc = prev_bnd->second.get_associations();
-                            if (coa_assoc.find(pt->first) != coa_assoc.end()){
+                            const libkerat::session_set & prev_assoc = prev_bnd->second.get_associations();
+                            if (prev_assoc.find(pt->first) != prev_assoc.end()){
                                 record_found = true;
 // commendted out due to experiment
-//                                if (inside_bound_ellipse(m_bounds[prev_bnd->first], pt->second)){
+//                                if (m_bounds[prev_bnd->first].contains(pt->second.get_x(), pt->second.get_y())){
 //                                    is_inside = true;
 //                                } else {
+                                    libkerat::session_set coa_assoc = prev_assoc;
                                     coa_assoc.erase(pt->first);
                                     prev_bnd->second.set_associations(coa_assoc);
 //                                }
@@ -223,18 +179,15 @@ namespace muse {
                         if (is_inside){ continue; }
                     }
 
-                    // find new association
-                    for (bounds_map::const_iterator i = m_bounds.begin(); (!is_inside) && (i != m_bounds.end()); i++){
-                        if (cid_map->first == i->first){ continue; }
-                        is_inside = inside_bound_ellipse(i->second, pt->second);
-                        if (is_inside){
-                            libkerat::message::container_association & coa = tmp_containers[i->first];
-                            libkerat::session_set coa_assoc = coa.get_associations();
-                            coa_assoc.insert(cid_map->first);
-                            coa.set_associations(coa_assoc);
-                            coa.set_session_id(i->first);
-                            coa.set_slot(m_slot);
-                        }
+                    // new association
+                    bounds_map::const_iterator i = matches[point_index];
+                    if (i != m_bounds.end()){
+                        libkerat::message::container_association & coa = tmp_containers[i->first];
+                        libkerat::session_set coa_assoc = coa.get_associations();
+                        coa_assoc.insert(cid_map->first);
+                        coa.set_associations(coa_assoc);
+                        coa.set_session_id(i->first);
+                        coa.set_slot(m_slot);
                     }
                 }
             }
@@ -285,18 +238,7 @@ namespace muse {
         }
 
         bool bounds_container::is_bundle_matching(const libkerat::bundle_handle& bundle){
-
-            const libkerat::message::frame * msg_frame = bundle.get_frame();
-            assert(msg_frame != NULL);
-            if (msg_frame == NULL){ return false; }
-            assert(msg_frame->is_extended());
-            if (!msg_frame->is_extended()){ return false; }
-
-            std::stringstream sx;
-            sx << msg_frame->get_app_name() << ":" << libkerat::ipv4_to_str(msg_frame->get_address()) << "/" << msg_frame->get_instance();
-            std::string tmp;
-            std::getline(sx, tmp);
-            return !regexec(&m_regex, tmp.c_str(), 0, NULL, 0);
+            return m_matcher.is_matching(bundle);
         }
 
         void bounds_container::notify(const libkerat::client * cl){
@@ -0,0 +1,343 @@
+/**
+ * \file      container_shapes.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:01 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/kerat.hpp>
+#include <muse/container_shapes.hpp>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace muse {
+    namespace internals {
+
+        convex_shape::convex_shape()
+            :m_error(-1), m_orientation(1), m_center_x(0), m_center_y(0), m_radius_squared(0)
+        {
+            m_bounds.min_x = m_bounds.min_y = 0;
+            m_bounds.max_x = m_bounds.max_y = -1;
+        }
+
+        convex_shape::convex_shape(const libkerat::message::convex_hull::point_2d_list & hull)
+            :m_error(0), m_orientation(1), m_center_x(0), m_center_y(0), m_radius_squared(0)
+        {
+            using libkerat::helpers::point_2d;
+            typedef std::vector<point_2d> point_vector;
+
+            m_bounds.min_x = m_bounds.min_y = 0;
+            m_bounds.max_x = m_bounds.max_y = -1;
+
+            point_vector points(hull.begin(), hull.end());
+            const size_t count = points.size();
+            if (count <= 2){
+                m_error = -1;
+                return;
+            }
+
+            // the same checks as inside_convex_polygonal_container, including the truncation
+            int correction = 0;
+            for (size_t i = 0; i < count; ++i){
+                const point_2d & first = points[i];
+                const point_2d & second = points[(i + 1) % count];
+                const point_2d & third = points[(i + 2) % count];
+
+                point_2d a(second.get_x() - first.get_x(), second.get_y() - first.get_y());
+                point_2d b(third.get_x() - second.get_x(), third.get_y() - second.get_y());
+
+                int tmp_correction = (a.get_x() * b.get_y()) - (a.get_y() * b.get_x());
+                if (tmp_correction == 0){
+                    m_error = -2;
+                    return;
+                }
+
+                tmp_correction = (tmp_correction > 0)?1:-1;
+                if (correction == 0){ correction = tmp_correction; }
+                if (correction != tmp_correction){
+                    m_error = -3;
+                    return;
+                }
+            }
+            m_orientation = correction;
+
+            m_first_x.reserve(count);
+            m_first_y.reserve(count);
+            m_second_x.reserve(count);
+            m_second_y.reserve(count);
+
+            double min_x = points[0].get_x();
+            double max_x = min_x;
+            double min_y = points[0].get_y();
+            double max_y = min_y;
+            double min_edge = HUGE_VAL;
+            double magnitude = 0;
+
+            for (size_t i = 0; i < count; ++i){
+                const point_2d & first = points[i];
+                const point_2d & second = points[(i + 1) % count];
+
+                m_first_x.push_back(first.get_x());
+                m_first_y.push_back(first.get_y());
+                m_second_x.push_back(second.get_x());
+                m_second_y.push_back(second.get_y());
+
+                min_x = std::min(min_x, (double)first.get_x());
+                max_x = std::max(max_x, (double)first.get_x());
+                min_y = std::min(min_y, (double)first.get_y());
+                max_y = std::max(max_y, (double)first.get_y());
+                min_edge = std::min(min_edge, libkerat::distance(first, second));
+                magnitude = std::max(magnitude, (double)std::max(std::fabs(first.get_x()), std::fabs(first.get_y())));
+            }
+
+            m_center_x = (min_x + max_x) / 2;
+            m_center_y = (min_y + max_y) / 2;
+            double radius = 0;
+            for (size_t i = 0; i < count; ++i){
+                double dx = points[i].get_x() - m_center_x;
+                double dy = points[i].get_y() - m_center_y;
+                radius = std::max(radius, std::sqrt((dx * dx) + (dy * dy)));
+            }
+
+            // The determinant is truncated to int, thus the points closer than
+            // 1/edge length to the edge count as inside. Add the rounding error
+            // of the float computation and widen by the miter of the sharpest
+            // corner to get the enclosure of all the points that may pass.
+            double span = (2 * radius) + magnitude + 1;
+            double tolerance = (1 + (32 * FLT_EPSILON * span * span)) / min_edge;
+            double miter = 1;
+            for (size_t i = 0; i < count; ++i){
+                const point_2d & previous = points[(i + count - 1) % count];
+                const point_2d & current = points[i];
+                const point_2d & next = points[(i + 1) % count];
+
+                double in_x = previous.get_x() - current.get_x();
+                double in_y = previous.get_y() - current.get_y();
+                double out_x = next.get_x() - current.get_x();
+                double out_y = next.get_y() - current.get_y();
+
+                double cosine = ((in_x * out_x) + (in_y * out_y)) / (std::sqrt((in_x * in_x) + (in_y * in_y)) * std::sqrt((out_x * out_x) + (out_y * out_y)));
+                double half_sine = std::sqrt(std::max(0.0, (1 - cosine) / 2));
+                miter = std::max(miter, 1 / std::max(half_sine, 1e-6));
+            }
+            double margin = (tolerance * miter * 1.01) + 1e-3;
+
+            m_bounds.min_x = min_x - margin;
+            m_bounds.max_x = max_x + margin;
+            m_bounds.min_y = min_y - margin;
+            m_bounds.max_y = max_y + margin;
+            m_radius_squared = (radius + margin) * (radius + margin);
+        }
+
+        bool convex_shape::may_contain(const libkerat::coord_t x, const libkerat::coord_t y) const {
+            if (!m_bounds.contains(x, y)){ return false; }
+
+            double dx = x - m_center_x;
+            double dy = y - m_center_y;
+            return ((dx * dx) + (dy * dy)) <= m_radius_squared;
+        }
+
+        bool convex_shape::contains(const libkerat::coord_t x, const libkerat::coord_t y) const {
+            if (m_error != 0){ return false; }
+
+            for (size_t i = 0; i < m_first_x.size(); ++i){
+                libkerat::coord_t ax = m_first_x[i] - x;
+                libkerat::coord_t ay = m_first_y[i] - y;
+                libkerat::coord_t bx = x - m_second_x[i];
+                libkerat::coord_t by = y - m_second_y[i];
+
+                libkerat::coord_t determinant = (bx * ay) - (by * ax);
+                // int truncated determinant * correction < 0
+                if ((determinant * m_orientation) <= -1){ return false; }
+            }
+
+            return true;
+        }
+
+        void convex_shape::classify(const libkerat::coord_t * xs, const libkerat::coord_t * ys, size_t count, unsigned char * inside) const {
+            size_t i = 0;
+
+            if (m_error != 0){
+                for (; i < count; ++i){ inside[i] = 0; }
+                return;
+            }
+
+#ifdef __SSE__
+            const size_t edges = m_first_x.size();
+            const __m128 limit = _mm_set1_ps(-1);
+            const __m128 orientation = _mm_set1_ps(m_orientation);
+
+            for (; (i + 4) <= count; i += 4){
+                const __m128 x = _mm_loadu_ps(xs + i);
+                const __m128 y = _mm_loadu_ps(ys + i);
+
+                int outside = 0;
+                for (size_t e = 0; (e < edges) && (outside != 0xf); ++e){
+                    __m128 ax = _mm_sub_ps(_mm_set1_ps(m_first_x[e]), x);
+                    __m128 ay = _mm_sub_ps(_mm_set1_ps(m_first_y[e]), y);
+                    __m128 bx = _mm_sub_ps(x, _mm_set1_ps(m_second_x[e]));
+                    __m128 by = _mm_sub_ps(y, _mm_set1_ps(m_second_y[e]));
+
+                    __m128 determinant = _mm_sub_ps(_mm_mul_ps(bx, ay), _mm_mul_ps(by, ax));
+                    outside |= _mm_movemask_ps(_mm_cmple_ps(_mm_mul_ps(determinant, orientation), limit));
+                }
+
+                for (size_t lane = 0; lane < 4; ++lane){ inside[i + lane] = !((outside >> lane) & 1); }
+            }
+#endif
+
+            for (; i < count; ++i){ inside[i] = contains(xs[i], ys[i]); }
+        }
+
+        ellipse_shape::ellipse_shape()
+            :m_valid(false), m_cos(1), m_sin(0), m_major_axis(0), m_radius_squared(0)
+        {
+            m_bounds.min_x = m_bounds.min_y = 0;
+            m_bounds.max_x = m_bounds.max_y = -1;
+        }
+
+        ellipse_shape::ellipse_shape(const libkerat::message::bounds & bound)
+            :m_valid(false), m_center(bound.get_x(), bound.get_y()), m_major_axis(0), m_radius_squared(0)
+        {
+            using libkerat::helpers::point_2d;
+
+            m_bounds.min_x = m_bounds.min_y = 0;
+            m_bounds.max_x = m_bounds.max_y = -1;
+
+            // rotating the bounding box inner ellipse for the main axis to match x axis
+            m_cos = cos(-bound.get_angle());
+            m_sin = sin(-bound.get_angle());
+
+            double a = bound.get_width()/2;
+            double b = bound.get_height()/2;
+
+            // a is the main axis, the foci would not be real otherwise
+            m_valid = (a >= b);
+            if (!m_valid){ return; }
+
+            double a_squared = (a * a);
+            double b_squared = (b * b);
+
+            double focus = sqrt(a_squared - b_squared);
+
+            m_focus_1 = point_2d(bound.get_x() - focus, bound.get_y());
+            m_focus_2 = point_2d(bound.get_x() + focus, bound.get_y());
+            m_major_axis = 2*a;
+
+            // enclose the slightly bigger ellipse to cover the rounding of the rotated point
+            double margin = (16 * FLT_EPSILON * (a + std::fabs(bound.get_x()) + std::fabs(bound.get_y()))) + 1e-3;
+            double major = a + margin;
+            double minor_squared = b_squared + (2 * a * margin) + (margin * margin);
+
+            double half_width = std::sqrt((major * major * m_cos * m_cos) + (minor_squared * m_sin * m_sin));
+            double half_height = std::sqrt((major * major * m_sin * m_sin) + (minor_squared * m_cos * m_cos));
+
+            m_bounds.min_x = bound.get_x() - half_width;
+            m_bounds.max_x = bound.get_x() + half_width;
+            m_bounds.min_y = bound.get_y() - half_height;
+            m_bounds.max_y = bound.get_y() + half_height;
+            m_radius_squared = major * major;
+        }
+
+        bool ellipse_shape::may_contain(const libkerat::coord_t x, const libkerat::coord_t y) const {
+            if (!m_bounds.contains(x, y)){ return false; }
+
+            double dx = x - (double)m_center.get_x();
+            double dy = y - (double)m_center.get_y();
+            return ((dx * dx) + (dy * dy)) <= m_radius_squared;
+        }
+
+        bool ellipse_shape::contains(const libkerat::coord_t x, const libkerat::coord_t y) const {
+            using libkerat::helpers::point_2d;
+
+            if (!m_valid){ return false; }
+
+            point_2d rotated_point = point_2d(x, y) - m_center;
+            rotated_point = point_2d(
+                (m_cos * rotated_point.get_x()) + (m_sin*rotated_point.get_y()),
+                ((-m_sin)*rotated_point.get_x()) + (m_cos*rotated_point.get_y())
+            );
+            rotated_point += m_center;
+
+            return ((libkerat::distance(m_focus_1, rotated_point) + libkerat::distance(m_focus_2, rotated_point)) < m_major_axis);
+        }
+
+        void ellipse_shape::classify(const libkerat::coord_t * xs, const libkerat::coord_t * ys, size_t count, unsigned char * inside) const {
+            for (size_t i = 0; i < count; ++i){ inside[i] = contains(xs[i], ys[i]); }
+        }
+
+        point_batch::point_batch()
+            :m_cell_size(1)
+        { ; }
+
+        void point_batch::clear(){
+            m_x.clear();
+            m_y.clear();
+            m_grid.clear();
+        }
+
+        size_t point_batch::add(const libkerat::helpers::point_2d & point){
+            m_x.push_back(point.get_x());
+            m_y.push_back(point.get_y());
+            return m_x.size() - 1;
+        }
+
+        int32_t point_batch::get_cell(double coord) const {
+            static const double LIMIT = 1 << 30;
+
+            double cell = std::floor(coord / m_cell_size);
+            if (!(cell > -LIMIT)){ return -LIMIT; }
+            if (!(cell < LIMIT)){ return LIMIT; }
+            return cell;
+        }
+
+        void point_batch::build_grid(double cell_size){
+            m_cell_size = (cell_size > 1)?cell_size:1;
+
+            m_grid.clear();
+            for (size_t i = 0; i < m_x.size(); ++i){
+                m_grid[grid_cell(get_cell(m_x[i]), get_cell(m_y[i]))].push_back(i);
+            }
+        }
+
+        void point_batch::query(const bounding_box & box, index_vector & found) const {
+            found.clear();
+            if ((box.min_x > box.max_x) || (box.min_y > box.max_y)){ return; }
+
+            const int32_t min_x = get_cell(box.min_x);
+            const int32_t max_x = get_cell(box.max_x);
+            const int32_t min_y = get_cell(box.min_y);
+            const int32_t max_y = get_cell(box.max_y);
+
+            const double cells = ((double)max_x - min_x + 1) * ((double)max_y - min_y + 1);
+            if (cells > m_grid.size()){
+                // the box spans more cells than occupied, walk the occupied ones
+                for (cell_map::const_iterator cell = m_grid.begin(); cell != m_grid.end(); ++cell){
+                    if ((cell->first.first < min_x) || (cell->first.first > max_x)){ continue; }
+                    if ((cell->first.second < min_y) || (cell->first.second > max_y)){ continue; }
+
+                    for (index_vector::const_iterator i = cell->second.begin(); i != cell->second.end(); ++i){
+                        if (box.contains(m_x[*i], m_y[*i])){ found.push_back(*i); }
+                    }
+                }
+            } else {
+                for (int32_t x = min_x; x <= max_x; ++x){
+                    for (int32_t y = min_y; y <= max_y; ++y){
+                        cell_map::const_iterator cell = m_grid.find(grid_cell(x, y));
+                        if (cell == m_grid.end()){ continue; }
+
+                        for (index_vector::const_iterator i = cell->second.begin(); i != cell->second.end(); ++i){
+                            if (box.contains(m_x[*i], m_y[*i])){ found.push_back(*i); }
+                        }
+                    }
+                }
+            }
+        }
+
+    }
+}
@@ -19,52 +19,39 @@
 #include <iostream>
 #include <unistd.h>
 #include <sys/time.h>
-#include "polygonal_container_core.hpp"
 
 namespace muse {
     namespace aggregators {
 
         convex_hull_container::convex_hull_container(const std::string & matching_regex, libkerat::slot_t container_slot, bool container_cascade)
-            :m_slot(container_slot), m_cascade(container_cascade), m_was_ala(false)
-        {
-            memset(&m_regex, 0, sizeof(m_regex));
-
-            int rslt = regcomp(&m_regex, matching_regex.c_str(), REG_EXTENDED | REG_NOSUB);
-            if (rslt != 0){
-                //! \todo throw
-                const size_t REGEX_ERROR_BUFFSIZE = 2048;
-                char * regex_error = new char[REGEX_ERROR_BUFFSIZE];
-                memset(regex_error, 0, REGEX_ERROR_BUFFSIZE);
-                regerror(rslt, &m_regex, regex_error, REGEX_ERROR_BUFFSIZE-1);
-                std::cerr << "Regex: '" << matching_regex << "' is invalid due to :" << regex_error << std::endl;
-                delete regex_error;
-                regex_error = NULL;
-                regfree(&m_regex);
-            }
-        }
+            :m_matcher(matching_regex), m_slot(container_slot), m_cascade(container_cascade), m_was_ala(false)
+        { ; }
 
-        convex_hull_container::~convex_hull_container(){
-            regfree(&m_regex);
-        }
+        convex_hull_container::~convex_hull_container(){ ; }
 
-        bool convex_hull_container::inside_hull(const libkerat::message::convex_hull& hull, const libkerat::helpers::point_2d& point){
-            
-            switch (muse::internals::inside_convex_polygonal_container(hull.get_hull(), point)){
-                case 0: {
-                    return true;
-                }
-                case 1: {
-                    return false;
-                }
-                default: {
-                    std::cerr << "MUSE:convex_hull_container: Error has occured, see message above. Hull dumped:" << std::endl;
-                    std::cerr << hull << std::endl;
-                    return false;
+        internals::convex_shape convex_hull_container::make_shape(const libkerat::message::convex_hull & hull){
+            internals::convex_shape retval(hull.get_hull());
+
+            if (!retval.is_valid()){
+                switch (retval.get_error()){
+                    case -1: {
+                        std::cerr << "MUSE:polygonal_container: Container must have at least 3 points!" << std::endl;
+                        break;
+                    }
+                    case -2: {
+                        std::cerr << "MUSE:polygonal_container: Container is not minimal!" << std::endl;
+                        break;
+                    }
+                    default: {
+                        std::cerr << "MUSE:polygonal_container: Container is not convex!" << std::endl;
+                        break;
+                    }
                 }
+                std::cerr << "MUSE:convex_hull_container: No points will be associated with the hull. Hull dumped:" << std::endl;
+                std::cerr << hull << std::endl;
             }
-            
-            // unreachable
-            return false;
+
+            return retval;
         }
 
         int convex_hull_container::process_container_frame(const libkerat::bundle_handle& to_process){
@@ -79,9 +66,9 @@ namespace muse {
                     hull_map::iterator hull = m_hulls.find(sid);
 
                     if (hull != m_hulls.end()){
-                        hull->second = *msg_hull;
+                        hull->second = make_shape(*msg_hull);
                     } else {
-                        m_hulls.insert(hull_map::value_type(sid, *msg_hull));
+                        m_hulls.insert(hull_map::value_type(sid, make_shape(*msg_hull)));
                     }
 
                     m_alives.insert(sid);
@@ -177,22 +164,36 @@ namespace muse {
             }
             m_ala_ids = alas;
 
+            // find the first hull containing each of the received points at once
+            std::vector<libkerat::session_id_t> owners;
+            m_points.clear();
+            for (sid_cid_point_map::const_iterator cid_map = m_points_buffer.begin(); cid_map != m_points_buffer.end(); cid_map++){
+                for (cid_point_map::const_iterator pt = cid_map->second.begin(); pt != cid_map->second.end(); pt++){
+                    m_points.add(pt->second);
+                    owners.push_back(cid_map->first);
+                }
+            }
+            std::vector<hull_map::const_iterator> matches;
+            internals::match_containers(m_hulls, m_points, owners, matches);
+
             sid_coa_map tmp_containers = m_containers;
             // commit all received points
+            size_t point_index = 0;
             for (sid_cid_point_map::const_iterator cid_map = m_points_buffer.begin(); cid_map != m_points_buffer.end(); cid_map++){
-                for (cid_point_map::const_iterator pt = cid_map->second.begin(); pt != cid_map->second.end(); pt++){
+                for (cid_point_map::const_iterator pt = cid_map->second.begin(); pt != cid_map->second.end(); pt++, point_index++){
                     bool is_inside = false;
                     bool record_found = false;
                     // find previous association
                     if (!m_cascade){
                         for (sid_coa_map::iterator prev_bnd = tmp_containers.begin(); !(is_inside|record_found) && (tmp_containers.end() != prev_bnd); prev_bnd++){
-                            libkerat::session_set coa_assoc = prev_bnd->second.get_associations();
-                            if (coa_assoc.find(pt->first) != coa_assoc.end()){
+                            const libkerat::session_set & prev_assoc = prev_bnd->second.get_associations();
+                            if (prev_assoc.find(pt->first) != prev_assoc.end()){
                                 record_found = true;
 // commented out due to experiment - lock on and not let out
-//                                if (inside_hull(m_hulls[prev_bnd->first], pt->second)){
+//                                if (m_hulls[prev_bnd->first].contains(pt->second.get_x(), pt->second.get_y())){
 //                                    is_inside = true;
 //                                } else {
+                                    libkerat::session_set coa_assoc = prev_assoc;
                                     coa_assoc.erase(pt->first);
                                     prev_bnd->second.set_associations(coa_assoc);
 //                                }
@@ -202,18 +203,15 @@ namespace muse {
                         if (is_inside){ continue; }
                     }
 
-                    // find new association
-                    for (hull_map::const_iterator i = m_hulls.begin(); (!is_inside) && (i != m_hulls.end()); i++){
-                        if (cid_map->first == i->first){ continue; }
-                        is_inside = inside_hull(i->second, pt->second);
-                        if (is_inside){
-                            libkerat::message::container_association & coa = tmp_containers[i->first];
-                            libkerat::session_set coa_assoc = coa.get_associations();
-                            coa_assoc.insert(cid_map->first);
-                            coa.set_associations(coa_assoc);
-                            coa.set_session_id(i->first);
-                            coa.set_slot(m_slot);
-                        }
+                    // new association
+                    hull_map::const_iterator i = matches[point_index];
+                    if (i != m_hulls.end()){
+                        libkerat::message::container_association & coa = tmp_containers[i->first];
+                        libkerat::session_set coa_assoc = coa.get_associations();
+                        coa_assoc.insert(cid_map->first);
+                        coa.set_associations(coa_assoc);
+                        coa.set_session_id(i->first);
+                        coa.set_slot(m_slot);
                     }
                 }
             }
@@ -264,18 +262,7 @@ namespace muse {
         }
 
         bool convex_hull_container::is_bundle_matching(const libkerat::bundle_handle& bundle){
-
-            const libkerat::message::frame * msg_frame = bundle.get_frame();
-            assert(msg_frame != NULL);
-            if (msg_frame == NULL){ return false; }
-            assert(msg_frame->is_extended());
-            if (!msg_frame->is_extended()){ return false; }
-
-            std::stringstream sx;
-            sx << msg_frame->get_app_name() << ":" << libkerat::ipv4_to_str(msg_frame->get_address()) << "/" << msg_frame->get_instance();
-            std::string tmp;
-            std::getline(sx, tmp);
-            return !regexec(&m_regex, tmp.c_str(), 0, NULL, 0);
+            return m_matcher.is_matching(bundle);
         }
 
         void convex_hull_container::notify(const libkerat::client * cl){
@@ -23,23 +23,8 @@ namespace muse {
     namespace aggregators {
 
         filter::filter(const std::string & matching_regex, libkerat::listener * sink)
-            :m_sink(NULL)
+            :m_matcher(matching_regex), m_sink(NULL)
         {
-            memset(&m_regex, 0, sizeof(m_regex));
-
-            int rslt = regcomp(&m_regex, matching_regex.c_str(), REG_EXTENDED | REG_NOSUB);
-            if (rslt != 0){
-                //! \todo throw
-                const size_t REGEX_ERROR_BUFFSIZE = 2048;
-                char * regex_error = new char[REGEX_ERROR_BUFFSIZE];
-                memset(regex_error, 0, REGEX_ERROR_BUFFSIZE);
-                regerror(rslt, &m_regex, regex_error, REGEX_ERROR_BUFFSIZE-1);
-                std::cerr << "Regex: '" << matching_regex << "' is invalid due to :" << regex_error << std::endl;
-                delete regex_error;
-                regex_error = NULL;
-                regfree(&m_regex);
-            }
-            
             set_sink(sink);
         }
         
@@ -70,12 +55,11 @@ namespace muse {
             }
         }
 
-        filter::~filter(){
-            regfree(&m_regex);
-        }
+        filter::~filter(){ ; }
 
         int filter::process_bundle(const libkerat::bundle_handle & to_process, libkerat::bundle_handle & output_frame){
-            libkerat::bundle_handle * newbundle = bm_handle_clone(to_process);
+            // the bundle is just passed over, share the messages
+            libkerat::bundle_handle * newbundle = bm_handle_clone_shared(to_process);
 
             if (is_bundle_matching(to_process)){
                 bm_stack_append(m_filtered_frames, newbundle);
@@ -88,18 +72,7 @@ namespace muse {
         }
 
         bool filter::is_bundle_matching(const libkerat::bundle_handle& bundle){
-
-            const libkerat::message::frame * msg_frame = bundle.get_frame();
-            assert(msg_frame != NULL);
-            if (msg_frame == NULL){ return false; }
-            assert(msg_frame->is_extended());
-            if (!msg_frame->is_extended()){ return false; }
-
-            std::stringstream sx;
-            sx << msg_frame->get_app_name() << ":" << libkerat::ipv4_to_str(msg_frame->get_address()) << "/" << msg_frame->get_instance();
-            std::string tmp;
-            std::getline(sx, tmp);
-            return !regexec(&m_regex, tmp.c_str(), 0, NULL, 0);
+            return m_matcher.is_matching(bundle);
         }
         
         void filter::purge(){
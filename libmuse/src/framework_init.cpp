@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <iterator>
 #include <sstream>
+#include <cstring>
 #include <errno.h>
 #include <limits>
 #include <uuid/uuid.h>
@@ -64,10 +65,40 @@ public:
         *module = new libkerat::adaptors::multiplexing_adaptor;
         return (*module == NULL);
     }
+    virtual bool get_module_interest(const TiXmlElement * module_config __attribute__((unused)), muse::module_interest & interest) const {
+        // session ids of all the messages are remapped
+        interest.add_read<libkerat::message::alive>();
+        interest.set_modifies_all(true);
+        return true;
+    }
     static const char * PATH;
 };
 const char * libkerat_adaptor_multiplexing::PATH = "/libkerat/multiplexing_adaptor";
 
+class libkerat_adaptor_sharded_multiplexing: public muse::module_container {
+public:
+    virtual int create_module_instance(muse::muse_module ** module, const TiXmlElement * module_config) const {
+        if (module == NULL){ return -1; }
+
+        long shards = libkerat::adaptors::sharded_multiplexing_adaptor::DEFAULT_SHARDS;
+        if ((module_config != NULL) && config_key_to_long(module_config, "shards", shards) && (shards <= 0)){
+            *module = NULL;
+            return -1;
+        }
+
+        *module = new libkerat::adaptors::sharded_multiplexing_adaptor(shards);
+        return (*module == NULL);
+    }
+    virtual bool get_module_interest(const TiXmlElement * module_config __attribute__((unused)), muse::module_interest & interest) const {
+        // session ids of all the messages are remapped
+        interest.add_read<libkerat::message::alive>();
+        interest.set_modifies_all(true);
+        return true;
+    }
+    static const char * PATH;
+};
+const char * libkerat_adaptor_sharded_multiplexing::PATH = "/libkerat/sharded_multiplexing_adaptor";
+
 class libkerat_adaptor_scaling: public muse::module_container {
 public:
     //! \todo make module configurable
@@ -255,6 +286,13 @@ public:
 
         return ((*module) == NULL);
     }
+    virtual bool get_module_interest(const TiXmlElement * module_config __attribute__((unused)), muse::module_interest & interest) const {
+        // every message with position might be projected
+        interest.add_read<dtuio::sensor::viewport>();
+        interest.add_read<libkerat::message::alive>();
+        interest.set_modifies_all(true);
+        return true;
+    }
     static const char * PATH;
 };
 const char * dtuio_adaptor_viewport::PATH = "/dtuio/viewport";
@@ -290,6 +328,20 @@ public:
 };
 const char * dtuio_adaptor_scaler::PATH = "/dtuio/scaler";
 
+//! \brief Types touched by the container aggregators, the containers themselves aside
+static void get_container_aggregator_interest(muse::module_interest & interest){
+    interest.add_read<libkerat::message::alive>();
+    interest.add_read<libkerat::message::pointer>();
+    interest.add_read<libkerat::message::token>();
+    interest.add_read<libkerat::message::bounds>();
+    interest.add_read<libkerat::message::container_association>();
+    interest.add_read<libkerat::message::alive_associations>();
+
+    interest.add_modified<libkerat::message::container_association>();
+    interest.add_modified<libkerat::message::alive_associations>();
+    interest.add_modified<libkerat::message::alive>();
+}
+
 class muse_aggregator_cb: public muse::module_container {
 public:
     virtual int create_module_instance(muse::muse_module ** module, const TiXmlElement * module_config) const {
@@ -319,6 +371,10 @@ public:
 
         return (*module == NULL);
     }
+    virtual bool get_module_interest(const TiXmlElement * module_config __attribute__((unused)), muse::module_interest & interest) const {
+        get_container_aggregator_interest(interest);
+        return true;
+    }
     static const char * PATH;
 };
 const char * muse_aggregator_cb::PATH = "/muse/aggregator/container_bounds";
@@ -352,6 +408,11 @@ public:
 
         return (*module == NULL);
     }
+    virtual bool get_module_interest(const TiXmlElement * module_config __attribute__((unused)), muse::module_interest & interest) const {
+        get_container_aggregator_interest(interest);
+        interest.add_read<libkerat::message::convex_hull>();
+        return true;
+    }
     static const char * PATH;
 };
 const char * muse_aggregator_cch::PATH = "/muse/aggregator/container_convex_hull";
@@ -892,6 +953,56 @@ static bool libreco_load_uint32_key(const TiXmlElement * module_config, const ch
     return has_points_count;
 }
 
+/**
+ * \brief Loads number of threads the recognizer matches templates by
+ *
+ * The key is optional, the templates are matched in the calling thread only
+ * when it is unset. Scores do not depend on the number of threads.
+ */
+static unsigned int libreco_load_threads_key(const TiXmlElement * module_config) {
+    long tmp_value = 1;
+    if (config_key_text_value(module_config, "threads") == NULL) {
+        return 1;
+    }
+    
+    if ((!config_key_to_long(module_config, "threads", tmp_value)) || (tmp_value < 1) || (tmp_value > 256)) {
+        std::cerr << "Error loading module configuration - threads invalid, templates are matched in single thread." << std::endl;
+        return 1;
+    }
+    
+    return tmp_value;
+}
+
+/**
+ * \brief Loads number of templates the template index shortlists
+ *
+ * The index is selected by the optional template_index key, vp_tree is the only
+ * index, none (default) scores all templates. Number of shortlisted templates is
+ * read from the shortlist key.
+ *
+ * \return number of shortlisted templates, 0 if no index is used
+ */
+static size_t libreco_load_shortlist_key(const TiXmlElement * module_config, size_t default_size) {
+    std::string index_type = "none";
+    config_key_to_string(module_config, "template_index", index_type);
+    if (index_type == "none") {
+        return 0;
+    }
+    if (index_type != "vp_tree") {
+        std::cerr << "Error loading module configuration - template_index " << index_type << " unknown, all templates are scored." << std::endl;
+        return 0;
+    }
+    
+    long tmp_value = default_size;
+    if ((config_key_text_value(module_config, "shortlist") != NULL)
+            && ((!config_key_to_long(module_config, "shortlist", tmp_value)) || (tmp_value < 1))) {
+        std::cerr << "Error loading module configuration - shortlist invalid, set to default value = " << default_size << std::endl;
+        tmp_value = default_size;
+    }
+    
+    return tmp_value;
+}
+
 static bool libreco_load_origin_key(const TiXmlElement * module_config, libkerat::helpers::point_2d & origin) {
     std::string origin_str = "0 0";
     bool has_origin = config_key_to_string(module_config, "origin", origin_str);
@@ -920,16 +1031,62 @@ static libreco::rutils::unistroke_gesture libreco_convert_singlestroke(const lib
     return gesture;
 }
 
+//! \brief Types touched by the unistroke recognizers, the multistroke ones emit bundles on their own
+static void get_unistroke_recognizer_interest(muse::module_interest & interest){
+    interest.add_read<libkerat::message::pointer>();
+    interest.add_read<libkerat::message::alive>();
+    interest.add_modified<dtuio::gesture::gesture_identification>();
+}
+
+//! \brief Hashes the string and its terminator, so the neighbouring fields can not merge
+static uint64_t libreco_hash_string(const char * str, uint64_t hash) {
+    if (str == NULL) { str = ""; }
+    return libreco::iotools::compiled_templates::hash(str, strlen(str) + 1, hash);
+}
+
+/**
+ * \brief Hashes the template source of the multistroke recognizers as written
+ *
+ * Only the attributes and texts the \ref libreco_anystrokes_loader reads are
+ * hashed, the points are not parsed, so the staleness of compiled templates
+ * is known without the cost of loading the templates.
+ */
+static uint64_t libreco_anystrokes_hash(const TiXmlElement * e_config) {
+    uint64_t hash = libreco::iotools::compiled_templates::HASH_SEED;
+
+    for (const TiXmlElement * e_uni_gesture = e_config->FirstChildElement("uni_gesture"); e_uni_gesture != NULL;
+            e_uni_gesture = e_uni_gesture->NextSiblingElement("uni_gesture")) {
+        hash = libreco_hash_string("uni_gesture", hash);
+        hash = libreco_hash_string(e_uni_gesture->Attribute("gesture_id"), hash);
+        hash = libreco_hash_string(e_uni_gesture->Attribute("name"), hash);
+        hash = libreco_hash_string(e_uni_gesture->Attribute("sensitivity"), hash);
+        hash = libreco_hash_string(e_uni_gesture->Attribute("revert"), hash);
+        hash = libreco_hash_string(e_uni_gesture->GetText(), hash);
+    }
+
+    for (const TiXmlElement * e_multi_gesture = e_config->FirstChildElement("multi_gesture"); e_multi_gesture != NULL;
+            e_multi_gesture = e_multi_gesture->NextSiblingElement("multi_gesture")) {
+        hash = libreco_hash_string("multi_gesture", hash);
+        hash = libreco_hash_string(e_multi_gesture->Attribute("gesture_id"), hash);
+        hash = libreco_hash_string(e_multi_gesture->Attribute("name"), hash);
+        hash = libreco_hash_string(e_multi_gesture->Attribute("sensitivity"), hash);
+
+        for (const TiXmlElement * e_stroke = e_multi_gesture->FirstChildElement("stroke"); e_stroke != NULL;
+                e_stroke = e_stroke->NextSiblingElement("stroke")) {
+            hash = libreco_hash_string(e_stroke->Attribute("stroke_id"), hash);
+            hash = libreco_hash_string(e_stroke->GetText(), hash);
+        }
+    }
+
+    return hash;
+}
+
 class libreco_adaptor_dollar_n: public muse::module_container {
 public:
     //! \todo make module configurable
     virtual int create_module_instance(muse::muse_module ** module, const TiXmlElement * module_config __attribute__((unused))) const {
         if (module == NULL){ return -1; }
         
-        // load templates
-        libreco_generic_multistroke_map gestures;
-        libreco_anystrokes_loader(module_config, gestures);
-        
         //load dollar_n constructor attributes
         uint16_t resample_count = 0;
         if(!libreco_load_uint16_key(module_config, "resample", resample_count)) {
@@ -996,6 +1153,18 @@ public:
             eq_strokes = true;
         }
         
+        unsigned int threads = libreco_load_threads_key(module_config);
+        
+        //optional, the exhaustive matching is the default
+        bool cascade = false;
+        if ((config_key_text_value(module_config, "cascade") != NULL) && !config_key_to_bool(module_config, "cascade", cascade)) {
+            std::cerr << "Error loading module configuration - cascade invalid! Dollar N ($N) matches exhaustively." << std::endl;
+            cascade = false;
+        }
+        
+        //unistroke permutations shortlisted by the template index
+        size_t shortlist = libreco_load_shortlist_key(module_config, 256);
+        
         //load multistroke_adaptor attributes
         uint32_t timeout_sec = 0;
         if(!libreco_load_uint32_key(module_config, "timeout_seconds", timeout_sec)) {
@@ -1026,9 +1195,41 @@ public:
             std::cerr << "Multistroke adaptor sensor_properties message uuid unset or invalid." << std::endl;
         }
         
+        //compiled templates, preprocessed on the first load
+        std::string cache_path;
+        bool has_cache = config_key_to_string(module_config, "template_cache", cache_path) && !cache_path.empty();
+        
+        uint64_t source_hash = has_cache ? libreco_anystrokes_hash(module_config) : 0;
+        libreco::iotools::compiled_parameters expected(source_hash, resample_count, origin, scale_box, scale_thresh, start_index);
+        libreco::iotools::compiled_templates compiled;
+        
+        if (has_cache && compiled.load(cache_path) && (compiled.get_parameters() == expected)) {
+            libreco::recognizers::dollar_n tmp_dollar_n(compiled, rot_down, rot_up, rot_thresh, start_thresh, eq_strokes);
+            tmp_dollar_n.set_thread_count(threads);
+            tmp_dollar_n.set_cascade(cascade);
+            tmp_dollar_n.set_shortlist_size(shortlist);
+            *module = new libreco::adaptors::multistroke_adaptor<libreco::recognizers::dollar_n>(tmp_dollar_n, uuid, timeout_sec, timeout_frac, radius);
+            return (*module == NULL);
+        }
+        
+        if (compiled.is_loaded()) {
+            std::cerr << "Dollar N ($N) compiled templates " << cache_path << " are stale, recompiling." << std::endl;
+            compiled.unload();
+        }
+        
+        // load templates
+        libreco_generic_multistroke_map gestures;
+        libreco_anystrokes_loader(module_config, gestures);
+        
         libreco::recognizers::dollar_n tmp_dollar_n(gestures, resample_count, origin, rot_down, rot_up, rot_thresh,
                                                     scale_box, scale_thresh, start_index, start_thresh, eq_strokes);
+        tmp_dollar_n.set_thread_count(threads);
+        tmp_dollar_n.set_cascade(cascade);
+        tmp_dollar_n.set_shortlist_size(shortlist);
         
+        if (has_cache && !tmp_dollar_n.save_compiled(cache_path, source_hash)) {
+            std::cerr << "Dollar N ($N) templates could not be compiled to " << cache_path << std::endl;
+        }
                         
         *module = new libreco::adaptors::multistroke_adaptor<libreco::recognizers::dollar_n>(tmp_dollar_n, uuid, timeout_sec, timeout_frac, radius);
         
@@ -1064,10 +1265,16 @@ public:
         std::transform(gestures.begin(), gestures.end(), std::back_inserter(tmp_gestures), libreco_convert_singlestroke);
         
         libreco::recognizers::protractor tmp_protractor(tmp_gestures, resample_count, origin);
+        tmp_protractor.set_thread_count(libreco_load_threads_key(module_config));
+        tmp_protractor.set_shortlist_size(libreco_load_shortlist_key(module_config, 32));
         
         *module = new libreco::adaptors::unistroke_adaptor<libreco::recognizers::protractor>(tmp_protractor);
         return (*module == NULL);
     }
+    virtual bool get_module_interest(const TiXmlElement * module_config __attribute__((unused)), muse::module_interest & interest) const {
+        get_unistroke_recognizer_interest(interest);
+        return true;
+    }
     static const char * PATH;
 };
 const char * libreco_adaptor_protractor::PATH = "/muse/recognizers/protractor";
@@ -1125,10 +1332,16 @@ public:
         std::transform(gestures.begin(), gestures.end(), std::back_inserter(tmp_gestures), libreco_convert_singlestroke);
         
         libreco::recognizers::dollar_recognizer tmp_dollar_rec(tmp_gestures, resample_count, origin, rot_down, rot_up, rot_thresh, scale_box);
+        tmp_dollar_rec.set_thread_count(libreco_load_threads_key(module_config));
+        tmp_dollar_rec.set_shortlist_size(libreco_load_shortlist_key(module_config, 32));
         
         *module = new libreco::adaptors::unistroke_adaptor<libreco::recognizers::dollar_recognizer>(tmp_dollar_rec);
         return (*module == NULL);
     }
+    virtual bool get_module_interest(const TiXmlElement * module_config __attribute__((unused)), muse::module_interest & interest) const {
+        get_unistroke_recognizer_interest(interest);
+        return true;
+    }
     static const char * PATH;
 };
 const char * libreco_adaptor_dollar_recognizer::PATH = "/muse/recognizers/dollar_recognizer";
@@ -1180,11 +1393,13 @@ int muse::internals::finalize() {
 int register_libkerat_modules() {
     int retval = 0;
     retval += register_container<libkerat_adaptor_multiplexing>();
+    retval += register_container<libkerat_adaptor_sharded_multiplexing>();
     retval += register_container<libkerat_adaptor_scaling>();
     return retval;
 }
 void unregister_libkerat_modules() {
     unregister_container<libkerat_adaptor_multiplexing>();
+    unregister_container<libkerat_adaptor_sharded_multiplexing>();
     unregister_container<libkerat_adaptor_scaling>();
 }
 
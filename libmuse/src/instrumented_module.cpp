@@ -0,0 +1,128 @@
+/**
+ * \file      instrumented_module.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:38 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/kerat.hpp>
+#include <muse/instrumented_module.hpp>
+#include <iterator>
+#include <time.h>
+
+namespace muse {
+
+    static inline uint64_t elapsed_nsec(const struct timespec & from){
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        struct timespec diff = libkerat::nanotimersub(now, from);
+        return ((uint64_t)diff.tv_sec * (uint64_t)1000000000) + diff.tv_nsec;
+    }
+
+    module_statistics::module_statistics()
+        :bundles_in(0), bundles_out(0), messages_in(0), messages_out(0),
+        backlog(0), backlog_max(0)
+    { ; }
+
+    instrumented_module::probe::probe(instrumented_module & owner)
+        :m_owner(owner)
+    { ; }
+
+    void instrumented_module::probe::notify(const libkerat::client * notifier){
+        // the module is done, what follows is the time of the listeners
+        m_owner.finish_measurement();
+
+        libkerat::bundle_stack data = notifier->get_stack();
+        size_t bundles = 0;
+        m_owner.m_statistics.messages_out += count_messages(data, bundles);
+        m_owner.m_statistics.bundles_out += bundles;
+
+        if (m_owner.m_tracer != NULL){
+            m_owner.m_tracer->stamp(m_owner.m_trace_point, notifier->get_stack());
+        }
+
+        m_owner.notify_listeners();
+    }
+
+    instrumented_module::instrumented_module(libkerat::adaptor * module)
+        :m_module(module), m_probe(*this), m_measuring(false), m_tracer(NULL), m_trace_point(0)
+    {
+        m_module->add_listener(&m_probe);
+    }
+
+    instrumented_module::~instrumented_module(){
+        m_module->del_listener(&m_probe);
+        delete m_module;
+        m_module = NULL;
+    }
+
+    size_t instrumented_module::count_messages(libkerat::bundle_stack & stack, size_t & bundles){
+        size_t messages = 0;
+        bundles = stack.get_length();
+
+        while (stack.get_length() > 0){
+            libkerat::bundle_handle current = stack.get_update();
+            messages += std::distance(current.begin(), current.end());
+        }
+
+        return messages;
+    }
+
+    void instrumented_module::finish_measurement(){
+        if (!m_measuring){ return; }
+
+        m_statistics.latency.record(elapsed_nsec(m_started));
+        m_measuring = false;
+    }
+
+    void instrumented_module::notify(const libkerat::client * notifier){
+        libkerat::bundle_stack data = notifier->get_stack();
+        size_t bundles = 0;
+        m_statistics.messages_in += count_messages(data, bundles);
+        m_statistics.bundles_in += bundles;
+
+        m_statistics.backlog = bundles;
+        if (bundles > m_statistics.backlog_max){ m_statistics.backlog_max = bundles; }
+
+        clock_gettime(CLOCK_MONOTONIC, &m_started);
+        m_measuring = true;
+
+        m_module->notify(notifier);
+
+        // the module has not notified anyone
+        finish_measurement();
+    }
+
+    int instrumented_module::process_bundle(const libkerat::bundle_handle & to_process, libkerat::bundle_handle & output_bundle){
+        ++m_statistics.bundles_in;
+        m_statistics.messages_in += std::distance(to_process.begin(), to_process.end());
+
+        struct timespec started;
+        clock_gettime(CLOCK_MONOTONIC, &started);
+
+        int retval = m_module->process_bundle(to_process, output_bundle);
+
+        m_statistics.latency.record(elapsed_nsec(started));
+        ++m_statistics.bundles_out;
+        m_statistics.messages_out += std::distance(output_bundle.begin(), output_bundle.end());
+
+        if (m_tracer != NULL){ m_tracer->stamp(m_trace_point, output_bundle); }
+
+        return retval;
+    }
+
+    libkerat::bundle_stack instrumented_module::get_stack() const { return m_module->get_stack(); }
+
+    void instrumented_module::purge(){ m_module->purge(); }
+
+    module_statistics instrumented_module::get_statistics() const { return m_statistics; }
+
+    void instrumented_module::reset_statistics(){ m_statistics = module_statistics(); }
+
+    void instrumented_module::set_trace_point(latency_tracer * tracer, size_t point){
+        m_tracer = tracer;
+        m_trace_point = point;
+    }
+
+} // ns muse
@@ -0,0 +1,96 @@
+/**
+ * \file      latency_histogram.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:38 UTC
+ * \copyright BSD
+ */
+
+#include <muse/latency_histogram.hpp>
+
+namespace muse {
+
+    // log2(SUB_BUCKETS)
+    static const unsigned int SUB_BUCKET_BITS = 4;
+
+    // values below SUB_BUCKETS have buckets of their own, then SUB_BUCKETS per each higher bit
+    static const size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * latency_histogram::SUB_BUCKETS;
+
+    latency_histogram::latency_histogram()
+        :m_buckets(BUCKET_COUNT, 0), m_count(0), m_sum(0), m_min(0), m_max(0)
+    { ; }
+
+    size_t latency_histogram::bucket_index(uint64_t value){
+        if (value < SUB_BUCKETS){ return value; }
+
+        unsigned int highest_bit = 63 - __builtin_clzll(value);
+        unsigned int shift = highest_bit - SUB_BUCKET_BITS;
+        size_t sub_bucket = (value >> shift) & (SUB_BUCKETS - 1);
+
+        return ((shift + 1) * SUB_BUCKETS) + sub_bucket;
+    }
+
+    uint64_t latency_histogram::bucket_upper_bound(size_t index){
+        if (index < SUB_BUCKETS){ return index; }
+
+        unsigned int shift = (index / SUB_BUCKETS) - 1;
+        uint64_t sub_bucket = index % SUB_BUCKETS;
+        uint64_t lower_bound = (SUB_BUCKETS + sub_bucket) << shift;
+
+        return lower_bound + (((uint64_t)1 << shift) - 1);
+    }
+
+    void latency_histogram::record(uint64_t value){
+        ++m_buckets[bucket_index(value)];
+
+        if ((m_count == 0) || (value < m_min)){ m_min = value; }
+        if (value > m_max){ m_max = value; }
+        ++m_count;
+        m_sum += value;
+    }
+
+    void latency_histogram::merge(const latency_histogram & other){
+        if (other.m_count == 0){ return; }
+
+        for (size_t i = 0; i < BUCKET_COUNT; ++i){ m_buckets[i] += other.m_buckets[i]; }
+
+        if ((m_count == 0) || (other.m_min < m_min)){ m_min = other.m_min; }
+        if (other.m_max > m_max){ m_max = other.m_max; }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+    }
+
+    void latency_histogram::clear(){
+        m_buckets.assign(BUCKET_COUNT, 0);
+        m_count = 0;
+        m_sum = 0;
+        m_min = 0;
+        m_max = 0;
+    }
+
+    uint64_t latency_histogram::get_mean() const {
+        return (m_count > 0)?(m_sum / m_count):0;
+    }
+
+    uint64_t latency_histogram::get_percentile(double percentile) const {
+        if (m_count == 0){ return 0; }
+
+        if (percentile < 0){ percentile = 0; }
+        if (percentile > 100){ percentile = 100; }
+
+        // rank of the value searched for, at least the first one
+        uint64_t rank = (uint64_t)((percentile / 100.0) * m_count + 0.5);
+        if (rank == 0){ rank = 1; }
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i){
+            seen += m_buckets[i];
+            if (seen >= rank){
+                uint64_t bound = bucket_upper_bound(i);
+                return (bound < m_max)?bound:m_max;
+            }
+        }
+
+        return m_max;
+    }
+
+} // ns muse
@@ -0,0 +1,170 @@
+/**
+ * \file      latency_tracer.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:41 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/kerat.hpp>
+#include <kerat/utils.hpp>
+#include <muse/latency_tracer.hpp>
+#include <lo/lo.h>
+
+namespace muse {
+
+    static inline uint64_t timetag_to_nsec(const libkerat::timetag_t & timetag){
+        return ((uint64_t)timetag.sec * (uint64_t)1000000000) + (((uint64_t)timetag.frac * (uint64_t)1000000000) >> 32);
+    }
+
+    static inline uint64_t elapsed_nsec(const struct timespec & from, const struct timespec & to){
+        struct timespec diff = libkerat::nanotimersub(to, from);
+        return ((uint64_t)diff.tv_sec * (uint64_t)1000000000) + diff.tv_nsec;
+    }
+
+    latency_tracer::point_statistics::point_statistics()
+        :over_budget(0)
+    { ; }
+
+    latency_tracer::point_trace::point_trace()
+        :valid(false), frame(0), over_budget(0)
+    {
+        stamped.tv_sec = 0;
+        stamped.tv_nsec = 0;
+    }
+
+    latency_tracer::latency_tracer()
+        :m_budget(0)
+    {
+        pthread_mutex_init(&m_mutex, NULL);
+    }
+
+    latency_tracer::~latency_tracer(){
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    size_t latency_tracer::add_point(const std::string & name){
+        pthread_mutex_lock(&m_mutex);
+        size_t retval = m_points.size();
+        m_points.push_back(name);
+        pthread_mutex_unlock(&m_mutex);
+
+        return retval;
+    }
+
+    size_t latency_tracer::get_points_count() const {
+        pthread_mutex_lock(&m_mutex);
+        size_t retval = m_points.size();
+        pthread_mutex_unlock(&m_mutex);
+
+        return retval;
+    }
+
+    void latency_tracer::set_budget(uint64_t budget){ m_budget = budget; }
+
+    void latency_tracer::stamp(size_t point, const libkerat::bundle_handle & bundle){
+        const libkerat::message::frame * msg_frame = bundle.get_frame();
+        if (msg_frame == NULL){ return; }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        libkerat::timetag_t wall_now;
+        lo_timetag_now(&wall_now);
+
+        // immediate timetag carries no information, neither do the ones from future
+        libkerat::timetag_t sent = msg_frame->get_timestamp();
+        bool has_timestamp = (sent != LO_TT_IMMEDIATE) && (sent < wall_now);
+
+        pthread_mutex_lock(&m_mutex);
+
+        if (point < m_points.size()){
+            source_trace & trace = m_sources[source_key::from_frame(*msg_frame)];
+            if (trace.size() < m_points.size()){ trace.resize(m_points.size()); }
+
+            point_trace & current = trace[point];
+
+            if (has_timestamp){
+                uint64_t age = timetag_to_nsec(libkerat::timetag_sub(wall_now, sent));
+                current.since_sensor.record(age);
+                if ((m_budget > 0) && (age > m_budget)){ ++current.over_budget; }
+            }
+
+            for (size_t previous = point; previous > 0; --previous){
+                const point_trace & candidate = trace[previous - 1];
+                if (candidate.valid && (candidate.frame == msg_frame->get_frame_id())){
+                    current.since_previous.record(elapsed_nsec(candidate.stamped, now));
+                    break;
+                }
+            }
+
+            current.valid = true;
+            current.frame = msg_frame->get_frame_id();
+            current.stamped = now;
+        }
+
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    void latency_tracer::stamp(size_t point, const libkerat::bundle_stack & stack){
+        libkerat::bundle_stack data = stack;
+        while (data.get_length() > 0){ stamp(point, data.get_update()); }
+    }
+
+    void latency_tracer::get_sources(std::vector<latency_tracer::source_key> & sources) const {
+        sources.clear();
+
+        pthread_mutex_lock(&m_mutex);
+        for (source_map::const_iterator i = m_sources.begin(); i != m_sources.end(); ++i){
+            sources.push_back(i->first);
+        }
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    void latency_tracer::fill_statistics(const latency_tracer::source_trace & trace, latency_tracer::statistics_list & statistics) const {
+        for (size_t point = 0; point < trace.size(); ++point){
+            statistics[point].since_sensor.merge(trace[point].since_sensor);
+            statistics[point].since_previous.merge(trace[point].since_previous);
+            statistics[point].over_budget += trace[point].over_budget;
+        }
+    }
+
+    void latency_tracer::get_statistics(const latency_tracer::source_key & source, latency_tracer::statistics_list & statistics) const {
+        pthread_mutex_lock(&m_mutex);
+
+        statistics.assign(m_points.size(), point_statistics());
+        for (size_t point = 0; point < m_points.size(); ++point){ statistics[point].point = m_points[point]; }
+
+        source_map::const_iterator found = m_sources.find(source);
+        if (found != m_sources.end()){ fill_statistics(found->second, statistics); }
+
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    void latency_tracer::get_statistics(latency_tracer::statistics_list & statistics) const {
+        pthread_mutex_lock(&m_mutex);
+
+        statistics.assign(m_points.size(), point_statistics());
+        for (size_t point = 0; point < m_points.size(); ++point){ statistics[point].point = m_points[point]; }
+
+        for (source_map::const_iterator i = m_sources.begin(); i != m_sources.end(); ++i){
+            fill_statistics(i->second, statistics);
+        }
+
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    void latency_tracer::reset(){
+        pthread_mutex_lock(&m_mutex);
+        m_sources.clear();
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    trace_probe::trace_probe(latency_tracer & tracer, const std::string & name)
+        :m_tracer(tracer), m_point(tracer.add_point(name))
+    { ; }
+
+    void trace_probe::notify(const libkerat::client * notifier){
+        m_tracer.stamp(m_point, notifier->get_stack());
+    }
+
+} // ns muse
@@ -0,0 +1,143 @@
+/**
+ * \file      module_interest.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:15 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/kerat.hpp>
+#include <dtuio/dtuio.hpp>
+#include <muse/module_interest.hpp>
+#include <string>
+#include <list>
+#include <map>
+
+namespace muse {
+
+    //! \brief Known message type along with its OSC paths, NULL if none
+    struct known_type {
+        const std::type_info * type;
+        const char * path;
+        const char * path_3d;
+    };
+
+    struct known_type_less {
+        inline bool operator()(const std::type_info * first, const std::type_info * second) const {
+            return first->before(*second);
+        }
+    };
+
+    typedef std::map<const std::type_info *, known_type, known_type_less> known_type_map;
+
+    static known_type make_known_type(const std::type_info & type, const char * path, const char * path_3d = NULL){
+        known_type retval;
+        retval.type = &type;
+        retval.path = path;
+        retval.path_3d = path_3d;
+        return retval;
+    }
+
+    static known_type_map make_known_types(){
+        using namespace libkerat::message;
+        known_type known[] = {
+            make_known_type(typeid(frame), frame::PATH),
+            make_known_type(typeid(alive), alive::PATH),
+            make_known_type(typeid(pointer), pointer::PATH_2D, pointer::PATH_3D),
+            make_known_type(typeid(token), token::PATH_2D, token::PATH_3D),
+            make_known_type(typeid(bounds), bounds::PATH_2D, bounds::PATH_3D),
+            make_known_type(typeid(symbol), symbol::PATH),
+            make_known_type(typeid(control), control::PATH),
+            make_known_type(typeid(data), data::PATH),
+            make_known_type(typeid(signal), signal::PATH),
+            make_known_type(typeid(convex_hull), convex_hull::PATH),
+            make_known_type(typeid(outer_contour), outer_contour::PATH),
+            make_known_type(typeid(inner_contour), inner_contour::PATH),
+            make_known_type(typeid(skeleton), skeleton::PATH_2D, skeleton::PATH_3D),
+            make_known_type(typeid(skeleton_volume), skeleton_volume::PATH),
+            make_known_type(typeid(area), area::PATH),
+            make_known_type(typeid(raw), raw::PATH),
+            make_known_type(typeid(alive_associations), alive_associations::PATH),
+            make_known_type(typeid(container_association), container_association::PATH),
+            make_known_type(typeid(link_association), link_association::PATH),
+            make_known_type(typeid(linked_list_association), linked_list_association::PATH),
+            make_known_type(typeid(linked_tree_association), linked_tree_association::PATH),
+            // received for the paths with no convertor, consumed by nobody
+            make_known_type(typeid(generic_osc_message), NULL),
+            make_known_type(typeid(dtuio::sensor::viewport), dtuio::sensor::viewport::PATH),
+            make_known_type(typeid(dtuio::sensor::sensor_properties), dtuio::sensor::sensor_properties::PATH),
+            make_known_type(typeid(dtuio::sensor_topology::neighbour), dtuio::sensor_topology::neighbour::PATH),
+            make_known_type(typeid(dtuio::sensor_topology::group_member), dtuio::sensor_topology::group_member::PATH),
+            make_known_type(typeid(dtuio::gesture::gesture_identification), dtuio::gesture::gesture_identification::PATH)
+        };
+
+        known_type_map retval;
+        for (size_t i = 0; i < (sizeof(known)/sizeof(known[0])); ++i){
+            retval.insert(known_type_map::value_type(known[i].type, known[i]));
+        }
+
+        return retval;
+    }
+
+    static const known_type_map & get_known_types(){
+        // the initialization is guarded, the modules of the pipelined chains may ask at once
+        static const known_type_map types(make_known_types());
+        return types;
+    }
+
+    static void append_paths(const known_type & type, std::list<std::string> & paths){
+        if (type.path != NULL){ paths.push_back(type.path); }
+        if (type.path_3d != NULL){ paths.push_back(type.path_3d); }
+    }
+
+    module_interest::module_interest()
+        :m_modifies_all(false)
+    { ; }
+
+    void module_interest::add_read(const std::type_info & type){ m_read.insert(&type); }
+
+    void module_interest::add_modified(const std::type_info & type){ m_modified.insert(&type); }
+
+    bool module_interest::is_read(const std::type_info & type) const { return m_read.find(&type) != m_read.end(); }
+
+    bool module_interest::is_modified(const std::type_info & type) const {
+        return m_modifies_all || (m_modified.find(&type) != m_modified.end());
+    }
+
+    bool module_interest::is_touched(const std::type_info & type) const {
+        return is_read(type) || is_modified(type) || !is_known(type);
+    }
+
+    void module_interest::merge(const module_interest & other){
+        m_read.insert(other.m_read.begin(), other.m_read.end());
+        m_modified.insert(other.m_modified.begin(), other.m_modified.end());
+        m_modifies_all |= other.m_modifies_all;
+    }
+
+    void module_interest::get_read_paths(std::list<std::string> & paths) const {
+        paths.clear();
+
+        const known_type_map & types = get_known_types();
+        for (type_set::const_iterator i = m_read.begin(); i != m_read.end(); ++i){
+            known_type_map::const_iterator type = types.find(*i);
+            if (type != types.end()){ append_paths(type->second, paths); }
+        }
+    }
+
+    void module_interest::get_unused_paths(std::list<std::string> & paths) const {
+        paths.clear();
+
+        const known_type_map & types = get_known_types();
+        for (known_type_map::const_iterator i = types.begin(); i != types.end(); ++i){
+            if ((*(i->first) == typeid(libkerat::message::frame)) || (*(i->first) == typeid(libkerat::message::alive))){ continue; }
+            if (is_read(*(i->first))){ continue; }
+
+            append_paths(i->second, paths);
+        }
+    }
+
+    bool module_interest::is_known(const std::type_info & type){
+        const known_type_map & types = get_known_types();
+        return types.find(&type) != types.end();
+    }
+
+} // ns muse
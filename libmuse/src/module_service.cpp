@@ -6,10 +6,23 @@
  */
 
 #include <muse/module_service.hpp>
+#include <muse/pipeline_stage.hpp>
+#include <muse/instrumented_module.hpp>
+#include <muse/routed_module.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <sstream>
+#include <set>
+
+#include "config_commons_internal.hpp"
 
 namespace muse {
 
-    module_service::module_service(){ ; }
+    const char * module_service::PIPELINE_STAGE_PATH = "/muse/pipeline_stage";
+
+    module_service::module_service():m_instrumentation(false), m_tracer(NULL){ ; }
     module_service::~module_service(){ ; }
     
 	module_service * module_service::get_instance() {
@@ -46,6 +59,14 @@ namespace muse {
 		return !(module_entry == m_registered_modules.end());
 	}
 
+	bool module_service::get_module_interest(const std::string & module_path, const TiXmlElement * module_config, module_interest & interest){
+		typedef module_map::const_iterator const_iterator;
+		const_iterator module_entry = m_registered_modules.find(module_path);
+		if (module_entry == m_registered_modules.end()) { return false; }
+
+		return module_entry->second->get_module_interest(module_config, interest);
+	}
+
 	int module_service::register_module_container(const std::string & module_path, module_container * module_templ){
 		typedef module_map::const_iterator const_iterator;
 		const_iterator module_entry = m_registered_modules.find(module_path);
@@ -89,18 +110,272 @@ namespace muse {
             e_current_module = e_current_module->NextSiblingElement("module");
         }
         
+        module_links links;
         if ((retval == 0) && (!resulting_chain.empty())){
-            module_chain::iterator previous_module = resulting_chain.begin();
-            module_chain::iterator current_module = ++resulting_chain.begin();
-            for ( ; current_module != resulting_chain.end(); ++current_module){
-                previous_module->first->add_listener(current_module->first);
-                previous_module = current_module;
+            retval = resolve_module_links(resulting_chain, links);
+        }
+
+        // routed unless disabled explicitly
+        bool routing = true;
+        if (!config_attr_to_bool(chain_root, "routing", routing)){ routing = true; }
+
+        if ((retval == 0) && routing){
+            for (module_chain::iterator current_module = resulting_chain.begin(); current_module != resulting_chain.end(); ++current_module){
+                module_interest interest;
+                const TiXmlElement * e_config = current_module->second->FirstChildElement("config");
+                if (!get_module_interest(current_module->second->Attribute("path"), e_config, interest)){ continue; }
+
+                // everything would go through the module anyway
+                if (interest.get_modifies_all()){ continue; }
+
+                current_module->first = new routed_module(current_module->first, interest);
+            }
+        }
+
+        bool instrumentation = false;
+        config_attr_to_bool(chain_root, "instrumentation", instrumentation);
+        instrumentation |= m_instrumentation;
+        instrumentation |= (m_tracer != NULL);
+
+        if ((retval == 0) && instrumentation){
+            for (module_chain::iterator current_module = resulting_chain.begin(); current_module != resulting_chain.end(); ++current_module){
+                current_module->first = new instrumented_module(current_module->first);
+            }
+        }
+
+        if ((retval == 0) && (!resulting_chain.empty())){
+            std::string threading;
+            config_attr_to_string(chain_root, "threading", threading);
+            if (threading == "pipeline"){
+                long queue_capacity = pipeline_stage::DEFAULT_QUEUE_CAPACITY;
+                if (!config_attr_to_long(chain_root, "queue_capacity", queue_capacity) || (queue_capacity <= 0)){
+                    queue_capacity = pipeline_stage::DEFAULT_QUEUE_CAPACITY;
+                }
+
+                insert_pipeline_stages(resulting_chain, links, queue_capacity);
+            }
+
+            store_module_links(resulting_chain, links);
+
+            if (m_tracer != NULL){
+                for (module_chain::iterator current_module = resulting_chain.begin(); current_module != resulting_chain.end(); ++current_module){
+                    instrumented_module * instrumented = dynamic_cast<instrumented_module *>(current_module->first);
+                    if (instrumented == NULL){ continue; }
+
+                    std::string point_name = current_module->second->Attribute("id");
+                    point_name += " ";
+                    point_name += current_module->second->Attribute("path");
+                    instrumented->set_trace_point(m_tracer, m_tracer->add_point(point_name));
+                }
+            }
+
+            // fan-out just adds listeners, the bundles are shared by reference
+            for (size_t current_module = 0; current_module < resulting_chain.size(); ++current_module){
+                const std::vector<size_t> & upstream = links[current_module];
+                for (std::vector<size_t>::const_iterator i = upstream.begin(); i != upstream.end(); ++i){
+                    resulting_chain[*i].first->add_listener(resulting_chain[current_module].first);
+                }
             }
         }
         
         return retval;
     }
+
+    static void split_module_ids(const char * list, std::vector<std::string> & ids){
+        ids.clear();
+
+        std::string current;
+        for (const char * c = list; *c != '\0'; ++c){
+            if ((*c == ',') || isspace(*c)){
+                if (!current.empty()){ ids.push_back(current); }
+                current.clear();
+            } else {
+                current.push_back(*c);
+            }
+        }
+        if (!current.empty()){ ids.push_back(current); }
+    }
+
+    int module_service::resolve_module_links(const module_service::module_chain & chain, module_service::module_links & links){
+        typedef std::map<std::string, size_t> id_map;
+        id_map known_ids;
+
+        links.assign(chain.size(), std::vector<size_t>());
+
+        for (size_t current_module = 0; current_module < chain.size(); ++current_module){
+            const TiXmlElement * e_module = chain[current_module].second;
+
+            const char * after = e_module->Attribute("after");
+            if (after == NULL){
+                // by default, module consumes the output of the preceding one
+                if (current_module > 0){ links[current_module].push_back(current_module - 1); }
+            } else {
+                std::vector<std::string> upstream_ids;
+                split_module_ids(after, upstream_ids);
+                if (upstream_ids.empty()){ return -1; }
+
+                // only the modules declared above can be referenced, so the graph has no cycles
+                for (std::vector<std::string>::const_iterator i = upstream_ids.begin(); i != upstream_ids.end(); ++i){
+                    id_map::const_iterator upstream = known_ids.find(*i);
+                    if (upstream == known_ids.end()){ return -1; }
+                    links[current_module].push_back(upstream->second);
+                }
+            }
+
+            const char * id = e_module->Attribute("id");
+            if (id != NULL){
+                if (known_ids.find(id) != known_ids.end()){ return -1; }
+                known_ids.insert(id_map::value_type(id, current_module));
+            }
+        }
+
+        return 0;
+    }
+
+    void module_service::store_module_links(module_service::module_chain & chain, const module_service::module_links & links){
+        std::vector<std::string> ids(chain.size());
+
+        for (size_t current_module = 0; current_module < chain.size(); ++current_module){
+            TiXmlElement * e_module = chain[current_module].second;
+
+            const char * id = e_module->Attribute("id");
+            if (id == NULL){
+                std::stringstream sx;
+                sx << "#" << current_module;
+                sx >> ids[current_module];
+                e_module->SetAttribute("id", ids[current_module].c_str());
+            } else {
+                ids[current_module] = id;
+            }
+
+            std::string after;
+            const std::vector<size_t> & upstream = links[current_module];
+            for (std::vector<size_t>::const_iterator i = upstream.begin(); i != upstream.end(); ++i){
+                if (!after.empty()){ after.append(","); }
+                after.append(ids[*i]);
+            }
+
+            if (after.empty()){
+                e_module->RemoveAttribute("after");
+            } else {
+                e_module->SetAttribute("after", after.c_str());
+            }
+        }
+    }
+
+    void module_service::insert_pipeline_stages(module_service::module_chain & chain, module_service::module_links & links, size_t queue_capacity){
+        module_chain pipelined;
+        module_links pipelined_links;
+        std::vector<size_t> moved_to(chain.size());
+        std::vector<std::string> groups(chain.size());
+
+        for (size_t current_module = 0; current_module < chain.size(); ++current_module){
+            const TiXmlElement * e_module = chain[current_module].second;
+            const char * group = e_module->Attribute("stage");
+            groups[current_module] = (group != NULL)?group:"";
+
+            std::vector<size_t> upstream;
+            for (std::vector<size_t>::const_iterator i = links[current_module].begin(); i != links[current_module].end(); ++i){
+                upstream.push_back(moved_to[*i]);
+            }
+
+            // module shares the worker with its only upstream module of the same named group
+            bool same_group = (group != NULL)
+                && (links[current_module].size() == 1)
+                && (groups[links[current_module].front()] == groups[current_module]);
+
+            if (!same_group){
+                const char * id = e_module->Attribute("id");
+                std::string stage_name = (group != NULL)?group:((id != NULL)?id:e_module->Attribute("path"));
+
+                TiXmlElement * e_stage = new TiXmlElement("module");
+                e_stage->SetAttribute("path", PIPELINE_STAGE_PATH);
+                e_stage->SetAttribute("stage", stage_name.c_str());
+
+                pipelined.push_back(module_chain::value_type(new pipeline_stage(stage_name, queue_capacity), e_stage));
+                pipelined_links.push_back(upstream);
+                upstream.assign(1, pipelined.size() - 1);
+            }
+
+            moved_to[current_module] = pipelined.size();
+            pipelined.push_back(chain[current_module]);
+            pipelined_links.push_back(upstream);
+        }
+
+        chain.swap(pipelined);
+        links.swap(pipelined_links);
+    }
+
+    void module_service::get_chain_statistics(const module_service::module_chain & chain, module_service::statistics_list & statistics){
+        statistics.clear();
+
+        for (module_chain::const_iterator current_module = chain.begin(); current_module != chain.end(); ++current_module){
+            const instrumented_module * instrumented = dynamic_cast<const instrumented_module *>(current_module->first);
+            if (instrumented != NULL){
+                statistics.push_back(statistics_list::value_type(current_module->second, instrumented->get_statistics()));
+            }
+        }
+    }
+
+    bool module_service::get_chain_interest(const module_service::module_chain & chain, module_interest & interest){
+        interest = module_interest();
+
+        for (module_chain::const_iterator current_module = chain.begin(); current_module != chain.end(); ++current_module){
+            const char * path = current_module->second->Attribute("path");
+            if (strcmp(path, PIPELINE_STAGE_PATH) == 0){ continue; }
+
+            module_interest current;
+            if (!get_module_interest(path, current_module->second->FirstChildElement("config"), current)){ return false; }
+            interest.merge(current);
+        }
+
+        return true;
+    }
+
+    void module_service::get_chain_sinks(const module_service::module_chain & chain, std::vector<muse_module *> & sinks){
+        sinks.clear();
+
+        std::set<std::string> consumed;
+        for (module_chain::const_iterator current_module = chain.begin(); current_module != chain.end(); ++current_module){
+            const char * after = current_module->second->Attribute("after");
+            if (after == NULL){ continue; }
+
+            std::vector<std::string> upstream_ids;
+            split_module_ids(after, upstream_ids);
+            consumed.insert(upstream_ids.begin(), upstream_ids.end());
+        }
+
+        for (module_chain::const_iterator current_module = chain.begin(); current_module != chain.end(); ++current_module){
+            const char * id = current_module->second->Attribute("id");
+            if ((id == NULL) || (consumed.find(id) == consumed.end())){
+                sinks.push_back(current_module->first);
+            }
+        }
+    }
+
+    int module_service::start_module_chain(module_service::module_chain & chain){
+        int retval = 0;
+
+        // start from the tail, so no stage waits for the following one to come up
+        for (module_chain::reverse_iterator current_module = chain.rbegin(); current_module != chain.rend(); ++current_module){
+            pipeline_stage * stage = dynamic_cast<pipeline_stage *>(current_module->first);
+            if ((stage != NULL) && !stage->start()){ retval = -1; }
+        }
+
+        if (retval != 0){ stop_module_chain(chain); }
+        return retval;
+    }
+
+    void module_service::stop_module_chain(module_service::module_chain & chain){
+        // the stages are stopped from the head, so no worker waits on the stopped one
+        for (module_chain::iterator current_module = chain.begin(); current_module != chain.end(); ++current_module){
+            pipeline_stage * stage = dynamic_cast<pipeline_stage *>(current_module->first);
+            if (stage != NULL){ stage->stop(); }
+        }
+    }
+
     void module_service::free_module_chain(module_service::module_chain& chain){
+        stop_module_chain(chain);
         for ( 
             module_chain::iterator current_module = chain.begin();
             current_module != chain.end(); 
@@ -0,0 +1,282 @@
+/**
+ * \file      pipeline_stage.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:34 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/kerat.hpp>
+#include <kerat/message_pool.hpp>
+#include <muse/pipeline_stage.hpp>
+#include <errno.h>
+
+namespace muse {
+
+    static inline uint64_t elapsed_nsec(const struct timespec & from, const struct timespec & to){
+        struct timespec diff = libkerat::nanotimersub(to, from);
+        return ((uint64_t)diff.tv_sec * (uint64_t)1000000000) + diff.tv_nsec;
+    }
+
+    //! \brief Computes the absolute monotonic time limit of the waits
+    static inline struct timespec wait_limit(){
+        // short timeout so the stop request is noticed in time
+        struct timespec timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_nsec = 100000000;
+
+        struct timespec limit;
+        clock_gettime(CLOCK_MONOTONIC, &limit);
+        return libkerat::nanotimeradd(limit, timeout);
+    }
+
+    //! \brief Reads the flag shared by the threads, full barrier
+    static inline bool flag_get(volatile int & flag){
+        return __sync_fetch_and_add(&flag, 0) != 0;
+    }
+
+    //! \brief Changes the flag shared by the threads, full barrier
+    static inline void flag_set(volatile int & flag, bool value){
+        if (value){
+            __sync_fetch_and_or(&flag, 1);
+        } else {
+            __sync_fetch_and_and(&flag, 0);
+        }
+    }
+
+    pipeline_stage::statistics::statistics()
+        :processed(0), blocked(0), dropped(0), max_depth(0),
+        queue_latency_total(0), queue_latency_max(0),
+        processing_total(0), processing_max(0)
+    { ; }
+
+    pipeline_stage::pipeline_stage(const std::string & name, size_t queue_capacity)
+        :m_name(name), m_queue((queue_capacity > 0)?queue_capacity:1), m_running(0),
+        m_worker_waiting(0), m_producer_waiting(0)
+    {
+        pthread_mutex_init(&m_producer_mutex, NULL);
+        pthread_mutex_init(&m_wait_mutex, NULL);
+        pthread_mutex_init(&m_statistics_mutex, NULL);
+
+        // wait timeouts are computed from the monotonic clock
+        pthread_condattr_t attributes;
+        pthread_condattr_init(&attributes);
+        pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+        pthread_cond_init(&m_data_cond, &attributes);
+        pthread_cond_init(&m_space_cond, &attributes);
+        pthread_condattr_destroy(&attributes);
+    }
+
+    pipeline_stage::~pipeline_stage(){
+        stop();
+        drain();
+        purge();
+
+        pthread_cond_destroy(&m_space_cond);
+        pthread_cond_destroy(&m_data_cond);
+        pthread_mutex_destroy(&m_statistics_mutex);
+        pthread_mutex_destroy(&m_wait_mutex);
+        pthread_mutex_destroy(&m_producer_mutex);
+    }
+
+    bool pipeline_stage::start(){
+        if (flag_get(m_running)){ return true; }
+
+        flag_set(m_running, true);
+        if (pthread_create(&m_thread, NULL, &pipeline_stage::worker_thread, this) != 0){
+            flag_set(m_running, false);
+        }
+
+        return flag_get(m_running);
+    }
+
+    void pipeline_stage::stop(){
+        if (!flag_get(m_running)){ return; }
+
+        pthread_mutex_lock(&m_wait_mutex);
+        flag_set(m_running, false);
+        pthread_cond_broadcast(&m_data_cond);
+        pthread_cond_broadcast(&m_space_cond);
+        pthread_mutex_unlock(&m_wait_mutex);
+
+        pthread_join(m_thread, NULL);
+        drain();
+    }
+
+    void * pipeline_stage::worker_thread(void * self){
+        pipeline_stage * owner = static_cast<pipeline_stage *>(self);
+
+        while (flag_get(owner->m_running)){
+            queued_bundle * item = NULL;
+            if (owner->m_queue.pop(item)){
+                owner->dispatch(item);
+                continue;
+            }
+
+            struct timespec limit = wait_limit();
+
+            pthread_mutex_lock(&owner->m_wait_mutex);
+            flag_set(owner->m_worker_waiting, true);
+
+            // any error ends the wait as well, the mutex must not be held while spinning
+            int waited = 0;
+            while (flag_get(owner->m_running) && owner->m_queue.empty() && (waited == 0)){
+                waited = pthread_cond_timedwait(&owner->m_data_cond, &owner->m_wait_mutex, &limit);
+            }
+
+            flag_set(owner->m_worker_waiting, false);
+            pthread_mutex_unlock(&owner->m_wait_mutex);
+        }
+
+        // the modules behind the stage hold no more data of this thread
+        owner->purge();
+        libkerat::internals::pool_trim();
+
+        return NULL;
+    }
+
+    void pipeline_stage::dispatch(queued_bundle * item){
+        struct timespec taken;
+        clock_gettime(CLOCK_MONOTONIC, &taken);
+
+        // pairs with the barrier in enqueue, either the producer sees the free slot or we see it waiting
+        if (flag_get(m_producer_waiting)){
+            pthread_mutex_lock(&m_wait_mutex);
+            pthread_cond_signal(&m_space_cond);
+            pthread_mutex_unlock(&m_wait_mutex);
+        }
+
+        uint64_t queue_latency = elapsed_nsec(item->queued, taken);
+
+        purge();
+        bm_stack_append(m_received_frames, item->bundle);
+        delete item;
+
+        // counted before the listeners run, so whoever sees the bundle sees it counted
+        pthread_mutex_lock(&m_statistics_mutex);
+        ++m_statistics.processed;
+        m_statistics.queue_latency_total += queue_latency;
+        if (queue_latency > m_statistics.queue_latency_max){ m_statistics.queue_latency_max = queue_latency; }
+        pthread_mutex_unlock(&m_statistics_mutex);
+
+        notify_listeners();
+
+        struct timespec done;
+        clock_gettime(CLOCK_MONOTONIC, &done);
+
+        uint64_t processing = elapsed_nsec(taken, done);
+        pthread_mutex_lock(&m_statistics_mutex);
+        m_statistics.processing_total += processing;
+        if (processing > m_statistics.processing_max){ m_statistics.processing_max = processing; }
+        pthread_mutex_unlock(&m_statistics_mutex);
+    }
+
+    void pipeline_stage::enqueue(queued_bundle * item){
+        bool blocked = false;
+
+        while (!m_queue.push(item)){
+            if (!flag_get(m_running)){
+                delete item->bundle;
+                delete item;
+                count_dropped();
+                return;
+            }
+
+            if (!blocked){
+                pthread_mutex_lock(&m_statistics_mutex);
+                ++m_statistics.blocked;
+                pthread_mutex_unlock(&m_statistics_mutex);
+                blocked = true;
+            }
+
+            struct timespec limit = wait_limit();
+
+            pthread_mutex_lock(&m_wait_mutex);
+            flag_set(m_producer_waiting, true);
+
+            // any error ends the wait as well, the mutex must not be held while spinning
+            int waited = 0;
+            while (flag_get(m_running) && (m_queue.size() >= m_queue.capacity()) && (waited == 0)){
+                waited = pthread_cond_timedwait(&m_space_cond, &m_wait_mutex, &limit);
+            }
+
+            flag_set(m_producer_waiting, false);
+            pthread_mutex_unlock(&m_wait_mutex);
+        }
+
+        size_t depth = m_queue.size();
+        pthread_mutex_lock(&m_statistics_mutex);
+        if (depth > m_statistics.max_depth){ m_statistics.max_depth = depth; }
+        pthread_mutex_unlock(&m_statistics_mutex);
+
+        // pairs with the barrier in worker_thread, either the worker sees the item or we see it waiting
+        if (flag_get(m_worker_waiting)){
+            pthread_mutex_lock(&m_wait_mutex);
+            pthread_cond_signal(&m_data_cond);
+            pthread_mutex_unlock(&m_wait_mutex);
+        }
+    }
+
+    void pipeline_stage::drain(){
+        queued_bundle * item = NULL;
+        while (m_queue.pop(item)){
+            delete item->bundle;
+            delete item;
+            count_dropped();
+        }
+    }
+
+    void pipeline_stage::count_dropped(){
+        pthread_mutex_lock(&m_statistics_mutex);
+        ++m_statistics.dropped;
+        pthread_mutex_unlock(&m_statistics_mutex);
+    }
+
+    void pipeline_stage::notify(const libkerat::client * notifier){
+        libkerat::bundle_stack data = notifier->get_stack();
+
+        pthread_mutex_lock(&m_producer_mutex);
+
+        if (!flag_get(m_running)){
+            // serial pass-through
+            purge();
+            while (data.get_length() > 0){
+                bm_stack_append(m_received_frames, bm_handle_clone_shared(data.get_update()));
+            }
+
+            notify_listeners();
+        } else {
+            while (data.get_length() > 0){
+                // the worker gets own message list, the messages themselves are shared
+                queued_bundle * item = new queued_bundle;
+                item->bundle = bm_handle_clone_shared(data.get_update());
+                clock_gettime(CLOCK_MONOTONIC, &item->queued);
+
+                enqueue(item);
+            }
+        }
+
+        pthread_mutex_unlock(&m_producer_mutex);
+    }
+
+    int pipeline_stage::process_bundle(const libkerat::bundle_handle & to_process, libkerat::bundle_handle & output_bundle){
+        // stage does not change the data
+        output_bundle = to_process;
+        return 0;
+    }
+
+    libkerat::bundle_stack pipeline_stage::get_stack() const { return m_received_frames; }
+
+    void pipeline_stage::purge(){ bm_stack_clear(m_received_frames); }
+
+    bool pipeline_stage::is_running() const {
+        return flag_get(const_cast<volatile int &>(m_running));
+    }
+
+    pipeline_stage::statistics pipeline_stage::get_statistics() const {
+        pthread_mutex_lock(&m_statistics_mutex);
+        statistics retval = m_statistics;
+        pthread_mutex_unlock(&m_statistics_mutex);
+        return retval;
+    }
+
+} // ns muse
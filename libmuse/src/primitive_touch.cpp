@@ -8,6 +8,8 @@
 
 #include <kerat/kerat.hpp>
 #include <muse/primitive_touch.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace muse {
 
@@ -46,10 +48,12 @@ namespace muse {
         }
 
         primitive_touch::primitive_touch()
-            :m_updates_waiting(false),m_join_treshold_squared(4000)
+            :m_updates_waiting(false),m_join_treshold_squared(4000),
+            m_candidates_count(0), m_candidates_sequence(0)
         {
             m_delta_time.sec = 0;
             m_delta_time.frac = (((uint32_t)-1)/10)*4;
+            init_join_index();
         }
 
         primitive_touch::~primitive_touch(){
@@ -57,14 +61,26 @@ namespace muse {
         }
 
         primitive_touch::primitive_touch(uint32_t join_treshold, libkerat::timetag_t time_treshold)
-            :m_updates_waiting(false),m_join_treshold_squared(join_treshold * join_treshold), m_delta_time(time_treshold)
+            :m_updates_waiting(false),m_join_treshold_squared(join_treshold * join_treshold), m_delta_time(time_treshold),
+            m_candidates_count(0), m_candidates_sequence(0)
         {
-            ;
+            init_join_index();
+        }
+
+        void primitive_touch::init_join_index(){
+            // any point within the treshold lies in the same or neighbouring cell
+            m_cell_size = sqrt((double)m_join_treshold_squared);
+            if (m_cell_size < 1){ m_cell_size = 1; }
+
+            // expiry granularity, the candidates are dropped at most quarter of the delta late
+            uint64_t width = (((uint64_t)m_delta_time.sec << 32) | m_delta_time.frac) / 4;
+            m_bucket_width.sec = width >> 32;
+            m_bucket_width.frac = width & (uint64_t)0xffffffff;
         }
 
         bool primitive_touch::load(int count){
 
-            if (!m_avail_to_join.empty()){
+            if (m_candidates_count > 0){
                 timespec t;
                 t.tv_sec = 0;
                 t.tv_nsec = 100000000;
@@ -112,12 +128,12 @@ namespace muse {
 
             for (const_iterator i = to_process.begin(); i != to_process.end(); i++){
 
-                libkerat::kerat_message * tmp = (*i)->clone();
+                // messages are cloned only when changed, the rest is shared
+                const libkerat::kerat_message * original = *i;
+                libkerat::kerat_message * tmp = NULL;
 
-                libkerat::helpers::point_2d * hp_point = dynamic_cast<libkerat::helpers::point_2d *>(tmp);
-                libkerat::helpers::contact_session * hp_session = dynamic_cast<libkerat::helpers::contact_session *>(tmp);
-                libkerat::message::frame * msg_frm = dynamic_cast<libkerat::message::frame *>(tmp);
-                libkerat::message::alive * msg_alv = dynamic_cast<libkerat::message::alive *>(tmp);
+                const libkerat::helpers::point_2d * hp_point = dynamic_cast<const libkerat::helpers::point_2d *>(original);
+                const libkerat::helpers::contact_session * hp_session = dynamic_cast<const libkerat::helpers::contact_session *>(original);
 
                 if ((hp_point != NULL) && (hp_session != NULL)){
 
@@ -143,27 +159,26 @@ namespace muse {
                     // from now on, consider id safely mapped
                     // update and store last known coordinates
                     m_objects[sid] = *hp_point;
-                    hp_session->set_session_id(sid);
-                } else if (msg_frm != NULL){
-                    msg_frm->set_frame_id(get_next_frame_id());
-                } else if (msg_alv != NULL){
-                    msg_alv->clear();
-                    libkerat::session_set alives;
-
-                    for (session_id_map::const_iterator sr = m_mapping.begin(); sr != m_mapping.end(); sr++){
-                        for (internal_session_id_map::const_iterator sid = sr->second.begin(); sid != sr->second.end(); sid++){
-                            alives.insert(sid->second.mapped_sid);
-                        }
+                    if (sid != tmpsid){
+                        tmp = original->clone();
+                        dynamic_cast<libkerat::helpers::contact_session *>(tmp)->set_session_id(sid);
                     }
-                    for (primitive_touch::free_vector::iterator i = m_avail_to_join.begin(); i != m_avail_to_join.end(); i++){
-                        alives.insert(i->session_id);
-                    }
-
-                    msg_alv->set_alives(alives);
+                } else if (dynamic_cast<const libkerat::message::frame *>(original) != NULL){
+                    tmp = original->clone();
+                    libkerat::message::frame * msg_frm = static_cast<libkerat::message::frame *>(tmp);
+                    msg_frm->set_frame_id(get_next_frame_id());
+                } else if (dynamic_cast<const libkerat::message::alive *>(original) != NULL){
+                    tmp = original->clone();
+                    libkerat::message::alive * msg_alv = static_cast<libkerat::message::alive *>(tmp);
+                    msg_alv->set_alives(m_alives);
                 }
 
-                bm_handle_insert(output_frame, bm_handle_end(output_frame), tmp);
-                tmp = NULL;
+                if (tmp != NULL){
+                    bm_handle_insert(output_frame, bm_handle_end(output_frame), tmp);
+                    tmp = NULL;
+                } else {
+                    bm_handle_insert_shared(output_frame, bm_handle_end(output_frame), original);
+                }
             }
 
             update_idmap(*orig_msg_frm, orig_msg_alv->get_alives());
@@ -203,21 +218,19 @@ namespace muse {
 
 
             { // remove mappings for already-present nodes
-                const internal_session_id_map srcmap_full(srcmap);
-                alive_ids::const_iterator update_end = update.end();
-                alive_ids::const_iterator update_begin = update.begin();
-
-                for (internal_session_id_map::const_iterator current = srcmap_full.begin(); current != srcmap_full.end(); current++){
-                    alive_ids::const_iterator cs = std::find(update_begin, update_end, current->first);
-                    if (cs != update_end){
+                internal_session_id_map::iterator current = srcmap.begin();
+                while (current != srcmap.end()){
+                    alive_ids::iterator cs = update.find(current->first);
+                    if (cs != update.end()){
                         update.erase(cs);
+                        ++current;
                     } else {
                         alv_stamp tmpst;
                         tmpst.since = frame_timestamp;
-                        tmpst.session_id = get_mapped_id(frame, current->first);
+                        tmpst.session_id = current->second.mapped_sid;
                         imprint_coordinates(tmpst, tmpst.session_id);
-                        m_avail_to_join.push_back(tmpst);
-                        srcmap.erase(current->first);
+                        add_join_candidate(tmpst);
+                        srcmap.erase(current++);
                     }
                 }
             }
@@ -252,35 +265,106 @@ namespace muse {
 
         }
 
+        primitive_touch::grid_cell primitive_touch::get_grid_cell(libkerat::coord_t x, libkerat::coord_t y) const {
+            // keep the neighbours of the cell representable
+            const double limit = 1 << 30;
+
+            double cx = floor(x / m_cell_size);
+            double cy = floor(y / m_cell_size);
+            cx = (cx < -limit)?-limit:((cx > limit)?limit:cx);
+            cy = (cy < -limit)?-limit:((cy > limit)?limit:cy);
+
+            return grid_cell((int32_t)cx, (int32_t)cy);
+        }
+
+        void primitive_touch::add_join_candidate(const primitive_touch::alv_stamp & stamp){
+            size_t slot = m_candidates.size();
+            if (m_free_candidates.empty()){
+                m_candidates.push_back(join_candidate());
+            } else {
+                slot = m_free_candidates.back();
+                m_free_candidates.pop_back();
+            }
+
+            join_candidate & candidate = m_candidates[slot];
+            candidate.stamp = stamp;
+            candidate.sequence = ++m_candidates_sequence;
+            candidate.used = true;
+            ++m_candidates_count;
+
+            m_grid[get_grid_cell(stamp.last_x, stamp.last_y)].push_back(slot);
+
+            // the candidates come in the order of release, so only the newest bucket may take it
+            if (m_buckets.empty() || !(libkerat::timetag_diff_abs(stamp.waiting_since, m_buckets.back().oldest) < m_bucket_width)){
+                m_buckets.push_back(time_bucket());
+                m_buckets.back().oldest = stamp.waiting_since;
+            }
+            m_buckets.back().newest = stamp.waiting_since;
+            m_buckets.back().candidates.push_back(candidate_ref(slot, candidate.sequence));
+        }
+
+        void primitive_touch::remove_join_candidate(size_t slot){
+            join_candidate & candidate = m_candidates[slot];
+
+            candidate_grid::iterator cell = m_grid.find(get_grid_cell(candidate.stamp.last_x, candidate.stamp.last_y));
+            if (cell != m_grid.end()){
+                std::vector<size_t> & slots = cell->second;
+                std::vector<size_t>::iterator found = std::find(slots.begin(), slots.end(), slot);
+                if (found != slots.end()){
+                    *found = slots.back();
+                    slots.pop_back();
+                }
+                if (slots.empty()){ m_grid.erase(cell); }
+            }
+
+            candidate.used = false;
+            m_free_candidates.push_back(slot);
+            --m_candidates_count;
+        }
+
         primitive_touch::id_stamp primitive_touch::allocate_session_id(const primitive_touch::alv_stamp & whom){
 
-            typedef primitive_touch::free_vector::iterator iterator;
             using libkerat::coord_t;
             using libkerat::session_id_t;
             using libkerat::timetag_t;
 
             id_stamp retval;
-            
-            for (iterator i = m_avail_to_join.begin(); (retval.mapped_sid == 0) && (i != m_avail_to_join.end()); i++){
-                alv_stamp & scanned = *i;
-
-                coord_t dx = scanned.last_x - whom.last_x; dx *= dx;
-                coord_t dy = scanned.last_y - whom.last_y; dy *= dy;
-                coord_t dz = scanned.last_z - whom.last_z; dz *= dz;
-                timetag_t timediff = libkerat::timetag_diff_abs(whom.since, scanned.since);
-
-                if ((dx+dy+dz) <= m_join_treshold_squared){
-                    if (timediff < m_delta_time){
-                        retval.since = scanned.since;
-                        retval.mapped_sid = scanned.session_id;
-                        m_avail_to_join.erase(i);
+
+            // probe the neighbourhood only, take the earliest released match
+            size_t best = m_candidates.size();
+            if (m_candidates_count > 0){
+                grid_cell center = get_grid_cell(whom.last_x, whom.last_y);
+                for (int32_t x = center.first - 1; x <= center.first + 1; ++x){
+                    for (int32_t y = center.second - 1; y <= center.second + 1; ++y){
+                        candidate_grid::const_iterator cell = m_grid.find(grid_cell(x, y));
+                        if (cell == m_grid.end()){ continue; }
+
+                        for (std::vector<size_t>::const_iterator i = cell->second.begin(); i != cell->second.end(); ++i){
+                            const join_candidate & candidate = m_candidates[*i];
+                            const alv_stamp & scanned = candidate.stamp;
+                            if ((best < m_candidates.size()) && (m_candidates[best].sequence < candidate.sequence)){ continue; }
+
+                            coord_t dx = scanned.last_x - whom.last_x; dx *= dx;
+                            coord_t dy = scanned.last_y - whom.last_y; dy *= dy;
+                            coord_t dz = scanned.last_z - whom.last_z; dz *= dz;
+                            timetag_t timediff = libkerat::timetag_diff_abs(whom.since, scanned.since);
+
+                            if (((dx+dy+dz) <= m_join_treshold_squared) && (timediff < m_delta_time)){
+                                best = *i;
+                            }
+                        }
                     }
                 }
             }
 
-            if (retval.mapped_sid == 0) {
+            if (best < m_candidates.size()){
+                retval.since = m_candidates[best].stamp.since;
+                retval.mapped_sid = m_candidates[best].stamp.session_id;
+                remove_join_candidate(best);
+            } else {
                 retval.since = whom.since;
                 retval.mapped_sid = get_auto_session_id();
+                m_alives.insert(retval.mapped_sid);
             }
 
             return retval;
@@ -292,16 +376,20 @@ namespace muse {
 
             libkerat::timetag_t droptime = libkerat::timetag_add(m_delta_time, m_delta_time);
 
-            typedef primitive_touch::free_vector::iterator iterator;
-            iterator end = m_avail_to_join.end();
-            for (iterator i = m_avail_to_join.begin(); (i != end); i++){
-                alv_stamp & scanned = *i;
-                libkerat::timetag_t timediff = libkerat::timetag_diff_abs(currtime, scanned.waiting_since);
-                if (droptime < timediff){
+            // whole buckets expire once their newest candidate has
+            while (!m_buckets.empty() && (droptime < libkerat::timetag_diff_abs(currtime, m_buckets.front().newest))){
+                const std::vector<candidate_ref> & expired = m_buckets.front().candidates;
+                for (std::vector<candidate_ref>::const_iterator i = expired.begin(); i != expired.end(); ++i){
+                    join_candidate & candidate = m_candidates[i->first];
+                    // joined meanwhile, possibly reused by another candidate
+                    if (!candidate.used || (candidate.sequence != i->second)){ continue; }
+
                     m_updates_waiting = true;
-                    m_objects.erase(scanned.session_id);
-                    m_avail_to_join.erase(i);
+                    m_objects.erase(candidate.stamp.session_id);
+                    m_alives.erase(candidate.stamp.session_id);
+                    remove_join_candidate(i->first);
                 }
+                m_buckets.pop_front();
             }
         }
     }
@@ -0,0 +1,96 @@
+/**
+ * \file      routed_module.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:15 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/kerat.hpp>
+#include <muse/routed_module.hpp>
+#include <typeinfo>
+
+namespace muse {
+
+    routed_module::routed_module(libkerat::adaptor * module, const module_interest & interest)
+        :m_module(module), m_interest(interest), m_bypassed(0), m_routed(0)
+    { ; }
+
+    routed_module::~routed_module(){
+        purge();
+        delete m_module;
+        m_module = NULL;
+    }
+
+    void routed_module::notify(const libkerat::client * notifier){
+        purge();
+
+        libkerat::bundle_stack data = notifier->get_stack();
+
+        while (data.get_length() > 0){
+            libkerat::bundle_handle current_frame = data.get_update();
+            libkerat::bundle_handle * tmphx = new libkerat::bundle_handle;
+            process_bundle(current_frame, *tmphx);
+
+            if (tmphx->begin() == tmphx->end()){ delete tmphx; continue; }
+
+            bm_stack_append(m_processed_frames, tmphx);
+        }
+
+        // the recognizers rely on being notified even if nothing came out
+        notify_listeners();
+    }
+
+    int routed_module::process_bundle(const libkerat::bundle_handle & to_process, libkerat::bundle_handle & output_bundle){
+        typedef libkerat::bundle_handle::const_iterator iterator;
+
+        bool touched = false;
+        for (iterator i = to_process.begin(); (i != to_process.end()) && !touched; ++i){
+            const std::type_info & type = typeid(**i);
+            touched = (type != typeid(libkerat::message::frame)) && m_interest.is_touched(type);
+        }
+
+        if (!touched){
+            ++m_bypassed;
+            bm_handle_share(to_process, output_bundle);
+            return 0;
+        }
+
+        // the input might be the output as well, so both parts are taken first
+        libkerat::bundle_handle reduced;
+        libkerat::bundle_handle untouched;
+        for (iterator i = to_process.begin(); i != to_process.end(); ++i){
+            const std::type_info & type = typeid(**i);
+            if ((type == typeid(libkerat::message::frame)) || m_interest.is_touched(type)){
+                bm_handle_insert_shared(reduced, bm_handle_end(reduced), *i);
+            } else {
+                bm_handle_insert_shared(untouched, bm_handle_end(untouched), *i);
+            }
+        }
+
+        libkerat::bundle_handle result;
+        int retval = m_module->process_bundle(reduced, result);
+
+        // the module has dropped the bundle
+        if (result.begin() == result.end()){
+            bm_handle_clear(output_bundle);
+            return retval;
+        }
+
+        handle_iterator where = bm_handle_begin(result);
+        while ((where != bm_handle_end(result)) && (typeid(**where) != typeid(libkerat::message::alive))){ ++where; }
+
+        for (iterator i = untouched.begin(); i != untouched.end(); ++i){
+            bm_handle_insert_shared(result, where, *i);
+            ++m_routed;
+        }
+
+        bm_handle_share(result, output_bundle);
+
+        return retval;
+    }
+
+    libkerat::bundle_stack routed_module::get_stack() const { return m_processed_frames; }
+
+    void routed_module::purge(){ bm_stack_clear(m_processed_frames); }
+
+} // ns muse
@@ -0,0 +1,116 @@
+/**
+ * \file      source_matcher.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:03 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/kerat.hpp>
+#include <muse/source_matcher.hpp>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <cassert>
+#include <iostream>
+#include <pthread.h>
+
+namespace muse {
+    namespace internals {
+
+        typedef std::map<libkerat::internals::source_key, std::string> identity_map;
+
+        static pthread_mutex_t identities_mutex = PTHREAD_MUTEX_INITIALIZER;
+        static identity_map identities;
+
+        const std::string & get_source_identity(const libkerat::internals::source_key & source){
+            pthread_mutex_lock(&identities_mutex);
+
+            identity_map::iterator identity = identities.find(source);
+            if (identity == identities.end()){
+                std::stringstream sx;
+                sx << source.application << ":" << libkerat::ipv4_to_str(source.addr) << "/" << source.instance;
+                std::string tmp;
+                std::getline(sx, tmp);
+
+                identity = identities.insert(identity_map::value_type(source, tmp)).first;
+            }
+
+            // map values stay in place
+            const std::string & retval = identity->second;
+            pthread_mutex_unlock(&identities_mutex);
+
+            return retval;
+        }
+
+        source_matcher::source_matcher(const std::string & matching_regex)
+            :m_valid(false)
+        {
+            memset(&m_regex, 0, sizeof(m_regex));
+            m_last = m_decisions.end();
+
+            set_regex(matching_regex);
+        }
+
+        source_matcher::~source_matcher(){
+            if (m_valid){ regfree(&m_regex); }
+        }
+
+        bool source_matcher::set_regex(const std::string & matching_regex){
+            if (m_valid){ regfree(&m_regex); }
+            memset(&m_regex, 0, sizeof(m_regex));
+
+            m_pattern = matching_regex;
+            m_decisions.clear();
+            m_last = m_decisions.end();
+
+            int rslt = regcomp(&m_regex, matching_regex.c_str(), REG_EXTENDED | REG_NOSUB);
+            m_valid = (rslt == 0);
+            if (!m_valid){
+                //! \todo throw
+                const size_t REGEX_ERROR_BUFFSIZE = 2048;
+                char * regex_error = new char[REGEX_ERROR_BUFFSIZE];
+                memset(regex_error, 0, REGEX_ERROR_BUFFSIZE);
+                regerror(rslt, &m_regex, regex_error, REGEX_ERROR_BUFFSIZE-1);
+                std::cerr << "Regex: '" << matching_regex << "' is invalid due to :" << regex_error << std::endl;
+                delete [] regex_error;
+                regex_error = NULL;
+                regfree(&m_regex);
+            }
+
+            return m_valid;
+        }
+
+        bool source_matcher::is_matching(const libkerat::bundle_handle & bundle){
+            const libkerat::message::frame * msg_frame = bundle.get_frame();
+            assert(msg_frame != NULL);
+            if (msg_frame == NULL){ return false; }
+            assert(msg_frame->is_extended());
+            if (!msg_frame->is_extended()){ return false; }
+
+            return is_matching(*msg_frame);
+        }
+
+        bool source_matcher::is_matching(const libkerat::message::frame & frame){
+            if (!m_valid){ return false; }
+
+            if ((m_last != m_decisions.end())
+                && (m_last->first.addr == frame.get_address())
+                && (m_last->first.instance == frame.get_instance())
+                && (m_last->first.application == frame.get_app_name())
+            ){
+                return m_last->second;
+            }
+
+            libkerat::internals::source_key source = libkerat::internals::source_key::from_frame(frame);
+            decision_map::iterator decision = m_decisions.find(source);
+            if (decision == m_decisions.end()){
+                bool matching = !regexec(&m_regex, get_source_identity(source).c_str(), 0, NULL, 0);
+                decision = m_decisions.insert(decision_map::value_type(source, matching)).first;
+            }
+
+            m_last = decision;
+            return decision->second;
+        }
+
+    }
+}
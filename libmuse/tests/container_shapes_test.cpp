@@ -0,0 +1,278 @@
+/**
+ * \file      container_shapes_test.cpp
+ * \brief     Test the precomputed container shapes against the per-point checks and benchmark them
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:01 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <kerat/kerat.hpp>
+#include <muse/container_shapes.hpp>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+
+using libkerat::helpers::point_2d;
+typedef libkerat::message::convex_hull::point_2d_list point_2d_list;
+
+static const size_t HULLS = 200;
+static const size_t POINTS = 2000;
+static const size_t ROUNDS = 20;
+static const double AREA = 4000;
+
+//! \brief The per-point check the aggregators used, see polygonal_container_core.cpp
+static bool reference_inside_hull(const point_2d_list & container, const point_2d & point){
+    if (container.size() <= 2){ return false; }
+
+    int correction = 0;
+    for (point_2d_list::const_iterator first_point = container.begin(); first_point != container.end(); ++first_point){
+        point_2d_list::const_iterator second_point = first_point;
+        ++second_point;
+        if (second_point == container.end()){ second_point = container.begin(); }
+
+        point_2d_list::const_iterator third_point = second_point;
+        ++third_point;
+        if (third_point == container.end()){ third_point = container.begin(); }
+
+        {
+            point_2d a(second_point->get_x() - first_point->get_x(), second_point->get_y() - first_point->get_y());
+            point_2d b(third_point->get_x() - second_point->get_x(), third_point->get_y() - second_point->get_y());
+
+            int tmp_correction = (a.get_x() * b.get_y()) - (a.get_y() * b.get_x());
+            if (tmp_correction == 0){ return false; }
+
+            tmp_correction = (tmp_correction > 0)?1:-1;
+            if (correction == 0){ correction = tmp_correction; }
+            if (correction != tmp_correction){ return false; }
+        }
+
+        {
+            point_2d a(first_point->get_x() - point.get_x(), first_point->get_y() - point.get_y());
+            point_2d b(point.get_x() - second_point->get_x(), point.get_y() - second_point->get_y());
+
+            int determinant = (b.get_x() * a.get_y()) - (b.get_y() * a.get_x());
+            if ((determinant * correction) < 0){ return false; }
+        }
+    }
+
+    return true;
+}
+
+//! \brief The per-point check the bounds aggregator used
+static bool reference_inside_ellipse(const libkerat::message::bounds & bound, const point_2d & point){
+    point_2d rotated_point = point - bound;
+
+    double tmp_cos = cos(-bound.get_angle());
+    double tmp_sin = sin(-bound.get_angle());
+
+    rotated_point = point_2d(
+        (tmp_cos * rotated_point.get_x()) + (tmp_sin*rotated_point.get_y()),
+        ((-tmp_sin)*rotated_point.get_x()) + (tmp_cos*rotated_point.get_y())
+    );
+    rotated_point += bound;
+
+    double a = bound.get_width()/2;
+    double b = bound.get_height()/2;
+    if (a < b){ return false; }
+
+    double focus = sqrt((a * a) - (b * b));
+
+    point_2d f1(bound.get_x() - focus, bound.get_y());
+    point_2d f2(bound.get_x() + focus, bound.get_y());
+
+    return ((libkerat::distance(f1, rotated_point) + libkerat::distance(f2, rotated_point)) < (2*a));
+}
+
+static double random_unit(){ return rand() / (double)RAND_MAX; }
+
+//! \brief Random convex polygon around the center, occasionally degenerate or wrongly ordered
+static point_2d_list random_hull(double x, double y, double radius){
+    size_t count = 3 + (rand() % 8);
+    std::vector<double> angles;
+    for (size_t i = 0; i < count; ++i){ angles.push_back(random_unit() * 2 * M_PI); }
+    std::sort(angles.begin(), angles.end());
+    if (rand() % 2){ std::reverse(angles.begin(), angles.end()); }
+
+    point_2d_list retval;
+    for (size_t i = 0; i < count; ++i){
+        retval.push_back(point_2d(x + (radius * cos(angles[i])), y + (radius * sin(angles[i]))));
+    }
+    if ((rand() % 10) == 0){ std::swap(*retval.begin(), *(++retval.begin())); }
+
+    return retval;
+}
+
+//! \brief Random point, biased towards the hull vertices and edges to hit the tolerance
+static point_2d random_point_near(const point_2d_list & hull){
+    std::vector<point_2d> vertices(hull.begin(), hull.end());
+    const point_2d & first = vertices[rand() % vertices.size()];
+    const point_2d & second = vertices[rand() % vertices.size()];
+
+    double t = random_unit();
+    double jitter = ((random_unit() * 2) - 1) * ((rand() % 2)?0.05:5);
+    return point_2d(
+        first.get_x() + ((second.get_x() - first.get_x()) * t) + jitter,
+        first.get_y() + ((second.get_y() - first.get_y()) * t) - jitter
+    );
+}
+
+/**
+ * Test 1 - the convex shape gives the same result as the per-point check
+ */
+static bool run_test_1(){
+    bool result = true;
+
+    srand(1);
+    for (size_t h = 0; (h < 2000) && result; ++h){
+        double radius = 2 + (random_unit() * ((h % 2)?20:400));
+        point_2d_list hull = random_hull(random_unit() * AREA, random_unit() * AREA, radius);
+        muse::internals::convex_shape shape(hull);
+
+        std::vector<libkerat::coord_t> xs, ys;
+        std::vector<bool> expected;
+        for (size_t i = 0; i < 103; ++i){
+            point_2d point = random_point_near(hull);
+            bool inside = reference_inside_hull(hull, point);
+
+            result &= (shape.contains(point.get_x(), point.get_y()) == inside);
+            // the prefilter never drops a point inside
+            result &= !inside || shape.may_contain(point.get_x(), point.get_y());
+
+            xs.push_back(point.get_x());
+            ys.push_back(point.get_y());
+            expected.push_back(inside);
+        }
+
+        std::vector<unsigned char> classified(xs.size());
+        shape.classify(&xs[0], &ys[0], xs.size(), &classified[0]);
+        for (size_t i = 0; i < xs.size(); ++i){ result &= ((classified[i] != 0) == expected[i]); }
+    }
+
+    return result;
+}
+
+/**
+ * Test 2 - the ellipse shape gives the same result as the per-point check
+ */
+static bool run_test_2(){
+    bool result = true;
+
+    srand(2);
+    for (size_t b = 0; (b < 2000) && result; ++b){
+        libkerat::distance_t width = 1 + (random_unit() * 300);
+        libkerat::distance_t height = width * random_unit();
+        if ((b % 50) == 0){ std::swap(width, height); }
+        libkerat::message::bounds bound(1, random_unit() * AREA, random_unit() * AREA, random_unit() * 2 * M_PI, width, height, width * height);
+        muse::internals::ellipse_shape shape(bound);
+
+        for (size_t i = 0; i < 100; ++i){
+            double angle = random_unit() * 2 * M_PI;
+            double distance = width * random_unit() * 0.7;
+            point_2d point(bound.get_x() + (distance * cos(angle)), bound.get_y() + (distance * sin(angle)));
+            bool inside = reference_inside_ellipse(bound, point);
+
+            result &= (shape.contains(point.get_x(), point.get_y()) == inside);
+            result &= !inside || shape.may_contain(point.get_x(), point.get_y());
+        }
+    }
+
+    return result;
+}
+
+typedef std::map<libkerat::session_id_t, point_2d_list> hull_lists;
+typedef std::map<libkerat::session_id_t, muse::internals::convex_shape> hull_shapes;
+
+/**
+ * Test 3 - containers matched at once agree with testing each point against all
+ */
+static bool run_test_3(double & brute_force_ms, double & batched_ms){
+    hull_lists hulls;
+    hull_shapes shapes;
+
+    srand(3);
+    for (libkerat::session_id_t sid = 1; sid <= HULLS; ++sid){
+        hulls[sid] = random_hull(random_unit() * AREA, random_unit() * AREA, 20 + (random_unit() * 100));
+        shapes[sid] = muse::internals::convex_shape(hulls[sid]);
+    }
+
+    std::vector<point_2d> points;
+    std::vector<libkerat::session_id_t> owners;
+    for (size_t i = 0; i < POINTS; ++i){
+        points.push_back(point_2d(random_unit() * AREA, random_unit() * AREA));
+        // some of the points are the hull contacts themselves
+        owners.push_back(1 + (i % (HULLS * 2)));
+    }
+
+    struct timespec started, finished;
+
+    std::vector<libkerat::session_id_t> expected(POINTS, 0);
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t round = 0; round < ROUNDS; ++round){
+        for (size_t p = 0; p < POINTS; ++p){
+            expected[p] = 0;
+            for (hull_lists::const_iterator h = hulls.begin(); h != hulls.end(); ++h){
+                if (h->first == owners[p]){ continue; }
+                if (reference_inside_hull(h->second, points[p])){
+                    expected[p] = h->first;
+                    break;
+                }
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    struct timespec elapsed = libkerat::nanotimersub(finished, started);
+    brute_force_ms = ((elapsed.tv_sec * 1000.0) + (elapsed.tv_nsec / 1000000.0)) / ROUNDS;
+
+    muse::internals::point_batch batch;
+    std::vector<hull_shapes::const_iterator> matches;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t round = 0; round < ROUNDS; ++round){
+        batch.clear();
+        for (size_t p = 0; p < POINTS; ++p){ batch.add(points[p]); }
+        muse::internals::match_containers(shapes, batch, owners, matches);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    elapsed = libkerat::nanotimersub(finished, started);
+    batched_ms = ((elapsed.tv_sec * 1000.0) + (elapsed.tv_nsec / 1000000.0)) / ROUNDS;
+
+    bool result = (matches.size() == POINTS);
+    size_t matched = 0;
+    for (size_t p = 0; (p < POINTS) && result; ++p){
+        libkerat::session_id_t found = (matches[p] == shapes.end())?0:matches[p]->first;
+        result &= (found == expected[p]);
+        matched += (found != 0);
+    }
+
+    return result && (matched > 0);
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    current = run_test_1();
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    double brute_force_ms = 0;
+    double batched_ms = 0;
+    current = run_test_3(brute_force_ms, batched_ms);
+    cout << "Hulls: " << HULLS << ", points: " << POINTS << endl;
+    cout << "Each point against each hull: " << brute_force_ms << " ms/frame" << endl;
+    cout << "Broadphase and batched test: " << batched_ms << " ms/frame" << endl;
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result?0:1;
+}
@@ -0,0 +1,151 @@
+/**
+ * \file      dollar_n_module_cache_test.cpp
+ * \brief     Test the dollar N module compiles its templates once and again when they change
+ * \author    agent <agent@local>
+ * \date      2026-10-17 06:15 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <kerat/kerat.hpp>
+#include <muse/muse.hpp>
+#include <muse/recognizers/libreco.hpp>
+#include <tinyxml.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using libkerat::helpers::point_2d;
+using libreco::iotools::compiled_templates;
+
+static const char * CACHE_PATH = "/tmp/muse_dollar_n_module_cache_test.cache";
+
+//! \brief Straight stroke between two points
+static vector<point_2d> make_stroke(float x1, float y1, float x2, float y2, float wobble){
+    vector<point_2d> retval;
+    for (int i = 0; i <= 20; ++i){
+        float t = i / 20.0;
+        retval.push_back(point_2d(x1 + (t * (x2 - x1)) + (wobble * std::sin(t * 7)), y1 + (t * (y2 - y1)) + (wobble * std::cos(t * 5))));
+    }
+    return retval;
+}
+
+//! \brief Square of four strokes, cross of two and triangle of three
+static vector<vector<vector<point_2d> > > make_shapes(float wobble){
+    vector<vector<vector<point_2d> > > retval(3);
+    retval[0].push_back(make_stroke(100, 100, 300, 100, wobble));
+    retval[0].push_back(make_stroke(300, 100, 300, 300, wobble));
+    retval[0].push_back(make_stroke(300, 300, 100, 300, wobble));
+    retval[0].push_back(make_stroke(100, 300, 100, 100, wobble));
+
+    retval[1].push_back(make_stroke(100, 100, 300, 300, wobble));
+    retval[1].push_back(make_stroke(300, 100, 100, 300, wobble));
+
+    retval[2].push_back(make_stroke(200, 100, 300, 300, wobble));
+    retval[2].push_back(make_stroke(300, 300, 100, 300, wobble));
+    retval[2].push_back(make_stroke(100, 300, 200, 100, wobble));
+    return retval;
+}
+
+static ino_t file_inode(const char * path){
+    struct stat file_stat;
+    if (stat(path, &file_stat) != 0){ return 0; }
+    return file_stat.st_ino;
+}
+
+//! \brief Module config of the dollar N recognizer with the compiled templates
+static TiXmlElement make_chain(float offset){
+    TiXmlElement e_config("config");
+    {
+        TiXmlElement e_cache("template_cache");
+        e_cache.InsertEndChild(TiXmlText(CACHE_PATH));
+        e_config.InsertEndChild(e_cache);
+    }
+
+    vector<vector<vector<point_2d> > > shapes = make_shapes(0);
+    for (size_t i = 0; i < shapes.size(); ++i){
+        std::stringstream id;
+        id << (i + 1);
+        TiXmlElement e_gesture("multi_gesture");
+        e_gesture.SetAttribute("gesture_id", id.str().c_str());
+        e_gesture.SetAttribute("name", id.str().c_str());
+        e_gesture.SetAttribute("sensitivity", "false");
+
+        for (size_t s = 0; s < shapes[i].size(); ++s){
+            std::stringstream stroke_id;
+            stroke_id << (s + 1);
+            std::stringstream points;
+            // integral coordinates, one point per line, as the template files have
+            for (size_t p = 0; p < shapes[i][s].size(); ++p){
+                if (p != 0){ points << "\n"; }
+                points << (int)(shapes[i][s][p].get_x() + offset) << "\t" << (int)shapes[i][s][p].get_y();
+            }
+
+            TiXmlElement e_stroke("stroke");
+            e_stroke.SetAttribute("stroke_id", stroke_id.str().c_str());
+            e_stroke.InsertEndChild(TiXmlText(points.str().c_str()));
+            e_gesture.InsertEndChild(e_stroke);
+        }
+        e_config.InsertEndChild(e_gesture);
+    }
+
+    TiXmlElement e_module("module");
+    e_module.SetAttribute("path", "/muse/recognizers/dollar_n");
+    e_module.InsertEndChild(e_config);
+
+    TiXmlElement e_chain("chain");
+    e_chain.InsertEndChild(e_module);
+    return e_chain;
+}
+
+static bool create_chain(const TiXmlElement & e_chain){
+    muse::module_service * service = muse::module_service::get_instance();
+    muse::module_service::module_chain chain;
+    bool result = (service->create_module_chain(&e_chain, chain) == 0) && (chain.size() == 1);
+    service->free_module_chain(chain);
+    return result;
+}
+
+/**
+ * Test 1 - the module compiles the templates once and again when they change
+ */
+static bool run_test_1(){
+    unlink(CACHE_PATH);
+    bool result = true;
+
+    TiXmlElement e_chain = make_chain(0);
+    result &= create_chain(e_chain);
+    ino_t compiled_inode = file_inode(CACHE_PATH);
+    result &= (compiled_inode != 0);
+
+    // up to date, loaded as it is
+    result &= create_chain(e_chain);
+    result &= (file_inode(CACHE_PATH) == compiled_inode);
+
+    compiled_templates compiled;
+    result &= compiled.load(CACHE_PATH);
+    uint64_t first_hash = compiled.get_parameters().source_hash;
+    compiled.unload();
+
+    // stale, recompiled
+    TiXmlElement e_moved = make_chain(50);
+    result &= create_chain(e_moved);
+    result &= (file_inode(CACHE_PATH) != compiled_inode);
+    result &= compiled.load(CACHE_PATH) && (compiled.get_parameters().source_hash != first_hash);
+
+    return result;
+}
+
+int main(){
+    bool result = run_test_1();
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+
+    unlink(CACHE_PATH);
+    return result ? 0 : 1;
+}
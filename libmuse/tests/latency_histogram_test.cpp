@@ -0,0 +1,56 @@
+/**
+ * \file      latency_histogram_test.cpp
+ * \brief     Test the precision of the logarithmic latency histogram
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:38 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <muse/latency_histogram.hpp>
+
+using std::cout;
+using std::endl;
+
+//! \brief Checks that the value is reported with at most 1/16 relative error
+static bool precise(uint64_t reported, uint64_t expected){
+    uint64_t difference = (reported > expected)?(reported - expected):(expected - reported);
+    return (difference * muse::latency_histogram::SUB_BUCKETS) <= expected;
+}
+
+int main(){
+
+    muse::latency_histogram histogram;
+
+    // empty histogram
+    bool result = (histogram.get_percentile(50) == 0) && (histogram.get_mean() == 0);
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+
+    // uniform 1..10000 microseconds
+    for (uint64_t i = 1; i <= 10000; ++i){ histogram.record(i * 1000); }
+
+    result &= (histogram.get_count() == 10000);
+    result &= (histogram.get_min() == 1000) && (histogram.get_max() == 10000000);
+    result &= (histogram.get_mean() == 5000500);
+    result &= precise(histogram.get_percentile(50), 5000000);
+    result &= precise(histogram.get_percentile(90), 9000000);
+    result &= precise(histogram.get_percentile(99), 9900000);
+    result &= (histogram.get_percentile(100) == 10000000);
+    cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+
+    // small values are exact, huge values fit
+    muse::latency_histogram other;
+    for (uint64_t i = 0; i < 16; ++i){ other.record(i); }
+    result &= (other.get_percentile(50) == 7);
+    other.record(~(uint64_t)0);
+    result &= (other.get_max() == ~(uint64_t)0) && (other.get_percentile(100) == ~(uint64_t)0);
+
+    // merge adds the counts up
+    histogram.merge(other);
+    result &= (histogram.get_count() == 10017) && (histogram.get_min() == 0);
+    histogram.clear();
+    result &= (histogram.get_count() == 0) && (histogram.get_max() == 0);
+    cout << "Test 3: " << (result?"OK":"FAIL") << endl;
+
+    return result?0:1;
+}
@@ -0,0 +1,88 @@
+/**
+ * \file      latency_tracer_test.cpp
+ * \brief     Test the per-source and per-hop latency tracing
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:41 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <kerat/kerat.hpp>
+#include <muse/latency_tracer.hpp>
+#include <lo/lo.h>
+
+using std::cout;
+using std::endl;
+
+//! \brief Makes bundles with frames sent given count of milliseconds ago
+class frame_maker: protected libkerat::internals::bundle_manipulator {
+public:
+    libkerat::bundle_handle make_bundle(libkerat::frame_id_t frame_id, libkerat::instance_id_t instance, uint32_t age_ms){
+        libkerat::timetag_t sent;
+        lo_timetag_now(&sent);
+        uint32_t frac = age_ms * 4294967U; // 2^32 / 1000
+        if (sent.frac < frac){ --sent.sec; }
+        sent.frac -= frac;
+
+        libkerat::bundle_handle bundle;
+        bm_handle_insert(bundle, bm_handle_end(bundle), new libkerat::message::frame(frame_id, sent, "Tracer test", 0x7f000001, instance, 640, 480));
+        return bundle;
+    }
+};
+
+int main(){
+
+    frame_maker maker;
+    muse::latency_tracer tracer;
+    size_t receive = tracer.add_point("receive");
+    size_t delivery = tracer.add_point("delivery");
+    tracer.set_budget(30000000);
+
+    // the bundles without frame are ignored
+    tracer.stamp(receive, libkerat::bundle_handle());
+    std::vector<muse::latency_tracer::source_key> sources;
+    tracer.get_sources(sources);
+    bool result = sources.empty() && (tracer.get_points_count() == 2);
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+
+    // two sources, one of them over the budget
+    for (libkerat::frame_id_t frame = 1; frame <= 10; ++frame){
+        libkerat::bundle_handle fresh = maker.make_bundle(frame, 1, 5);
+        libkerat::bundle_handle stale = maker.make_bundle(frame, 2, 50);
+        tracer.stamp(receive, fresh);
+        tracer.stamp(receive, stale);
+        tracer.stamp(delivery, fresh);
+        tracer.stamp(delivery, stale);
+    }
+
+    tracer.get_sources(sources);
+    result &= (sources.size() == 2);
+
+    muse::latency_tracer::statistics_list statistics;
+    for (std::vector<muse::latency_tracer::source_key>::const_iterator source = sources.begin(); source != sources.end(); ++source){
+        tracer.get_statistics(*source, statistics);
+        result &= (statistics.size() == 2) && (statistics[0].point == "receive");
+        result &= (statistics[0].since_sensor.get_count() == 10);
+        result &= (statistics[0].since_previous.get_count() == 0);
+        result &= (statistics[1].since_previous.get_count() == 10);
+
+        bool stale = (source->instance == 2);
+        result &= (statistics[0].over_budget == (stale?10U:0U));
+        result &= ((statistics[0].since_sensor.get_min() >= 45000000) == stale);
+    }
+    cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+
+    // merged statistics, hop matched only for the same frame
+    tracer.stamp(delivery, maker.make_bundle(100, 1, 1));
+    tracer.get_statistics(statistics);
+    result &= (statistics[1].since_sensor.get_count() == 21);
+    result &= (statistics[1].since_previous.get_count() == 20);
+    result &= (statistics[1].over_budget == 10);
+
+    tracer.reset();
+    tracer.get_sources(sources);
+    result &= sources.empty() && (tracer.get_points_count() == 2);
+    cout << "Test 3: " << (result?"OK":"FAIL") << endl;
+
+    return result?0:1;
+}
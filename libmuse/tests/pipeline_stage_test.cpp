@@ -0,0 +1,148 @@
+/**
+ * \file      pipeline_stage_test.cpp
+ * \brief     Test the pipelined module execution
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:34 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <vector>
+#include <kerat/kerat.hpp>
+#include <muse/pipeline_stage.hpp>
+#include <pthread.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+using namespace libkerat::message;
+
+static const libkerat::frame_id_t FRAMES = 200;
+static const size_t QUEUE_CAPACITY = 4;
+
+//! \brief Passes the bundles over, remembers the frames and the thread it ran on
+class test_module: public libkerat::adaptor {
+public:
+    test_module():m_thread(pthread_self()), m_last_frame(0), m_in_order(true), m_count(0){ ; }
+
+    void notify(const libkerat::client * notifier){
+        purge();
+
+        libkerat::bundle_stack data = notifier->get_stack();
+        while (data.get_length() > 0){
+            libkerat::bundle_handle current = data.get_update();
+            libkerat::frame_id_t frame_id = current.get_frame()->get_frame_id();
+
+            m_in_order &= (frame_id == (get_last_frame() + 1));
+            ++m_count;
+            m_thread = pthread_self();
+
+            // the frame is published last, whoever sees it sees the rest too
+            __sync_bool_compare_and_swap(&m_last_frame, get_last_frame(), frame_id);
+
+            bm_stack_append(m_processed, bm_handle_clone_shared(current));
+        }
+
+        // give the stage in front some work to overlap with
+        usleep(100);
+
+        notify_listeners();
+    }
+
+    int process_bundle(const libkerat::bundle_handle & to_process, libkerat::bundle_handle & output_bundle){
+        output_bundle = to_process;
+        return 0;
+    }
+
+    libkerat::bundle_stack get_stack() const { return m_processed; }
+    void purge(){ bm_stack_clear(m_processed); }
+
+    //! \brief Last frame seen, read from any thread
+    libkerat::frame_id_t get_last_frame() const {
+        return __sync_fetch_and_add(const_cast<volatile libkerat::frame_id_t *>(&m_last_frame), 0);
+    }
+
+    pthread_t m_thread;
+    volatile libkerat::frame_id_t m_last_frame;
+    bool m_in_order;
+    size_t m_count;
+
+private:
+    libkerat::bundle_stack m_processed;
+};
+
+//! \brief Feeds the frames into the chain
+class test_client: public libkerat::client {
+public:
+    bool load(int count __attribute__((unused))){ return true; }
+    bool load(int count __attribute__((unused)), struct timespec timeout __attribute__((unused))){ return true; }
+    libkerat::bundle_stack get_stack() const { return m_stack; }
+    void purge(){ bm_stack_clear(m_stack); }
+
+    void send(libkerat::frame_id_t frame_id){
+        purge();
+
+        libkerat::bundle_handle * handle = new libkerat::bundle_handle;
+        alive::alive_ids ids; ids.insert(1);
+        bm_handle_insert(*handle, bm_handle_end(*handle), new frame(frame_id));
+        bm_handle_insert(*handle, bm_handle_end(*handle), new pointer(1, 0, 0, 0, frame_id, 10, 1, 1));
+        bm_handle_insert(*handle, bm_handle_end(*handle), new alive(ids));
+        bm_stack_append(m_stack, handle);
+
+        notify_listeners();
+    }
+
+private:
+    libkerat::bundle_stack m_stack;
+};
+
+static bool wait_for(const test_module & module, libkerat::frame_id_t frame_id){
+    for (int i = 0; (i < 5000) && (module.get_last_frame() != frame_id); ++i){ usleep(1000); }
+    return module.get_last_frame() == frame_id;
+}
+
+int main(){
+
+    test_client source;
+    muse::pipeline_stage stage_1("first", QUEUE_CAPACITY);
+    test_module module_1;
+    muse::pipeline_stage stage_2("second", QUEUE_CAPACITY);
+    test_module module_2;
+
+    source.add_listener(&stage_1);
+    stage_1.add_listener(&module_1);
+    module_1.add_listener(&stage_2);
+    stage_2.add_listener(&module_2);
+
+    // not started stages just pass the data over
+    source.send(1);
+    bool result = (module_1.get_last_frame() == 1) && (module_2.get_last_frame() == 1);
+    result &= pthread_equal(module_2.m_thread, pthread_self());
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+
+    // started stages keep the order and do not drop anything
+    result &= stage_2.start() && stage_1.start();
+    for (libkerat::frame_id_t i = 2; i <= FRAMES; ++i){ source.send(i); }
+
+    result &= wait_for(module_2, FRAMES);
+    result &= module_1.m_in_order && module_2.m_in_order;
+    result &= (module_1.m_count == FRAMES) && (module_2.m_count == FRAMES);
+    cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+
+    // each stage ran on its own thread
+    result &= !pthread_equal(module_1.m_thread, pthread_self());
+    result &= !pthread_equal(module_2.m_thread, pthread_self());
+    result &= !pthread_equal(module_1.m_thread, module_2.m_thread);
+
+    muse::pipeline_stage::statistics stats_1 = stage_1.get_statistics();
+    muse::pipeline_stage::statistics stats_2 = stage_2.get_statistics();
+    result &= (stats_1.processed == (FRAMES - 1)) && (stats_2.processed == (FRAMES - 1));
+    result &= (stats_1.dropped == 0) && (stats_2.dropped == 0);
+    result &= (stats_1.max_depth <= QUEUE_CAPACITY) && (stats_1.max_depth > 0);
+    cout << "Test 3: " << (result?"OK":"FAIL") << endl;
+
+    stage_1.stop();
+    stage_2.stop();
+
+    return result?0:1;
+}
@@ -0,0 +1,197 @@
+/**
+ * \file      primitive_touch_test.cpp
+ * \brief     Benchmark of joining the contacts crossing the seams of tiled sensors
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:56 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <set>
+#include <kerat/kerat.hpp>
+#include <muse/primitive_touch.hpp>
+#include <lo/lo.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+
+static const size_t SENSORS = 4;
+static const libkerat::coord_t SENSOR_WIDTH = 1000;
+static const size_t CONTACTS = 400;
+static const size_t FRAMES = 1000;
+static const libkerat::coord_t STEP = 7;
+static const libkerat::coord_t ROW_SPACING = 200;
+//! \brief Short taps pile up as join candidates until they expire
+static const size_t TAPS_PER_FRAME = 20;
+static const size_t TAP_FRAMES = 3;
+
+//! \brief Contact sliding across the sensors, each sensor tracks it under its own id
+struct contact {
+    libkerat::coord_t x;
+    libkerat::coord_t y;
+    size_t sensor;
+    libkerat::session_id_t sid;
+    //! \brief Frames left to live, 0 for the sliding contacts
+    size_t life;
+};
+
+//! \brief Feeds the frames of all the sensors at once, as a multi-port client would
+class sensor_wall: public libkerat::client {
+public:
+    sensor_wall():m_frame_id(0), m_next_row(0), m_crossings(0), m_taps(0){
+        for (size_t i = 0; i < CONTACTS; ++i){
+            // spread the contacts along the wall
+            land((i * SENSORS * SENSOR_WIDTH) / CONTACTS, 0);
+        }
+    }
+
+    ~sensor_wall(){ purge(); }
+
+    void run_frame(){
+        ++m_frame_id;
+
+        // lift the taps that are over
+        for (size_t i = 0; i < m_contacts.size(); ){
+            if ((m_contacts[i].life > 0) && (--m_contacts[i].life == 0)){
+                m_contacts[i] = m_contacts.back();
+                m_contacts.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        for (std::vector<contact>::iterator i = m_contacts.begin(); i != m_contacts.end(); ++i){
+            if (i->life > 0){ continue; }
+
+            i->x += STEP;
+            size_t sensor = (size_t)(i->x / SENSOR_WIDTH);
+            if (sensor >= SENSORS){
+                // lifted at the far edge, lands again as new contact
+                i->x = 0;
+                i->y = (m_next_row++) * ROW_SPACING;
+                sensor = 0;
+            } else if (sensor != i->sensor){
+                ++m_crossings;
+            }
+
+            if (sensor != i->sensor){
+                i->sensor = sensor;
+                i->sid = ++m_sensor_sids[sensor];
+            }
+        }
+
+        for (size_t i = 0; i < TAPS_PER_FRAME; ++i){
+            land((libkerat::coord_t)((m_taps++ * 397) % (size_t)(SENSORS * SENSOR_WIDTH)), TAP_FRAMES);
+        }
+
+        libkerat::timetag_t now;
+        lo_timetag_now(&now);
+
+        for (size_t sensor = 0; sensor < SENSORS; ++sensor){
+            libkerat::bundle_handle * bundle = new libkerat::bundle_handle;
+            bm_handle_insert(*bundle, bm_handle_end(*bundle), new libkerat::message::frame(m_frame_id, now, "Wall test", 0x7f000001, sensor, SENSOR_WIDTH, SENSOR_WIDTH));
+
+            libkerat::message::alive::alive_ids alives;
+            for (std::vector<contact>::const_iterator i = m_contacts.begin(); i != m_contacts.end(); ++i){
+                if (i->sensor != sensor){ continue; }
+                bm_handle_insert(*bundle, bm_handle_end(*bundle), new libkerat::message::pointer(i->sid, 0, 0, 0, i->x, i->y, 1, 1));
+                alives.insert(i->sid);
+            }
+            bm_handle_insert(*bundle, bm_handle_end(*bundle), new libkerat::message::alive(alives));
+
+            bm_stack_append(m_stack, bundle);
+        }
+
+        notify_listeners();
+        purge();
+    }
+
+    inline size_t get_crossings() const { return m_crossings; }
+    inline size_t get_taps() const { return m_taps; }
+
+    libkerat::bundle_stack get_stack() const { return m_stack; }
+    void purge(){ bm_stack_clear(m_stack); }
+    bool load(int count __attribute__((unused))){ return true; }
+    bool load(int count __attribute__((unused)), struct timespec timeout __attribute__((unused))){ return true; }
+
+private:
+
+    void land(libkerat::coord_t x, size_t life){
+        contact current;
+        current.life = life;
+        current.x = x;
+        current.y = (m_next_row++) * ROW_SPACING;
+        current.sensor = (size_t)(x / SENSOR_WIDTH);
+        current.sid = ++m_sensor_sids[current.sensor];
+        m_contacts.push_back(current);
+    }
+
+    libkerat::frame_id_t m_frame_id;
+    size_t m_next_row;
+    size_t m_crossings;
+    size_t m_taps;
+    std::vector<contact> m_contacts;
+    std::map<size_t, libkerat::session_id_t> m_sensor_sids;
+    libkerat::bundle_stack m_stack;
+};
+
+//! \brief Checks that every contact keeps its joined id for its whole life
+class identity_checker: public libkerat::listener {
+public:
+    identity_checker():consistent(true), unique(true){ ; }
+
+    void notify(const libkerat::client * notifier){
+        libkerat::bundle_stack data = notifier->get_stack();
+        std::set<libkerat::session_id_t> seen;
+        while (data.get_length() > 0){
+            libkerat::bundle_handle current = data.get_update(libkerat::bundle_stack::INDEX_OLDEST);
+            for (libkerat::bundle_handle::const_iterator i = current.begin(); i != current.end(); ++i){
+                const libkerat::message::pointer * msg_ptr = dynamic_cast<const libkerat::message::pointer *>(*i);
+                if (msg_ptr == NULL){ continue; }
+
+                // the rows are never reused, so the row identifies the contact
+                std::pair<row_map::iterator, bool> known = rows.insert(row_map::value_type(msg_ptr->get_y(), msg_ptr->get_session_id()));
+                consistent &= (known.first->second == msg_ptr->get_session_id());
+                unique &= seen.insert(msg_ptr->get_session_id()).second;
+            }
+        }
+    }
+
+    typedef std::map<libkerat::coord_t, libkerat::session_id_t> row_map;
+    row_map rows;
+    bool consistent;
+    bool unique;
+};
+
+int main(){
+
+    sensor_wall wall;
+    muse::virtual_sensors::primitive_touch joiner;
+    identity_checker checker;
+
+    wall.add_listener(&joiner);
+    joiner.add_listener(&checker);
+
+    struct timespec started, finished;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t frame = 0; frame < FRAMES; ++frame){ wall.run_frame(); }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+
+    struct timespec elapsed = libkerat::nanotimersub(finished, started);
+    double us_per_frame = ((elapsed.tv_sec * 1000000.0) + (elapsed.tv_nsec / 1000.0)) / FRAMES;
+
+    cout << "Sensors: " << SENSORS << ", contacts: " << CONTACTS << ", frames: " << FRAMES
+        << ", seam crossings: " << wall.get_crossings() << ", taps: " << wall.get_taps() << endl;
+    cout << "Joining: " << us_per_frame << " us/frame" << endl;
+
+    bool result = (wall.get_crossings() > 0) && checker.consistent;
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+
+    result &= checker.unique;
+    cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+
+    return result?0:1;
+}
@@ -0,0 +1,307 @@
+/**
+ * \file      routed_module_test.cpp
+ * \brief     Test routing the untouched messages around the modules and benchmark it
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:15 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <kerat/kerat.hpp>
+#include <dtuio/dtuio.hpp>
+#include <muse/muse.hpp>
+#include <tinyxml.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+using namespace libkerat::message;
+
+static const size_t BUNDLES = 2000;
+static const size_t POINTERS = 8;
+static const size_t SYMBOLS = 24;
+
+//! \brief Client replaying prepared bundles
+class test_client: public libkerat::client {
+public:
+
+    void add_bundle(const libkerat::bundle_handle & bundle){
+        libkerat::bundle_handle * tmp = new libkerat::bundle_handle;
+        bm_handle_share(bundle, *tmp);
+        bm_stack_append(m_stack, tmp);
+    }
+
+    libkerat::bundle_stack get_stack() const { return m_stack; }
+
+    bool load(int count __attribute__((unused))){ return true; }
+    bool load(int count __attribute__((unused)), struct timespec timeout __attribute__((unused))){ return true; }
+    void purge(){ bm_stack_clear(m_stack); }
+
+    void commit(){ notify_listeners(); }
+
+    //! \brief Makes the bundle of moving pointers over the containers, with symbols nobody reads
+    libkerat::bundle_handle make_bundle(size_t index, bool with_pointers){
+        libkerat::bundle_handle retval;
+        libkerat::timetag_t now = { 0, (uint32_t)index };
+        bm_handle_insert(retval, bm_handle_end(retval), new frame(index + 1, now, "table", 0x0a000001, 1, 1920, 1080));
+
+        alive::alive_ids alives;
+        for (libkerat::session_id_t sid = 1; sid <= 2; ++sid){
+            alives.insert(sid);
+            bm_handle_insert(retval, bm_handle_end(retval), new bounds(sid, 200 + (sid * 400), 300, 0, 300, 200, 60000));
+        }
+
+        for (size_t i = 0; i < SYMBOLS; ++i){
+            if (with_pointers && (i < POINTERS)){
+                libkerat::session_id_t sid = 10 + i;
+                alives.insert(sid);
+                bm_handle_insert(retval, bm_handle_end(retval), new pointer(sid, 0, 0, 0, 100 + (i * 100) + (index % 50), 300, 0, 0));
+            }
+
+            bm_handle_insert(retval, bm_handle_end(retval), new symbol(100 + i, 0, 0, 1, "muse", "marker"));
+        }
+
+        bm_handle_insert(retval, bm_handle_end(retval), new alive(alives));
+        return retval;
+    }
+
+private:
+    libkerat::bundle_stack m_stack;
+};
+
+static std::string message_text(const libkerat::kerat_message * message){
+    std::stringstream sx;
+    message->print(sx);
+    return sx.str();
+}
+
+static libkerat::adaptor * make_routed_container(){
+    muse::module_interest interest;
+    interest.add_read<alive>();
+    interest.add_read<pointer>();
+    interest.add_read<token>();
+    interest.add_read<bounds>();
+    interest.add_read<container_association>();
+    interest.add_read<alive_associations>();
+    interest.add_modified<container_association>();
+    interest.add_modified<alive_associations>();
+    interest.add_modified<alive>();
+
+    return new muse::routed_module(new muse::aggregators::bounds_container(".*", 1), interest);
+}
+
+/**
+ * Test 1 - routed module gives the same messages, the untouched ones are shared
+ */
+static bool run_test_1(){
+    test_client source;
+    muse::aggregators::bounds_container direct(".*", 1);
+    libkerat::adaptor * routed = make_routed_container();
+    source.add_listener(&direct);
+    source.add_listener(routed);
+
+    std::vector<libkerat::bundle_handle> inputs;
+    for (size_t i = 0; i < 50; ++i){
+        inputs.push_back(source.make_bundle(i, true));
+        source.add_bundle(inputs.back());
+    }
+    source.commit();
+
+    libkerat::bundle_stack direct_stack = direct.get_stack();
+    libkerat::bundle_stack routed_stack = routed->get_stack();
+
+    bool result = (direct_stack.get_length() == inputs.size()) && (routed_stack.get_length() == inputs.size());
+    size_t associations = 0;
+    for (size_t i = 0; (i < inputs.size()) && result; ++i){
+        libkerat::bundle_handle direct_bundle = direct_stack.get_update();
+        libkerat::bundle_handle routed_bundle = routed_stack.get_update();
+
+        std::vector<std::string> direct_texts;
+        std::vector<std::string> routed_texts;
+        for (libkerat::bundle_handle::const_iterator m = direct_bundle.begin(); m != direct_bundle.end(); ++m){ direct_texts.push_back(message_text(*m)); }
+        for (libkerat::bundle_handle::const_iterator m = routed_bundle.begin(); m != routed_bundle.end(); ++m){ routed_texts.push_back(message_text(*m)); }
+
+        // framed the same way, the untouched messages might move before the alive
+        result &= !routed_texts.empty() && (routed_texts.front() == direct_texts.front()) && (routed_texts.back() == direct_texts.back());
+        std::sort(direct_texts.begin(), direct_texts.end());
+        std::sort(routed_texts.begin(), routed_texts.end());
+        result &= (direct_texts == routed_texts);
+
+        // the symbols are the very messages received
+        std::vector<const libkerat::kerat_message *> received(inputs[i].begin(), inputs[i].end());
+        std::sort(received.begin(), received.end());
+        for (libkerat::bundle_handle::const_iterator m = routed_bundle.begin(); m != routed_bundle.end(); ++m){
+            if (dynamic_cast<const symbol *>(*m) == NULL){ continue; }
+            result &= std::binary_search(received.begin(), received.end(), *m);
+        }
+
+        associations += (routed_bundle.get_message_of_type<container_association>() != NULL);
+    }
+
+    muse::routed_module * wrapper = static_cast<muse::routed_module *>(routed);
+    result &= (associations > 0) && (wrapper->get_routed_count() == (inputs.size() * SYMBOLS)) && (wrapper->get_bypassed_count() == 0);
+
+    delete routed;
+    return result;
+}
+
+/**
+ * Test 2 - bundle with nothing the module touches is passed on as it is
+ */
+static bool run_test_2(){
+    test_client source;
+    muse::module_interest interest;
+    interest.add_read<pointer>();
+    muse::routed_module routed(new muse::aggregators::bounds_container(".*", 1), interest);
+    source.add_listener(&routed);
+
+    // bounds, symbols and alive, no pointers
+    libkerat::bundle_handle input = source.make_bundle(0, false);
+    source.add_bundle(input);
+    source.commit();
+
+    libkerat::bundle_stack output = routed.get_stack();
+    bool result = (output.get_length() == 1) && (routed.get_bypassed_count() == 1);
+    libkerat::bundle_handle bundle = output.get_update();
+
+    // bounds and alive are neither read nor modified, the module is not run at all
+    result &= std::equal(bundle.begin(), bundle.end(), input.begin());
+    result &= (std::distance(bundle.begin(), bundle.end()) == std::distance(input.begin(), input.end()));
+
+    return result;
+}
+
+/**
+ * Test 3 - the interest of the chain and the paths left to decode
+ */
+static bool run_test_3(){
+    muse::module_interest interest;
+    interest.add_read<pointer>();
+    interest.add_read<dtuio::sensor::viewport>();
+    interest.add_modified<container_association>();
+
+    bool result = interest.is_touched(typeid(pointer)) && interest.is_touched(typeid(container_association));
+    result &= !interest.is_touched(typeid(symbol)) && !interest.is_touched(typeid(dtuio::sensor::sensor_properties));
+    result &= !muse::module_interest::is_known(typeid(std::string)) && interest.is_touched(typeid(std::string));
+
+    std::list<std::string> unused;
+    interest.get_unused_paths(unused);
+    result &= (std::find(unused.begin(), unused.end(), symbol::PATH) != unused.end());
+    result &= (std::find(unused.begin(), unused.end(), dtuio::sensor::sensor_properties::PATH) != unused.end());
+    result &= (std::find(unused.begin(), unused.end(), container_association::PATH) != unused.end());
+    result &= (std::find(unused.begin(), unused.end(), pointer::PATH_2D) == unused.end());
+    result &= (std::find(unused.begin(), unused.end(), pointer::PATH_3D) == unused.end());
+    result &= (std::find(unused.begin(), unused.end(), dtuio::sensor::viewport::PATH) == unused.end());
+    result &= (std::find(unused.begin(), unused.end(), frame::PATH) == unused.end());
+    result &= (std::find(unused.begin(), unused.end(), alive::PATH) == unused.end());
+
+    // the chain of declaring modules is routed
+    TiXmlElement e_chain("chain");
+    {
+        TiXmlElement e_multiplexing("module");
+        e_multiplexing.SetAttribute("path", "/libkerat/multiplexing_adaptor");
+        e_chain.InsertEndChild(e_multiplexing);
+
+        TiXmlElement e_slot("container_slot");
+        e_slot.InsertEndChild(TiXmlText("1"));
+        TiXmlElement e_config("config");
+        e_config.InsertEndChild(e_slot);
+        TiXmlElement e_container("module");
+        e_container.SetAttribute("path", "/muse/aggregator/container_bounds");
+        e_container.InsertEndChild(e_config);
+        e_chain.InsertEndChild(e_container);
+    }
+
+    muse::module_service * service = muse::module_service::get_instance();
+    muse::module_service::module_chain chain;
+    result &= (service->create_module_chain(&e_chain, chain) == 0) && (chain.size() == 2);
+    if (result){
+        // everything goes through the multiplexing adaptor anyway
+        result &= (dynamic_cast<muse::routed_module *>(chain[0].first) == NULL);
+        result &= (dynamic_cast<muse::routed_module *>(chain[1].first) != NULL);
+
+        muse::module_interest chain_interest;
+        result &= service->get_chain_interest(chain, chain_interest);
+        result &= chain_interest.is_read(typeid(bounds)) && !chain_interest.is_read(typeid(symbol));
+    }
+    service->free_module_chain(chain);
+
+    // routing disabled
+    TiXmlElement e_plain(e_chain);
+    e_plain.SetAttribute("routing", "false");
+    result &= (service->create_module_chain(&e_plain, chain) == 0) && (chain.size() == 2);
+    if (result){ result &= (dynamic_cast<muse::routed_module *>(chain[1].first) == NULL); }
+    service->free_module_chain(chain);
+
+    return result;
+}
+
+/**
+ * Test 4 - benchmark of the routed and plain module
+ */
+static bool run_test_4(double & direct_us, double & routed_us){
+    test_client source;
+    std::vector<libkerat::bundle_handle> inputs;
+    for (size_t i = 0; i < BUNDLES; ++i){ inputs.push_back(source.make_bundle(i, true)); }
+
+    struct timespec started, finished;
+    libkerat::adaptor * modules[2] = { new muse::aggregators::bounds_container(".*", 1), make_routed_container() };
+    double * results[2] = { &direct_us, &routed_us };
+    size_t messages[2] = { 0, 0 };
+
+    for (size_t m = 0; m < 2; ++m){
+        source.add_listener(modules[m]);
+
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        for (size_t i = 0; i < BUNDLES; ++i){
+            source.purge();
+            source.add_bundle(inputs[i]);
+            source.commit();
+            libkerat::bundle_stack output = modules[m]->get_stack();
+            libkerat::bundle_handle bundle = output.get_update();
+            messages[m] += std::distance(bundle.begin(), bundle.end());
+        }
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+
+        struct timespec elapsed = libkerat::nanotimersub(finished, started);
+        *(results[m]) = ((elapsed.tv_sec * 1000000.0) + (elapsed.tv_nsec / 1000.0)) / BUNDLES;
+
+        source.del_listener(modules[m]);
+        delete modules[m];
+    }
+
+    return messages[0] == messages[1];
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    current = run_test_1();
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_3();
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    double direct_us = 0;
+    double routed_us = 0;
+    current = run_test_4(direct_us, routed_us);
+    cout << "Pointers: " << POINTERS << ", symbols nobody reads: " << SYMBOLS << endl;
+    cout << "Every message through the module: " << direct_us << " us/bundle" << endl;
+    cout << "Untouched messages routed around: " << routed_us << " us/bundle" << endl;
+    cout << "Test 4: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result?0:1;
+}
@@ -0,0 +1,160 @@
+/**
+ * \file      source_matcher_test.cpp
+ * \brief     Test the cached source matching and compare it to formatting and matching every bundle
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:03 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <kerat/kerat.hpp>
+#include <muse/source_matcher.hpp>
+#include <regex.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+
+static const size_t BUNDLES = 200000;
+static const size_t SOURCES = 4;
+
+//! \brief Makes bundles containing just the frame of given source
+class frame_maker: protected libkerat::internals::bundle_manipulator {
+public:
+    libkerat::bundle_handle make_bundle(const std::string & application, libkerat::addr_ipv4_t address, libkerat::instance_id_t instance){
+        libkerat::bundle_handle retval;
+        libkerat::timetag_t now = { 0, 1 };
+        bm_handle_insert(retval, bm_handle_end(retval), new libkerat::message::frame(1, now, application, address, instance, 1920, 1080));
+        return retval;
+    }
+};
+
+static frame_maker maker;
+
+//! \brief Per bundle matching as the modules did before
+static bool reference_matching(regex_t & regex, const libkerat::bundle_handle & bundle){
+    const libkerat::message::frame * msg_frame = bundle.get_frame();
+    std::stringstream sx;
+    sx << msg_frame->get_app_name() << ":" << libkerat::ipv4_to_str(msg_frame->get_address()) << "/" << msg_frame->get_instance();
+    std::string tmp;
+    std::getline(sx, tmp);
+    return !regexec(&regex, tmp.c_str(), 0, NULL, 0);
+}
+
+/**
+ * Test 1 - decisions match the regular expression and are remembered per source
+ */
+static bool run_test_1(){
+    muse::internals::source_matcher matcher("^table:10\\.0\\.0\\.1/[12]$");
+
+    libkerat::bundle_handle first = maker.make_bundle("table", 0x0a000001, 1);
+    libkerat::bundle_handle second = maker.make_bundle("table", 0x0a000001, 2);
+    libkerat::bundle_handle other_instance = maker.make_bundle("table", 0x0a000001, 3);
+    libkerat::bundle_handle other_app = maker.make_bundle("wall", 0x0a000001, 1);
+    libkerat::bundle_handle other_address = maker.make_bundle("table", 0x0a000002, 1);
+
+    bool result = matcher.is_valid();
+    for (size_t round = 0; round < 3; ++round){
+        result &= matcher.is_matching(first) && matcher.is_matching(second);
+        result &= !matcher.is_matching(other_instance) && !matcher.is_matching(other_app) && !matcher.is_matching(other_address);
+    }
+    result &= (matcher.get_cached_count() == 5);
+
+    result &= (muse::internals::get_source_identity(libkerat::internals::source_key::from_frame(*first.get_frame())) == "table:10.0.0.1/1");
+
+    return result;
+}
+
+/**
+ * Test 2 - changing the expression forgets the decisions, invalid one matches nothing
+ */
+static bool run_test_2(){
+    muse::internals::source_matcher matcher("^table:");
+    libkerat::bundle_handle table = maker.make_bundle("table", 0x0a000001, 1);
+    libkerat::bundle_handle wall = maker.make_bundle("wall", 0x0a000001, 1);
+
+    bool result = matcher.is_matching(table) && !matcher.is_matching(wall);
+
+    result &= matcher.set_regex("^wall:");
+    result &= (matcher.get_cached_count() == 0);
+    result &= !matcher.is_matching(table) && matcher.is_matching(wall);
+
+    result &= !matcher.set_regex("(unbalanced");
+    result &= !matcher.is_valid() && !matcher.is_matching(table) && !matcher.is_matching(wall);
+
+    result &= matcher.set_regex(".*") && matcher.is_matching(table) && matcher.is_matching(wall);
+
+    return result;
+}
+
+/**
+ * Test 3 - cached decisions agree with per bundle matching, benchmark
+ */
+static bool run_test_3(double & reference_ns, double & cached_ns){
+    const char * pattern = "^(table|wall):10\\.0\\.0\\.[0-9]+/[13]$";
+    muse::internals::source_matcher matcher(pattern);
+    regex_t regex;
+    regcomp(&regex, pattern, REG_EXTENDED | REG_NOSUB);
+
+    libkerat::bundle_handle bundles[SOURCES] = {
+        maker.make_bundle("table", 0x0a000001, 1),
+        maker.make_bundle("table", 0x0a000001, 2),
+        maker.make_bundle("wall", 0x0a000003, 3),
+        maker.make_bundle("floor", 0x0a000004, 1)
+    };
+
+    bool result = true;
+    size_t matching = 0;
+    struct timespec started, finished;
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t i = 0; i < BUNDLES; ++i){
+        // sources send their bundles in bursts
+        matching += reference_matching(regex, bundles[(i / 16) % SOURCES]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    struct timespec elapsed = libkerat::nanotimersub(finished, started);
+    reference_ns = ((elapsed.tv_sec * 1000000000.0) + elapsed.tv_nsec) / BUNDLES;
+
+    size_t cached_matching = 0;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t i = 0; i < BUNDLES; ++i){
+        cached_matching += matcher.is_matching(bundles[(i / 16) % SOURCES]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    elapsed = libkerat::nanotimersub(finished, started);
+    cached_ns = ((elapsed.tv_sec * 1000000000.0) + elapsed.tv_nsec) / BUNDLES;
+
+    result &= (matching == cached_matching) && (matching == (BUNDLES / 2));
+    for (size_t i = 0; i < SOURCES; ++i){
+        result &= (matcher.is_matching(bundles[i]) == reference_matching(regex, bundles[i]));
+    }
+
+    regfree(&regex);
+    return result;
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    current = run_test_1();
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    double reference_ns = 0;
+    double cached_ns = 0;
+    current = run_test_3(reference_ns, cached_ns);
+    cout << "Formatting and matching every bundle: " << reference_ns << " ns/bundle" << endl;
+    cout << "Cached decisions: " << cached_ns << " ns/bundle" << endl;
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result?0:1;
+}
@@ -7,6 +7,8 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <list>
 #include <algorithm>
 #include <stdlib.h>
 #include <signal.h>
@@ -20,24 +22,39 @@ using std::cerr;
 using std::cout;
 
 using libkerat::simple_client;
+using libkerat::multi_client;
+using libkerat::threaded_client;
 using libkerat::listeners::stdout_listener;
 
 //! \brief Struct that holds the runtime configuration
 struct stdout_config {
-    uint16_t port;
+    std::vector<uint16_t> ports;
+    size_t queue_capacity;
+    threaded_client::overflow_policy overflow_policy;
+    unsigned int stats_interval;
+    unsigned int trace_budget;
+    bool prune;
     TiXmlDocument muse_config;
 };
 
 //! \brief Make default configuration
 static stdout_config get_default_config(){
     stdout_config config;
-    config.port         = 3333;
+    config.queue_capacity = 0;
+    config.overflow_policy = threaded_client::OVERFLOW_DROP_OLDEST;
+    config.stats_interval = 0;
+    config.trace_budget = 0;
+    config.prune = false;
     return config;
 }
 
 static void usage();
 static int parse_commandline(stdout_config* config, int argc, char** argv);
 static void register_signal_handlers();
+static void print_stage_statistics(const muse::module_service::module_chain & modules);
+static void print_module_statistics(const muse::module_service::module_chain & modules);
+static void print_trace_statistics(const muse::latency_tracer * tracer);
+static void prune_convertors(const muse::module_service::module_chain & modules, std::vector<simple_client *> & parsers);
 static void handle_kill_signal(int ev);
 
 bool running = true;
@@ -55,17 +72,44 @@ int main(int argc, char ** argv){
 
     stdout_listener lstnr;
 
-    simple_client * raw_client = new simple_client(config.port);
+    libkerat::client * raw_client = NULL;
+    std::vector<simple_client *> parsers;
     { // register framework with client
         libkerat::internals::convertor_list muse_convertors(muse::get_muse_convertors());
-        std::for_each(muse_convertors.begin(), muse_convertors.end(), raw_client->get_enabler_functor());
+
+        if (config.ports.size() == 1){
+            simple_client * single_client = new simple_client(config.ports.front());
+            std::for_each(muse_convertors.begin(), muse_convertors.end(), single_client->get_enabler_functor());
+            parsers.push_back(single_client);
+            raw_client = single_client;
+        } else {
+            // all the ports are served by single event loop
+            multi_client * ports_client = new multi_client;
+            ports_client->enable_convertors(muse_convertors);
+            for (std::vector<uint16_t>::const_iterator port = config.ports.begin(); port != config.ports.end(); ++port){
+                parsers.push_back(ports_client->get_source_client(ports_client->add_port(*port)));
+            }
+            raw_client = ports_client;
+        }
     }
     
-    libkerat::client * last_client = raw_client;
     muse::module_service::module_chain modules;
+
+    // trace points are ordered, so receive goes first and delivery last
+    muse::latency_tracer * tracer = NULL;
+    muse::trace_probe * receive_probe = NULL;
+    muse::trace_probe * delivery_probe = NULL;
+    if (config.trace_budget > 0){
+        tracer = new muse::latency_tracer;
+        tracer->set_budget(config.trace_budget * (uint64_t)1000000);
+        receive_probe = new muse::trace_probe(*tracer, "receive");
+        raw_client->add_listener(receive_probe);
+    }
     
     if (!config.muse_config.NoChildren()){
         muse::module_service * modserv = muse::module_service::get_instance();
+        modserv->set_instrumentation(config.stats_interval > 0);
+        modserv->set_tracer(tracer);
         
         const TiXmlElement * e_config = config.muse_config.RootElement();
         assert(e_config != NULL);
@@ -82,12 +126,40 @@ int main(int argc, char ** argv){
         }
     }
 
-    // connect
+    // the convertors are set up before the receiver thread starts
+    if (config.prune && !modules.empty()){ prune_convertors(modules, parsers); }
+
+    libkerat::client * last_client = raw_client;
+
+    // receive on dedicated thread, modules run on this one
+    threaded_client * queued_client = NULL;
+    if (config.queue_capacity > 0){
+        queued_client = new threaded_client(*raw_client, config.queue_capacity, config.overflow_policy);
+        if (!queued_client->start()){
+            std::cerr << "Failed to start the receiver thread!" << std::endl;
+            delete queued_client;
+            delete raw_client;
+            exit(EXIT_FAILURE);
+        }
+        last_client = queued_client;
+    }
+
+    if (tracer != NULL){ delivery_probe = new muse::trace_probe(*tracer, "delivery"); }
+
+    // connect, the listener gets the output of every branch
     if (!modules.empty()){
         last_client->add_listener(modules.front().first);
-        last_client = modules.back().first;
+
+        std::vector<muse::muse_module *> sinks;
+        muse::module_service::get_instance()->get_chain_sinks(modules, sinks);
+        for (std::vector<muse::muse_module *>::iterator sink = sinks.begin(); sink != sinks.end(); ++sink){
+            if (delivery_probe != NULL){ (*sink)->add_listener(delivery_probe); }
+            (*sink)->add_listener(&lstnr);
+        }
+    } else {
+        if (delivery_probe != NULL){ last_client->add_listener(delivery_probe); }
+        last_client->add_listener(&lstnr);
     }
-    last_client->add_listener(&lstnr);
     
     // print loaded modules
     std::cout << "Modules loaded: ";
@@ -102,18 +174,64 @@ int main(int argc, char ** argv){
             ++current_module
         ){
             const TiXmlElement * tmp = current_module->second;
-            std::cout << "\t" << tmp->Attribute("path") << std::endl;
+            const char * after = tmp->Attribute("after");
+            std::cout << "\t" << tmp->Attribute("id") << ": " << tmp->Attribute("path");
+            if (after != NULL){ std::cout << " <- " << after; }
+            std::cout << std::endl;
         }
     }
     std::cout << "--------------------------------" << std::endl;
 
+    if (muse::module_service::get_instance()->start_module_chain(modules) != 0){
+        std::cerr << "Failed to start the pipeline stages, running serially!" << std::endl;
+    }
+
+    struct timespec next_dump;
+    clock_gettime(CLOCK_MONOTONIC, &next_dump);
+    next_dump.tv_sec += config.stats_interval;
+
     while (running){
-        last_client->load();
-        // do-nothink
+        if (config.stats_interval == 0){
+            last_client->load();
+            continue;
+        }
+
+        // wake up in time for the dump even if no data come
+        struct timespec timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_nsec = 0;
+        last_client->load(1, timeout);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec >= next_dump.tv_sec){
+            print_module_statistics(modules);
+            print_stage_statistics(modules);
+            print_trace_statistics(tracer);
+            next_dump.tv_sec = now.tv_sec + config.stats_interval;
+        }
+    }
+
+    muse::module_service::get_instance()->stop_module_chain(modules);
+    print_module_statistics(modules);
+    print_stage_statistics(modules);
+    print_trace_statistics(tracer);
+
+    if (queued_client != NULL){
+        std::cout << "Bundles published: " << queued_client->get_published_count()
+            << ", dropped: " << queued_client->get_dropped_count()
+            << ", coalesced: " << queued_client->get_coalesced_count()
+            << ", max queue depth: " << queued_client->get_max_queue_depth()
+            << "/" << queued_client->get_queue_capacity() << std::endl;
+        delete queued_client;
     }
 
     muse::module_service::get_instance()->free_module_chain(modules);
+    if (receive_probe != NULL){ raw_client->del_listener(receive_probe); }
     delete raw_client;
+    delete receive_probe;
+    delete delivery_probe;
+    delete tracer;
 
     return EXIT_SUCCESS;
 }
@@ -141,10 +259,40 @@ int parse_commandline(stdout_config * config, int argc, char ** argv){
         cmdline_opts[index].flag = NULL;
         cmdline_opts[index].val = 'm';
         ++index;
+
+        cmdline_opts[index].name = "queue";
+        cmdline_opts[index].has_arg = 1;
+        cmdline_opts[index].flag = NULL;
+        cmdline_opts[index].val = 'q';
+        ++index;
+
+        cmdline_opts[index].name = "coalesce";
+        cmdline_opts[index].has_arg = 0;
+        cmdline_opts[index].flag = NULL;
+        cmdline_opts[index].val = 'c';
+        ++index;
+
+        cmdline_opts[index].name = "stats";
+        cmdline_opts[index].has_arg = 1;
+        cmdline_opts[index].flag = NULL;
+        cmdline_opts[index].val = 's';
+        ++index;
+
+        cmdline_opts[index].name = "trace";
+        cmdline_opts[index].has_arg = 1;
+        cmdline_opts[index].flag = NULL;
+        cmdline_opts[index].val = 't';
+        ++index;
+
+        cmdline_opts[index].name = "prune";
+        cmdline_opts[index].has_arg = 0;
+        cmdline_opts[index].flag = NULL;
+        cmdline_opts[index].val = 'u';
+        ++index;
     }
     
   char opt = -1;
-    while ((opt = getopt_long(argc, argv, "-hp:m:", cmdline_opts, NULL)) != -1){
+    while ((opt = getopt_long(argc, argv, "-hp:m:q:cs:t:u", cmdline_opts, NULL)) != -1){
         switch (opt){
             case 'h': {
                 usage();
@@ -153,8 +301,12 @@ int parse_commandline(stdout_config * config, int argc, char ** argv){
                 break;
             }
             case 'p': { // ================ port
-                config->port = strtol(optarg, NULL, 10);
-                if (config->port > 0xffff){ cerr << "Invalid port " << config->port << endl; }
+                long port = strtol(optarg, NULL, 10);
+                if ((port <= 0) || (port > 0xffff)){
+                    cerr << "Invalid port " << port << endl;
+                } else {
+                    config->ports.push_back(port);
+                }
                 break;
             }
             case 'm': {
@@ -166,6 +318,26 @@ int parse_commandline(stdout_config * config, int argc, char ** argv){
                 }
                 break;
             }
+            case 'q': { // ================ threaded receive
+                config->queue_capacity = strtoul(optarg, NULL, 10);
+                break;
+            }
+            case 'c': {
+                config->overflow_policy = threaded_client::OVERFLOW_COALESCE_PER_SOURCE;
+                break;
+            }
+            case 's': { // ================ module instrumentation
+                config->stats_interval = strtoul(optarg, NULL, 10);
+                break;
+            }
+            case 't': { // ================ end-to-end latency tracing
+                config->trace_budget = strtoul(optarg, NULL, 10);
+                break;
+            }
+            case 'u': { // ================ decode just what the modules read
+                config->prune = true;
+                break;
+            }
 
             default: {
                 std::cerr << "Unrecognized argument!" << std::endl;
@@ -185,6 +357,8 @@ int parse_commandline(stdout_config * config, int argc, char ** argv){
         config->muse_config.InsertEndChild(e_root);
     }
 */  
+    if (config->ports.empty()){ config->ports.push_back(3333); }
+
     return 0;
 }
 
@@ -194,11 +368,125 @@ static void usage(){
     cout << endl;
     cout << "Options:" << endl;
     cout << "--raw                   \tDisable all event transformations, print data as were received" << endl;
-    cout << "--port                  \tPort to listen on" << endl;
+    cout << "--port                  \tPort to listen on, can be given multiple times" << endl;
     cout << "--muse-config=<file.xml>\tUse given MUSE framework configuration" << endl;
+    cout << "--queue=<capacity>      \tReceive on dedicated thread, queue up to capacity bundles" << endl;
+    cout << "--coalesce              \tWhen the queue is full keep only latest bundle per source" << endl;
+    cout << "                        \tinstead of dropping the oldest one" << endl;
+    cout << "--stats=<seconds>       \tMeasure the modules, print the statistics every given seconds" << endl;
+    cout << "--trace=<budget_ms>     \tTrace the frame latency from the sensor, count frames over budget" << endl;
+    cout << "                        \tprinted with the statistics or at exit" << endl;
+    cout << "--prune                 \tDo not decode the messages none of the modules reads," << endl;
+    cout << "                        \tthey are not printed then" << endl;
     cout.flush();
 }
 
+static void prune_convertors(const muse::module_service::module_chain & modules, std::vector<simple_client *> & parsers){
+    muse::module_interest interest;
+    if (!muse::module_service::get_instance()->get_chain_interest(modules, interest)){
+        std::cerr << "Some of the modules have not declared the messages they read, nothing pruned!" << std::endl;
+        return;
+    }
+
+    std::list<std::string> unused;
+    interest.get_unused_paths(unused);
+
+    for (std::vector<simple_client *>::iterator parser = parsers.begin(); parser != parsers.end(); ++parser){
+        if (*parser == NULL){ continue; }
+        (*parser)->disable_convertors(unused);
+        // nobody reads the messages left without convertor either
+        (*parser)->set_accept_unknown(false);
+    }
+
+    std::cout << "Messages not decoded: " << unused.size() << " paths" << std::endl;
+}
+
+static void print_stage_statistics(const muse::module_service::module_chain & modules){
+    for (
+        muse::module_service::module_chain::const_iterator current_module = modules.begin();
+        current_module != modules.end();
+        ++current_module
+    ){
+        const muse::pipeline_stage * stage = dynamic_cast<const muse::pipeline_stage *>(current_module->first);
+        if (stage == NULL){ continue; }
+
+        muse::pipeline_stage::statistics stats = stage->get_statistics();
+        uint64_t processed = (stats.processed > 0)?stats.processed:1;
+
+        std::cout << "Stage " << stage->get_name()
+            << ": processed " << stats.processed
+            << ", blocked " << stats.blocked
+            << ", dropped " << stats.dropped
+            << ", max queue depth " << stats.max_depth << "/" << stage->get_queue_capacity()
+            << ", queue latency avg/max " << (stats.queue_latency_total / processed) / 1000
+            << "/" << stats.queue_latency_max / 1000 << " us"
+            << ", processing avg/max " << (stats.processing_total / processed) / 1000
+            << "/" << stats.processing_max / 1000 << " us" << std::endl;
+    }
+}
+
+static void print_module_statistics(const muse::module_service::module_chain & modules){
+    muse::module_service::statistics_list statistics;
+    muse::module_service::get_instance()->get_chain_statistics(modules, statistics);
+
+    for (
+        muse::module_service::statistics_list::const_iterator current_module = statistics.begin();
+        current_module != statistics.end();
+        ++current_module
+    ){
+        const muse::module_statistics & stats = current_module->second;
+
+        std::cout << "Module " << current_module->first->Attribute("id")
+            << " " << current_module->first->Attribute("path")
+            << ": bundles in/out " << stats.bundles_in << "/" << stats.bundles_out
+            << ", messages in/out " << stats.messages_in << "/" << stats.messages_out
+            << ", backlog " << stats.backlog << " (max " << stats.backlog_max << ")"
+            << ", latency p50/p99/max " << stats.latency.get_percentile(50) / 1000
+            << "/" << stats.latency.get_percentile(99) / 1000
+            << "/" << stats.latency.get_max() / 1000 << " us" << std::endl;
+    }
+}
+
+static void print_trace_points(const muse::latency_tracer::statistics_list & statistics){
+    for (
+        muse::latency_tracer::statistics_list::const_iterator point = statistics.begin();
+        point != statistics.end();
+        ++point
+    ){
+        std::cout << "\t" << point->point
+            << ": since sensor p50/p99/max " << point->since_sensor.get_percentile(50) / 1000
+            << "/" << point->since_sensor.get_percentile(99) / 1000
+            << "/" << point->since_sensor.get_max() / 1000 << " us"
+            << ", hop p50/p99 " << point->since_previous.get_percentile(50) / 1000
+            << "/" << point->since_previous.get_percentile(99) / 1000 << " us"
+            << ", over budget " << point->over_budget
+            << "/" << point->since_sensor.get_count() << std::endl;
+    }
+}
+
+static void print_trace_statistics(const muse::latency_tracer * tracer){
+    if (tracer == NULL){ return; }
+
+    std::vector<muse::latency_tracer::source_key> sources;
+    tracer->get_sources(sources);
+
+    muse::latency_tracer::statistics_list statistics;
+    for (
+        std::vector<muse::latency_tracer::source_key>::const_iterator source = sources.begin();
+        source != sources.end();
+        ++source
+    ){
+        tracer->get_statistics(*source, statistics);
+        std::cout << "Trace of " << source->application << "@" << libkerat::ipv4_to_str(source->addr)
+            << "/" << source->instance << ":" << std::endl;
+        print_trace_points(statistics);
+    }
+
+    tracer->get_statistics(statistics);
+    std::cout << "Trace of all sources, budget " << tracer->get_budget() / 1000 << " us:" << std::endl;
+    print_trace_points(statistics);
+}
+
 static void register_signal_handlers(){
 
     signal(SIGTERM, handle_kill_signal);
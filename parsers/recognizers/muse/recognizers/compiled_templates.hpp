@@ -0,0 +1,198 @@
+/**
+ * \file      compiled_templates.hpp
+ * \brief     Provides the binary file of preprocessed dollar N ($N) templates
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:25 UTC
+ * \copyright BSD
+ */
+
+#ifndef COMPILED_TEMPLATES_HPP_
+#define	COMPILED_TEMPLATES_HPP_
+
+#include <kerat/message_helpers.hpp>
+#include <muse/recognizers/recognizers_utils.hpp>
+#include <muse/recognizers/stroke_kernels.hpp>
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace libreco {
+    namespace iotools {
+
+        /**
+         * \brief Parameters the templates were preprocessed with
+         *
+         * Compiled templates can be used only by the recognizer created with
+         * the same parameters from the same templates. The templates themselves
+         * are identified by the hash of their source, see \ref compiled_templates::hash.
+         */
+        struct compiled_parameters {
+            //! \brief hash of the template source
+            uint64_t source_hash;
+            //! \brief number of points of each unistroke
+            uint16_t number_of_points;
+            //! \brief side length of the box the unistrokes were scaled to
+            uint16_t scale_box_size;
+            //! \brief index of the point the start unit vectors were computed for
+            uint16_t start_vector_index;
+            //! \brief threshold between uniform and non-uniform scaling
+            float scaling_threshold;
+            //! \brief centroid of the unistrokes
+            libkerat::helpers::point_2d origin;
+
+            //! \brief creates empty parameters
+            compiled_parameters();
+
+            /**
+             * \brief Creates the parameters of the dollar N ($N) preprocessing
+             *
+             * \param hash          hash of the template source
+             * \param num_of_pts    number of points of each unistroke
+             * \param orig          centroid of the unistrokes
+             * \param scale_box     side length of the scaling box
+             * \param scale_thresh  threshold between uniform and non-uniform scaling
+             * \param start_index   index of the point the start unit vector is computed for
+             */
+            compiled_parameters(uint64_t hash, uint16_t num_of_pts, const libkerat::helpers::point_2d & orig,
+                    uint16_t scale_box, float scale_thresh, uint16_t start_index);
+
+            //! \brief parameters are equal if all of them are exactly equal
+            bool operator==(const compiled_parameters & second) const;
+            bool operator!=(const compiled_parameters & second) const { return !operator==(second); }
+        };
+
+        /**
+         * \brief Preprocessed dollar N ($N) templates in flat binary file
+         *
+         * The file holds all unistroke permutations of the multistroke templates
+         * after resampling, rotating, scaling and translating, along with their start
+         * unit vectors and centroids, so the recognizer does not preprocess anything.
+         * Coordinates of each unistroke are stored as x array followed by y array
+         * (\ref libreco::rauxiliary::soa_stroke). File is in native byte order, its
+         * header records format version and byte order, so file written by other
+         * version or on other machine is refused.
+         */
+        class compiled_templates {
+        public:
+            //! \brief version of the file format, increase with every change of the layout
+            static const uint32_t FORMAT_VERSION;
+
+            //! \brief gesture (template) record
+            struct gesture_record {
+                //! \brief offset of the name in the names block
+                uint32_t name_offset;
+                //! \brief length of the name
+                uint32_t name_length;
+                //! \brief index of the first unistroke of the gesture
+                uint32_t first_unistroke;
+                //! \brief number of unistrokes of the gesture
+                uint32_t unistroke_count;
+                //! \brief number of partial strokes of the gesture
+                uint16_t number_of_strokes;
+                //! \brief orientation sensitivity of the gesture, 0 or 1
+                uint8_t sensitive;
+                //! \brief padding, always 0
+                uint8_t reserved;
+            };
+
+            //! \brief unistroke record, followed by the coordinates in the points block
+            struct unistroke_record {
+                //! \brief start unit vector
+                float start_x;
+                float start_y;
+                //! \brief centroid
+                float center_x;
+                float center_y;
+            };
+
+            compiled_templates();
+            ~compiled_templates();
+
+            /**
+             * \brief Reads the file to memory and checks its format
+             *
+             * \param file_path path to the file
+             * \return          false if the file does not exist, is of other format version or byte order or is damaged
+             */
+            bool load(const std::string & file_path);
+
+            //! \brief Releases the loaded file
+            void unload();
+
+            //! \brief true if file is loaded
+            inline bool is_loaded() const { return data != NULL; }
+
+            //! \brief parameters the loaded templates were preprocessed with
+            inline const compiled_parameters & get_parameters() const { return parameters; }
+
+            //! \brief number of gestures (templates)
+            uint32_t get_gesture_count() const;
+
+            //! \brief gesture record at given index
+            const gesture_record & get_gesture(uint32_t index) const;
+
+            //! \brief name of gesture at given index
+            std::string get_name(uint32_t index) const;
+
+            //! \brief unistroke record at given index
+            const unistroke_record & get_unistroke(uint32_t index) const;
+
+            //! \brief x coordinates of the unistroke at given index, there are \ref compiled_parameters::number_of_points of them
+            const float * get_xs(uint32_t index) const;
+
+            //! \brief y coordinates of the unistroke at given index
+            const float * get_ys(uint32_t index) const;
+
+            /**
+             * \brief Writes the preprocessed templates to given file
+             *
+             * The file is written under temporary name and renamed, so running
+             * recognizers never load half written file.
+             *
+             * Unistrokes shorter than given number of points are padded by their last point.
+             *
+             * \param file_path         path to the file
+             * \param params            parameters the templates were preprocessed with
+             * \param templates         preprocessed templates
+             * \param kernel_templates  the same unistrokes as structure of arrays, one vector for each template
+             * \return                  false if the file can not be written or any unistroke is empty or has more than given number of points
+             */
+            static bool save(const std::string & file_path, const compiled_parameters & params,
+                    const std::vector<libreco::rutils::multistroke_gesture> & templates,
+                    const std::vector<std::vector<libreco::rauxiliary::soa_stroke> > & kernel_templates);
+
+            /**
+             * \brief Computes 64bit FNV-1a hash of given bytes
+             *
+             * \param bytes     bytes to hash
+             * \param length    number of bytes
+             * \param hash      hash of the preceding bytes, to hash the source by parts
+             * \return          hash
+             */
+            static uint64_t hash(const void * bytes, size_t length, uint64_t hash = HASH_SEED);
+
+            //! \brief hash of no bytes
+            static const uint64_t HASH_SEED;
+
+        private:
+            compiled_templates(const compiled_templates &);
+            compiled_templates & operator=(const compiled_templates &);
+
+            const char * data;
+            size_t data_size;
+
+            compiled_parameters parameters;
+            const gesture_record * gestures;
+            const unistroke_record * unistrokes;
+            const float * points;
+            const char * names;
+            uint32_t gesture_count;
+            uint32_t unistroke_count;
+        };
+
+    } // ns iotools
+} // ns libreco
+
+#endif	/* COMPILED_TEMPLATES_HPP_ */
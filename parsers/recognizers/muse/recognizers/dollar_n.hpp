@@ -11,6 +11,10 @@
 
 #include <kerat/message_helpers.hpp>
 #include <muse/recognizers/recognizers_auxiliary.hpp>
+#include <muse/recognizers/stroke_kernels.hpp>
+#include <muse/recognizers/compiled_templates.hpp>
+#include <muse/recognizers/matching_pool.hpp>
+#include <muse/recognizers/template_index.hpp>
 #include <muse/recognizers/typedefs.hpp>
 
 #include <vector>
@@ -33,6 +37,26 @@ namespace libreco {
              * Mapped value is vector of partial strokes for given multistroke gesture.
              */
             typedef std::map<libreco::rutils::gesture_identity, vector<vector<point_2d> > > libreco_generic_multistroke_map;
+            
+            /**
+             * \brief Agreement of the cascade matching with the exhaustive one
+             * 
+             * \see recognize(const vector<vector<point_2d> > & unknown_gesture, cascade_report & report) const
+             */
+            struct cascade_report {
+                //! \brief unistroke permutations passing the stroke number and start vector tests, each is searched by the exhaustive matching
+                size_t candidates;
+                //! \brief unistroke permutations searched at full resolution by the cascade
+                size_t full_searches;
+                //! \brief number of templates ranked by the exhaustive matching
+                size_t ranks;
+                //! \brief number of ranks at which the cascade ranked the same template as the exhaustive matching
+                size_t agreeing_ranks;
+                //! \brief true if both rank the same template first with the same score
+                bool same_best;
+                
+                cascade_report() : candidates(0), full_searches(0), ranks(0), agreeing_ranks(0), same_best(false) { ; }
+            };
                                     
             /**
              * \brief Creates new Dollar N ($N) recognizer instance with default parameters
@@ -85,6 +109,34 @@ namespace libreco {
             dollar_n(const libreco_generic_multistroke_map & tmpls, uint16_t num_of_pts, const point_2d orig, float rot_down, float rot_up,
                      float rot_thresh, uint16_t scale_box, float scale_thresh, uint16_t start_index, float start_thresh, bool eq_strokes);
             
+            /**
+             * \brief Creates new Dollar N ($N) recognizer instance from compiled templates
+             * 
+             * Templates are taken as they are, already preprocessed with the parameters stored in the compiled file,
+             * so this takes time linear to the size of the file. Caller is responsible for checking that the compiled
+             * templates match the template source, see \ref libreco::iotools::compiled_parameters.
+             * 
+             * \see save_compiled
+             * 
+             * \param compiled      loaded compiled templates
+             * \param rot_down      angle which specifies down limit of rotation range used for searching distance at best angle
+             * \param rot_up        angle which specifies up limit of rotation range used for searching distance at best angle
+             * \param rot_thresh    if rotation change in recognition process is less than threshold recognition is done
+             * \param start_thresh  threshold for angle between template and gesture start vectors
+             * \param eq_strokes    if true, unknown gesture will be compered only to templates with same number of strokes in recognition process.
+             */
+            dollar_n(const libreco::iotools::compiled_templates & compiled, float rot_down, float rot_up, float rot_thresh,
+                     float start_thresh, bool eq_strokes);
+            
+            /**
+             * \brief Writes the preprocessed templates to given file, to be loaded by \ref libreco::iotools::compiled_templates
+             * 
+             * \param file_path     path to the file
+             * \param source_hash   hash of the template source the recognizer was created from
+             * \return              true if the file was written
+             */
+            bool save_compiled(const std::string & file_path, uint64_t source_hash) const;
+            
             /**
              * \brief Method for gesture recognition
              * 
@@ -107,8 +159,67 @@ namespace libreco {
              */
             libreco::recognizers::recognized_gestures recognize(const vector<vector<point_2d> > & unknown_gesture) const;
             
+            /**
+             * \brief Recognizes the gesture by the cascade and compares the result to the exhaustive matching
+             * 
+             * Both matchings are run, regardless of \ref set_cascade, so this is meant for tuning only.
+             * 
+             * \param unknown_gesture   vector of strokes which represents unknown gesture made by user
+             * \param report            agreement of both matchings
+             * \return                  scores of the cascade matching
+             */
+            libreco::recognizers::recognized_gestures recognize(const vector<vector<point_2d> > & unknown_gesture, cascade_report & report) const;
+            
+            /**
+             * \brief Enables the coarse to fine cascade matching
+             * 
+             * Candidate unistrokes of each template are ordered by their distance at 16 points and zero angle first,
+             * and the best of them is searched at full resolution. The other candidates are searched only if the lower bound
+             * of their distance (see \ref libreco::rauxiliary::rotation_lower_bound) can still beat both the best distance
+             * of their template and the best distance of all templates found by the first searches.
+             * The best template and its score are the same as of the exhaustive matching, other templates may
+             * score lower, as their search stops once they can not be the best.
+             * 
+             * \param enable    true to match by the cascade, false (default) to search all candidates at full resolution
+             */
+            inline void set_cascade(bool enable) { cascade = enable; }
+            
+            //! \brief true if the cascade matching is enabled
+            inline bool get_cascade() const { return cascade; }
+            
+            /**
+             * \brief Enables the template index, only unistroke permutations nearest to the unknown gesture are searched
+             * 
+             * Indexes (\ref libreco::rutils::vp_tree) over the permutations of orientation invariant and sensitive templates,
+             * at the resolution of the cascade, are built here, so call it when the templates are loaded. Permutations which
+             * pass the stroke number and start vector tests are shortlisted by euclidean distance of their points at zero angle
+             * and searched for the best angle. Only templates of the searched permutations are returned, all permutations are
+             * searched if none is shortlisted. The index takes precedence over the cascade.
+             * 
+             * \param size      number of unistroke permutations shortlisted, 0 (default) drops the index and searches all of them
+             */
+            void set_shortlist_size(size_t size);
+            
+            //! \brief Gets number of permutations shortlisted by the template index, 0 if the index is not used
+            inline size_t get_shortlist_size() const { return shortlist_size; }
+            
+            /**
+             * \brief Sets number of threads the templates are matched by
+             * 
+             * Unistroke permutations of all templates are split to contiguous chunks, one for each thread, the calling
+             * thread matches one of them. Scores do not depend on number of threads.
+             * 
+             * \param threads   number of threads, 1 (default) matches in the calling thread only
+             */
+            inline void set_thread_count(unsigned int threads) { matching_threads.set_thread_count(threads); }
+            
+            //! \brief Gets number of threads the templates are matched by
+            inline unsigned int get_thread_count() const { return matching_threads.get_thread_count(); }
+            
         private:
             vector<libreco::rutils::multistroke_gesture> dollar_n_templates;
+            //! \brief unistrokes of each template laid out for the rotation search, in the same order as dollar_n_templates
+            vector<vector<libreco::rauxiliary::soa_stroke> > dollar_n_kernel_templates;
             uint16_t number_of_points;
             point_2d origin;
             float rotation_down_limit;
@@ -119,6 +230,49 @@ namespace libreco {
             uint16_t start_vector_index;
             float start_vector_threshold;
             bool equal_strokes_numbers;
+            //! \brief index of the first unistroke of each template in all unistrokes, followed by their count
+            vector<size_t> dollar_n_unistroke_offsets;
+            //! \brief unistrokes of all templates at cascade resolution, indexed as all unistrokes
+            vector<libreco::rauxiliary::soa_stroke> dollar_n_coarse_unistrokes;
+            //! \brief distances of unistroke points to their centroid, number_of_points for each of all unistrokes
+            vector<float> dollar_n_unistroke_radii;
+            bool cascade;
+            libreco::rutils::matching_pool matching_threads;
+            //! \brief indexes over dollar_n_coarse_unistrokes of orientation invariant and sensitive templates, identified by their index
+            libreco::rutils::vp_tree invariant_index;
+            libreco::rutils::vp_tree sensitive_index;
+            size_t shortlist_size;
+            
+            //! \brief unknown gesture preprocessed for matching, in both orientation sensitive and invariant variant
+            struct prepared_gesture {
+                size_t number_of_strokes;
+                point_2d inv_start_vector;
+                libreco::rauxiliary::soa_stroke inv_unistroke;
+                libreco::rauxiliary::soa_stroke inv_coarse;
+                vector<float> inv_radii;
+                point_2d sens_start_vector;
+                libreco::rauxiliary::soa_stroke sens_unistroke;
+                libreco::rauxiliary::soa_stroke sens_coarse;
+                vector<float> sens_radii;
+            };
+            
+            //! \brief state of the cascade matching shared by its chunks, each chunk writes only the entries of its templates
+            struct cascade_state {
+                //! \brief lower bound of distance of each candidate, indexed as all unistrokes
+                vector<float> bounds;
+                //! \brief candidates of each template, ordered by the coarse distance, starting at the offset of the template
+                vector<size_t> candidates;
+                //! \brief number of candidates of each template
+                vector<size_t> candidate_counts;
+                //! \brief least distance of each template found so far
+                vector<float> best_distances;
+                //! \brief least distance of all templates after the first searches
+                float global_best;
+            };
+            
+            friend class dollar_n_matching_task;
+            friend class dollar_n_cascade_task;
+            friend class dollar_n_index_filter;
                         
             //! \brief transforms multistroke templates to all possible uni-stroke permutations
             void generate_unistroke_permutations(const libreco_generic_multistroke_map & tmpls);
@@ -143,9 +297,52 @@ namespace libreco {
             //! \brief computes angle between two vectors
             static float angle_between_vectors(const point_2d & p1, const point_2d & p2);
             
-            //! \brief computes distance at best angle between unknown gesture and given template
-            float compare_gestures(const vector<libreco::rutils::multistroke_gesture>::const_iterator & tmpls_iter,
-                                   const point_2d & start_vector, const vector<point_2d> & unistroke) const;
+            //! \brief indexes unistrokes of all templates, so they can be split to chunks, and lays them out for the cascade
+            void index_unistrokes();
+            
+            //! \brief preprocesses unknown gesture the same way templates are processed
+            void prepare_gesture(const vector<vector<point_2d> > & unknown_gesture, bool with_coarse, prepared_gesture & prepared) const;
+            
+            //! \brief true if the unistroke at given index of given template passes the stroke number and start vector tests
+            bool is_candidate(const prepared_gesture & gesture, size_t tmpl, size_t unistroke) const;
+            
+            /**
+             * \brief computes distances at best angle between unknown gesture and the range of all or selected unistrokes
+             * 
+             * Stores the least distance for each template to best_distances, FLT_MAX stays for templates not compared.
+             * 
+             * \param selection     indexes of selected unistrokes in ascending order, all unistrokes if NULL
+             * \return              number of unistrokes searched
+             */
+            size_t compare_unistrokes(size_t begin, size_t end, const vector<size_t> * selection, const prepared_gesture & gesture,
+                                      float * best_distances) const;
+            
+            /**
+             * \brief first stage of the cascade for the range of templates
+             * 
+             * Bounds and orders the candidates of each template and searches the first of them at full resolution.
+             * 
+             * \return  number of unistrokes searched
+             */
+            size_t seed_cascade(size_t begin, size_t end, const prepared_gesture & gesture, cascade_state & state) const;
+            
+            /**
+             * \brief second stage of the cascade for the range of templates
+             * 
+             * Searches the candidates which lower bound beats both the template and the global best distance.
+             * 
+             * \return  number of unistrokes searched
+             */
+            size_t refine_cascade(size_t begin, size_t end, const prepared_gesture & gesture, cascade_state & state) const;
+            
+            //! \brief matches all or selected candidates at full resolution, returns number of unistrokes searched
+            size_t match_exhaustive(const prepared_gesture & gesture, const vector<size_t> * selection, vector<float> & best_distances) const;
+            
+            //! \brief matches candidates by the cascade, returns number of unistrokes searched
+            size_t match_cascade(const prepared_gesture & gesture, vector<float> & best_distances) const;
+            
+            //! \brief converts least distances of templates to scores
+            libreco::recognizers::recognized_gestures make_scores(const vector<float> & best_distances) const;
           
         
         };
@@ -12,6 +12,9 @@
 
 #include <kerat/message_helpers.hpp>
 #include <muse/recognizers/recognizers_utils.hpp>
+#include <muse/recognizers/stroke_kernels.hpp>
+#include <muse/recognizers/matching_pool.hpp>
+#include <muse/recognizers/template_index.hpp>
 #include <muse/recognizers/typedefs.hpp>
 
 #include <vector>
@@ -96,15 +99,48 @@ namespace libreco {
              * \return                  multimap of scores and names for each template loaded in constructor (scores are sorted in descending order)
              */
             libreco::recognizers::recognized_gestures recognize(const std::vector<libreco::rutils::point_time> & unknown_gesture) const;
+            
+            /**
+             * \brief Sets number of threads the templates are matched by
+             * 
+             * Templates are split to contiguous chunks, one for each thread, the calling
+             * thread matches one of them. Scores do not depend on number of threads.
+             * 
+             * \param threads   number of threads, 1 (default) matches in the calling thread only
+             */
+            inline void set_thread_count(unsigned int threads) { matching_threads.set_thread_count(threads); }
+            
+            //! \brief Gets number of threads the templates are matched by
+            inline unsigned int get_thread_count() const { return matching_threads.get_thread_count(); }
+            
+            /**
+             * \brief Enables the template index, only templates nearest to the unknown gesture are scored
+             * 
+             * The index (\ref libreco::rutils::vp_tree) over the processed templates is built here, so call it when
+             * the templates are loaded. Templates are shortlisted by euclidean distance of their points at zero angle,
+             * only the shortlisted ones are searched for the best angle and returned with their scores.
+             * 
+             * \param size      number of templates shortlisted, 0 (default) drops the index and scores all templates
+             */
+            void set_shortlist_size(size_t size);
+            
+            //! \brief Gets number of templates shortlisted by the template index, 0 if the index is not used
+            inline size_t get_shortlist_size() const { return shortlist_size; }
 
         private:
             std::vector<libreco::rutils::unistroke_gesture> dollar_templates;
+            //! \brief processed templates laid out for the rotation search, in the same order as dollar_templates
+            std::vector<libreco::rauxiliary::soa_stroke> dollar_kernel_templates;
             uint16_t number_of_points;
             libkerat::helpers::point_2d origin;
             float rotation_down_limit;
             float rotation_up_limit;
             float rotation_threshold;
             uint16_t scale_box_size;
+            libreco::rutils::matching_pool matching_threads;
+            //! \brief index over dollar_kernel_templates, identified by their position
+            libreco::rutils::vp_tree template_index;
+            size_t shortlist_size;
             
             //! \brief Uniformly scales gesture to bounding box so gestures of all sizes are treated the same
             void scale_to_bounding_box(std::vector<libkerat::helpers::point_2d> & points) const;
@@ -11,7 +11,11 @@
 
 #include <muse/recognizers/recognizers_auxiliary.hpp>
 #include <muse/recognizers/recognizers_utils.hpp>
+#include <muse/recognizers/stroke_kernels.hpp>
 #include <muse/recognizers/io_utils.hpp>
+#include <muse/recognizers/compiled_templates.hpp>
+#include <muse/recognizers/matching_pool.hpp>
+#include <muse/recognizers/template_index.hpp>
 #include <muse/recognizers/dollar_n.hpp>
 #include <muse/recognizers/dollar_recognizer.hpp>
 #include <muse/recognizers/protractor.hpp>
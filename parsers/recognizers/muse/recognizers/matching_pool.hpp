@@ -0,0 +1,104 @@
+/**
+ * \file      matching_pool.hpp
+ * \brief     Provides the worker pool the recognizers split the template matching across
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:30 UTC
+ * \copyright BSD
+ */
+
+#ifndef MATCHING_POOL_HPP_
+#define	MATCHING_POOL_HPP_
+
+#include <pthread.h>
+#include <stddef.h>
+
+namespace libreco {
+    namespace rutils {
+
+        /**
+         * \brief Part of the recognition run by the \ref matching_pool
+         *
+         * Matched items (eg. templates) are split to contiguous chunks, each chunk is
+         * matched by one thread. Task stores results of each chunk separately and
+         * merges them in chunk order once all chunks are done, so the results do not
+         * depend on which thread matched which chunk.
+         */
+        class matching_task {
+        public:
+            virtual ~matching_task() { ; }
+
+            /**
+             * \brief Matches items of given chunk
+             *
+             * \param chunk     index of the chunk, chunks are numbered in order of items
+             * \param begin     first item of the chunk
+             * \param end       item just after the last item of the chunk
+             */
+            virtual void match(size_t chunk, size_t begin, size_t end) = 0;
+        };
+
+        /**
+         * \brief Pool of threads matching the unknown gesture against templates
+         *
+         * Calling thread matches the first chunk itself, so the pool of N threads
+         * starts N-1 workers. Workers are started on the first run. Copy of the pool
+         * has the same number of threads and its own workers, so the recognizers
+         * holding the pool can be copied as before.
+         */
+        class matching_pool {
+        public:
+
+            /**
+             * \brief Creates the pool
+             *
+             * \param thread_count  number of threads matching, including the calling one, 0 is taken as 1
+             */
+            explicit matching_pool(unsigned int thread_count = 1);
+            matching_pool(const matching_pool & second);
+            ~matching_pool();
+
+            matching_pool & operator=(const matching_pool & second);
+
+            //! \brief number of threads matching, including the calling one
+            inline unsigned int get_thread_count() const { return threads; }
+
+            /**
+             * \brief Changes number of threads, stops the current workers
+             *
+             * \param thread_count  number of threads matching, including the calling one, 0 is taken as 1
+             */
+            void set_thread_count(unsigned int thread_count);
+
+            //! \brief number of chunks given number of items is split to
+            size_t get_chunk_count(size_t items) const;
+
+            /**
+             * \brief Matches given number of items
+             *
+             * Items are split to \ref get_chunk_count contiguous chunks of nearly equal
+             * size, this returns once all of them are matched. Calls from more threads
+             * are served one by one.
+             *
+             * \param task      task matching the chunks
+             * \param items     number of items to match
+             */
+            void run(matching_task & task, size_t items) const;
+
+        private:
+            struct pool_state;
+
+            //! \brief stops and joins the workers
+            void stop() const;
+
+            //! \brief body of the worker threads
+            static void * worker(void * state);
+
+            unsigned int threads;
+            mutable pthread_mutex_t run_mutex;
+            mutable pool_state * state;
+        };
+
+    } // ns rutils
+} // ns libreco
+
+#endif	/* MATCHING_POOL_HPP_ */
@@ -280,7 +280,7 @@ namespace libreco {
                 }
 
                 //insert message to processed messages bundle
-                bm_handle_insert(output_frame, bm_handle_end(output_frame), (*msg_iter)->clone());
+                bm_handle_insert_shared(output_frame, bm_handle_end(output_frame), *msg_iter);
             }
             
             return 0;
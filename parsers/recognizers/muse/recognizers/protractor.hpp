@@ -11,6 +11,8 @@
 
 #include <kerat/message_helpers.hpp>
 #include <muse/recognizers/recognizers_utils.hpp>
+#include <muse/recognizers/matching_pool.hpp>
+#include <muse/recognizers/template_index.hpp>
 #include <muse/recognizers/typedefs.hpp>
 
 #include <vector>
@@ -90,11 +92,46 @@ namespace libreco {
              */
             libreco::recognizers::recognized_gestures recognize(const std::vector<libreco::rutils::point_time> & unknown_gesture) const;
             
+            /**
+             * \brief Sets number of threads the templates are matched by
+             * 
+             * Templates are split to contiguous chunks, one for each thread, the calling
+             * thread matches one of them. Scores do not depend on number of threads.
+             * 
+             * \param threads   number of threads, 1 (default) matches in the calling thread only
+             */
+            inline void set_thread_count(unsigned int threads) { matching_threads.set_thread_count(threads); }
+            
+            //! \brief Gets number of threads the templates are matched by
+            inline unsigned int get_thread_count() const { return matching_threads.get_thread_count(); }
+            
+            /**
+             * \brief Enables the template index, only templates nearest to the unknown gesture are scored
+             * 
+             * Indexes (\ref libreco::rutils::vp_tree) over the vector representations of orientation invariant and
+             * sensitive templates are built here, so call it when the templates are loaded. Templates are shortlisted
+             * by euclidean distance of their vectors, which falls with their cosine at zero angle, only the shortlisted
+             * ones are scored by the optimal cosine distance.
+             * 
+             * \param size      number of templates shortlisted, 0 (default) drops the index and scores all templates
+             */
+            void set_shortlist_size(size_t size);
+            
+            //! \brief Gets number of templates shortlisted by the template index, 0 if the index is not used
+            inline size_t get_shortlist_size() const { return shortlist_size; }
+            
         private:
             
             std::vector<libreco::rutils::unistroke_gesture> prot_templates;
             uint16_t number_of_points;
             libkerat::helpers::point_2d origin;
+            libreco::rutils::matching_pool matching_threads;
+            //! \brief indexes over orientation invariant and sensitive prot_templates, identified by their position
+            libreco::rutils::vp_tree invariant_index;
+            libreco::rutils::vp_tree sensitive_index;
+            size_t shortlist_size;
+            
+            friend class protractor_matching_task;
 
             //! \brief Computes optimal cosine distance between unknown gesture and given pattern
             static float optimal_cosine_distance(const std::vector<libkerat::helpers::point_2d> & points, const std::vector<libkerat::helpers::point_2d> & pattern);
@@ -0,0 +1,144 @@
+/**
+ * \file      stroke_kernels.hpp
+ * \brief     Provides the strokes laid out for the vectorized distance computation
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:19 UTC
+ * \copyright BSD
+ */
+
+#ifndef STROKE_KERNELS_HPP_
+#define	STROKE_KERNELS_HPP_
+
+#include <kerat/message_helpers.hpp>
+
+#include <vector>
+
+namespace libreco {
+    namespace rauxiliary {
+
+        using std::vector;
+        using libkerat::helpers::point_2d;
+
+        /**
+         * \brief Stroke stored as separate arrays of x and y coordinates (structure of arrays)
+         *
+         * The centroid is computed once, when the stroke is stored, so the
+         * rotation search does not need to walk the stroke for it again.
+         * Templates are stored this way when the recognizer is created,
+         * the unknown gesture once per recognition.
+         */
+        struct soa_stroke {
+            //! \brief x coordinates of the points
+            vector<float> xs;
+            //! \brief y coordinates of the points
+            vector<float> ys;
+            //! \brief x coordinate of the centroid
+            float center_x;
+            //! \brief y coordinate of the centroid
+            float center_y;
+
+            //! \brief creates empty stroke
+            soa_stroke() : center_x(0.0), center_y(0.0) { ; }
+
+            /**
+             * \brief Creates the stroke from given points
+             *
+             * \param points    points of the stroke
+             */
+            explicit soa_stroke(const vector<point_2d> & points);
+
+            /**
+             * \brief Creates the stroke from coordinates laid out already, eg. compiled templates
+             *
+             * \param x_coords  x coordinates of the points
+             * \param y_coords  y coordinates of the points
+             * \param size      number of points
+             * \param c_x       x coordinate of the centroid
+             * \param c_y       y coordinate of the centroid
+             */
+            soa_stroke(const float * x_coords, const float * y_coords, unsigned int size, float c_x, float c_y)
+                    : xs(x_coords, x_coords + size), ys(y_coords, y_coords + size), center_x(c_x), center_y(c_y) { ; }
+
+            /**
+             * \brief Replaces the stroke by given points
+             *
+             * \param points    points of the stroke
+             */
+            void assign(const vector<point_2d> & points);
+
+            //! \brief number of points in the stroke
+            inline unsigned int size() const { return xs.size(); }
+        };
+
+        /**
+         * \brief Computes distance between unknown gesture and given pattern at given angle
+         *
+         * Rotation of the unknown gesture around its centroid and the average
+         * distance of its points to the pattern points are computed in one pass,
+         * using SSE when available, without any copy of the gesture.
+         * Distances are summed in the order of points, so the result is the same as of
+         * \ref distance_at_angle(const vector<point_2d> &, const vector<point_2d> &, float).
+         *
+         * \param points    unknown gesture will be compared to given pattern
+         * \param pattern   pattern which will be compared to unknown gesture, must have the same number of points
+         * \param angle     unknown gesture will be rotated by this angle
+         * \return          distance between given pattern and unknown gesture rotated by given angle
+         */
+        float distance_at_angle(const soa_stroke & points, const soa_stroke & pattern, float angle);
+
+        /**
+         * \brief Searches for best score between unknown gesture and given pattern.
+         *
+         * Performs the same golden section search as
+         * \ref distance_at_best_angle(const vector<point_2d> &, const vector<point_2d> &, float, float, float)
+         * on the strokes stored as structure of arrays.
+         *
+         * \param points        unknown gesture
+         * \param pattern       template which will be compared to unknown gesture
+         * \param down_lim      lower-bound for unknown gesture rotation
+         * \param top_lim       upper-bound for unknown gesture rotation
+         * \param thres         threshold used to stop the process of searching for better match
+         * \return              the best score of scores computed for given unknown gesture and given pattern
+         */
+        float distance_at_best_angle(const soa_stroke & points, const soa_stroke & pattern, float down_lim, float top_lim, float thres);
+
+        /**
+         * \brief Computes distance of each point of the stroke to its centroid
+         *
+         * \param stroke    stroke
+         * \param radii     distances, one for each point
+         */
+        void centroid_distances(const soa_stroke & stroke, vector<float> & radii);
+
+        /**
+         * \brief Picks evenly spaced points of the stroke, keeping its centroid
+         *
+         * Empty stroke gives empty coarse stroke, count below two picks just
+         * the first point, if any.
+         *
+         * \param stroke    stroke
+         * \param count     number of points to pick
+         * \param coarse    stroke of the picked points
+         */
+        void coarse_stroke(const soa_stroke & stroke, unsigned int count, soa_stroke & coarse);
+
+        /**
+         * \brief Computes lower bound of the distance between unknown gesture and given pattern at any angle
+         *
+         * Rotation around the centroid keeps distances of the points to the centroid, so the
+         * distance of each point pair is at least the difference of these distances, less the
+         * distance between both centroids. The bound holds for the result of
+         * \ref distance_at_best_angle(const soa_stroke &, const soa_stroke &, float, float, float)
+         * as well.
+         *
+         * \param points            unknown gesture
+         * \param points_radii      distances of gesture points to its centroid, see \ref centroid_distances
+         * \param pattern           pattern, must have the same number of points
+         * \param pattern_radii     distances of pattern points to its centroid
+         * \return                  lower bound of the distance, not negative
+         */
+        float rotation_lower_bound(const soa_stroke & points, const float * points_radii, const soa_stroke & pattern, const float * pattern_radii);
+
+    } //ns rauxiliary
+} //ns libreco
+#endif	/* STROKE_KERNELS_HPP_ */
@@ -0,0 +1,134 @@
+/**
+ * \file      template_index.hpp
+ * \brief     Provides the vantage point tree the recognizers shortlist templates by
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:43 UTC
+ * \copyright BSD
+ */
+
+#ifndef TEMPLATE_INDEX_HPP_
+#define	TEMPLATE_INDEX_HPP_
+
+#include <kerat/message_helpers.hpp>
+#include <muse/recognizers/stroke_kernels.hpp>
+
+#include <vector>
+#include <utility>
+#include <stddef.h>
+
+namespace libreco {
+    namespace rutils {
+
+        //! \brief neighbour found in the index, its distance to the query and its identifier
+        typedef std::pair<float, size_t> index_neighbour;
+
+        //! \brief Decides which templates may be found by the search
+        class index_filter {
+        public:
+            virtual ~index_filter() { ; }
+
+            //! \brief true if the template of given identifier may be found
+            virtual bool accepts(size_t id) const = 0;
+        };
+
+        /**
+         * \brief Vantage point tree over the templates as feature vectors
+         *
+         * Each node splits the templates by the median of their euclidean distance to its
+         * vantage point, so the search skips the subtrees which can not hold nearer template
+         * than those found already. The tree is built once, when the templates are loaded,
+         * and the search only reads it, so more threads may search at once.
+         */
+        class vp_tree {
+        public:
+            vp_tree();
+
+            /**
+             * \brief Builds the tree, replacing the previous one
+             *
+             * \param features      feature vectors of all templates, one after another
+             * \param ids           identifier of each template, reported by \ref nearest
+             * \param dimension     length of each feature vector
+             */
+            void build(const std::vector<float> & features, const std::vector<size_t> & ids, unsigned int dimension);
+
+            //! \brief Removes all templates
+            void clear();
+
+            //! \brief number of templates in the tree
+            inline size_t size() const { return ids.size(); }
+
+            //! \brief true if there is no template in the tree
+            inline bool empty() const { return ids.empty(); }
+
+            /**
+             * \brief Searches templates nearest to given feature vector
+             *
+             * Neighbours of equal distance are ordered by their identifiers, so the result
+             * does not depend on the shape of the tree. Templates the filter rejects are
+             * passed over during the search, so count accepted templates are found if
+             * there are so many.
+             *
+             * \param query         feature vector of the unknown gesture, of the dimension the tree was built with
+             * \param count         number of templates to find
+             * \param neighbours    up to count nearest templates are appended here, nearest first
+             * \param filter        templates which may be found, NULL for all of them
+             */
+            void nearest(const float * query, size_t count, std::vector<index_neighbour> & neighbours,
+                    const index_filter * filter = NULL) const;
+
+        private:
+            //! \brief node of the tree, templates nearer than the threshold to the vantage point are inside
+            struct vp_node {
+                size_t item;
+                float threshold;
+                long inside;
+                long outside;
+            };
+
+            //! \brief builds subtree of the items in given range, returns its node
+            long build_node(std::vector<size_t> & items, size_t begin, size_t end, unsigned int & seed);
+
+            //! \brief searches given subtree, keeping the neighbours found as max-heap
+            void search(long node, const float * query, size_t count, const index_filter * filter,
+                    std::vector<index_neighbour> & heap) const;
+
+            //! \brief euclidean distance of the item to the feature vector
+            float distance(size_t item, const float * query) const;
+
+            std::vector<float> features;
+            std::vector<size_t> ids;
+            std::vector<vp_node> nodes;
+            unsigned int dimension;
+            long root;
+        };
+
+        /**
+         * \brief Appends feature vector of the stroke, coordinates of its points in order
+         *
+         * Strokes resampled one point short are completed by their last point, so all
+         * feature vectors have the same dimension.
+         *
+         * \param points    preprocessed stroke
+         * \param count     number of points of the feature vector
+         * \param features  feature vector is appended here, 2 * count values
+         * \return false if the stroke is empty, nothing is appended then
+         */
+        bool append_features(const std::vector<libkerat::helpers::point_2d> & points, unsigned int count, std::vector<float> & features);
+
+        //! \brief Appends feature vector of the stroke stored as structure of arrays
+        bool append_features(const libreco::rauxiliary::soa_stroke & points, unsigned int count, std::vector<float> & features);
+
+        /**
+         * \brief Keeps given number of nearest neighbours found by more searches
+         *
+         * \param neighbours    neighbours of all searches, they are sorted
+         * \param count         number of neighbours to keep
+         * \param ids           identifiers of the kept neighbours in ascending order
+         */
+        void shortlist(std::vector<index_neighbour> & neighbours, size_t count, std::vector<size_t> & ids);
+
+    } // ns rutils
+} // ns libreco
+
+#endif	/* TEMPLATE_INDEX_HPP_ */
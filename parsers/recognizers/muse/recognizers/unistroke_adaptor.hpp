@@ -153,7 +153,7 @@ namespace libreco {
                 }
                 
                 //each message is inserted to output_frame
-                bm_handle_insert(output_frame, bm_handle_end(output_frame), (*msg_iter)->clone());
+                bm_handle_insert_shared(output_frame, bm_handle_end(output_frame), *msg_iter);
             }
             
             //from now, recognition process is launched if any contact previously present is no more in alive message
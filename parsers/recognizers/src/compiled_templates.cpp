@@ -0,0 +1,295 @@
+/**
+ * \file      compiled_templates.cpp
+ * \brief     Implements the binary file of preprocessed dollar N ($N) templates
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:25 UTC
+ * \copyright BSD
+ */
+
+#include <muse/recognizers/compiled_templates.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+
+#include <unistd.h>
+
+namespace libreco {
+    namespace iotools {
+
+        using std::vector;
+        using libkerat::helpers::point_2d;
+        using libreco::rutils::multistroke_gesture;
+        using libreco::rauxiliary::soa_stroke;
+
+        const uint32_t compiled_templates::FORMAT_VERSION = 1;
+        //FNV-1a offset basis, composed as long long literals are not part of C++98
+        const uint64_t compiled_templates::HASH_SEED = (((uint64_t) 0xcbf29ce4) << 32) | 0x84222325;
+        //! \brief FNV-1a 64 bit prime
+        static const uint64_t HASH_PRIME = (((uint64_t) 0x100) << 32) | 0x000001b3;
+
+        //! \brief identifies the file type
+        static const char COMPILED_MAGIC[8] = { 'L', 'R', 'E', 'C', 'O', 'D', 'N', 0 };
+        //! \brief written in native byte order, reads differently on machine of other endianness
+        static const uint32_t COMPILED_BYTE_ORDER = 0x01020304;
+
+        //! \brief file header, followed by gesture records, unistroke records, points and names
+        struct compiled_header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byte_order;
+            uint64_t source_hash;
+            uint64_t file_size;
+            uint16_t number_of_points;
+            uint16_t scale_box_size;
+            uint16_t start_vector_index;
+            uint16_t reserved;
+            float scaling_threshold;
+            float origin_x;
+            float origin_y;
+            uint32_t gesture_count;
+            uint32_t unistroke_count;
+            uint32_t names_size;
+        };
+
+        //layout must not depend on compiler padding, all blocks keep 4 byte alignment
+        typedef char compiled_header_size_check[(sizeof(compiled_header) == 64) ? 1 : -1];
+        typedef char gesture_record_size_check[(sizeof(compiled_templates::gesture_record) == 20) ? 1 : -1];
+        typedef char unistroke_record_size_check[(sizeof(compiled_templates::unistroke_record) == 16) ? 1 : -1];
+
+        //size of the file for given counts, 64 bit so the damaged counts can not overflow
+        static uint64_t compiled_size(uint64_t gestures, uint64_t unistrokes, uint64_t number_of_points, uint64_t names_size) {
+            return sizeof(compiled_header) + (gestures * sizeof(compiled_templates::gesture_record))
+                    + (unistrokes * sizeof(compiled_templates::unistroke_record))
+                    + (unistrokes * number_of_points * 2 * sizeof(float)) + names_size;
+        }
+
+        compiled_parameters::compiled_parameters()
+        : source_hash(0), number_of_points(0), scale_box_size(0), start_vector_index(0), scaling_threshold(0.0), origin(0, 0) {
+            ;
+        }
+
+        compiled_parameters::compiled_parameters(uint64_t hash, uint16_t num_of_pts, const point_2d & orig,
+                uint16_t scale_box, float scale_thresh, uint16_t start_index)
+        : source_hash(hash), number_of_points(num_of_pts), scale_box_size(scale_box), start_vector_index(start_index),
+        scaling_threshold(scale_thresh), origin(orig) {
+            ;
+        }
+
+        bool compiled_parameters::operator==(const compiled_parameters & second) const {
+            return (source_hash == second.source_hash) && (number_of_points == second.number_of_points)
+                    && (scale_box_size == second.scale_box_size) && (start_vector_index == second.start_vector_index)
+                    && (scaling_threshold == second.scaling_threshold)
+                    && (origin.get_x() == second.origin.get_x()) && (origin.get_y() == second.origin.get_y());
+        }
+
+        compiled_templates::compiled_templates()
+        : data(NULL), data_size(0), gestures(NULL), unistrokes(NULL), points(NULL), names(NULL), gesture_count(0), unistroke_count(0) {
+            ;
+        }
+
+        compiled_templates::~compiled_templates() {
+            unload();
+        }
+
+        bool compiled_templates::load(const std::string & file_path) {
+            unload();
+
+            //the recognizer copies the templates to its own structures, plain read is enough
+            std::ifstream in_file(file_path.c_str(), std::ios::binary);
+            if (!in_file.is_open()) {
+                return false;
+            }
+
+            in_file.seekg(0, std::ios::end);
+            std::streamoff file_size = in_file.tellg();
+            in_file.seekg(0, std::ios::beg);
+            if ((file_size < (std::streamoff) sizeof(compiled_header)) || in_file.fail()) {
+                return false;
+            }
+
+            //new char[] is aligned for any record type
+            char * buffer = new char[file_size];
+            data = buffer;
+            data_size = file_size;
+            if (!in_file.read(buffer, file_size)) {
+                unload();
+                return false;
+            }
+
+            //check everything before any record is touched
+            const compiled_header * header = reinterpret_cast<const compiled_header *> (data);
+            if ((memcmp(header->magic, COMPILED_MAGIC, sizeof(COMPILED_MAGIC)) != 0) || (header->version != FORMAT_VERSION)
+                    || (header->byte_order != COMPILED_BYTE_ORDER) || (header->file_size != data_size) || (header->number_of_points == 0)
+                    || (compiled_size(header->gesture_count, header->unistroke_count, header->number_of_points, header->names_size) != data_size)) {
+                unload();
+                return false;
+            }
+
+            gesture_count = header->gesture_count;
+            unistroke_count = header->unistroke_count;
+            gestures = reinterpret_cast<const gesture_record *> (data + sizeof(compiled_header));
+            unistrokes = reinterpret_cast<const unistroke_record *> (gestures + gesture_count);
+            points = reinterpret_cast<const float *> (unistrokes + unistroke_count);
+            names = reinterpret_cast<const char *> (points + ((size_t) unistroke_count * header->number_of_points * 2));
+
+            for (uint32_t i = 0; i < gesture_count; i++) {
+                const gesture_record & gesture = gestures[i];
+                if (((uint64_t) gesture.name_offset + gesture.name_length > header->names_size)
+                        || ((uint64_t) gesture.first_unistroke + gesture.unistroke_count > unistroke_count)) {
+                    unload();
+                    return false;
+                }
+            }
+
+            parameters = compiled_parameters(header->source_hash, header->number_of_points, point_2d(header->origin_x, header->origin_y),
+                    header->scale_box_size, header->scaling_threshold, header->start_vector_index);
+            return true;
+        }
+
+        void compiled_templates::unload() {
+            delete [] data;
+            data = NULL;
+            data_size = 0;
+            parameters = compiled_parameters();
+            gestures = NULL;
+            unistrokes = NULL;
+            points = NULL;
+            names = NULL;
+            gesture_count = 0;
+            unistroke_count = 0;
+        }
+
+        uint32_t compiled_templates::get_gesture_count() const {
+            return gesture_count;
+        }
+
+        const compiled_templates::gesture_record & compiled_templates::get_gesture(uint32_t index) const {
+            return gestures[index];
+        }
+
+        std::string compiled_templates::get_name(uint32_t index) const {
+            return std::string(names + gestures[index].name_offset, gestures[index].name_length);
+        }
+
+        const compiled_templates::unistroke_record & compiled_templates::get_unistroke(uint32_t index) const {
+            return unistrokes[index];
+        }
+
+        const float * compiled_templates::get_xs(uint32_t index) const {
+            return points + ((size_t) index * parameters.number_of_points * 2);
+        }
+
+        const float * compiled_templates::get_ys(uint32_t index) const {
+            return get_xs(index) + parameters.number_of_points;
+        }
+
+        bool compiled_templates::save(const std::string & file_path, const compiled_parameters & params,
+                const vector<multistroke_gesture> & templates, const vector<vector<soa_stroke> > & kernel_templates) {
+
+            if ((params.number_of_points == 0) || (templates.size() != kernel_templates.size())) {
+                return false;
+            }
+
+            //records are prepared first, so nothing is written for templates that can not be stored
+            vector<gesture_record> gesture_records;
+            vector<unistroke_record> unistroke_records;
+            std::string names_block;
+            gesture_records.reserve(templates.size());
+
+            for (unsigned int i = 0; i < templates.size(); i++) {
+                const multistroke_gesture & gesture = templates[i];
+                if (gesture.unistrokes.size() != kernel_templates[i].size()) {
+                    return false;
+                }
+
+                gesture_record record;
+                memset(&record, 0, sizeof(record));
+                record.name_offset = names_block.size();
+                record.name_length = gesture.name.size();
+                record.first_unistroke = unistroke_records.size();
+                record.unistroke_count = gesture.unistrokes.size();
+                record.number_of_strokes = gesture.number_of_strokes;
+                record.sensitive = gesture.sensitive ? 1 : 0;
+                gesture_records.push_back(record);
+                names_block += gesture.name;
+
+                for (unsigned int u = 0; u < gesture.unistrokes.size(); u++) {
+                    //short unistrokes are padded by their last point when written, longer can not be laid out flat
+                    if ((kernel_templates[i][u].size() == 0) || (kernel_templates[i][u].size() > params.number_of_points)) {
+                        return false;
+                    }
+
+                    unistroke_record unistroke;
+                    unistroke.start_x = gesture.unistrokes[u].first.get_x();
+                    unistroke.start_y = gesture.unistrokes[u].first.get_y();
+                    unistroke.center_x = kernel_templates[i][u].center_x;
+                    unistroke.center_y = kernel_templates[i][u].center_y;
+                    unistroke_records.push_back(unistroke);
+                }
+            }
+
+            compiled_header header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, COMPILED_MAGIC, sizeof(COMPILED_MAGIC));
+            header.version = FORMAT_VERSION;
+            header.byte_order = COMPILED_BYTE_ORDER;
+            header.source_hash = params.source_hash;
+            header.number_of_points = params.number_of_points;
+            header.scale_box_size = params.scale_box_size;
+            header.start_vector_index = params.start_vector_index;
+            header.scaling_threshold = params.scaling_threshold;
+            header.origin_x = params.origin.get_x();
+            header.origin_y = params.origin.get_y();
+            header.gesture_count = gesture_records.size();
+            header.unistroke_count = unistroke_records.size();
+            header.names_size = names_block.size();
+            header.file_size = compiled_size(header.gesture_count, header.unistroke_count, header.number_of_points, header.names_size);
+
+            std::stringstream tmp_path;
+            tmp_path << file_path << ".tmp." << getpid();
+
+            std::ofstream out_file(tmp_path.str().c_str(), std::ios::binary | std::ios::trunc);
+            if (!out_file.is_open()) {
+                return false;
+            }
+
+            out_file.write(reinterpret_cast<const char *> (&header), sizeof(header));
+            if (!gesture_records.empty()) {
+                out_file.write(reinterpret_cast<const char *> (&gesture_records[0]), gesture_records.size() * sizeof(gesture_record));
+            }
+            if (!unistroke_records.empty()) {
+                out_file.write(reinterpret_cast<const char *> (&unistroke_records[0]), unistroke_records.size() * sizeof(unistroke_record));
+            }
+            for (vector<vector<soa_stroke> >::const_iterator tmpls_iter = kernel_templates.begin(); tmpls_iter != kernel_templates.end(); tmpls_iter++) {
+                for (vector<soa_stroke>::const_iterator uni_iter = tmpls_iter->begin(); uni_iter != tmpls_iter->end(); uni_iter++) {
+                    vector<float> xs(uni_iter->xs);
+                    vector<float> ys(uni_iter->ys);
+                    xs.resize(params.number_of_points, xs.back());
+                    ys.resize(params.number_of_points, ys.back());
+                    out_file.write(reinterpret_cast<const char *> (&xs[0]), xs.size() * sizeof(float));
+                    out_file.write(reinterpret_cast<const char *> (&ys[0]), ys.size() * sizeof(float));
+                }
+            }
+            out_file.write(names_block.data(), names_block.size());
+            out_file.close();
+
+            if (out_file.fail() || (rename(tmp_path.str().c_str(), file_path.c_str()) != 0)) {
+                unlink(tmp_path.str().c_str());
+                return false;
+            }
+            return true;
+        }
+
+        uint64_t compiled_templates::hash(const void * bytes, size_t length, uint64_t hash) {
+            const unsigned char * current = static_cast<const unsigned char *> (bytes);
+            for (size_t i = 0; i < length; i++) {
+                hash ^= current[i];
+                hash *= HASH_PRIME;
+            }
+            return hash;
+        }
+
+    } // ns iotools
+} // ns libreco
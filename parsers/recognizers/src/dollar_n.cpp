@@ -11,6 +11,7 @@
 
 #include <math.h>
 #include <float.h>
+#include <algorithm>
 
 #ifdef TEST_PERFORMANCE
     #include <muse/recognizers/io_utils.hpp>
@@ -24,25 +25,148 @@ namespace libreco {
         using libreco::rutils::multistroke_gesture;
         using libreco::rauxiliary::degrees_to_radians;
 
+        //! \brief number of points the cascade orders candidates by
+        static const unsigned int CASCADE_POINTS = 16;
+        //! \brief lower bounds are lowered by this ratio, so the rounding can not prune candidate which is as good as the best one
+        static const float CASCADE_BOUND_MARGIN = 0.999;
+
+        //! \brief Computes distances of the unknown gesture to the chunk of unistroke permutations
+        class dollar_n_matching_task: public libreco::rutils::matching_task {
+        public:
+            dollar_n_matching_task(const dollar_n & reco, const vector<size_t> * selected, const dollar_n::prepared_gesture & unknown,
+                    size_t tmpls_count, vector<float> & out_distances, vector<size_t> & out_searches)
+            : recognizer(reco), selection(selected), gesture(unknown), templates_count(tmpls_count), chunk_distances(out_distances),
+              chunk_searches(out_searches) { ; }
+
+            //each chunk has its own row of least distances, so the chunks never write the same one
+            void match(size_t chunk, size_t begin, size_t end) {
+                if (begin == end) {
+                    return;
+                }
+                chunk_searches[chunk] = recognizer.compare_unistrokes(begin, end, selection, gesture, &chunk_distances[chunk * templates_count]);
+            }
+
+        private:
+            const dollar_n & recognizer;
+            //! \brief matched unistrokes, all of them if NULL
+            const vector<size_t> * selection;
+            const dollar_n::prepared_gesture & gesture;
+            size_t templates_count;
+            vector<float> & chunk_distances;
+            vector<size_t> & chunk_searches;
+        };
+
+        //! \brief Runs one stage of the cascade for the chunk of templates
+        class dollar_n_cascade_task: public libreco::rutils::matching_task {
+        public:
+            dollar_n_cascade_task(const dollar_n & reco, const dollar_n::prepared_gesture & unknown, dollar_n::cascade_state & cascade_state,
+                    bool refine_stage, vector<size_t> & out_searches)
+            : recognizer(reco), gesture(unknown), state(cascade_state), refine(refine_stage), chunk_searches(out_searches) { ; }
+
+            void match(size_t chunk, size_t begin, size_t end) {
+                if (refine) {
+                    chunk_searches[chunk] = recognizer.refine_cascade(begin, end, gesture, state);
+                } else {
+                    chunk_searches[chunk] = recognizer.seed_cascade(begin, end, gesture, state);
+                }
+            }
+
+        private:
+            const dollar_n & recognizer;
+            const dollar_n::prepared_gesture & gesture;
+            dollar_n::cascade_state & state;
+            bool refine;
+            vector<size_t> & chunk_searches;
+        };
+
+        //! \brief Lets the template index find only the permutations passing the stroke number and start vector tests
+        class dollar_n_index_filter: public libreco::rutils::index_filter {
+        public:
+            dollar_n_index_filter(const dollar_n & reco, const dollar_n::prepared_gesture & unknown)
+            : recognizer(reco), gesture(unknown) { ; }
+
+            bool accepts(size_t id) const {
+                const vector<size_t> & offsets = recognizer.dollar_n_unistroke_offsets;
+                size_t t = std::upper_bound(offsets.begin(), offsets.end(), id) - offsets.begin() - 1;
+                return recognizer.is_candidate(gesture, t, id - offsets[t]);
+            }
+
+        private:
+            const dollar_n & recognizer;
+            const dollar_n::prepared_gesture & gesture;
+        };
+
         dollar_n::dollar_n(const libreco_generic_multistroke_map & tmpls, uint16_t num_of_pts, const point_2d orig, float rot_down,
                 float rot_up, float rot_thresh, uint16_t scale_box, float scale_thresh, uint16_t start_index, float start_thresh, bool eq_strokes)
         : number_of_points(num_of_pts), origin(orig), rotation_down_limit(degrees_to_radians(rot_down)),
         rotation_up_limit(degrees_to_radians(rot_up)), rotation_threshold(degrees_to_radians(rot_thresh)),
         scale_box_size(scale_box), scaling_threshold(scale_thresh), start_vector_index(start_index),
-        start_vector_threshold(degrees_to_radians(start_thresh)), equal_strokes_numbers(eq_strokes) {
+        start_vector_threshold(degrees_to_radians(start_thresh)), equal_strokes_numbers(eq_strokes), cascade(false), shortlist_size(0) {
 
             //prevent reallocation
             dollar_n_templates.reserve(tmpls.size());
+            dollar_n_kernel_templates.reserve(tmpls.size());
             generate_unistroke_permutations(tmpls);
+            index_unistrokes();
         }
 
         dollar_n::dollar_n(const libreco_generic_multistroke_map & tmpls)
         : number_of_points(96), origin(point_2d(0, 0)), rotation_down_limit(degrees_to_radians(-45.0)), rotation_up_limit(degrees_to_radians(45.0)),
         rotation_threshold(degrees_to_radians(2.0)), scale_box_size(250), scaling_threshold(0.3), start_vector_index(12),
-        start_vector_threshold(degrees_to_radians(30.0)), equal_strokes_numbers(true) {
+        start_vector_threshold(degrees_to_radians(30.0)), equal_strokes_numbers(true), cascade(false), shortlist_size(0) {
             //prevent reallocation
             dollar_n_templates.reserve(tmpls.size());
+            dollar_n_kernel_templates.reserve(tmpls.size());
             generate_unistroke_permutations(tmpls);
+            index_unistrokes();
+        }
+
+        dollar_n::dollar_n(const libreco::iotools::compiled_templates & compiled, float rot_down, float rot_up, float rot_thresh,
+                float start_thresh, bool eq_strokes)
+        : number_of_points(compiled.get_parameters().number_of_points), origin(compiled.get_parameters().origin),
+        rotation_down_limit(degrees_to_radians(rot_down)), rotation_up_limit(degrees_to_radians(rot_up)),
+        rotation_threshold(degrees_to_radians(rot_thresh)), scale_box_size(compiled.get_parameters().scale_box_size),
+        scaling_threshold(compiled.get_parameters().scaling_threshold), start_vector_index(compiled.get_parameters().start_vector_index),
+        start_vector_threshold(degrees_to_radians(start_thresh)), equal_strokes_numbers(eq_strokes), cascade(false), shortlist_size(0) {
+
+            //prevent reallocation
+            dollar_n_templates.reserve(compiled.get_gesture_count());
+            dollar_n_kernel_templates.reserve(compiled.get_gesture_count());
+
+            for (uint32_t g = 0; g < compiled.get_gesture_count(); g++) {
+                const libreco::iotools::compiled_templates::gesture_record & record = compiled.get_gesture(g);
+
+                dollar_n_templates.push_back(multistroke_gesture());
+                multistroke_gesture & multi_pattern = dollar_n_templates.back();
+                multi_pattern.name = compiled.get_name(g);
+                multi_pattern.number_of_strokes = record.number_of_strokes;
+                multi_pattern.sensitive = (record.sensitive != 0);
+                multi_pattern.unistrokes.reserve(record.unistroke_count);
+
+                dollar_n_kernel_templates.push_back(vector<libreco::rauxiliary::soa_stroke>());
+                vector<libreco::rauxiliary::soa_stroke> & kernel_unistrokes = dollar_n_kernel_templates.back();
+                kernel_unistrokes.reserve(record.unistroke_count);
+
+                for (uint32_t u = record.first_unistroke; u < (record.first_unistroke + record.unistroke_count); u++) {
+                    const libreco::iotools::compiled_templates::unistroke_record & unistroke = compiled.get_unistroke(u);
+                    const float * xs = compiled.get_xs(u);
+                    const float * ys = compiled.get_ys(u);
+
+                    vector<point_2d> points;
+                    points.reserve(number_of_points);
+                    for (uint16_t i = 0; i < number_of_points; i++) {
+                        points.push_back(point_2d(xs[i], ys[i]));
+                    }
+                    multi_pattern.unistrokes.push_back(std::pair<point_2d, vector<point_2d> >(point_2d(unistroke.start_x, unistroke.start_y), points));
+                    kernel_unistrokes.push_back(libreco::rauxiliary::soa_stroke(xs, ys, number_of_points, unistroke.center_x, unistroke.center_y));
+                }
+            }
+            index_unistrokes();
+        }
+
+        bool dollar_n::save_compiled(const std::string & file_path, uint64_t source_hash) const {
+            libreco::iotools::compiled_parameters params(source_hash, number_of_points, origin, scale_box_size, scaling_threshold, start_vector_index);
+            return libreco::iotools::compiled_templates::save(file_path, params, dollar_n_templates, dollar_n_kernel_templates);
         }
 
         void dollar_n::generate_unistroke_permutations(const libreco_generic_multistroke_map & tmpls) {
@@ -88,6 +212,15 @@ namespace libreco {
                     strokes_iter->first = start_unit_vector(strokes_iter->second);
 
                 }
+                
+                //unistrokes are laid out once, so recognition does not copy them
+                dollar_n_kernel_templates.push_back(vector<libreco::rauxiliary::soa_stroke>());
+                vector<libreco::rauxiliary::soa_stroke> & kernel_unistrokes = dollar_n_kernel_templates.back();
+                kernel_unistrokes.reserve(multi_pattern.unistrokes.size());
+                for (vector<std::pair<point_2d, vector<point_2d> > >::const_iterator strokes_iter = multi_pattern.unistrokes.begin();
+                        strokes_iter != multi_pattern.unistrokes.end(); strokes_iter++) {
+                    kernel_unistrokes.push_back(libreco::rauxiliary::soa_stroke(strokes_iter->second));
+                }
             }
         }
 
@@ -178,29 +311,38 @@ namespace libreco {
             return std::acos(p1.get_x() * p2.get_x() + p1.get_y() * p2.get_y());
         }
 
-        //compares unknown unistroke gesture to unistroke template
-        float dollar_n::compare_gestures(const vector<multistroke_gesture>::const_iterator & tmpls_iter, const point_2d & start_vector, const vector<point_2d> & unistroke) const {
-            float min_distance = FLT_MAX;
-
-            for (vector<std::pair<point_2d, vector<point_2d> > >::const_iterator uni_iter = tmpls_iter->unistrokes.begin();
-                    uni_iter != tmpls_iter->unistrokes.end(); uni_iter++) {
+        //numbers unistrokes of all templates in one sequence, offsets[t] is the first unistroke of template t
+        void dollar_n::index_unistrokes() {
+            dollar_n_unistroke_offsets.clear();
+            dollar_n_unistroke_offsets.reserve(dollar_n_templates.size() + 1);
+            dollar_n_unistroke_offsets.push_back(0);
+            for (vector<multistroke_gesture>::const_iterator tmpls_iter = dollar_n_templates.begin(); tmpls_iter != dollar_n_templates.end(); tmpls_iter++) {
+                dollar_n_unistroke_offsets.push_back(dollar_n_unistroke_offsets.back() + tmpls_iter->unistrokes.size());
+            }
 
-                if (angle_between_vectors(start_vector, uni_iter->first) <= start_vector_threshold) {
-                    float distance = libreco::rauxiliary::distance_at_best_angle(unistroke, uni_iter->second,
-                            rotation_down_limit, rotation_up_limit, rotation_threshold);
-                    if (distance < min_distance) {
-                        min_distance = distance;
-                    }
+            //cascade resolution and centroid distances of all unistrokes
+            dollar_n_coarse_unistrokes.clear();
+            dollar_n_coarse_unistrokes.reserve(dollar_n_unistroke_offsets.back());
+            dollar_n_unistroke_radii.clear();
+            dollar_n_unistroke_radii.reserve(dollar_n_unistroke_offsets.back() * number_of_points);
+
+            vector<float> radii;
+            for (vector<vector<libreco::rauxiliary::soa_stroke> >::const_iterator tmpls_iter = dollar_n_kernel_templates.begin();
+                    tmpls_iter != dollar_n_kernel_templates.end(); tmpls_iter++) {
+                for (vector<libreco::rauxiliary::soa_stroke>::const_iterator uni_iter = tmpls_iter->begin(); uni_iter != tmpls_iter->end(); uni_iter++) {
+                    dollar_n_coarse_unistrokes.push_back(libreco::rauxiliary::soa_stroke());
+                    libreco::rauxiliary::coarse_stroke(*uni_iter, CASCADE_POINTS, dollar_n_coarse_unistrokes.back());
+
+                    //resampling may end a point short, missing distances are taken as zero
+                    libreco::rauxiliary::centroid_distances(*uni_iter, radii);
+                    radii.resize(number_of_points, 0.0);
+                    dollar_n_unistroke_radii.insert(dollar_n_unistroke_radii.end(), radii.begin(), radii.end());
                 }
             }
-            return min_distance;
         }
 
-        libreco::recognizers::recognized_gestures dollar_n::recognize(const vector<vector<point_2d> > & unknown_gesture) const {
-#ifdef TEST_PERFORMANCE
-            libkerat::timetag_t recognize_start;
-            lo_timetag_now(&recognize_start);
-#endif
+        //preprocesses unknown gesture in both orientation sensitive and invariant variant
+        void dollar_n::prepare_gesture(const vector<vector<point_2d> > & unknown_gesture, bool with_coarse, prepared_gesture & prepared) const {
             //combine all strokes of mulitstroke gesture to one unistroke
             vector<point_2d> inv_unistroke;
             combine_strokes(unknown_gesture, inv_unistroke);
@@ -223,30 +365,268 @@ namespace libreco {
             libreco::rauxiliary::rotate_by_angle(sens_unistroke, angle);
 
             //compute start unit vector for both gesture variants (sensitive and invariant)
-            point_2d inv_start_vect = start_unit_vector(inv_unistroke);
-            point_2d sens_start_vect = start_unit_vector(sens_unistroke);
+            prepared.number_of_strokes = unknown_gesture.size();
+            prepared.inv_start_vector = start_unit_vector(inv_unistroke);
+            prepared.sens_start_vector = start_unit_vector(sens_unistroke);
+
+            prepared.inv_unistroke.assign(inv_unistroke);
+            prepared.sens_unistroke.assign(sens_unistroke);
+
+            //cascade and template index work on these
+            if (with_coarse) {
+                libreco::rauxiliary::coarse_stroke(prepared.inv_unistroke, CASCADE_POINTS, prepared.inv_coarse);
+                libreco::rauxiliary::coarse_stroke(prepared.sens_unistroke, CASCADE_POINTS, prepared.sens_coarse);
+                libreco::rauxiliary::centroid_distances(prepared.inv_unistroke, prepared.inv_radii);
+                libreco::rauxiliary::centroid_distances(prepared.sens_unistroke, prepared.sens_radii);
+                prepared.inv_radii.resize(number_of_points, 0.0);
+                prepared.sens_radii.resize(number_of_points, 0.0);
+            }
+        }
+
+        //stroke number and start vector tests of the exhaustive matching
+        bool dollar_n::is_candidate(const prepared_gesture & gesture, size_t tmpl, size_t unistroke) const {
+            const multistroke_gesture & pattern = dollar_n_templates[tmpl];
+            //optional feature which compares only templates with the same number of strokes
+            if (equal_strokes_numbers && (gesture.number_of_strokes != pattern.number_of_strokes)) {
+                return false;
+            }
+            const point_2d & start_vector = pattern.sensitive ? gesture.sens_start_vector : gesture.inv_start_vector;
+            return angle_between_vectors(start_vector, pattern.unistrokes[unistroke].first) <= start_vector_threshold;
+        }
+
+        //compares unknown unistroke gesture to the range of unistroke templates
+        size_t dollar_n::compare_unistrokes(size_t begin, size_t end, const vector<size_t> * selection, const prepared_gesture & gesture,
+                float * best_distances) const {
+            size_t searches = 0;
+            if (begin == end) {
+                return searches;
+            }
+
+            //template the range starts in
+            size_t first = (selection != NULL) ? (*selection)[begin] : begin;
+            size_t t = std::upper_bound(dollar_n_unistroke_offsets.begin(), dollar_n_unistroke_offsets.end(), first)
+                    - dollar_n_unistroke_offsets.begin() - 1;
+
+            for (size_t j = begin; j < end; j++) {
+                size_t i = (selection != NULL) ? (*selection)[j] : j;
+                //skip templates without (selected) unistrokes
+                while (dollar_n_unistroke_offsets[t + 1] <= i) {
+                    t++;
+                }
+
+                size_t u = i - dollar_n_unistroke_offsets[t];
+                if (is_candidate(gesture, t, u)) {
+                    const multistroke_gesture & tmpl = dollar_n_templates[t];
+                    float distance = libreco::rauxiliary::distance_at_best_angle(tmpl.sensitive ? gesture.sens_unistroke : gesture.inv_unistroke,
+                            dollar_n_kernel_templates[t][u], rotation_down_limit, rotation_up_limit, rotation_threshold);
+                    searches++;
+                    if (distance < best_distances[t]) {
+                        best_distances[t] = distance;
+                    }
+                }
+            }
+            return searches;
+        }
+
+        //orders candidates of each template by their coarse distance and searches the first of them
+        size_t dollar_n::seed_cascade(size_t begin, size_t end, const prepared_gesture & gesture, cascade_state & state) const {
+            size_t searches = 0;
+            vector<std::pair<float, size_t> > ordered;
+
+            for (size_t t = begin; t < end; t++) {
+                const multistroke_gesture & tmpl = dollar_n_templates[t];
+                const libreco::rauxiliary::soa_stroke & unistroke = tmpl.sensitive ? gesture.sens_unistroke : gesture.inv_unistroke;
+                const libreco::rauxiliary::soa_stroke & coarse = tmpl.sensitive ? gesture.sens_coarse : gesture.inv_coarse;
+                const vector<float> & radii = tmpl.sensitive ? gesture.sens_radii : gesture.inv_radii;
+
+                ordered.clear();
+                for (size_t u = 0; u < tmpl.unistrokes.size(); u++) {
+                    if (!is_candidate(gesture, t, u)) {
+                        continue;
+                    }
+                    size_t i = dollar_n_unistroke_offsets[t] + u;
+                    state.bounds[i] = CASCADE_BOUND_MARGIN * libreco::rauxiliary::rotation_lower_bound(unistroke, &radii[0],
+                            dollar_n_kernel_templates[t][u], &dollar_n_unistroke_radii[i * number_of_points]);
+                    //unistrokes are already rotated by their indicative angle, so no rotation is searched
+                    ordered.push_back(std::pair<float, size_t>(libreco::rauxiliary::distance_at_angle(coarse, dollar_n_coarse_unistrokes[i], 0.0), i));
+                }
+
+                //equal coarse distances are ordered by index, so the order does not depend on the sort
+                std::sort(ordered.begin(), ordered.end());
+                state.candidate_counts[t] = ordered.size();
+                for (size_t c = 0; c < ordered.size(); c++) {
+                    state.candidates[dollar_n_unistroke_offsets[t] + c] = ordered[c].second;
+                }
 
+                if (!ordered.empty()) {
+                    size_t u = ordered.front().second - dollar_n_unistroke_offsets[t];
+                    state.best_distances[t] = libreco::rauxiliary::distance_at_best_angle(unistroke, dollar_n_kernel_templates[t][u],
+                            rotation_down_limit, rotation_up_limit, rotation_threshold);
+                    searches++;
+                }
+            }
+            return searches;
+        }
+
+        //searches the other candidates which may still beat the best one
+        size_t dollar_n::refine_cascade(size_t begin, size_t end, const prepared_gesture & gesture, cascade_state & state) const {
+            size_t searches = 0;
+
+            for (size_t t = begin; t < end; t++) {
+                const multistroke_gesture & tmpl = dollar_n_templates[t];
+                const libreco::rauxiliary::soa_stroke & unistroke = tmpl.sensitive ? gesture.sens_unistroke : gesture.inv_unistroke;
+
+                for (size_t c = 1; c < state.candidate_counts[t]; c++) {
+                    size_t i = state.candidates[dollar_n_unistroke_offsets[t] + c];
+                    //global best is fixed for this stage, so the result does not depend on the order of templates
+                    if (state.bounds[i] >= std::min(state.best_distances[t], state.global_best)) {
+                        continue;
+                    }
+
+                    float distance = libreco::rauxiliary::distance_at_best_angle(unistroke, dollar_n_kernel_templates[t][i - dollar_n_unistroke_offsets[t]],
+                            rotation_down_limit, rotation_up_limit, rotation_threshold);
+                    searches++;
+                    if (distance < state.best_distances[t]) {
+                        state.best_distances[t] = distance;
+                    }
+                }
+            }
+            return searches;
+        }
+
+        size_t dollar_n::match_exhaustive(const prepared_gesture & gesture, const vector<size_t> * selection, vector<float> & best_distances) const {
+            //unistrokes of all templates are matched in chunks, each chunk keeps least distance for each template
+            size_t templates_count = dollar_n_templates.size();
+            size_t matched = (selection != NULL) ? selection->size() : dollar_n_unistroke_offsets.back();
+            size_t chunks = matching_threads.get_chunk_count(matched);
+            vector<float> chunk_distances(chunks * templates_count, FLT_MAX);
+            vector<size_t> chunk_searches(chunks, 0);
+            dollar_n_matching_task task(*this, selection, gesture, templates_count, chunk_distances, chunk_searches);
+            matching_threads.run(task, matched);
+
+            //chunks are merged in the order of templates
+            best_distances.assign(templates_count, FLT_MAX);
+            for (size_t t = 0; t < templates_count; t++) {
+                for (size_t c = 0; c < chunks; c++) {
+                    best_distances[t] = std::min(best_distances[t], chunk_distances[(c * templates_count) + t]);
+                }
+            }
+
+            size_t searches = 0;
+            for (size_t c = 0; c < chunks; c++) {
+                searches += chunk_searches[c];
+            }
+            return searches;
+        }
+
+        size_t dollar_n::match_cascade(const prepared_gesture & gesture, vector<float> & best_distances) const {
+            size_t templates_count = dollar_n_templates.size();
+            cascade_state state;
+            state.bounds.resize(dollar_n_unistroke_offsets.back(), 0.0);
+            state.candidates.resize(dollar_n_unistroke_offsets.back(), 0);
+            state.candidate_counts.resize(templates_count, 0);
+            state.best_distances.resize(templates_count, FLT_MAX);
+            state.global_best = FLT_MAX;
+
+            //templates are split to chunks, each template belongs to one chunk in both stages
+            size_t chunks = matching_threads.get_chunk_count(templates_count);
+            vector<size_t> chunk_searches(chunks, 0);
+            size_t searches = 0;
+
+            dollar_n_cascade_task seed_task(*this, gesture, state, false, chunk_searches);
+            matching_threads.run(seed_task, templates_count);
+            for (size_t c = 0; c < chunks; c++) {
+                searches += chunk_searches[c];
+            }
+
+            for (size_t t = 0; t < templates_count; t++) {
+                state.global_best = std::min(state.global_best, state.best_distances[t]);
+            }
+
+            dollar_n_cascade_task refine_task(*this, gesture, state, true, chunk_searches);
+            matching_threads.run(refine_task, templates_count);
+            for (size_t c = 0; c < chunks; c++) {
+                searches += chunk_searches[c];
+            }
+
+            best_distances.swap(state.best_distances);
+            return searches;
+        }
+
+        //builds indexes over permutations at cascade resolution, the gesture is prepared differently for each of them
+        void dollar_n::set_shortlist_size(size_t size) {
+            shortlist_size = size;
+            invariant_index.clear();
+            sensitive_index.clear();
+            if (shortlist_size == 0) {
+                return;
+            }
+
+            vector<float> invariant_features;
+            vector<float> sensitive_features;
+            vector<size_t> invariant_ids;
+            vector<size_t> sensitive_ids;
+            for (size_t t = 0; t < dollar_n_templates.size(); t++) {
+                vector<float> & features = dollar_n_templates[t].sensitive ? sensitive_features : invariant_features;
+                vector<size_t> & ids = dollar_n_templates[t].sensitive ? sensitive_ids : invariant_ids;
+                for (size_t i = dollar_n_unistroke_offsets[t]; i < dollar_n_unistroke_offsets[t + 1]; i++) {
+                    //empty permutations are left out of the indexes
+                    if (libreco::rutils::append_features(dollar_n_coarse_unistrokes[i], CASCADE_POINTS, features)) {
+                        ids.push_back(i);
+                    }
+                }
+            }
+            invariant_index.build(invariant_features, invariant_ids, CASCADE_POINTS * 2);
+            sensitive_index.build(sensitive_features, sensitive_ids, CASCADE_POINTS * 2);
+        }
+
+        libreco::recognizers::recognized_gestures dollar_n::make_scores(const vector<float> & best_distances) const {
             libreco::recognizers::recognized_gestures scores;
             float score = 0.0;
             float half_diagonal = 0.5 * sqrt((scale_box_size * scale_box_size) + (scale_box_size * scale_box_size));
 
-            for (vector<libreco::rutils::multistroke_gesture>::const_iterator tmpls_iter = dollar_n_templates.begin();
-                    tmpls_iter != dollar_n_templates.end(); tmpls_iter++) {
+            //scores are inserted in the order of templates
+            for (size_t t = 0; t < best_distances.size(); t++) {
+                if (best_distances[t] != FLT_MAX) {
+                    score = 1.0 - (best_distances[t] / half_diagonal);
+                    scores.insert(std::pair<float, std::string > (score, dollar_n_templates[t].name));
+                }
+            }
+            return scores;
+        }
 
-                float min_distance = FLT_MAX;
-                //optional feature which compares only templates with the same number of strokes
-                if (!equal_strokes_numbers || (unknown_gesture.size() == tmpls_iter->number_of_strokes)) {
-                    if (tmpls_iter->sensitive) {
-                        min_distance = compare_gestures(tmpls_iter, sens_start_vect, sens_unistroke);
-                    } else {
-                        min_distance = compare_gestures(tmpls_iter, inv_start_vect, inv_unistroke);
-                    }
+        libreco::recognizers::recognized_gestures dollar_n::recognize(const vector<vector<point_2d> > & unknown_gesture) const {
+#ifdef TEST_PERFORMANCE
+            libkerat::timetag_t recognize_start;
+            lo_timetag_now(&recognize_start);
+#endif
+            prepared_gesture gesture;
+            prepare_gesture(unknown_gesture, cascade || (shortlist_size != 0), gesture);
+
+            vector<float> best_distances;
+            if (shortlist_size != 0) {
+                //only permutations nearest to the gesture are matched
+                vector<float> invariant_features;
+                vector<float> sensitive_features;
+                vector<libreco::rutils::index_neighbour> neighbours;
+                vector<size_t> selection;
+                //the permutations failing the tests are passed over while searching, so they do not take the shortlist
+                dollar_n_index_filter filter(*this, gesture);
+                if (libreco::rutils::append_features(gesture.inv_coarse, CASCADE_POINTS, invariant_features)) {
+                    invariant_index.nearest(&invariant_features[0], shortlist_size, neighbours, &filter);
                 }
-                if (min_distance != FLT_MAX) {
-                    score = 1.0 - (min_distance / half_diagonal);
-                    scores.insert(std::pair<float, std::string > (score, tmpls_iter->name));
+                if (libreco::rutils::append_features(gesture.sens_coarse, CASCADE_POINTS, sensitive_features)) {
+                    sensitive_index.nearest(&sensitive_features[0], shortlist_size, neighbours, &filter);
                 }
+                libreco::rutils::shortlist(neighbours, shortlist_size, selection);
+                //all permutations are matched if none was shortlisted
+                match_exhaustive(gesture, selection.empty() ? NULL : &selection, best_distances);
+            } else if (cascade) {
+                match_cascade(gesture, best_distances);
+            } else {
+                match_exhaustive(gesture, NULL, best_distances);
             }
+            libreco::recognizers::recognized_gestures scores = make_scores(best_distances);
 
 #ifdef TEST_PERFORMANCE
             libkerat::timetag_t recognize_end;
@@ -257,6 +637,33 @@ namespace libreco {
             return scores;
         }
 
+        libreco::recognizers::recognized_gestures dollar_n::recognize(const vector<vector<point_2d> > & unknown_gesture, cascade_report & report) const {
+            prepared_gesture gesture;
+            prepare_gesture(unknown_gesture, true, gesture);
+
+            vector<float> exhaustive_distances;
+            vector<float> cascade_distances;
+            report = cascade_report();
+            report.candidates = match_exhaustive(gesture, NULL, exhaustive_distances);
+            report.full_searches = match_cascade(gesture, cascade_distances);
+
+            libreco::recognizers::recognized_gestures exhaustive_scores = make_scores(exhaustive_distances);
+            libreco::recognizers::recognized_gestures scores = make_scores(cascade_distances);
+
+            //both rank the same templates, as the candidates are the same
+            report.ranks = exhaustive_scores.size();
+            libreco::recognizers::recognized_gestures::const_iterator exhaustive_iter = exhaustive_scores.begin();
+            libreco::recognizers::recognized_gestures::const_iterator cascade_iter = scores.begin();
+            for (; (exhaustive_iter != exhaustive_scores.end()) && (cascade_iter != scores.end()); exhaustive_iter++, cascade_iter++) {
+                if (exhaustive_iter->second == cascade_iter->second) {
+                    report.agreeing_ranks++;
+                }
+            }
+            report.same_best = !scores.empty() && !exhaustive_scores.empty() && (*scores.begin() == *exhaustive_scores.begin());
+
+            return scores;
+        }
+
     } // ns recognizers
 
     namespace rutils {
@@ -25,6 +25,33 @@ namespace libreco {
         using libreco::rutils::unistroke_gesture;
         using libreco::rauxiliary::degrees_to_radians;
         using libkerat::helpers::point_2d;
+        
+        //! \brief Computes distances of the unknown gesture to the chunk of templates
+        class dollar_matching_task: public libreco::rutils::matching_task {
+        public:
+            dollar_matching_task(const vector<libreco::rauxiliary::soa_stroke> & tmpls, const vector<size_t> * selected,
+                    const libreco::rauxiliary::soa_stroke & gesture, float down_lim, float top_lim, float thres, vector<float> & out_distances)
+            : templates(tmpls), selection(selected), points(gesture), rotation_down_limit(down_lim), rotation_up_limit(top_lim),
+              rotation_threshold(thres), distances(out_distances) { ; }
+            
+            //each matched template has its own slot, so the chunks never write the same one
+            void match(size_t chunk __attribute__((unused)), size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const libreco::rauxiliary::soa_stroke & pattern = templates[(selection != NULL) ? (*selection)[i] : i];
+                    distances[i] = libreco::rauxiliary::distance_at_best_angle(points, pattern, rotation_down_limit, rotation_up_limit, rotation_threshold);
+                }
+            }
+            
+        private:
+            const vector<libreco::rauxiliary::soa_stroke> & templates;
+            //! \brief matched templates, all of them if NULL
+            const vector<size_t> * selection;
+            const libreco::rauxiliary::soa_stroke & points;
+            float rotation_down_limit;
+            float rotation_up_limit;
+            float rotation_threshold;
+            vector<float> & distances;
+        };
                 
         //runs all methods needed for correct gesture preprocessing
         void dollar_recognizer::process_gesture(vector<point_2d> & gest) const {
@@ -54,6 +81,12 @@ namespace libreco {
             //reverse templates are added to dollar one templates
             dollar_templates.reserve(dollar_templates.size() + revert_gestures.size());
             dollar_templates.insert(dollar_templates.end(), revert_gestures.begin(), revert_gestures.end());
+            
+            //templates are laid out once, so recognition does not copy them
+            dollar_kernel_templates.reserve(dollar_templates.size());
+            for (vector<unistroke_gesture>::const_iterator iter = dollar_templates.begin(); iter != dollar_templates.end(); iter++) {
+                dollar_kernel_templates.push_back(libreco::rauxiliary::soa_stroke(iter->points));
+            }
         }
         
         
@@ -61,7 +94,7 @@ namespace libreco {
         dollar_recognizer::dollar_recognizer(const std::vector<libreco::rutils::unistroke_gesture> & tmpls, uint16_t num_of_pts,
                                              const libkerat::helpers::point_2d & orig, float rot_down, float rot_up, float rot_thresh, uint16_t scale_box)
         : number_of_points(num_of_pts), origin(orig), rotation_down_limit(degrees_to_radians(rot_down)),
-          rotation_up_limit(degrees_to_radians(rot_up)), rotation_threshold(degrees_to_radians(rot_thresh)), scale_box_size(scale_box) {
+          rotation_up_limit(degrees_to_radians(rot_up)), rotation_threshold(degrees_to_radians(rot_thresh)), scale_box_size(scale_box), shortlist_size(0) {
 
             dollar_templates.reserve(tmpls.size());
             dollar_templates = tmpls;
@@ -71,13 +104,33 @@ namespace libreco {
         //create dollar one instance with default parameters
         dollar_recognizer::dollar_recognizer(const std::vector<libreco::rutils::unistroke_gesture> & tmpls)
         : number_of_points(64), origin(point_2d(0, 0)), rotation_down_limit(degrees_to_radians(-45.0)),
-          rotation_up_limit(degrees_to_radians(45.0)), rotation_threshold(degrees_to_radians(2.0)),  scale_box_size(250) {
+          rotation_up_limit(degrees_to_radians(45.0)), rotation_threshold(degrees_to_radians(2.0)),  scale_box_size(250), shortlist_size(0) {
 
             dollar_templates.reserve(tmpls.size());
             dollar_templates = tmpls;
             process_templates();
         }
         
+        //builds the index over processed templates
+        void dollar_recognizer::set_shortlist_size(size_t size) {
+            shortlist_size = size;
+            template_index.clear();
+            if (shortlist_size == 0) {
+                return;
+            }
+            
+            vector<float> features;
+            vector<size_t> ids;
+            features.reserve(dollar_kernel_templates.size() * number_of_points * 2);
+            for (size_t i = 0; i < dollar_kernel_templates.size(); i++) {
+                //empty templates are left out of the index
+                if (libreco::rutils::append_features(dollar_kernel_templates[i], number_of_points, features)) {
+                    ids.push_back(i);
+                }
+            }
+            template_index.build(features, ids, number_of_points * 2);
+        }
+        
         //scales gesture to bounding box with side specified as constructor parameter
         void dollar_recognizer::scale_to_bounding_box(vector<point_2d> & points) const {
             libreco::rutils::rectangle min_bounding_box = libreco::rauxiliary::bounding_box(points);
@@ -114,14 +167,34 @@ namespace libreco {
             scale_to_bounding_box(gesture_points);
             libreco::rauxiliary::translate_to(gesture_points, origin);
             
+            const libreco::rauxiliary::soa_stroke kernel_points(gesture_points);
+            
             float half_diagonal = 0.5 * sqrt((scale_box_size * scale_box_size) + (scale_box_size * scale_box_size));
             libreco::recognizers::recognized_gestures scores;
             float score = 0.0;
 
-            for (vector<unistroke_gesture>::const_iterator iter = dollar_templates.begin(); iter != dollar_templates.end(); iter++) {
-                score = libreco::rauxiliary::distance_at_best_angle(gesture_points, iter->points, rotation_down_limit, rotation_up_limit, rotation_threshold);
-                score = 1.0 - (score / half_diagonal);
-                scores.insert(std::pair<float, std::string > (score, iter->name));
+            //only templates nearest to the gesture are matched, if the index is used
+            vector<size_t> selection;
+            if (shortlist_size != 0) {
+                vector<float> features;
+                vector<libreco::rutils::index_neighbour> neighbours;
+                if (libreco::rutils::append_features(kernel_points, number_of_points, features)) {
+                    template_index.nearest(&features[0], shortlist_size, neighbours);
+                }
+                libreco::rutils::shortlist(neighbours, shortlist_size, selection);
+            }
+            //all templates are matched if none was shortlisted
+            const vector<size_t> * selected = !selection.empty() ? &selection : NULL;
+            size_t matched = (selected != NULL) ? selection.size() : dollar_templates.size();
+
+            //templates are matched in chunks, scores are inserted in the order of templates afterwards
+            vector<float> distances(matched);
+            dollar_matching_task task(dollar_kernel_templates, selected, kernel_points, rotation_down_limit, rotation_up_limit, rotation_threshold, distances);
+            matching_threads.run(task, matched);
+
+            for (unsigned int i = 0; i < matched; i++) {
+                score = 1.0 - (distances[i] / half_diagonal);
+                scores.insert(std::pair<float, std::string > (score, dollar_templates[(selected != NULL) ? selection[i] : i].name));
             }
             
 #ifdef TEST_PERFORMANCE
@@ -0,0 +1,175 @@
+/**
+ * \file      matching_pool.cpp
+ * \brief     Implements the worker pool the recognizers split the template matching across
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:30 UTC
+ * \copyright BSD
+ */
+
+#include <muse/recognizers/matching_pool.hpp>
+
+#include <vector>
+#include <algorithm>
+
+namespace libreco {
+    namespace rutils {
+
+        //! \brief state shared by the workers, guarded by the mutex
+        struct matching_pool::pool_state {
+            pthread_mutex_t mutex;
+            //! \brief signalled when new run starts or the workers shall stop
+            pthread_cond_t work_cond;
+            //! \brief signalled when all chunks of the run are matched
+            pthread_cond_t done_cond;
+
+            std::vector<pthread_t> workers;
+            bool shutdown;
+
+            //! \brief current run
+            matching_task * task;
+            size_t items;
+            size_t chunks;
+            size_t next_chunk;
+            size_t done_chunks;
+        };
+
+        //matches chunks of the current run while any is left, mutex must be locked
+        static void match_chunks(matching_task * task, size_t items, size_t chunks, size_t & next_chunk,
+                size_t & done_chunks, pthread_mutex_t & mutex, pthread_cond_t & done_cond) {
+            while (next_chunk < chunks) {
+                size_t chunk = next_chunk++;
+                pthread_mutex_unlock(&mutex);
+
+                //contiguous chunks of nearly equal size, the first ones take the remainder
+                size_t begin = (items / chunks) * chunk + std::min(chunk, items % chunks);
+                size_t end = begin + (items / chunks) + ((chunk < (items % chunks)) ? 1 : 0);
+                task->match(chunk, begin, end);
+
+                pthread_mutex_lock(&mutex);
+                if (++done_chunks == chunks) {
+                    pthread_cond_broadcast(&done_cond);
+                }
+            }
+        }
+
+        matching_pool::matching_pool(unsigned int thread_count)
+        : threads(std::max(thread_count, 1u)), state(NULL) {
+            pthread_mutex_init(&run_mutex, NULL);
+        }
+
+        matching_pool::matching_pool(const matching_pool & second)
+        : threads(second.threads), state(NULL) {
+            pthread_mutex_init(&run_mutex, NULL);
+        }
+
+        matching_pool::~matching_pool() {
+            stop();
+            pthread_mutex_destroy(&run_mutex);
+        }
+
+        matching_pool & matching_pool::operator=(const matching_pool & second) {
+            if (this != &second) {
+                set_thread_count(second.threads);
+            }
+            return *this;
+        }
+
+        void matching_pool::set_thread_count(unsigned int thread_count) {
+            pthread_mutex_lock(&run_mutex);
+            stop();
+            threads = std::max(thread_count, 1u);
+            pthread_mutex_unlock(&run_mutex);
+        }
+
+        size_t matching_pool::get_chunk_count(size_t items) const {
+            return std::max<size_t>(std::min<size_t>(threads, items), 1);
+        }
+
+        void matching_pool::run(matching_task & task, size_t items) const {
+            size_t chunks = get_chunk_count(items);
+            if (chunks == 1) {
+                task.match(0, 0, items);
+                return;
+            }
+
+            pthread_mutex_lock(&run_mutex);
+
+            //workers are started on the first run only, copies of the recognizers never start them
+            if (state == NULL) {
+                state = new pool_state;
+                pthread_mutex_init(&state->mutex, NULL);
+                pthread_cond_init(&state->work_cond, NULL);
+                pthread_cond_init(&state->done_cond, NULL);
+                state->shutdown = false;
+                state->task = NULL;
+                state->items = 0;
+                state->chunks = 0;
+                state->next_chunk = 0;
+                state->done_chunks = 0;
+
+                for (unsigned int i = 1; i < threads; i++) {
+                    pthread_t thread;
+                    if (pthread_create(&thread, NULL, worker, state) == 0) {
+                        state->workers.push_back(thread);
+                    }
+                }
+            }
+
+            pthread_mutex_lock(&state->mutex);
+            state->task = &task;
+            state->items = items;
+            state->chunks = chunks;
+            state->next_chunk = 0;
+            state->done_chunks = 0;
+            pthread_cond_broadcast(&state->work_cond);
+
+            //calling thread matches as well, so the run finishes even if no worker started
+            match_chunks(&task, items, chunks, state->next_chunk, state->done_chunks, state->mutex, state->done_cond);
+            while (state->done_chunks < chunks) {
+                pthread_cond_wait(&state->done_cond, &state->mutex);
+            }
+            state->task = NULL;
+            pthread_mutex_unlock(&state->mutex);
+
+            pthread_mutex_unlock(&run_mutex);
+        }
+
+        void matching_pool::stop() const {
+            if (state == NULL) {
+                return;
+            }
+
+            pthread_mutex_lock(&state->mutex);
+            state->shutdown = true;
+            pthread_cond_broadcast(&state->work_cond);
+            pthread_mutex_unlock(&state->mutex);
+
+            for (std::vector<pthread_t>::iterator iter = state->workers.begin(); iter != state->workers.end(); iter++) {
+                pthread_join(*iter, NULL);
+            }
+
+            pthread_cond_destroy(&state->done_cond);
+            pthread_cond_destroy(&state->work_cond);
+            pthread_mutex_destroy(&state->mutex);
+            delete state;
+            state = NULL;
+        }
+
+        void * matching_pool::worker(void * arg) {
+            pool_state * state = static_cast<pool_state *> (arg);
+
+            pthread_mutex_lock(&state->mutex);
+            while (!state->shutdown) {
+                if ((state->task != NULL) && (state->next_chunk < state->chunks)) {
+                    match_chunks(state->task, state->items, state->chunks, state->next_chunk, state->done_chunks, state->mutex, state->done_cond);
+                } else {
+                    pthread_cond_wait(&state->work_cond, &state->mutex);
+                }
+            }
+            pthread_mutex_unlock(&state->mutex);
+
+            return NULL;
+        }
+
+    } // ns rutils
+} // ns libreco
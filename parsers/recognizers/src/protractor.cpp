@@ -29,6 +29,30 @@ namespace libreco {
         using libkerat::helpers::point_2d;
         using libreco::rutils::unistroke_gesture;
         
+        //! \brief Computes scores of the unknown gesture for the chunk of templates
+        class protractor_matching_task: public libreco::rutils::matching_task {
+        public:
+            protractor_matching_task(const vector<unistroke_gesture> & tmpls, const vector<size_t> * selected, const vector<point_2d> & invariant,
+                    const vector<point_2d> & sensitive, vector<float> & out_distances)
+            : templates(tmpls), selection(selected), o_invar_gest(invariant), o_sens_gest(sensitive), distances(out_distances) { ; }
+            
+            //each matched template has its own slot, so the chunks never write the same one
+            void match(size_t chunk __attribute__((unused)), size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const unistroke_gesture & pattern = templates[(selection != NULL) ? (*selection)[i] : i];
+                    distances[i] = protractor::optimal_cosine_distance(pattern.sensitive ? o_sens_gest : o_invar_gest, pattern.points);
+                }
+            }
+            
+        private:
+            const vector<unistroke_gesture> & templates;
+            //! \brief matched templates, all of them if NULL
+            const vector<size_t> * selection;
+            const vector<point_2d> & o_invar_gest;
+            const vector<point_2d> & o_sens_gest;
+            vector<float> & distances;
+        };
+        
         //preprocessing of templates
         void protractor::process_templates() {
             //temporary vector of gestures which are processed also in reverse order of points
@@ -61,7 +85,7 @@ namespace libreco {
         
         //create protractor instance with specified parameters
         protractor::protractor(const std::vector<libreco::rutils::unistroke_gesture> & tmpls, uint16_t num_of_pts, const libkerat::helpers::point_2d & orig)
-        : number_of_points(num_of_pts), origin(orig) {
+        : number_of_points(num_of_pts), origin(orig), shortlist_size(0) {
 
             prot_templates.reserve(tmpls.size());
             prot_templates = tmpls;
@@ -70,13 +94,40 @@ namespace libreco {
         
         //create protractor instance with default parameters
         protractor::protractor(const std::vector<libreco::rutils::unistroke_gesture> & tmpls)
-        : number_of_points(16), origin(point_2d(0, 0)) {
+        : number_of_points(16), origin(point_2d(0, 0)), shortlist_size(0) {
 
             prot_templates.reserve(tmpls.size());
             prot_templates = tmpls;
             process_templates();
         }
 
+        
+        //builds indexes over vectorized templates, the gesture is vectorized differently for each of them
+        void protractor::set_shortlist_size(size_t size) {
+            shortlist_size = size;
+            invariant_index.clear();
+            sensitive_index.clear();
+            if (shortlist_size == 0) {
+                return;
+            }
+            
+            vector<float> invariant_features;
+            vector<float> sensitive_features;
+            vector<size_t> invariant_ids;
+            vector<size_t> sensitive_ids;
+            for (size_t i = 0; i < prot_templates.size(); i++) {
+                //empty templates are left out of the indexes
+                if (prot_templates[i].sensitive) {
+                    if (libreco::rutils::append_features(prot_templates[i].points, number_of_points, sensitive_features)) {
+                        sensitive_ids.push_back(i);
+                    }
+                } else if (libreco::rutils::append_features(prot_templates[i].points, number_of_points, invariant_features)) {
+                    invariant_ids.push_back(i);
+                }
+            }
+            invariant_index.build(invariant_features, invariant_ids, number_of_points * 2);
+            sensitive_index.build(sensitive_features, sensitive_ids, number_of_points * 2);
+        }
 
         //Create a vector representation of the gesture
         void protractor::vectorize(vector<point_2d> & points, bool o_sensitive) {
@@ -178,14 +229,33 @@ namespace libreco {
             float score = 0.0;
             libreco::recognizers::recognized_gestures scores;
 
-            for (vector<unistroke_gesture>::const_iterator iter = prot_templates.begin(); iter != prot_templates.end(); iter++) {
-                if (iter->sensitive) {
-                    score = optimal_cosine_distance(o_sens_gest, iter->points);
-                } else {
-                    score = optimal_cosine_distance(o_invar_gest, iter->points);
+            //only templates nearest to the gesture are matched, if the index is used
+            vector<size_t> selection;
+            if (shortlist_size != 0) {
+                vector<float> invariant_features;
+                vector<float> sensitive_features;
+                vector<libreco::rutils::index_neighbour> neighbours;
+                if (libreco::rutils::append_features(o_invar_gest, number_of_points, invariant_features)) {
+                    invariant_index.nearest(&invariant_features[0], shortlist_size, neighbours);
+                }
+                if (libreco::rutils::append_features(o_sens_gest, number_of_points, sensitive_features)) {
+                    sensitive_index.nearest(&sensitive_features[0], shortlist_size, neighbours);
                 }
+                libreco::rutils::shortlist(neighbours, shortlist_size, selection);
+            }
+            //all templates are matched if none was shortlisted
+            const vector<size_t> * selected = !selection.empty() ? &selection : NULL;
+            size_t matched = (selected != NULL) ? selection.size() : prot_templates.size();
+
+            //templates are matched in chunks, scores are inserted in the order of templates afterwards
+            vector<float> distances(matched);
+            protractor_matching_task task(prot_templates, selected, o_invar_gest, o_sens_gest, distances);
+            matching_threads.run(task, matched);
+            
+            for (unsigned int i = 0; i < matched; i++) {
+                score = distances[i];
                 if(score < FLT_MAX) {
-                    scores.insert(std::pair<float, std::string > (1.0 / score, iter->name));
+                    scores.insert(std::pair<float, std::string > (1.0 / score, prot_templates[(selected != NULL) ? selection[i] : i].name));
                 }
             }
 #ifdef TEST_PERFORMANCE
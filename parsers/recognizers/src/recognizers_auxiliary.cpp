@@ -66,9 +66,11 @@ namespace libreco {
                 }
             }
 
-            if (resampled_points.size() == (number_of_points - 1)) {
-                resampled_points.insert(resampled_points.end(), 1, points[points.size() - 1]);
+            //rounding errors may end the walk a point or more short or long, keep exactly n points
+            while (resampled_points.size() < number_of_points) {
+                resampled_points.push_back(points[points.size() - 1]);
             }
+            resampled_points.resize(number_of_points, points[points.size() - 1]);
             points = resampled_points;
         }
         
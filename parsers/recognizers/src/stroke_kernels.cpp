@@ -0,0 +1,177 @@
+/**
+ * \file      stroke_kernels.cpp
+ * \brief     Implements the vectorized rotate and distance kernel used by the recognizers
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:19 UTC
+ * \copyright BSD
+ */
+
+#include <muse/recognizers/stroke_kernels.hpp>
+#include <muse/recognizers/recognizers_auxiliary.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+namespace libreco {
+    namespace rauxiliary {
+
+        using std::vector;
+        using libkerat::helpers::point_2d;
+
+        soa_stroke::soa_stroke(const vector<point_2d> & points) : center_x(0.0), center_y(0.0) {
+            assign(points);
+        }
+
+        void soa_stroke::assign(const vector<point_2d> & points) {
+            xs.resize(points.size());
+            ys.resize(points.size());
+            for (unsigned int i = 0; i < points.size(); i++) {
+                xs[i] = points[i].get_x();
+                ys[i] = points[i].get_y();
+            }
+
+            //same centroid as rotate_by_angle computes for every rotation
+            if (!points.empty()) {
+                point_2d center = centroid(points);
+                center_x = center.get_x();
+                center_y = center.get_y();
+            } else {
+                center_x = 0.0;
+                center_y = 0.0;
+            }
+        }
+
+        //rotates points around their centroid and sums distances to the pattern in one pass
+        float distance_at_angle(const soa_stroke & points, const soa_stroke & pattern, float angle) {
+            const unsigned int size = points.size();
+            const float cos_value = cos(angle);
+            const float sin_value = sin(angle);
+            const float center_x = points.center_x;
+            const float center_y = points.center_y;
+
+            const float * p_xs = size ? &points.xs[0] : NULL;
+            const float * p_ys = size ? &points.ys[0] : NULL;
+            const float * t_xs = size ? &pattern.xs[0] : NULL;
+            const float * t_ys = size ? &pattern.ys[0] : NULL;
+
+            float distance = 0.0;
+            unsigned int i = 0;
+
+#ifdef __SSE__
+            const __m128 v_cos = _mm_set1_ps(cos_value);
+            const __m128 v_sin = _mm_set1_ps(sin_value);
+            const __m128 v_center_x = _mm_set1_ps(center_x);
+            const __m128 v_center_y = _mm_set1_ps(center_y);
+            float lanes[4];
+
+            for (; (i + 4) <= size; i += 4) {
+                __m128 x = _mm_sub_ps(_mm_loadu_ps(p_xs + i), v_center_x);
+                __m128 y = _mm_sub_ps(_mm_loadu_ps(p_ys + i), v_center_y);
+
+                __m128 dx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(x, v_cos), _mm_mul_ps(y, v_sin)), v_center_x);
+                __m128 dy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, v_sin), _mm_mul_ps(y, v_cos)), v_center_y);
+                dx = _mm_sub_ps(dx, _mm_loadu_ps(t_xs + i));
+                dy = _mm_sub_ps(dy, _mm_loadu_ps(t_ys + i));
+
+                _mm_storeu_ps(lanes, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))));
+
+                //summed in the order of points, the search below is sensitive even to rounding
+                distance += lanes[0];
+                distance += lanes[1];
+                distance += lanes[2];
+                distance += lanes[3];
+            }
+#endif
+
+            //points not filling whole vector register, or all of them without SSE
+            for (; i < size; i++) {
+                float x = p_xs[i] - center_x;
+                float y = p_ys[i] - center_y;
+                float dx = ((x * cos_value) - (y * sin_value) + center_x) - t_xs[i];
+                float dy = ((x * sin_value) + (y * cos_value) + center_y) - t_ys[i];
+                distance += std::sqrt((dx * dx) + (dy * dy));
+            }
+
+            return distance / (float) size;
+        }
+
+        //golden section search, kept step by step with the point_2d version so the scores match
+        //equal distances of both probes decide the direction, so the distances must be bit exact
+        float distance_at_best_angle(const soa_stroke & points, const soa_stroke & pattern,
+                float down_lim, float top_lim, float thres) {
+
+            float golden_ratio = 0.5 * (sqrt(5.0) - 1.0);
+            float x_1 = golden_ratio * down_lim + (1.0 - golden_ratio) * top_lim;
+            float f_1 = distance_at_angle(points, pattern, x_1);
+            float x_2 = golden_ratio * top_lim + (1.0 - golden_ratio) * down_lim;
+            float f_2 = distance_at_angle(points, pattern, x_2);
+
+            while (std::abs(top_lim - down_lim) > thres) {
+                if (f_1 < f_2) {
+                    top_lim = x_2;
+                    x_2 = x_1;
+                    f_2 = f_1;
+                    x_1 = golden_ratio * down_lim + (1.0 - golden_ratio) * top_lim;
+                    f_1 = distance_at_angle(points, pattern, x_1);
+                } else {
+                    down_lim = x_1;
+                    x_1 = x_2;
+                    f_1 = f_2;
+                    x_2 = golden_ratio * top_lim + (1.0 - golden_ratio) * down_lim;
+                    f_1 = distance_at_angle(points, pattern, x_2);
+                }
+            }
+            return std::min(f_1, f_2);
+        }
+
+        void centroid_distances(const soa_stroke & stroke, vector<float> & radii) {
+            radii.resize(stroke.size());
+            for (unsigned int i = 0; i < stroke.size(); i++) {
+                float dx = stroke.xs[i] - stroke.center_x;
+                float dy = stroke.ys[i] - stroke.center_y;
+                radii[i] = std::sqrt((dx * dx) + (dy * dy));
+            }
+        }
+
+        void coarse_stroke(const soa_stroke & stroke, unsigned int count, soa_stroke & coarse) {
+            coarse.center_x = stroke.center_x;
+            coarse.center_y = stroke.center_y;
+
+            //nothing to pick from, or no span to spread the points over
+            if ((stroke.size() == 0) || (count < 2)) {
+                coarse.xs.assign(stroke.xs.begin(), stroke.xs.begin() + std::min(count, stroke.size()));
+                coarse.ys.assign(stroke.ys.begin(), stroke.ys.begin() + std::min(count, stroke.size()));
+                return;
+            }
+
+            coarse.xs.resize(count);
+            coarse.ys.resize(count);
+            //first and last points are always picked
+            for (unsigned int i = 0; i < count; i++) {
+                unsigned int index = (i * (stroke.size() - 1)) / (count - 1);
+                coarse.xs[i] = stroke.xs[index];
+                coarse.ys[i] = stroke.ys[index];
+            }
+        }
+
+        //|c_p + R(p - c_p) - t| >= ||p - c_p| - |t - c_t|| - |c_t - c_p| for any rotation R
+        float rotation_lower_bound(const soa_stroke & points, const float * points_radii, const soa_stroke & pattern, const float * pattern_radii) {
+            const unsigned int size = points.size();
+            float difference = 0.0;
+            for (unsigned int i = 0; i < size; i++) {
+                difference += std::abs(points_radii[i] - pattern_radii[i]);
+            }
+
+            float dx = points.center_x - pattern.center_x;
+            float dy = points.center_y - pattern.center_y;
+            float bound = (difference / (float) size) - std::sqrt((dx * dx) + (dy * dy));
+
+            return std::max(bound, 0.0f);
+        }
+
+    } //ns rauxiliary
+} //ns libreco
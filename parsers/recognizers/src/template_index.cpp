@@ -0,0 +1,192 @@
+/**
+ * \file      template_index.cpp
+ * \brief     Implements the vantage point tree the recognizers shortlist templates by
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:43 UTC
+ * \copyright BSD
+ */
+
+#include <muse/recognizers/template_index.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+
+namespace libreco {
+    namespace rutils {
+
+        using std::vector;
+        using libkerat::helpers::point_2d;
+
+        vp_tree::vp_tree() : dimension(0), root(-1) {
+            ;
+        }
+
+        void vp_tree::build(const vector<float> & tmpl_features, const vector<size_t> & tmpl_ids, unsigned int dim) {
+            features = tmpl_features;
+            ids = tmpl_ids;
+            dimension = dim;
+            nodes.clear();
+            nodes.reserve(ids.size());
+
+            vector<size_t> items(ids.size());
+            for (size_t i = 0; i < items.size(); i++) {
+                items[i] = i;
+            }
+
+            //fixed seed, the same templates always build the same tree
+            unsigned int seed = 1;
+            root = build_node(items, 0, items.size(), seed);
+        }
+
+        void vp_tree::clear() {
+            features.clear();
+            ids.clear();
+            nodes.clear();
+            dimension = 0;
+            root = -1;
+        }
+
+        long vp_tree::build_node(vector<size_t> & items, size_t begin, size_t end, unsigned int & seed) {
+            if (begin == end) {
+                return -1;
+            }
+
+            //random vantage point keeps the tree balanced for sorted templates as well
+            seed = (seed * 1103515245) + 12345;
+            std::swap(items[begin], items[begin + ((seed >> 16) % (end - begin))]);
+
+            long node = nodes.size();
+            vp_node vantage;
+            vantage.item = items[begin];
+            vantage.threshold = 0.0;
+            vantage.inside = -1;
+            vantage.outside = -1;
+            nodes.push_back(vantage);
+
+            if ((end - begin) == 1) {
+                return node;
+            }
+
+            //median of distances splits the rest, equal distances are split by item
+            vector<std::pair<float, size_t> > distances;
+            distances.reserve(end - begin - 1);
+            const float * vantage_features = &features[vantage.item * dimension];
+            for (size_t i = begin + 1; i < end; i++) {
+                distances.push_back(std::pair<float, size_t>(distance(items[i], vantage_features), items[i]));
+            }
+
+            size_t median = distances.size() / 2;
+            std::nth_element(distances.begin(), distances.begin() + median, distances.end());
+            for (size_t i = 0; i < distances.size(); i++) {
+                items[begin + 1 + i] = distances[i].second;
+            }
+
+            float threshold = distances[median].first;
+            size_t split = begin + 1 + median;
+            long inside = build_node(items, begin + 1, split, seed);
+            long outside = build_node(items, split, end, seed);
+
+            //nodes may have been reallocated
+            nodes[node].threshold = threshold;
+            nodes[node].inside = inside;
+            nodes[node].outside = outside;
+            return node;
+        }
+
+        float vp_tree::distance(size_t item, const float * query) const {
+            const float * item_features = &features[item * dimension];
+            float sum = 0.0;
+            for (unsigned int i = 0; i < dimension; i++) {
+                float difference = item_features[i] - query[i];
+                sum += difference * difference;
+            }
+            return std::sqrt(sum);
+        }
+
+        void vp_tree::nearest(const float * query, size_t count, vector<index_neighbour> & neighbours, const index_filter * filter) const {
+            if ((count == 0) || (root < 0)) {
+                return;
+            }
+
+            vector<index_neighbour> heap;
+            heap.reserve(count);
+            search(root, query, count, filter, heap);
+
+            std::sort_heap(heap.begin(), heap.end());
+            neighbours.insert(neighbours.end(), heap.begin(), heap.end());
+        }
+
+        void vp_tree::search(long node, const float * query, size_t count, const index_filter * filter, vector<index_neighbour> & heap) const {
+            if (node < 0) {
+                return;
+            }
+
+            const vp_node & vantage = nodes[node];
+            index_neighbour candidate(distance(vantage.item, query), ids[vantage.item]);
+
+            //rejected vantage point is not found, yet it still splits the subtrees
+            bool accepted = (filter == NULL) || filter->accepts(candidate.second);
+            if (accepted && (heap.size() < count)) {
+                heap.push_back(candidate);
+                std::push_heap(heap.begin(), heap.end());
+            } else if (accepted && (candidate < heap.front())) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = candidate;
+                std::push_heap(heap.begin(), heap.end());
+            }
+
+            //no template of the subtree can be nearer than the farthest neighbour found, triangle inequality tells
+            float vantage_distance = candidate.first;
+            float farthest = (heap.size() < count) ? FLT_MAX : heap.front().first;
+            if (vantage_distance < vantage.threshold) {
+                search(vantage.inside, query, count, filter, heap);
+                farthest = (heap.size() < count) ? FLT_MAX : heap.front().first;
+                if ((vantage_distance + farthest) >= vantage.threshold) {
+                    search(vantage.outside, query, count, filter, heap);
+                }
+            } else {
+                search(vantage.outside, query, count, filter, heap);
+                farthest = (heap.size() < count) ? FLT_MAX : heap.front().first;
+                if ((vantage_distance - farthest) <= vantage.threshold) {
+                    search(vantage.inside, query, count, filter, heap);
+                }
+            }
+        }
+
+        bool append_features(const vector<point_2d> & points, unsigned int count, vector<float> & features) {
+            if (points.empty()) {
+                return false;
+            }
+            for (unsigned int i = 0; i < count; i++) {
+                const point_2d & point = points[std::min<size_t>(i, points.size() - 1)];
+                features.push_back(point.get_x());
+                features.push_back(point.get_y());
+            }
+            return true;
+        }
+
+        bool append_features(const libreco::rauxiliary::soa_stroke & points, unsigned int count, vector<float> & features) {
+            if (points.size() == 0) {
+                return false;
+            }
+            for (unsigned int i = 0; i < count; i++) {
+                unsigned int index = std::min(i, points.size() - 1);
+                features.push_back(points.xs[index]);
+                features.push_back(points.ys[index]);
+            }
+            return true;
+        }
+
+        void shortlist(vector<index_neighbour> & neighbours, size_t count, vector<size_t> & ids) {
+            std::sort(neighbours.begin(), neighbours.end());
+            ids.clear();
+            for (size_t i = 0; (i < neighbours.size()) && (ids.size() < count); i++) {
+                ids.push_back(neighbours[i].second);
+            }
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+
+    } // ns rutils
+} // ns libreco
@@ -0,0 +1,242 @@
+/**
+ * \file      dollar_n_cache_test.cpp
+ * \brief     Test the compiled dollar N templates and benchmark loading them
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:25 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <kerat/kerat.hpp>
+#include <muse/recognizers/libreco.hpp>
+#include <unistd.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using libkerat::helpers::point_2d;
+using libreco::recognizers::dollar_n;
+using libreco::iotools::compiled_templates;
+using libreco::iotools::compiled_parameters;
+
+static const char * CACHE_PATH = "/tmp/muse_dollar_n_cache_test.cache";
+static const size_t LOADS = 5;
+
+//! \brief Straight stroke between two points
+static vector<point_2d> make_stroke(float x1, float y1, float x2, float y2, float wobble){
+    vector<point_2d> retval;
+    for (int i = 0; i <= 20; ++i){
+        float t = i / 20.0;
+        retval.push_back(point_2d(x1 + (t * (x2 - x1)) + (wobble * std::sin(t * 7)), y1 + (t * (y2 - y1)) + (wobble * std::cos(t * 5))));
+    }
+    return retval;
+}
+
+//! \brief Square of four strokes, cross of two and triangle of three
+static vector<vector<vector<point_2d> > > make_shapes(float wobble){
+    vector<vector<vector<point_2d> > > retval(3);
+    retval[0].push_back(make_stroke(100, 100, 300, 100, wobble));
+    retval[0].push_back(make_stroke(300, 100, 300, 300, wobble));
+    retval[0].push_back(make_stroke(300, 300, 100, 300, wobble));
+    retval[0].push_back(make_stroke(100, 300, 100, 100, wobble));
+
+    retval[1].push_back(make_stroke(100, 100, 300, 300, wobble));
+    retval[1].push_back(make_stroke(300, 100, 100, 300, wobble));
+
+    retval[2].push_back(make_stroke(200, 100, 300, 300, wobble));
+    retval[2].push_back(make_stroke(300, 300, 100, 300, wobble));
+    retval[2].push_back(make_stroke(100, 300, 200, 100, wobble));
+    return retval;
+}
+
+static dollar_n::libreco_generic_multistroke_map make_templates(){
+    const char * names[] = { "square", "cross", "triangle" };
+    vector<vector<vector<point_2d> > > shapes = make_shapes(0);
+
+    dollar_n::libreco_generic_multistroke_map retval;
+    for (size_t i = 0; i < shapes.size(); ++i){
+        retval[libreco::rutils::gesture_identity(i + 1, names[i], i == 2)] = shapes[i];
+    }
+    return retval;
+}
+
+static bool same_scores(const dollar_n & first, const dollar_n & second){
+    vector<vector<vector<point_2d> > > unknown = make_shapes(6);
+    bool result = true;
+    for (size_t i = 0; i < unknown.size(); ++i){
+        libreco::recognizers::recognized_gestures first_scores = first.recognize(unknown[i]);
+        libreco::recognizers::recognized_gestures second_scores = second.recognize(unknown[i]);
+        result &= !first_scores.empty() && (first_scores == second_scores);
+    }
+    return result;
+}
+
+/**
+ * Test 1 - recognizer created from the compiled templates scores the same
+ */
+static bool run_test_1(){
+    unlink(CACHE_PATH);
+
+    dollar_n original(make_templates());
+    bool result = original.save_compiled(CACHE_PATH, 42);
+
+    compiled_templates compiled;
+    result &= compiled.load(CACHE_PATH);
+    if (!result){ return false; }
+
+    result &= (compiled.get_parameters() == compiled_parameters(42, 96, point_2d(0, 0), 250, 0.3, 12));
+    result &= (compiled.get_gesture_count() == 3);
+    // 4! * 2^4 variants of the square
+    result &= (compiled.get_name(0) == "square") && (compiled.get_gesture(0).unistroke_count == 384);
+    result &= (compiled.get_gesture(0).number_of_strokes == 4) && (compiled.get_gesture(2).sensitive == 1);
+
+    dollar_n loaded(compiled, -45, 45, 2, 30, true);
+    result &= same_scores(original, loaded);
+
+    return result;
+}
+
+/**
+ * Test 2 - damaged and foreign files are refused, other parameters are detected
+ */
+static bool run_test_2(){
+    bool result = true;
+    compiled_templates compiled;
+
+    result &= !compiled.load("/tmp/muse_dollar_n_cache_test.missing");
+    result &= compiled.load(CACHE_PATH) && (compiled.get_parameters() != compiled_parameters(43, 96, point_2d(0, 0), 250, 0.3, 12));
+    result &= (compiled.get_parameters() != compiled_parameters(42, 64, point_2d(0, 0), 250, 0.3, 12));
+    compiled.unload();
+    result &= !compiled.is_loaded();
+
+    std::string content;
+    {
+        std::ifstream in(CACHE_PATH, std::ios::binary);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        content = buffer.str();
+    }
+
+    const char * damaged_path = "/tmp/muse_dollar_n_cache_test.damaged";
+
+    // truncated
+    {
+        std::ofstream out(damaged_path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), content.size() - 10);
+    }
+    result &= !compiled.load(damaged_path);
+
+    // other format version
+    {
+        std::string other = content;
+        other[8] ^= 0x7f;
+        std::ofstream out(damaged_path, std::ios::binary | std::ios::trunc);
+        out.write(other.data(), other.size());
+    }
+    result &= !compiled.load(damaged_path);
+
+    // not a compiled template file at all
+    {
+        std::ofstream out(damaged_path, std::ios::binary | std::ios::trunc);
+        out << std::string(content.size(), 'x');
+    }
+    result &= !compiled.load(damaged_path);
+
+    unlink(damaged_path);
+    return result;
+}
+
+/**
+ * Test 3 - benchmark of preprocessing the templates and loading them compiled
+ */
+static bool run_test_3(double & preprocess_ms, double & compiled_ms){
+    dollar_n::libreco_generic_multistroke_map templates = make_templates();
+    struct timespec started, finished;
+    bool result = true;
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t i = 0; i < LOADS; ++i){
+        dollar_n recognizer(templates);
+        if (i == 0){ result &= recognizer.save_compiled(CACHE_PATH, 0); }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    struct timespec elapsed = libkerat::nanotimersub(finished, started);
+    preprocess_ms = ((elapsed.tv_sec * 1000.0) + (elapsed.tv_nsec / 1000000.0)) / LOADS;
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t i = 0; i < LOADS; ++i){
+        compiled_templates compiled;
+        result &= compiled.load(CACHE_PATH);
+        dollar_n recognizer(compiled, -45, 45, 2, 30, true);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    elapsed = libkerat::nanotimersub(finished, started);
+    compiled_ms = ((elapsed.tv_sec * 1000.0) + (elapsed.tv_nsec / 1000000.0)) / LOADS;
+
+    unlink(CACHE_PATH);
+    return result;
+}
+
+/**
+ * Test 4 - unistrokes a point short are padded, not refused
+ */
+static bool run_test_4(){
+    const uint16_t points = 8;
+    vector<point_2d> stroke;
+    for (uint16_t i = 0; i < (points - 1); ++i){ stroke.push_back(point_2d(i, 2 * i)); }
+
+    vector<libreco::rutils::multistroke_gesture> templates(1);
+    templates[0].name = "short";
+    templates[0].sensitive = false;
+    templates[0].number_of_strokes = 1;
+    templates[0].unistrokes.push_back(std::make_pair(point_2d(1, 0), stroke));
+
+    vector<vector<libreco::rauxiliary::soa_stroke> > kernel_templates(1);
+    kernel_templates[0].push_back(libreco::rauxiliary::soa_stroke(stroke));
+
+    compiled_parameters params(0, points, point_2d(0, 0), 250, 0.3, 1);
+    bool result = compiled_templates::save(CACHE_PATH, params, templates, kernel_templates);
+
+    compiled_templates compiled;
+    result &= compiled.load(CACHE_PATH) && (compiled.get_gesture_count() == 1);
+    if (result){
+        result &= (compiled.get_xs(0)[points - 2] == (points - 2)) && (compiled.get_xs(0)[points - 1] == (points - 2));
+        result &= (compiled.get_ys(0)[points - 1] == (2 * (points - 2)));
+    }
+
+    unlink(CACHE_PATH);
+    return result;
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    current = run_test_1();
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    double preprocess_ms = 0;
+    double compiled_ms = 0;
+    current = run_test_3(preprocess_ms, compiled_ms);
+    cout << "Preprocessing templates: " << preprocess_ms << " ms" << endl;
+    cout << "Loading compiled templates: " << compiled_ms << " ms" << endl;
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_4();
+    cout << "Test 4: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result ? 0 : 1;
+}
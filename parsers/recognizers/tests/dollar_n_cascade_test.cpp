@@ -0,0 +1,220 @@
+/**
+ * \file      dollar_n_cascade_test.cpp
+ * \brief     Test the cascade matching of the dollar N recognizer and benchmark it against the exhaustive one
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:37 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <kerat/kerat.hpp>
+#include <muse/recognizers/libreco.hpp>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using libkerat::helpers::point_2d;
+using libreco::recognizers::dollar_n;
+using libreco::recognizers::recognized_gestures;
+
+static const size_t VARIANTS = 8;
+static const size_t RUNS = 5;
+
+//! \brief Straight stroke between two points
+static vector<point_2d> make_stroke(float x1, float y1, float x2, float y2, float wobble){
+    vector<point_2d> retval;
+    for (int i = 0; i <= 20; ++i){
+        float t = i / 20.0;
+        retval.push_back(point_2d(x1 + (t * (x2 - x1)) + (wobble * std::sin(t * 7)), y1 + (t * (y2 - y1)) + (wobble * std::cos(t * 5))));
+    }
+    return retval;
+}
+
+//! \brief Polygon of given number of strokes, its vertices are moved by the variant
+static vector<vector<point_2d> > make_shape(size_t strokes, size_t variant, float wobble){
+    vector<vector<point_2d> > retval;
+    for (size_t s = 0; s < strokes; ++s){
+        float a1 = ((2 * M_PI * s) / strokes) + (0.15 * variant * (s % 2));
+        float a2 = ((2 * M_PI * (s + 1)) / strokes) + (0.15 * variant * ((s + 1) % 2));
+        float r1 = 100 - (8.0 * variant * (s % 3));
+        float r2 = 100 - (8.0 * variant * ((s + 1) % 3));
+        retval.push_back(make_stroke(200 + (r1 * std::cos(a1)), 200 + (r1 * std::sin(a1)),
+                200 + (r2 * std::cos(a2)), 200 + (r2 * std::sin(a2)), wobble));
+    }
+    return retval;
+}
+
+static dollar_n::libreco_generic_multistroke_map make_templates(){
+    dollar_n::libreco_generic_multistroke_map retval;
+    size_t id = 1;
+    for (size_t strokes = 2; strokes <= 4; ++strokes){
+        for (size_t variant = 0; variant < VARIANTS; ++variant, ++id){
+            std::stringstream name;
+            name << "polygon_" << strokes << "_" << variant;
+            retval[libreco::rutils::gesture_identity(id, name.str(), (variant % 3) == 2)] = make_shape(strokes, variant, 0);
+        }
+    }
+    return retval;
+}
+
+//! \brief Unknown gestures, each stroke drawn in order, by a shaky hand
+static vector<vector<vector<point_2d> > > make_unknown(){
+    vector<vector<vector<point_2d> > > retval;
+    for (size_t strokes = 2; strokes <= 4; ++strokes){
+        for (size_t variant = 0; variant < VARIANTS; variant += 3){
+            retval.push_back(make_shape(strokes, variant, 4));
+        }
+    }
+    return retval;
+}
+
+static double elapsed_us(const struct timespec & started, const struct timespec & finished, size_t count){
+    struct timespec elapsed = libkerat::nanotimersub(finished, started);
+    return ((elapsed.tv_sec * 1000000.0) + (elapsed.tv_nsec / 1000.0)) / count;
+}
+
+/**
+ * Test 1 - the cascade ranks the same template first with the same score and searches less
+ */
+static bool run_test_1(dollar_n::cascade_report & total){
+    dollar_n recognizer(make_templates());
+    vector<vector<vector<point_2d> > > unknown = make_unknown();
+    bool result = true;
+
+    for (size_t i = 0; i < unknown.size(); ++i){
+        dollar_n::cascade_report report;
+        recognized_gestures cascade_scores = recognizer.recognize(unknown[i], report);
+        recognized_gestures exhaustive_scores = recognizer.recognize(unknown[i]);
+
+        result &= report.same_best && !cascade_scores.empty();
+        result &= (*cascade_scores.begin() == *exhaustive_scores.begin());
+        result &= (cascade_scores.size() == exhaustive_scores.size()) && (report.ranks == exhaustive_scores.size());
+        result &= (report.full_searches <= report.candidates);
+
+        total.candidates += report.candidates;
+        total.full_searches += report.full_searches;
+        total.ranks += report.ranks;
+        total.agreeing_ranks += report.agreeing_ranks;
+    }
+    total.same_best = result;
+
+    return result && (total.full_searches < total.candidates);
+}
+
+/**
+ * Test 2 - cascade scores do not depend on number of threads
+ */
+static bool run_test_2(){
+    dollar_n recognizer(make_templates());
+    recognizer.set_cascade(true);
+    vector<vector<vector<point_2d> > > unknown = make_unknown();
+    bool result = recognizer.get_cascade();
+
+    vector<recognized_gestures> expected;
+    for (size_t i = 0; i < unknown.size(); ++i){
+        expected.push_back(recognizer.recognize(unknown[i]));
+    }
+
+    recognizer.set_thread_count(3);
+    for (size_t i = 0; i < unknown.size(); ++i){
+        result &= (recognizer.recognize(unknown[i]) == expected[i]);
+    }
+
+    return result;
+}
+
+/**
+ * Test 3 - benchmark of the exhaustive and the cascade matching
+ */
+static bool run_test_3(double & exhaustive_us, double & cascade_us){
+    dollar_n recognizer(make_templates());
+    vector<vector<vector<point_2d> > > unknown = make_unknown();
+    struct timespec started, finished;
+    bool result = true;
+
+    vector<recognized_gestures> expected;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t run = 0; run < RUNS; ++run){
+        for (size_t i = 0; i < unknown.size(); ++i){
+            recognized_gestures scores = recognizer.recognize(unknown[i]);
+            if (run == 0){ expected.push_back(scores); }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    exhaustive_us = elapsed_us(started, finished, RUNS * unknown.size());
+
+    recognizer.set_cascade(true);
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t run = 0; run < RUNS; ++run){
+        for (size_t i = 0; i < unknown.size(); ++i){
+            recognized_gestures scores = recognizer.recognize(unknown[i]);
+            result &= (*scores.begin() == *expected[i].begin());
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    cascade_us = elapsed_us(started, finished, RUNS * unknown.size());
+
+    return result;
+}
+
+/**
+ * Test 4 - coarse strokes of degenerate strokes and counts stay in bounds
+ */
+static bool run_test_4(){
+    using libreco::rauxiliary::soa_stroke;
+
+    vector<point_2d> points;
+    points.push_back(point_2d(1, 2));
+    points.push_back(point_2d(3, 4));
+    points.push_back(point_2d(5, 6));
+    soa_stroke stroke(points);
+    soa_stroke coarse;
+
+    libreco::rauxiliary::coarse_stroke(soa_stroke(), 4, coarse);
+    bool result = (coarse.size() == 0);
+
+    libreco::rauxiliary::coarse_stroke(stroke, 0, coarse);
+    result &= (coarse.size() == 0);
+
+    libreco::rauxiliary::coarse_stroke(stroke, 1, coarse);
+    result &= (coarse.size() == 1) && (coarse.xs[0] == 1) && (coarse.ys[0] == 2);
+
+    libreco::rauxiliary::coarse_stroke(stroke, 2, coarse);
+    result &= (coarse.size() == 2) && (coarse.xs[1] == 5) && (coarse.ys[1] == 6);
+
+    return result;
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    dollar_n::cascade_report report;
+    current = run_test_1(report);
+    cout << "Full resolution searches: " << report.full_searches << " of " << report.candidates << endl;
+    cout << "Rank agreement: " << report.agreeing_ranks << " of " << report.ranks << endl;
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    double exhaustive_us = 0;
+    double cascade_us = 0;
+    current = run_test_3(exhaustive_us, cascade_us);
+    cout << "Exhaustive matching: " << exhaustive_us << " us" << endl;
+    cout << "Cascade matching: " << cascade_us << " us" << endl;
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_4();
+    cout << "Test 4: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result ? 0 : 1;
+}
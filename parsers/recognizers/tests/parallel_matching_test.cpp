@@ -0,0 +1,181 @@
+/**
+ * \file      parallel_matching_test.cpp
+ * \brief     Test the recognizers score the same with any number of matching threads and benchmark them
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:30 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <kerat/kerat.hpp>
+#include <muse/recognizers/libreco.hpp>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using libkerat::helpers::point_2d;
+using libreco::recognizers::dollar_n;
+using libreco::recognizers::dollar_recognizer;
+using libreco::recognizers::protractor;
+using libreco::recognizers::recognized_gestures;
+
+static const unsigned int THREAD_COUNTS[] = { 1, 2, 3, 4, 8 };
+static const size_t THREAD_COUNTS_SIZE = sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]);
+static const size_t RUNS = 20;
+
+//! \brief Straight stroke between two points
+static vector<point_2d> make_stroke(float x1, float y1, float x2, float y2, float wobble){
+    vector<point_2d> retval;
+    for (int i = 0; i <= 20; ++i){
+        float t = i / 20.0;
+        retval.push_back(point_2d(x1 + (t * (x2 - x1)) + (wobble * std::sin(t * 7)), y1 + (t * (y2 - y1)) + (wobble * std::cos(t * 5))));
+    }
+    return retval;
+}
+
+//! \brief Polygon of given number of strokes, rotated and skewed by the variant
+static vector<vector<point_2d> > make_shape(size_t strokes, size_t variant, float wobble){
+    vector<vector<point_2d> > retval;
+    float skew = 0.1 * variant;
+    for (size_t s = 0; s < strokes; ++s){
+        float a1 = ((2 * M_PI * s) / strokes) + skew;
+        float a2 = ((2 * M_PI * (s + 1)) / strokes) + (skew * 2);
+        retval.push_back(make_stroke(200 + (100 * std::cos(a1)), 200 + (100 * std::sin(a1)),
+                200 + (100 * std::cos(a2)), 200 + (100 * std::sin(a2)), wobble));
+    }
+    return retval;
+}
+
+//! \brief Single stroke of the polygon, as the unistroke recognizers take it
+static vector<point_2d> make_unistroke(size_t strokes, size_t variant, float wobble){
+    vector<vector<point_2d> > shape = make_shape(strokes, variant, wobble);
+    vector<point_2d> retval;
+    for (size_t s = 0; s < shape.size(); ++s){
+        retval.insert(retval.end(), shape[s].begin(), shape[s].end());
+    }
+    return retval;
+}
+
+static dollar_n::libreco_generic_multistroke_map make_multistroke_templates(){
+    dollar_n::libreco_generic_multistroke_map retval;
+    size_t id = 1;
+    for (size_t strokes = 2; strokes <= 4; ++strokes){
+        for (size_t variant = 0; variant < 4; ++variant, ++id){
+            std::string name = "polygon";
+            name += (char)('0' + strokes);
+            name += (char)('a' + variant);
+            retval[libreco::rutils::gesture_identity(id, name, (variant % 2) == 1)] = make_shape(strokes, variant, 0);
+        }
+    }
+    return retval;
+}
+
+static vector<libreco::rutils::unistroke_gesture> make_unistroke_templates(){
+    vector<libreco::rutils::unistroke_gesture> retval;
+    for (size_t strokes = 2; strokes <= 6; ++strokes){
+        for (size_t variant = 0; variant < 8; ++variant){
+            libreco::rutils::unistroke_gesture gesture;
+            gesture.name = "polygon";
+            gesture.name += (char)('0' + strokes);
+            gesture.name += (char)('a' + variant);
+            gesture.sensitive = (variant % 2) == 1;
+            gesture.revert = false;
+            gesture.points = make_unistroke(strokes, variant, 0);
+            retval.push_back(gesture);
+        }
+    }
+    return retval;
+}
+
+static double elapsed_us(const struct timespec & started, const struct timespec & finished){
+    struct timespec elapsed = libkerat::nanotimersub(finished, started);
+    return ((elapsed.tv_sec * 1000000.0) + (elapsed.tv_nsec / 1000.0)) / RUNS;
+}
+
+/**
+ * Test 1 - dollar N ($N) scores the same with any number of threads
+ */
+static bool run_test_1(vector<double> & times){
+    dollar_n recognizer(make_multistroke_templates());
+    bool result = true;
+
+    vector<recognized_gestures> expected;
+    for (size_t strokes = 2; strokes <= 4; ++strokes){
+        expected.push_back(recognizer.recognize(make_shape(strokes, 1, 6)));
+        result &= !expected.back().empty();
+    }
+
+    for (size_t t = 0; t < THREAD_COUNTS_SIZE; ++t){
+        recognizer.set_thread_count(THREAD_COUNTS[t]);
+        result &= (recognizer.get_thread_count() == THREAD_COUNTS[t]);
+
+        struct timespec started, finished;
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        for (size_t run = 0; run < RUNS; ++run){
+            for (size_t strokes = 2; strokes <= 4; ++strokes){
+                result &= (recognizer.recognize(make_shape(strokes, 1, 6)) == expected[strokes - 2]);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        times.push_back(elapsed_us(started, finished));
+    }
+
+    // copy has its own workers
+    dollar_n copy = recognizer;
+    result &= (copy.get_thread_count() == recognizer.get_thread_count());
+    result &= (copy.recognize(make_shape(3, 1, 6)) == expected[1]);
+
+    return result;
+}
+
+/**
+ * Test 2 - dollar one ($1) and protractor score the same with any number of threads
+ */
+static bool run_test_2(){
+    vector<libreco::rutils::unistroke_gesture> templates = make_unistroke_templates();
+    dollar_recognizer dollar(templates);
+    protractor protr(templates);
+    bool result = true;
+
+    vector<point_2d> unknown = make_unistroke(5, 3, 6);
+    recognized_gestures dollar_expected = dollar.recognize(unknown);
+    recognized_gestures protractor_expected = protr.recognize(unknown);
+    result &= (dollar_expected.size() == templates.size()) && (protractor_expected.size() == templates.size());
+
+    for (size_t t = 0; t < THREAD_COUNTS_SIZE; ++t){
+        dollar.set_thread_count(THREAD_COUNTS[t]);
+        protr.set_thread_count(THREAD_COUNTS[t]);
+        for (size_t run = 0; run < RUNS; ++run){
+            result &= (dollar.recognize(unknown) == dollar_expected);
+            result &= (protr.recognize(unknown) == protractor_expected);
+        }
+    }
+
+    // no threads is taken as one
+    dollar.set_thread_count(0);
+    result &= (dollar.get_thread_count() == 1) && (dollar.recognize(unknown) == dollar_expected);
+
+    return result;
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    vector<double> times;
+    current = run_test_1(times);
+    for (size_t t = 0; t < times.size(); ++t){
+        cout << "Dollar N ($N) matching by " << THREAD_COUNTS[t] << " thread(s): " << times[t] << " us" << endl;
+    }
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/**
+ * \file      stroke_kernels_test.cpp
+ * \brief     Test the rotation search over strokes stored as structure of arrays matches the point_2d one
+ * \author    agent <agent@local>
+ * \date      2026-10-17 06:14 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <kerat/kerat.hpp>
+#include <muse/recognizers/libreco.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using libkerat::helpers::point_2d;
+using libreco::rauxiliary::soa_stroke;
+
+//! \brief largest difference of distances still considered the same score
+static const float TOLERANCE = 1e-3;
+
+//! \brief Wobbly arc, odd point counts leave a remainder after the vector lanes
+static vector<point_2d> make_stroke(unsigned int points, float radius, float phase){
+    vector<point_2d> retval;
+    for (unsigned int i = 0; i < points; ++i){
+        float t = (float)i / points;
+        float angle = phase + (t * 4.0);
+        retval.push_back(point_2d(120 + (radius * std::cos(angle)) + (7 * std::sin(t * 13)), 80 + (radius * std::sin(angle))));
+    }
+    return retval;
+}
+
+//! \brief Pairs of strokes of the same length, as the recognizers compare them
+static void make_pairs(vector<vector<point_2d> > & unknown, vector<vector<point_2d> > & patterns){
+    const unsigned int counts[] = { 1, 3, 4, 7, 32, 63, 64 };
+    for (size_t i = 0; i < (sizeof(counts)/sizeof(unsigned int)); ++i){
+        unknown.push_back(make_stroke(counts[i], 50, 0.3));
+        patterns.push_back(make_stroke(counts[i], 60, 0.9));
+    }
+}
+
+/**
+ * Test 1 - the centroid stored with the stroke is the centroid of its points
+ */
+static bool run_test_1(){
+    vector<vector<point_2d> > unknown;
+    vector<vector<point_2d> > patterns;
+    make_pairs(unknown, patterns);
+
+    bool result = true;
+    for (size_t i = 0; i < unknown.size(); ++i){
+        soa_stroke stroke(unknown[i]);
+        point_2d center = libreco::rauxiliary::centroid(unknown[i]);
+        result &= (stroke.size() == unknown[i].size());
+        result &= (std::fabs(stroke.center_x - center.get_x()) < TOLERANCE) && (std::fabs(stroke.center_y - center.get_y()) < TOLERANCE);
+    }
+    return result;
+}
+
+/**
+ * Test 2 - distance at given angle is the same for both stroke layouts
+ */
+static bool run_test_2(){
+    vector<vector<point_2d> > unknown;
+    vector<vector<point_2d> > patterns;
+    make_pairs(unknown, patterns);
+
+    const float angles[] = { -0.7, -0.1, 0, 0.25, 0.78 };
+
+    bool result = true;
+    for (size_t i = 0; i < unknown.size(); ++i){
+        soa_stroke kernel_unknown(unknown[i]);
+        soa_stroke kernel_pattern(patterns[i]);
+        for (size_t a = 0; a < (sizeof(angles)/sizeof(float)); ++a){
+            float expected = libreco::rauxiliary::distance_at_angle(unknown[i], patterns[i], angles[a]);
+            float computed = libreco::rauxiliary::distance_at_angle(kernel_unknown, kernel_pattern, angles[a]);
+            result &= (std::fabs(expected - computed) < TOLERANCE);
+        }
+    }
+    return result;
+}
+
+/**
+ * Test 3 - golden section search finds the same score for both stroke layouts
+ */
+static bool run_test_3(){
+    vector<vector<point_2d> > unknown;
+    vector<vector<point_2d> > patterns;
+    make_pairs(unknown, patterns);
+
+    const float down_lim = libreco::rauxiliary::degrees_to_radians(-45.0);
+    const float top_lim = libreco::rauxiliary::degrees_to_radians(45.0);
+    const float thres = libreco::rauxiliary::degrees_to_radians(2.0);
+
+    bool result = true;
+    for (size_t i = 0; i < unknown.size(); ++i){
+        float expected = libreco::rauxiliary::distance_at_best_angle(unknown[i], patterns[i], down_lim, top_lim, thres);
+        float computed = libreco::rauxiliary::distance_at_best_angle(soa_stroke(unknown[i]), soa_stroke(patterns[i]), down_lim, top_lim, thres);
+        result &= (std::fabs(expected - computed) < TOLERANCE);
+    }
+    return result;
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    current = run_test_1();
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_3();
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result ? 0 : 1;
+}
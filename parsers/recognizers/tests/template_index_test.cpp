@@ -0,0 +1,327 @@
+/**
+ * \file      template_index_test.cpp
+ * \brief     Test the template index of the recognizers and benchmark it on large template sets
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:43 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <kerat/kerat.hpp>
+#include <muse/recognizers/libreco.hpp>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using libkerat::helpers::point_2d;
+using libreco::recognizers::dollar_n;
+using libreco::recognizers::dollar_recognizer;
+using libreco::recognizers::protractor;
+using libreco::recognizers::recognized_gestures;
+using libreco::rutils::vp_tree;
+using libreco::rutils::index_neighbour;
+using libreco::rutils::index_filter;
+
+static const size_t LIBRARY_SIZE = 2000;
+static const size_t QUERIES = 50;
+
+//! \brief Pseudo random numbers, the same on every run
+static float next_random(unsigned int & seed){
+    seed = (seed * 1103515245) + 12345;
+    return ((seed >> 8) & 0xffff) / 65536.0;
+}
+
+//! \brief Smooth curve given by its coefficients, moved by the wobble
+static vector<point_2d> make_curve(const vector<float> & coefficients, float wobble){
+    vector<point_2d> retval;
+    for (int i = 0; i <= 60; ++i){
+        float t = i / 60.0;
+        float x = 200 + (150 * t) + (wobble * std::sin(t * 9));
+        float y = 200 + (wobble * std::cos(t * 7));
+        for (size_t c = 0; (c + 1) < coefficients.size(); c += 2){
+            x += 60 * coefficients[c] * std::sin((c + 1) * t * 3);
+            y += 60 * coefficients[c + 1] * std::cos((c + 1) * t * 2);
+        }
+        retval.push_back(point_2d(x, y));
+    }
+    return retval;
+}
+
+static vector<vector<float> > make_coefficients(size_t count){
+    unsigned int seed = 7;
+    vector<vector<float> > retval(count);
+    for (size_t i = 0; i < count; ++i){
+        for (size_t c = 0; c < 6; ++c){
+            retval[i].push_back((2 * next_random(seed)) - 1);
+        }
+    }
+    return retval;
+}
+
+static vector<libreco::rutils::unistroke_gesture> make_library(const vector<vector<float> > & coefficients){
+    vector<libreco::rutils::unistroke_gesture> retval;
+    for (size_t i = 0; i < coefficients.size(); ++i){
+        std::stringstream name;
+        name << "curve_" << i;
+        libreco::rutils::unistroke_gesture gesture;
+        gesture.name = name.str();
+        gesture.sensitive = (i % 2) == 1;
+        gesture.revert = false;
+        gesture.points = make_curve(coefficients[i], 0);
+        retval.push_back(gesture);
+    }
+    return retval;
+}
+
+static double elapsed_us(const struct timespec & started, const struct timespec & finished, size_t count){
+    struct timespec elapsed = libkerat::nanotimersub(finished, started);
+    return ((elapsed.tv_sec * 1000000.0) + (elapsed.tv_nsec / 1000.0)) / count;
+}
+
+//! \brief Accepts even identifiers only
+class even_filter: public index_filter {
+public:
+    bool accepts(size_t id) const { return (id % 2) == 0; }
+};
+
+/**
+ * Test 1 - the tree finds the same neighbours as the brute force search
+ */
+static bool run_test_1(){
+    const unsigned int dimension = 8;
+    unsigned int seed = 3;
+    vector<float> features;
+    vector<size_t> ids;
+    for (size_t i = 0; i < 500; ++i){
+        for (unsigned int d = 0; d < dimension; ++d){
+            // coarse grid, so some distances are equal
+            features.push_back(std::floor(next_random(seed) * 8));
+        }
+        ids.push_back(1000 + i);
+    }
+
+    vp_tree tree;
+    tree.build(features, ids, dimension);
+    bool result = (tree.size() == ids.size());
+
+    for (size_t q = 0; q < 20; ++q){
+        vector<float> query;
+        for (unsigned int d = 0; d < dimension; ++d){
+            query.push_back(next_random(seed) * 8);
+        }
+
+        vector<index_neighbour> expected;
+        for (size_t i = 0; i < ids.size(); ++i){
+            float sum = 0;
+            for (unsigned int d = 0; d < dimension; ++d){
+                float difference = features[(i * dimension) + d] - query[d];
+                sum += difference * difference;
+            }
+            expected.push_back(index_neighbour(std::sqrt(sum), ids[i]));
+        }
+        std::sort(expected.begin(), expected.end());
+
+        vector<index_neighbour> expected_even;
+        even_filter filter;
+        for (size_t i = 0; i < expected.size(); ++i){
+            if (filter.accepts(expected[i].second)){ expected_even.push_back(expected[i]); }
+        }
+
+        const size_t counts[] = { 1, 5, 40 };
+        for (size_t c = 0; c < 3; ++c){
+            vector<index_neighbour> found;
+            tree.nearest(&query[0], counts[c], found);
+            result &= (found.size() == counts[c]) && std::equal(found.begin(), found.end(), expected.begin());
+
+            // rejected templates do not take the places of the accepted ones
+            vector<index_neighbour> found_even;
+            tree.nearest(&query[0], counts[c], found_even, &filter);
+            result &= (found_even.size() == counts[c]) && std::equal(found_even.begin(), found_even.end(), expected_even.begin());
+        }
+    }
+
+    vp_tree empty;
+    vector<index_neighbour> found;
+    empty.nearest(&features[0], 5, found);
+    result &= empty.empty() && found.empty();
+
+    // empty stroke has no feature vector
+    vector<float> empty_features;
+    result &= !libreco::rutils::append_features(vector<point_2d>(), 4, empty_features) && empty_features.empty();
+    result &= !libreco::rutils::append_features(libreco::rauxiliary::soa_stroke(), 4, empty_features) && empty_features.empty();
+
+    return result;
+}
+
+/**
+ * Test 2 - unistroke recognizers score the shortlisted templates exactly, benchmark on large library
+ */
+template <typename RECOGNIZER>
+static bool run_test_unistroke(const char * name, size_t shortlist){
+    vector<vector<float> > coefficients = make_coefficients(LIBRARY_SIZE);
+    RECOGNIZER recognizer(make_library(coefficients));
+    RECOGNIZER indexed = recognizer;
+    indexed.set_shortlist_size(shortlist);
+    bool result = (indexed.get_shortlist_size() == shortlist);
+
+    vector<vector<point_2d> > queries;
+    for (size_t q = 0; q < QUERIES; ++q){
+        queries.push_back(make_curve(coefficients[(q * 37) % LIBRARY_SIZE], 3));
+    }
+
+    struct timespec started, finished;
+    vector<recognized_gestures> expected;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t q = 0; q < queries.size(); ++q){
+        expected.push_back(recognizer.recognize(queries[q]));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    double exhaustive_us = elapsed_us(started, finished, queries.size());
+
+    size_t agreeing = 0;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    for (size_t q = 0; q < queries.size(); ++q){
+        recognized_gestures scores = indexed.recognize(queries[q]);
+        result &= !scores.empty() && (scores.size() <= shortlist);
+
+        // every shortlisted template scores exactly as without the index
+        for (recognized_gestures::const_iterator iter = scores.begin(); iter != scores.end(); ++iter){
+            bool found = false;
+            for (recognized_gestures::const_iterator e_iter = expected[q].begin(); e_iter != expected[q].end(); ++e_iter){
+                found |= (*e_iter == *iter);
+            }
+            result &= found;
+        }
+        agreeing += (!scores.empty() && (*scores.begin() == *expected[q].begin())) ? 1 : 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    double indexed_us = elapsed_us(started, finished, queries.size());
+
+    cout << name << " of " << LIBRARY_SIZE << " templates, exhaustive: " << exhaustive_us << " us, shortlist of "
+         << shortlist << ": " << indexed_us << " us, best template agrees " << agreeing << " of " << queries.size() << endl;
+
+    // dropping the index scores all templates again
+    indexed.set_shortlist_size(0);
+    result &= (indexed.recognize(queries[0]) == expected[0]);
+
+    return result && (agreeing >= ((queries.size() * 9) / 10));
+}
+
+//! \brief Multistroke library, the curves split to two strokes
+static dollar_n::libreco_generic_multistroke_map make_multistroke_library(const vector<vector<float> > & coefficients){
+    dollar_n::libreco_generic_multistroke_map retval;
+    for (size_t i = 0; i < coefficients.size(); ++i){
+        std::stringstream name;
+        name << "curve_" << i;
+        vector<point_2d> curve = make_curve(coefficients[i], 0);
+        vector<vector<point_2d> > strokes(2);
+        strokes[0].assign(curve.begin(), curve.begin() + 30);
+        strokes[1].assign(curve.begin() + 30, curve.end());
+        retval[libreco::rutils::gesture_identity(i + 1, name.str(), false)] = strokes;
+    }
+    return retval;
+}
+
+/**
+ * Test 4 - dollar N ($N) with the index finds the best template of the exhaustive search
+ */
+static bool run_test_4(){
+    vector<vector<float> > coefficients = make_coefficients(LIBRARY_SIZE / 4);
+    dollar_n recognizer(make_multistroke_library(coefficients));
+    dollar_n indexed = recognizer;
+    indexed.set_shortlist_size(64);
+    bool result = (indexed.get_shortlist_size() == 64);
+
+    struct timespec started, finished;
+    double exhaustive_us = 0;
+    double indexed_us = 0;
+    size_t agreeing = 0;
+    for (size_t q = 0; q < QUERIES; ++q){
+        vector<point_2d> curve = make_curve(coefficients[(q * 37) % coefficients.size()], 3);
+        vector<vector<point_2d> > unknown(2);
+        unknown[0].assign(curve.begin(), curve.begin() + 30);
+        unknown[1].assign(curve.begin() + 30, curve.end());
+
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        recognized_gestures expected = recognizer.recognize(unknown);
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        exhaustive_us += elapsed_us(started, finished, QUERIES);
+
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        recognized_gestures scores = indexed.recognize(unknown);
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        indexed_us += elapsed_us(started, finished, QUERIES);
+
+        result &= !scores.empty() && (scores.size() <= expected.size());
+        agreeing += (!scores.empty() && (*scores.begin() == *expected.begin())) ? 1 : 0;
+    }
+
+    cout << "Dollar N ($N) of " << coefficients.size() << " templates, exhaustive: " << exhaustive_us << " us, shortlist of 64: "
+         << indexed_us << " us, best template agrees " << agreeing << " of " << QUERIES << endl;
+
+    return result && (agreeing >= ((QUERIES * 9) / 10));
+}
+
+/**
+ * Test 5 - dollar N ($N) finds the template of the same number of strokes even if the permutations nearest to the
+ * gesture have other number of strokes
+ */
+static bool run_test_5(){
+    vector<vector<float> > coefficients = make_coefficients(LIBRARY_SIZE / 4);
+    dollar_n::libreco_generic_multistroke_map templates = make_multistroke_library(coefficients);
+
+    // single three stroke template, other curves are drawn by two strokes
+    vector<point_2d> other = make_curve(coefficients[1], 0);
+    vector<vector<point_2d> > three_strokes(3);
+    three_strokes[0].assign(other.begin(), other.begin() + 20);
+    three_strokes[1].assign(other.begin() + 20, other.begin() + 40);
+    three_strokes[2].assign(other.begin() + 40, other.end());
+    templates[libreco::rutils::gesture_identity(coefficients.size() + 1, "three_strokes", false)] = three_strokes;
+
+    dollar_n recognizer(templates);
+
+    // the first curve drawn by three strokes, its nearest permutation is of the two stroke one
+    vector<point_2d> curve = make_curve(coefficients[0], 3);
+    vector<vector<point_2d> > unknown(3);
+    unknown[0].assign(curve.begin(), curve.begin() + 20);
+    unknown[1].assign(curve.begin() + 20, curve.begin() + 40);
+    unknown[2].assign(curve.begin() + 40, curve.end());
+    recognized_gestures expected = recognizer.recognize(unknown);
+
+    recognizer.set_shortlist_size(1);
+    recognized_gestures scores = recognizer.recognize(unknown);
+
+    return !expected.empty() && (scores == expected) && (scores.begin()->second == "three_strokes");
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    current = run_test_1();
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_unistroke<dollar_recognizer>("Dollar one ($1)", 32);
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_unistroke<protractor>("Protractor", 32);
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_4();
+    cout << "Test 4: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_5();
+    cout << "Test 5: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/**
+ * \file      kernel_bench.cpp
+ * \brief     Compares the rotation search over the point_2d strokes with the
+ *            vectorized one over the strokes stored as structure of arrays,
+ *            using the templates from given MUSE config files
+ * \author    agent <agent@local>
+ * \date      2026-10-17 04:19 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/kerat.hpp>
+#include <muse/recognizers/libreco.hpp>
+#include <tinyxml.h>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using std::string;
+using std::vector;
+
+using libkerat::helpers::point_2d;
+using libreco::rauxiliary::soa_stroke;
+
+//! \brief number of points the strokes are resampled to, as the default of the dollar one recognizer
+static const unsigned int NUMBER_OF_POINTS = 64;
+//! \brief side of the box the strokes are scaled to
+static const float SCALE_BOX_SIZE = 250;
+//! \brief how many times all the pairs of strokes are compared
+static const unsigned int ROUNDS = 10;
+//! \brief largest difference of distances still considered the same score
+static const float TOLERANCE = 1e-3;
+
+//! \brief shows command line options for this utility
+static void usage();
+
+//! \brief loads all unistroke and multistroke templates found in given config file
+static bool load_templates(const char * file_path, vector<vector<point_2d> > & strokes);
+
+//! \brief resamples, rotates, scales and translates the stroke as dollar one recognizer does
+static void process_stroke(vector<point_2d> & stroke);
+
+//! \brief returns current time in seconds
+static double now();
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        exit(EXIT_FAILURE);
+    }
+
+    vector<vector<point_2d> > strokes;
+    for (int i = 1; i < argc; i++) {
+        if (!load_templates(argv[i], strokes)) {
+            cerr << "Error while loading templates from given file: " << argv[i] << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (strokes.empty()) {
+        cerr << "No templates found!!!" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    vector<soa_stroke> kernel_strokes;
+    kernel_strokes.reserve(strokes.size());
+    for (vector<vector<point_2d> >::iterator iter = strokes.begin(); iter != strokes.end(); iter++) {
+        process_stroke(*iter);
+        kernel_strokes.push_back(soa_stroke(*iter));
+    }
+
+    const float down_lim = libreco::rauxiliary::degrees_to_radians(-45.0);
+    const float top_lim = libreco::rauxiliary::degrees_to_radians(45.0);
+    const float thres = libreco::rauxiliary::degrees_to_radians(2.0);
+    const size_t pairs = strokes.size() * strokes.size();
+
+    //each stroke is taken as unknown gesture and compared to all the strokes
+    vector<float> distances(pairs);
+    double start = now();
+    for (unsigned int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < pairs; i++) {
+            distances[i] = libreco::rauxiliary::distance_at_best_angle(strokes[i / strokes.size()], strokes[i % strokes.size()],
+                    down_lim, top_lim, thres);
+        }
+    }
+    double point_2d_time = now() - start;
+
+    vector<float> kernel_distances(pairs);
+    start = now();
+    for (unsigned int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < pairs; i++) {
+            kernel_distances[i] = libreco::rauxiliary::distance_at_best_angle(kernel_strokes[i / strokes.size()], kernel_strokes[i % strokes.size()],
+                    down_lim, top_lim, thres);
+        }
+    }
+    double kernel_time = now() - start;
+
+    float max_difference = 0.0;
+    for (size_t i = 0; i < pairs; i++) {
+        max_difference = std::max(max_difference, std::fabs(distances[i] - kernel_distances[i]));
+    }
+
+    cout << "Templates: " << strokes.size() << ", comparisons: " << (pairs * ROUNDS) << endl;
+    cout << "point_2d search:   " << (point_2d_time * 1e6 / (pairs * ROUNDS)) << " us/comparison" << endl;
+    cout << "vectorized search: " << (kernel_time * 1e6 / (pairs * ROUNDS)) << " us/comparison" << endl;
+    cout << "Largest difference of distances: " << max_difference << endl;
+
+    if (max_difference > TOLERANCE) {
+        cerr << "Distances differ more than " << TOLERANCE << "!!!" << endl;
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+//parses points written as "x y" pairs, one per line
+static bool parse_points(const char * text, vector<point_2d> & stroke) {
+    if (text == NULL) {
+        return false;
+    }
+
+    std::istringstream content(text);
+    float x_coord = 0.0;
+    float y_coord = 0.0;
+    while (content >> x_coord >> y_coord) {
+        stroke.push_back(point_2d(x_coord, y_coord));
+    }
+    return content.eof() && (stroke.size() > 1);
+}
+
+//walks whole document, templates of all recognizers are taken
+static bool load_element(const TiXmlElement * element, vector<vector<point_2d> > & strokes) {
+    for (; element != NULL; element = element->NextSiblingElement()) {
+        string name = element->Value();
+        if (name == "uni_gesture") {
+            vector<point_2d> stroke;
+            if (!parse_points(element->GetText(), stroke)) {
+                return false;
+            }
+            strokes.push_back(stroke);
+        } else if (name == "multi_gesture") {
+            //strokes are combined in the order given, as dollar n does with unknown gesture
+            vector<point_2d> unistroke;
+            for (const TiXmlElement * e_stroke = element->FirstChildElement("stroke"); e_stroke != NULL;
+                    e_stroke = e_stroke->NextSiblingElement("stroke")) {
+                if (!parse_points(e_stroke->GetText(), unistroke)) {
+                    return false;
+                }
+            }
+            strokes.push_back(unistroke);
+        } else if (!load_element(element->FirstChildElement(), strokes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool load_templates(const char * file_path, vector<vector<point_2d> > & strokes) {
+    TiXmlDocument document(file_path);
+    if (!document.LoadFile()) {
+        return false;
+    }
+    return load_element(document.RootElement(), strokes);
+}
+
+static void process_stroke(vector<point_2d> & stroke) {
+    libreco::rauxiliary::resample(stroke, NUMBER_OF_POINTS);
+    float angle = libreco::rauxiliary::indicative_angle(stroke);
+    libreco::rauxiliary::rotate_by_angle(stroke, -angle);
+
+    libreco::rutils::rectangle b_box = libreco::rauxiliary::bounding_box(stroke);
+    for (vector<point_2d>::iterator iter = stroke.begin(); iter != stroke.end(); iter++) {
+        iter->set_x(iter->get_x() * (SCALE_BOX_SIZE / b_box.width()));
+        iter->set_y(iter->get_y() * (SCALE_BOX_SIZE / b_box.height()));
+    }
+    libreco::rauxiliary::translate_to(stroke, point_2d(0, 0));
+}
+
+static double now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + (time.tv_nsec / 1e9);
+}
+
+static void usage() {
+    cout << "Usage:" << endl;
+    cout << "libreco_kernel_bench <config> [config ...]\t\t" << endl;
+    cout << endl;
+    cout << "Compares the point_2d and vectorized rotation search over all templates" << endl;
+    cout << "found in given MUSE config files, eg. templates/*.xml." << endl;
+    cout.flush();
+}
@@ -14,6 +14,7 @@
 #include <kerat/utils.hpp>
 #include <uuid/uuid.h>
 #include <limits>
+#include <vector>
 #include <list>
 
 namespace dtuio {
@@ -76,7 +77,7 @@ namespace dtuio {
             libkerat::bundle_handle input;
             // if not the same already
             if (&to_process == &output_frame){
-                bm_handle_copy(to_process, input);
+                bm_handle_share(to_process, input);
             } else {
                 input = to_process;
             }
@@ -89,7 +90,7 @@ namespace dtuio {
             // scan all messages & check whether they are within this viewport; if so then remap
             for (libkerat::bundle_handle::const_iterator i = input.begin(); i != input.end(); ++i){
                 if (dynamic_cast<const libkerat::message::frame *>(*i) != NULL){
-                    bm_handle_insert(output_frame, bm_handle_end(output_frame), (*i)->clone());
+                    bm_handle_insert_shared(output_frame, bm_handle_end(output_frame), *i);
                     
                     // create viewport
                     // no rotations
@@ -107,37 +108,35 @@ namespace dtuio {
                     
                     continue;
                 } else if (dynamic_cast<const libkerat::message::alive *>(*i) != NULL){
-                    bm_handle_insert(output_frame, bm_handle_end(output_frame), (*i)->clone());
+                    bm_handle_insert_shared(output_frame, bm_handle_end(output_frame), *i);
                     continue;
                 } else if (dynamic_cast<const sensor::viewport *>(*i) != NULL){
                     // stop all outgoing viewport messages if strip is enabled
                     //! \todo make the added viewports rotatable & strip the received viewport
                     if (!m_strip){
-                        bm_handle_insert(output_frame, bm_handle_end(output_frame), (*i)->clone());
+                        bm_handle_insert_shared(output_frame, bm_handle_end(output_frame), *i);
                     }
                     continue;
                 }
                 
                 // that means not a frame, not a viewport, run tests & rotations
+                // the message is cloned only if it's about to be changed, otherwise shared
+                const libkerat::kerat_message * original = *i;
+                libkerat::kerat_message * new_message = NULL;
                 
-                libkerat::kerat_message * new_message = (*i)->clone();
-                
-                libkerat::helpers::point_2d * hp_2pt = dynamic_cast<libkerat::helpers::point_2d *>(new_message);
+                const libkerat::helpers::point_2d * hp_2pt = dynamic_cast<const libkerat::helpers::point_2d *>(original);
                 if (hp_2pt != NULL){
-                    libkerat::helpers::point_3d * hp_3pt = dynamic_cast<libkerat::helpers::point_3d *>(new_message);
+                    const libkerat::helpers::point_3d * hp_3pt = dynamic_cast<const libkerat::helpers::point_3d *>(original);
                     
                     libkerat::helpers::point_3d original_position = (hp_3pt != NULL)?*hp_3pt:*hp_2pt;
                     
                     libkerat::helpers::point_3d tmp_coord = apply_viewport_cs(original_position, m_match);
                     // test whether the message isn't trash
-                    if (!in_viewport_box(tmp_coord, m_match)){ 
-                        delete new_message;
-                        new_message = NULL;
-                        continue; 
-                    }
+                    if (!in_viewport_box(tmp_coord, m_match)){ continue; }
                     
-                    libkerat::helpers::movable_2d * hp_2mv = dynamic_cast<libkerat::helpers::movable_2d *>(new_message);
-                    if (hp_2mv != NULL){
+                    if (dynamic_cast<const libkerat::helpers::movable_2d *>(original) != NULL){
+                        new_message = original->clone();
+                        libkerat::helpers::movable_2d * hp_2mv = dynamic_cast<libkerat::helpers::movable_2d *>(new_message);
                         libkerat::helpers::movable_3d * hp_3mv = dynamic_cast<libkerat::helpers::movable_3d *>(new_message);
                         
                         hp_2mv->move_x(m_match.get_width()/2 - m_match.get_x() + tmp_coord.get_x() - original_position.get_x());
@@ -150,8 +149,9 @@ namespace dtuio {
                 }
                 
                 // yet, it still can be rotated
-                libkerat::helpers::rotatable_independent_2d * hp_2r = dynamic_cast<libkerat::helpers::rotatable_independent_2d *>(new_message);
-                if (hp_2r != NULL) {
+                if (dynamic_cast<const libkerat::helpers::rotatable_independent_2d *>(original) != NULL) {
+                    if (new_message == NULL){ new_message = original->clone(); }
+                    libkerat::helpers::rotatable_independent_2d * hp_2r = dynamic_cast<libkerat::helpers::rotatable_independent_2d *>(new_message);
                     libkerat::helpers::rotatable_independent_3d * hp_3r = dynamic_cast<libkerat::helpers::rotatable_independent_3d *>(new_message);
                     
                     if (hp_3r != NULL) {
@@ -163,6 +163,11 @@ namespace dtuio {
                     }
                 }
                 
+                if (new_message == NULL){
+                    bm_handle_insert_shared(output_frame, bm_handle_end(output_frame), original);
+                    continue;
+                }
+
                 bm_handle_insert(output_frame, bm_handle_end(output_frame), new_message);
             }
             
@@ -198,20 +203,24 @@ namespace dtuio {
             if (!m_adaptive) { return; }
 
             viewport_list viewports;
-            const sensor::viewport * msg_vpr = NULL;
+
+            // single pass over the viewports through the bundle's type index
+            typedef std::vector<const sensor::viewport *> viewport_message_list;
+            viewport_message_list received;
+            to_process.get_messages_of_type<sensor::viewport>(received);
             
             // wildcard adaptive matching
             if (helpers::uuid::empty_uuid() == m_match) {
                 viewports.push_back(m_match);
-                for (size_t i = 0; (msg_vpr = to_process.get_message_of_type<sensor::viewport>(i)) != NULL; ++i){
-                    viewports.push_back(*msg_vpr);
+                for (viewport_message_list::const_iterator msg_vpr = received.begin(); msg_vpr != received.end(); ++msg_vpr){
+                    viewports.push_back(**msg_vpr);
                 }
                 
                 m_match = calculate_bounding_viewport(viewports);
             } else {
-                for (size_t i = 0; (msg_vpr = to_process.get_message_of_type<sensor::viewport>(i)) != NULL; ++i) {
-                    if (m_follow != *msg_vpr){ continue; }
-                    m_match = *msg_vpr;
+                for (viewport_message_list::const_iterator msg_vpr = received.begin(); msg_vpr != received.end(); ++msg_vpr){
+                    if (m_follow != **msg_vpr){ continue; }
+                    m_match = **msg_vpr;
                 }
             }
         }
@@ -92,7 +92,8 @@ namespace dtuio {
                             factor_z /= msg_vpt->get_depth();
                         }
                         
-                        // replace viewport dimmensions in output
+                        // replace viewport dimmensions in output, the message may be shared
+                        msg_vpt = static_cast<sensor::viewport *>(bm_handle_detach(to_process, current));
                         msg_vpt->set_width(m_target.get_width());
                         msg_vpt->set_height(m_target.get_height());
                         msg_vpt->set_depth(m_target.get_depth());
@@ -107,7 +108,8 @@ namespace dtuio {
                 if (!interresting){ continue; }
                 
 
-                apply_scale(*current, factor_x, factor_y, factor_z, scale_center);
+                // the message may be shared with other bundles, scale private copy
+                apply_scale(bm_handle_detach(to_process, current), factor_x, factor_y, factor_z, scale_center);
             }
             
             // clean up unused viewports
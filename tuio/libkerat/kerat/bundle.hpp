@@ -11,7 +11,10 @@
 
 #include <kerat/typedefs.hpp>
 #include <kerat/tuio_messages.hpp>
+#include <kerat/message_pool.hpp>
 #include <iterator>
+#include <typeinfo>
+#include <vector>
 #include <list>
 #include <map>
 #include <deque>
@@ -24,13 +27,22 @@ namespace libkerat {
     
     namespace internals {
         class bundle_manipulator;
+        struct message_type_index;
     }
 
     /**
      * \brief Handle for TUIO 2.0 event bundle
      * 
      * The received data is considered to be of WORM character, so internals use
-     * reference counters to hold the data.
+     * reference counters to hold the data. The messages themselves are reference
+     * counted as well, so single message can be held by several bundles.
+     * Such message must not be changed, use \ref internals::bundle_manipulator::bm_handle_detach
+     * to obtain a private copy first.
+     *
+     * The typed lookups share an index of the messages, built on first lookup.
+     * Several threads may read the bundle at once, yet the bundle must not be
+     * modified while other threads read it: a modification drops the index the
+     * readers might be using, so such access needs external synchronization.
      */
     class bundle_handle {
     private:
@@ -38,6 +50,49 @@ namespace libkerat {
         //! \brief Pre-destructor cleanup, manipulates the internal reference counter
         void try_clear();
 
+        //! \brief Adds a reference to message held by another bundle
+        static void message_retain(const kerat_message * message);
+
+        //! \brief Drops the reference to message, deletes the message if it was the last one
+        static void message_release(kerat_message * message);
+
+        //! \brief Checks whether the message is held by more than one bundle
+        static bool message_shared(const kerat_message * message);
+
+        //! \brief Tests whether given message is of the type requested by the caller
+        typedef bool (*message_type_matcher)(const kerat_message * message);
+
+        //! \brief Type matcher for \ref find_message_of_type and \ref collect_messages_of_type
+        template <typename T>
+        static bool message_type_matches(const kerat_message * message){ return dynamic_cast<const T *>(message) != NULL; }
+
+        /**
+         * \brief Gets the type index of this bundle, builds it if not built yet
+         * \return type index valid until the bundle gets modified
+         */
+        const internals::message_type_index & get_type_index() const;
+
+        /**
+         * \brief Finds indexed message of given type using the type index
+         * \param type - the type requested, messages of exactly this type are matched without further tests
+         * \param matcher - decides whether messages of other types match as well
+         * \param index - the position of message to extract (relative to all matching messages)
+         * \return matching message or NULL if such does not exist
+         */
+        const kerat_message * find_message_of_type(const std::type_info & type, message_type_matcher matcher, uint32_t index) const;
+
+        /**
+         * \brief Collects all messages of given type in bundle order using the type index
+         * \param type - the type requested, messages of exactly this type are matched without further tests
+         * \param matcher - decides whether messages of other types match as well
+         * \param output - container to append the matching messages to
+         * \return count of the matching messages
+         */
+        size_t collect_messages_of_type(const std::type_info & type, message_type_matcher matcher, std::vector<const kerat_message *> & output) const;
+
+        //! \brief Counts the messages of given type using the type index, \see collect_messages_of_type
+        size_t count_messages_of_type(const std::type_info & type, message_type_matcher matcher) const;
+
     protected:
 
         //! \brief Internal representation of the event bundle
@@ -47,15 +102,25 @@ namespace libkerat {
             
             void clear();
 
-            typedef std::list<kerat_message *> message_list;
+            //! \brief Drops the type index, must be called whenever the stored messages change, not thread safe
+            void invalidate_index();
+
+            //! \brief Storage nodes come from the recycling pool, so does the handle itself
+            typedef std::list<kerat_message *, internals::pool_allocator<kerat_message *> > message_list;
+
+            static inline void * operator new(size_t size){ return internals::pool_allocate(size); }
+            static inline void operator delete(void * block, size_t size){ internals::pool_release(block, size); }
 
             friend class internals::bundle_manipulator;
             
             //! \brief References to bundle_handle instances using this storage
-            uint32_t reference_count;
+            volatile uint32_t reference_count;
 
             //! \brief The very stored messages
             message_list stored_messages;
+
+            //! \brief Index of stored messages by their type, built on first typed lookup
+            mutable internals::message_type_index * volatile type_index;
         };
 
         /**
@@ -64,6 +129,13 @@ namespace libkerat {
          */
         bundle_handle * clone() const;
 
+        /**
+         * \brief Creates a copy of this frame handle with storage of it's own,
+         * sharing the messages with this handle in copy-on-write manner
+         * \return Newly allocated copy
+         */
+        bundle_handle * clone_shared() const;
+
         /**
          * \brief Flushes the message stack. Adding the frame message does not call this automaticaly
          * \note Affects all bundle_handles that access the same data!
@@ -90,6 +162,12 @@ namespace libkerat {
         //! \brief Accesses the same data as given bundle handle
         bundle_handle & operator=(const bundle_handle & second);
 
+        //! \brief Handles kept in \ref bundle_stack are allocated from the recycling pool
+        static inline void * operator new(size_t size){ return internals::pool_allocate(size); }
+
+        //! \brief Returns the handle memory to the recycling pool
+        static inline void operator delete(void * block, size_t size){ internals::pool_release(block, size); }
+
         /**
          * \brief Gets the bundle opening TUIO 2.0 frame message
          * \return Valid frame message or NULL if not set - possible due to mallformed bundle
@@ -104,31 +182,45 @@ namespace libkerat {
 
         /**
          * \brief Gets the indexed message of given type
+         *
+         * The lookup uses per-bundle type index, built once on first lookup,
+         * so the cost does not depend on the count of messages in the bundle.
+         *
          * \tparam type - type of messages to filter out
          * \param index - the position of message to extract (relative to all messages of this type)
          * \return NULL if pointer with given index does not exist
          */
         template <typename T>
         const T * get_message_of_type(uint32_t index = 0) const {
-        
-            const T * retval = NULL;
-
-            // slow, naive algorithm
-            uint32_t cur = 0;
-            typedef reference_bundle_handle::message_list::const_iterator const_iterator;
-
-            for (const_iterator i = m_messages_held->stored_messages.begin(); (retval == NULL) && (i != m_messages_held->stored_messages.end()); i++){
-                const T * tmp = dynamic_cast<const T *>(*i);
-                if (tmp != NULL){
-                    if (index == cur){
-                        retval = dynamic_cast<const T *>(*i);;
-                    }
-                    ++cur;
-                }
+            return dynamic_cast<const T *>(find_message_of_type(typeid(T), &message_type_matches<T>, index));
+        }
+
+        /**
+         * \brief Gets all messages of given type
+         * \tparam type - type of messages to filter out
+         * \param output - container to append the messages to, in bundle order
+         * \return count of the messages appended
+         */
+        template <typename T>
+        size_t get_messages_of_type(std::vector<const T *> & output) const {
+            std::vector<const kerat_message *> found;
+            collect_messages_of_type(typeid(T), &message_type_matches<T>, found);
+
+            output.reserve(output.size() + found.size());
+            for (std::vector<const kerat_message *>::const_iterator i = found.begin(); i != found.end(); ++i){
+                output.push_back(dynamic_cast<const T *>(*i));
             }
+            return found.size();
+        }
 
-            return retval;
-            
+        /**
+         * \brief Gets the count of messages of given type
+         * \tparam type - type of messages to count
+         * \return count of messages of given type
+         */
+        template <typename T>
+        size_t get_message_count_of_type() const {
+            return count_messages_of_type(typeid(T), &message_type_matches<T>);
         }
 
         /**
@@ -241,16 +333,45 @@ namespace libkerat {
             //! \brief Creates a copy of source handle's messages to destination handles's
             static void bm_handle_copy(const bundle_handle & source, bundle_handle & destination);
 
+            //! \brief Calls \ref bundle_handle::clone_shared
+            static bundle_handle * bm_handle_clone_shared(const bundle_handle & handle);
+
+            /**
+             * \brief Makes destination hold the source handle's messages, the
+             * messages are shared, not copied
+             */
+            static void bm_handle_share(const bundle_handle & source, bundle_handle & destination);
+
+            /**
+             * \brief Inserts message held by other bundle into handle on given position
+             *
+             * The message is shared, not copied; neither of the bundles may change
+             * it unless detached by \ref bm_handle_detach.
+             */
+            static bool bm_handle_insert_shared(bundle_handle & handle, handle_iterator where, const libkerat::kerat_message * message);
+
+            /**
+             * \brief Makes the message on given position private to the handle
+             * \return message that can be safely modified, the original message
+             * if it was not shared, private clone otherwise
+             */
+            static libkerat::kerat_message * bm_handle_detach(bundle_handle & handle, handle_iterator where);
+
             //! \brief Calls \ref bundle_handle::clear
             static void bm_handle_clear(bundle_handle & handle);
             
             //! \brief Inserts message into handle on given position
             static bool bm_handle_insert(bundle_handle & handle, handle_iterator where, libkerat::kerat_message * message);
 
-            //! \brief Erases the message from handle on given position
+            //! \brief Erases the message from handle on given position, releasing it
             static bool bm_handle_erase(bundle_handle & handle, handle_iterator where);
 
-            //! \brief Gets the begin rw iterator for handle
+            /**
+             * \brief Gets the begin rw iterator for handle
+             *
+             * The messages must not be replaced through the iterator, use \ref bm_handle_insert,
+             * \ref bm_handle_erase or \ref bm_handle_detach, which keep the type index up to date.
+             */
             static handle_iterator bm_handle_begin(bundle_handle & handle);
 
             //! \brief Gets the end rw iterator for handle
@@ -0,0 +1,128 @@
+/**
+ * \file      delta_encoding.hpp
+ * \brief     Provides the delta frame encoding extension and its reconstruction
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:31 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_DELTA_ENCODING_HPP
+#define KERAT_DELTA_ENCODING_HPP
+
+#include <kerat/typedefs.hpp>
+#include <kerat/message.hpp>
+#include <kerat/bundle.hpp>
+#include <kerat/tuio_message_frame.hpp>
+#include <string>
+#include <map>
+
+namespace libkerat {
+    namespace internals {
+
+        //! \brief Identifies the TUIO source by its frame message
+        struct source_key {
+            addr_ipv4_t addr;
+            instance_id_t instance;
+            std::string application;
+
+            //! \brief Gets the key of the source that has sent given frame
+            static source_key from_frame(const message::frame & frame);
+
+            bool operator<(const source_key & second) const;
+        };
+
+        /**
+         * \brief Checks whether the message may be left out of delta frame
+         *
+         * Only the per-contact state messages (pointer, token, bounds and
+         * symbol) are subject to the delta encoding, all other messages are
+         * always sent.
+         */
+        bool delta_encodable(const kerat_message * message);
+
+        /**
+         * \brief Checks whether the message state has not changed since the reference
+         *
+         * The positions, angles, velocities and accelerations may differ by
+         * at most epsilon, all other attributes must be the same.
+         *
+         * \param reference - state last sent to the clients
+         * \param current - current state of the same contact
+         * \param epsilon - maximal difference that is not considered a change
+         * \return true if the current state does not have to be sent
+         */
+        bool delta_unchanged(const kerat_message * reference, const kerat_message * current, float epsilon);
+
+        /**
+         * \brief Leaves the unchanged contacts out of the bundles to send
+         *
+         * Every contact message is compared to the state that was last sent
+         * for the same session id and message type, see \ref delta_unchanged.
+         * Frame and alive messages are always kept, so the clients know which
+         * contacts are still present. Every keyframe_interval-th bundle is a
+         * keyframe and carries the full state.
+         */
+        class delta_encoder: protected bundle_manipulator {
+        public:
+
+            /**
+             * \param epsilon - see \ref delta_unchanged
+             * \param keyframe_interval - count of bundles between keyframes,
+             * 0 or 1 means every bundle is a keyframe
+             */
+            delta_encoder(float epsilon, unsigned int keyframe_interval);
+
+            /**
+             * \brief Removes the unchanged contact messages from the complete bundle
+             * \param bundle - full bundle to send, modified in place
+             * \return true if the bundle is a keyframe and was kept whole
+             */
+            bool encode(bundle_handle & bundle);
+
+            //! \brief Forgets the sent state, next bundle will be a keyframe
+            void reset();
+
+            inline float get_epsilon() const { return m_epsilon; }
+            inline unsigned int get_keyframe_interval() const { return m_keyframe_interval; }
+
+        private:
+            float m_epsilon;
+            unsigned int m_keyframe_interval;
+            unsigned int m_since_keyframe;
+            bool m_keyframe_pending;
+
+            //! \brief The last sent message of every contact
+            bundle_handle m_sent_state;
+        };
+
+        /**
+         * \brief Rebuilds the full bundles from delta encoded ones
+         *
+         * Contact messages of the sessions that are alive but missing in the
+         * bundle are taken over from the previous reconstructed bundle of the
+         * same source, so the listeners always see the full state. The taken
+         * over messages are shared, not copied, and are placed just before
+         * the alive message.
+         */
+        class delta_decoder: protected bundle_manipulator {
+        public:
+
+            /**
+             * \brief Completes the bundle ended by alive message
+             * \param bundle - received bundle, modified in place
+             * \return count of messages taken over from the previous bundle
+             */
+            size_t decode(bundle_handle & bundle);
+
+            //! \brief Forgets the state of all the sources
+            void reset();
+
+        private:
+            typedef std::map<source_key, bundle_handle> source_map;
+            source_map m_sources;
+        };
+
+    } // ns internals
+} // ns libkerat
+
+#endif // KERAT_DELTA_ENCODING_HPP
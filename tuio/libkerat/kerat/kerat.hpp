@@ -22,6 +22,8 @@
 #include <kerat/utils.hpp>
 
 #include <kerat/simple_client.hpp>
+#include <kerat/threaded_client.hpp>
+#include <kerat/multi_client.hpp>
 #include <kerat/simple_server.hpp>
 #include <kerat/kerat_adaptors.hpp>
 #include <kerat/kerat_listeners.hpp>
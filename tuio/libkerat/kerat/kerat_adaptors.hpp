@@ -11,6 +11,7 @@
 
 #include <kerat/scaling_adaptor.hpp>
 #include <kerat/multiplexing_adaptor.hpp>
+#include <kerat/sharded_multiplexing_adaptor.hpp>
 #include <kerat/append_adaptor.hpp>
 
 #endif // KERAT_ADAPTORS_HPP
@@ -10,12 +10,14 @@
 #define KERAT_MESSAGE_HPP
 
 #include <kerat/typedefs.hpp>
+#include <kerat/message_pool.hpp>
 #include <lo/lo.h>
 #include <ostream>
 
 namespace libkerat {
 
     class server;
+    class bundle_handle;
 
     //! \brief A common ancestor for all message classes handled by the kerat library
     class kerat_message {
@@ -36,10 +38,17 @@ namespace libkerat {
          */
         virtual void print(std::ostream & output) const = 0;
 
+        //! \brief Messages are allocated from the recycling pool, see \ref internals::pool_allocate
+        static inline void * operator new(size_t size){ return internals::pool_allocate(size); }
+
+        //! \brief Returns the message memory to the recycling pool
+        static inline void operator delete(void * block, size_t size){ internals::pool_release(block, size); }
+
     protected:
         kerat_message(){ ; }
 
         friend class server;
+        friend class bundle_handle;
 
         /**
          * \brief Imprints the target bundle with OSC messages
@@ -50,6 +59,27 @@ namespace libkerat {
          */
         virtual bool imprint_lo_messages(lo_bundle target) const = 0;
 
+    private:
+
+        //! \brief Reference counter that is never copied, the copy is not shared regardless of the original
+        struct reference_counter {
+            reference_counter():count(1){ ; }
+            reference_counter(const reference_counter & original __attribute__((unused))):count(1){ ; }
+
+            //! \brief Keeps the counter of the target untouched
+            reference_counter & operator=(const reference_counter & original __attribute__((unused))){ return *this; }
+
+            volatile uint32_t count;
+        };
+
+        /**
+         * \brief Count of bundles holding this message
+         *
+         * Messages are shared by the bundles in copy-on-write manner, see
+         * \ref internals::bundle_manipulator::bm_handle_insert_shared
+         */
+        mutable reference_counter m_references;
+
     }; // cls kerat_message
 
 } // ns libkerat
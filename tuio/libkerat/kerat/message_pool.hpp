@@ -0,0 +1,117 @@
+/**
+ * \file      message_pool.hpp
+ * \brief     Provides recycling allocator for the messages and bundle storage
+ * \author    agent <agent@local>
+ * \date      2026-10-17 02:56 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_MESSAGE_POOL_HPP
+#define KERAT_MESSAGE_POOL_HPP
+
+#include <kerat/typedefs.hpp>
+#include <cstddef>
+#include <new>
+
+namespace libkerat {
+    namespace internals {
+
+        /**
+         * \brief Allocates block of memory from the recycling pool
+         *
+         * Blocks are sorted into size classes, released blocks are kept in
+         * per-thread free lists and handed out again on subsequent requests
+         * of the same class, so the steady-state frame processing does not
+         * touch the system allocator at all. Blocks too large for any size
+         * class are passed to the global operator new.
+         *
+         * Blocks allocated by one thread and released by another, such as
+         * bundles passed from a receiving thread to a worker, return through
+         * a shared depot: a full free list gives a batch of blocks to the
+         * depot, an empty one takes a batch from it.
+         *
+         * \param size - requested block size in bytes
+         * \return pointer to the allocated block
+         * \throw std::bad_alloc when the memory cannot be allocated
+         */
+        void * pool_allocate(size_t size);
+
+        /**
+         * \brief Returns block of memory to the recycling pool
+         * \param block - block previously returned by \ref pool_allocate, NULL is ignored
+         * \param size - the size the block was allocated with
+         */
+        void pool_release(void * block, size_t size) throw ();
+
+        /**
+         * \brief Releases all blocks cached by the calling thread
+         *
+         * Should be called by threads that processed messages before they
+         * terminate, otherwise their cached blocks are never given back.
+         * The batches in the shared depot are kept for the other threads.
+         */
+        void pool_trim() throw ();
+
+        /**
+         * \brief Enables or disables the recycling
+         *
+         * With recycling disabled, every allocation is passed to the global
+         * operator new, which makes memory debuggers report the individual
+         * messages again.
+         *
+         * \param enabled - true to recycle the released blocks
+         * \return previous setting
+         */
+        bool pool_set_recycling(bool enabled);
+
+        /**
+         * \brief STL compliant allocator backed by the recycling pool
+         * \tparam T - type of allocated objects
+         */
+        template <typename T>
+        class pool_allocator {
+        public:
+            typedef T value_type;
+            typedef T * pointer;
+            typedef const T * const_pointer;
+            typedef T & reference;
+            typedef const T & const_reference;
+            typedef size_t size_type;
+            typedef ptrdiff_t difference_type;
+
+            template <typename U>
+            struct rebind { typedef pool_allocator<U> other; };
+
+            pool_allocator() throw () { ; }
+            pool_allocator(const pool_allocator &) throw () { ; }
+
+            template <typename U>
+            pool_allocator(const pool_allocator<U> &) throw () { ; }
+
+            ~pool_allocator() throw () { ; }
+
+            inline pointer address(reference value) const { return &value; }
+            inline const_pointer address(const_reference value) const { return &value; }
+
+            inline pointer allocate(size_type count, const void * hint __attribute__((unused)) = NULL){
+                return static_cast<pointer>(pool_allocate(count * sizeof(T)));
+            }
+
+            inline void deallocate(pointer block, size_type count){ pool_release(block, count * sizeof(T)); }
+
+            inline size_type max_size() const throw () { return static_cast<size_type>(-1) / sizeof(T); }
+
+            inline void construct(pointer where, const T & value){ new (static_cast<void *>(where)) T(value); }
+            inline void destroy(pointer where){ where->~T(); }
+        };
+
+        template <typename T, typename U>
+        inline bool operator==(const pool_allocator<T> &, const pool_allocator<U> &){ return true; }
+
+        template <typename T, typename U>
+        inline bool operator!=(const pool_allocator<T> &, const pool_allocator<U> &){ return false; }
+
+    } // ns internals
+} // ns libkerat
+
+#endif // KERAT_MESSAGE_POOL_HPP
@@ -0,0 +1,210 @@
+/**
+ * \file      multi_client.hpp
+ * \brief     Provides tuio client that listens on multiple sockets at once.
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:13 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_MULTI_CLIENT_HPP
+#define KERAT_MULTI_CLIENT_HPP
+
+#include <lo/lo.h>
+#include <kerat/typedefs.hpp>
+#include <kerat/client.hpp>
+#include <kerat/bundle.hpp>
+#include <kerat/parsers.hpp>
+#include <kerat/exceptions.hpp>
+#include <kerat/simple_client.hpp>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace libkerat {
+
+    /**
+     * \brief TUIO 2.0 network client listening on any number of UDP and TCP ports
+     *
+     * All the sockets are watched by single epoll instance, so one \ref load
+     * call serves every source. Each source is parsed by its own
+     * \ref simple_client, so the bundles of different sources never mix, and
+     * every bundle in the stack is tagged by the source it came from, see
+     * \ref get_source_tags.
+     *
+     * TCP sources accept any number of connections, the OSC packets are
+     * expected to be prefixed by 32-bit big endian length as liblo does.
+     */
+    class multi_client: public client {
+    public:
+
+        //! \brief Identifies the source within this client
+        typedef uint32_t source_tag_t;
+
+        //! \brief Source tags of the bundles in the stack, oldest first
+        typedef std::deque<source_tag_t> source_tag_list;
+
+        /**
+         * \brief Create a new client with no sources
+         * \param accept_unknown - whether to accept unknown messages and pass
+         * them over as \ref libkerat::message::generic_osc_message; defaults to true
+         * \throw libkerat::exception::net_setup_error when the epoll instance cannot be created
+         */
+        multi_client(bool accept_unknown = true) throw (libkerat::exception::net_setup_error);
+
+        ~multi_client();
+
+        /**
+         * \brief Start listening on given port
+         * \param port - port to listen on
+         * \param protocol - either LO_UDP or LO_TCP
+         * \return tag of the newly created source
+         * \throw libkerat::exception::net_setup_error when fails to setup listenning on given port
+         */
+        source_tag_t add_port(uint16_t port, int protocol = LO_UDP) throw (libkerat::exception::net_setup_error);
+
+        /**
+         * \brief Stop listening on socket of given source, closes all its connections
+         * \param tag - tag of the source to remove
+         * \return true if such source existed
+         */
+        bool del_source(source_tag_t tag);
+
+        //! \brief Gets the count of sources of this client
+        inline size_t get_source_count() const { return m_sources.size(); }
+
+        /**
+         * \brief Gets the client parsing data of given source, for custom convertor setup
+         * \param tag - tag of the source
+         * \return client of the source or NULL if no such source exists
+         */
+        simple_client * get_source_client(source_tag_t tag) const;
+
+        /**
+         * \brief Gets the count of bundles received from given source
+         * \param tag - tag of the source
+         * \return bundles received so far, 0 if no such source exists
+         */
+        uint64_t get_source_bundles_count(source_tag_t tag) const;
+
+        /**
+         * \brief Enable given message convertor for all present and future sources
+         * \param convertor - convertor entry that should be enabled
+         */
+        void enable_convertor(const simple_client::message_convertor_entry & convertor);
+
+        /**
+         * \brief Enable given message convertors for all present and future sources
+         * \param convertors - convertor entries that should be enabled
+         */
+        void enable_convertors(const internals::convertor_list & convertors);
+
+        /**
+         * \brief Enable or disable native OSC decoding for all present and future sources
+         * \see simple_client::set_native_decoding
+         * \param flag - true to enable native decoding
+         * \return previous setting
+         */
+        bool set_native_decoding(bool flag);
+
+        //! \brief Check whether the native OSC decoding is in effect
+        inline bool get_native_decoding() const { return m_native; }
+
+        /**
+         * \brief Enable or disable delta frame reconstruction for all present and future sources
+         * \see simple_client::set_delta_reconstruction
+         * \param flag - true to enable the reconstruction
+         * \return previous setting
+         */
+        bool set_delta_reconstruction(bool flag);
+
+        //! \brief Check whether the delta frame reconstruction is in effect
+        inline bool get_delta_reconstruction() const { return m_delta; }
+
+        bool load(int count = 1);
+
+        bool load(int count, struct timespec timeout);
+
+        void purge();
+
+        bundle_stack get_stack() const;
+
+        /**
+         * \brief Gets the source tags of the bundles loaded
+         * \return tags in the same order as the bundles of \ref get_stack
+         */
+        inline source_tag_list get_source_tags() const { return m_received_sources; }
+
+    private:
+
+        struct source_entry;
+
+        //! \brief Socket watched by the epoll instance
+        struct socket_entry {
+            typedef enum { DATAGRAM, LISTENER, STREAM } socket_kind;
+
+            int fd;
+            socket_kind kind;
+            source_entry * source;
+
+            //! \brief Incomplete OSC packet of the stream sockets
+            std::vector<char> pending;
+        };
+
+        typedef std::vector<socket_entry *> socket_list;
+
+        struct source_entry {
+            source_tag_t tag;
+            lo_server server;
+            simple_client * parser;
+            uint64_t bundles;
+
+            //! \brief Datagram or listening socket followed by the accepted connections
+            socket_list sockets;
+        };
+
+        typedef std::map<source_tag_t, source_entry *> source_map;
+
+        multi_client(const multi_client &);
+        multi_client & operator=(const multi_client &);
+
+        bool watch_socket(source_entry * source, int fd, socket_entry::socket_kind kind);
+
+        //! \brief Stops watching the socket, the entry is released by \ref release_closed
+        void close_socket(socket_entry * socket);
+        void release_closed();
+        void free_source(source_entry * source);
+
+        //! \brief Drains the socket, returns count of OSC packets dispatched
+        int read_socket(socket_entry * socket);
+        int read_datagrams(socket_entry * socket);
+        int read_stream(socket_entry * socket);
+        void accept_connections(socket_entry * socket);
+
+        //! \brief Moves the bundles completed by the source parser to this client's stack
+        void collect_bundles(source_entry * source);
+
+        int m_epoll_fd;
+        bool m_accept_unknown;
+        bool m_native;
+        bool m_delta;
+
+        source_map m_sources;
+        source_tag_t m_next_tag;
+
+        internals::convertor_list m_convertors;
+
+        //! \brief Receive buffer shared by all the datagram sockets
+        std::vector<char> m_datagram_buffer;
+
+        //! \brief Sockets closed while handling the events, epoll might still report them
+        socket_list m_closed;
+
+        bundle_stack m_received_frames;
+        source_tag_list m_received_sources;
+
+    }; // cls multi_client
+
+} // ns libkerat
+
+#endif // KERAT_MULTI_CLIENT_HPP
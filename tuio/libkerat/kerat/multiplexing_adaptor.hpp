@@ -13,6 +13,11 @@
 #include <kerat/typedefs.hpp>
 #include <kerat/adaptor.hpp>
 #include <kerat/session_manager.hpp>
+#include <kerat/session_id_table.hpp>
+#include <kerat/tuio_message_alive.hpp>
+#include <kerat/tuio_message_alive_associations.hpp>
+#include <vector>
+#include <map>
 
 namespace libkerat {
 
@@ -23,7 +28,7 @@ namespace libkerat {
         public:
 
             //! \brief Create a new multiplexing adaptor
-            multiplexing_adaptor(){ ; }
+            multiplexing_adaptor();
 
             virtual ~multiplexing_adaptor(){ ; }
 
@@ -45,13 +50,16 @@ namespace libkerat {
              */
             int process_bundle(const bundle_handle & to_process, bundle_handle & output_frame);
 
-        private:
+        protected:
+            //! \brief Interned source, index to the source states
+            typedef size_t source_index;
 
-            //! \brief The mapping type that holds actual id to id mapping
-            typedef std::map<libkerat::session_id_t, libkerat::session_id_t> internal_session_id_map;
+        private:
 
             //! \brief The type uniquely identyfying the source.
             typedef struct source_key_type {
+                source_key_type();
+
                 bool operator<(const source_key_type & second) const ;
 
                 //! \brief Source IPv4 address of the bundle
@@ -62,11 +70,32 @@ namespace libkerat {
                 std::string application;
             } source_key_type;
 
-            //! \brief The mapping type that holds the id mapping for source
-            typedef std::map<source_key_type, internal_session_id_map> session_id_map;
+            //! \brief Maps the source to its interned index
+            typedef std::map<source_key_type, source_index> source_index_map;
 
-            //! \brief The type that holds alive associations
-            typedef std::map<source_key_type, libkerat::message::alive_associations::associated_ids> associations_map;
+            //! \brief Everything known about single source
+            struct source_state {
+                //! \brief Session id mapping of the source
+                internals::session_id_table mapping;
+                //! \brief Source session ids listed in the last alive message
+                libkerat::message::alive::alive_ids alive;
+                //! \brief Source session ids mapped since the last alive message
+                std::vector<libkerat::session_id_t> fresh;
+                //! \brief Alive associations of the source
+                libkerat::message::alive_associations::associated_ids associations;
+            };
+
+            typedef std::vector<source_state> source_state_vector;
+
+            /**
+             * \brief Gets the interned index of the source that has sent the frame
+             *
+             * Sources are never forgotten, thus the index is stable.
+             */
+            source_index intern_source(const message::frame & frame);
+
+            //! \brief Drops the mapping of the source id and its global alive entry
+            void remove_mapping(source_state & state, const libkerat::session_id_t sid);
 
         protected:
             /**
@@ -79,18 +108,20 @@ namespace libkerat {
              * \param sid    - session id to map from
              * \return session id that corresponds to the unique combination of source and sid
              */
-            libkerat::session_id_t get_mapped_id(const source_key_type & source, const libkerat::session_id_t sid);
+            libkerat::session_id_t get_mapped_id(const source_index source, const libkerat::session_id_t sid);
 
             /**
              * \brief Removes the dead session id's
              *
              * Removes the dead session id's received from source from the session
-             * mapping and possibly creates new mappings if the corresponding mapping did not exist yet
+             * mapping and possibly creates new mappings if the corresponding mapping did not exist yet.
+             * Only the ids that have changed since the last update are touched
+             * in the mapping and the global alive set.
              *
              * \param source - source from which the id set came
              * \param update - the update id set
              */
-            void update_alives(const source_key_type & source, const message::alive::alive_ids & update);
+            void update_alives(const source_index source, const message::alive::alive_ids & update);
 
             /**
              * \brief Removes the dead associations and adds new
@@ -101,14 +132,14 @@ namespace libkerat {
              * \param source - source from which the id set came
              * \param update - the update id set
              */
-            void update_associations(const source_key_type & source, const message::alive_associations::associated_ids & update);
+            void update_associations(const source_index source, const message::alive_associations::associated_ids & update);
             /**
              * \brief remap session id's in association-type messages
              * \tparam T - association class message to run remapping process on
              * \param[in,out] message - message to run remapping on
              * \param source - source of the bundle conatining the message remapped
              */
-            template <class T> void rempap_associated_ids(T & message, const source_key_type & source);
+            template <class T> void rempap_associated_ids(T & message, const source_index source);
 
             /**
              * \brief remap session id's in link topology messages
@@ -116,17 +147,48 @@ namespace libkerat {
              * \param[in,out] message - message to run remapping on
              * \param source - source of the bundle conatining the message remapped
              */
-            template <class T> void rempap_links(T & message, const source_key_type & source);
+            template <class T> void rempap_links(T & message, const source_index source);
 
-            //! \brief generate new alive message content
-            libkerat::message::alive::alive_ids get_alives() const;
+            //! \brief get the mapped ids of all the sources, maintained incrementally
+            inline const libkerat::message::alive::alive_ids & get_alives() const { return m_alives; }
 
             //! \brief generate new alive association message content
             libkerat::message::alive_associations::associated_ids get_associations() const;
 
+            /**
+             * \brief Allocates the session id for new mapping and marks it alive
+             *
+             * This and the following methods are the only ones touching the
+             * state shared by all the sources, override them to share the
+             * session id space and the alive output with other multiplexors.
+             *
+             * \return newly allocated session id
+             */
+            virtual libkerat::session_id_t allocate_mapped_id();
+
+            /**
+             * \brief Releases the mapped session id, it is no longer alive
+             * \param mapped - session id returned by \ref allocate_mapped_id
+             */
+            virtual void release_mapped_id(const libkerat::session_id_t mapped);
+
+            /**
+             * \brief Sets the alive message content to the ids alive in all the sources
+             * \param[out] message - alive message to fill
+             */
+            virtual void merge_alives(message::alive & message) const;
+
+            /**
+             * \brief Stores the associations of the source and merges them with the others
+             * \param source - source of the bundle containing the message
+             * \param[in,out] message - alive associations of the source, replaced by the merged ones
+             */
+            virtual void merge_associations(const source_index source, message::alive_associations & message);
+
         private:
-            session_id_map m_mapping;
-            associations_map m_associations;
+            source_index_map m_source_indexes;
+            source_state_vector m_sources;
+            libkerat::message::alive::alive_ids m_alives;
             bundle_stack m_processed_frames;
 
         };
@@ -0,0 +1,126 @@
+/**
+ * \file      osc_decoder.hpp
+ * \brief     Provides in-place OSC packet decoder dispatching on path hashes
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:18 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_OSC_DECODER_HPP
+#define KERAT_OSC_DECODER_HPP
+
+#include <lo/lo.h>
+#include <kerat/typedefs.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace libkerat {
+    namespace internals {
+
+        /**
+         * \brief OSC packet decoder that works directly on the received datagram
+         *
+         * Message paths are looked up in open addressing table of precomputed
+         * path hashes. For the known paths, the arguments are converted to host
+         * byte order in place and handed over as lo_arg array pointing into the
+         * packet, laid out exactly as liblo lays out the arguments of received
+         * messages, so the standard convertors can be used unchanged. Nothing
+         * is allocated per message.
+         *
+         * \note Unlike liblo, bundle timetags are not honoured, all the messages
+         * are dispatched immediately, in the order they appear in the packet.
+         */
+        class osc_decoder {
+        public:
+
+            /**
+             * \brief Called for every message whose path has a target set
+             * \param target - target registered for the path
+             * \param path - OSC path of the message
+             * \param types - type tags of the arguments, without the leading comma
+             * \param argv - the arguments, pointing into the decoded packet
+             * \param argc - count of the arguments
+             * \param user_data - user data given to the decoder
+             */
+            typedef void (*message_handler)(void * target, const char * path, const char * types, lo_arg ** argv, int argc, void * user_data);
+
+            /**
+             * \brief Called for every message whose path has no target set
+             * \param path - OSC path of the message
+             * \param message - the untouched serialised message
+             * \param size - size of the serialised message
+             * \param user_data - user data given to the decoder
+             */
+            typedef void (*unknown_handler)(const char * path, void * message, size_t size, void * user_data);
+
+            /**
+             * \brief Create a new decoder with no paths known
+             * \param handler - handler for the known messages
+             * \param unknown - handler for the unknown messages, can be NULL
+             * \param user_data - data to pass to the handlers
+             */
+            osc_decoder(message_handler handler, unknown_handler unknown, void * user_data);
+
+            /**
+             * \brief Set the target for given OSC path
+             * \param path - exact OSC path, patterns are not supported
+             * \param target - target to pass to the message handler, NULL removes the path
+             */
+            void set_target(const std::string & path, void * target);
+
+            /**
+             * \brief Get the target of given OSC path
+             * \param path - OSC path to look up
+             * \return target set for the path or NULL if none
+             */
+            void * get_target(const char * path) const;
+
+            /**
+             * \brief Decodes the OSC packet, calling the handlers for every message
+             * \note The packet is modified in place, it can be decoded only once
+             * \param packet - OSC message or bundle
+             * \param size - size of the packet in bytes
+             * \note Messages with argument types of unknown size are skipped
+             * \return false if the packet is malformed, the messages preceding
+             * the malformed part have already been dispatched
+             */
+            bool decode(void * packet, size_t size);
+
+            //! \brief Computes the hash of given OSC path, as used by the lookup table
+            static uint32_t path_hash(const char * path);
+
+        private:
+
+            struct path_slot {
+                uint32_t hash;
+                std::string path;
+                void * target;
+            };
+
+            typedef std::vector<path_slot> path_table;
+
+            bool decode_element(char * data, size_t size, unsigned int depth);
+            bool decode_message(char * data, size_t size);
+
+            void * find_target(const char * path, uint32_t hash) const;
+
+            //! \brief Rebuilds the lookup table, so it has at least twice as many slots as paths
+            void rebuild_table();
+
+            message_handler m_handler;
+            unknown_handler m_unknown;
+            void * m_user_data;
+
+            path_table m_table;
+            size_t m_mask;
+
+            //! \brief Arguments of the message being dispatched, reused between messages
+            std::vector<lo_arg *> m_argv;
+
+        }; // cls osc_decoder
+
+    } // ns internals
+} // ns libkerat
+
+#endif // KERAT_OSC_DECODER_HPP
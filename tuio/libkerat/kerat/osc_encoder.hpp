@@ -0,0 +1,89 @@
+/**
+ * \file      osc_encoder.hpp
+ * \brief     Provides direct OSC serialisation of the common TUIO messages
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:22 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_OSC_ENCODER_HPP
+#define KERAT_OSC_ENCODER_HPP
+
+#include <lo/lo.h>
+#include <kerat/typedefs.hpp>
+#include <kerat/message.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace libkerat {
+    namespace internals {
+
+        /**
+         * \brief Serialises TUIO bundles into reusable buffer without liblo
+         *
+         * Frame, alive, pointer and bounds messages are written straight into
+         * the buffer in the very same layout \ref kerat_message::imprint_lo_messages
+         * followed by lo_bundle_serialise produce, so the output is byte identical.
+         * The buffer is kept between bundles, so the steady state encoding does
+         * not allocate at all.
+         */
+        class osc_encoder {
+        public:
+
+            /**
+             * \brief Create a new encoder
+             * \param initial_capacity - initial size of the buffer in bytes
+             */
+            explicit osc_encoder(size_t initial_capacity = 4096);
+
+            /**
+             * \brief Discards the buffer contents and starts a new OSC bundle
+             * \param timetag - timetag of the bundle
+             */
+            void begin_bundle(const lo_timetag & timetag);
+
+            /**
+             * \brief Serialises the message into the bundle
+             * \param message - message to serialise
+             * \return false if the message type is not supported, see \ref supports
+             */
+            bool append(const kerat_message * message);
+
+            /**
+             * \brief Checks whether the message can be serialised by this encoder
+             * \param message - message to check
+             * \return true for frame, alive, pointer and bounds messages
+             */
+            static bool supports(const kerat_message * message);
+
+            //! \brief Gets the serialised bundle
+            inline const char * data() const { return &m_buffer[0]; }
+
+            //! \brief Gets the size of the serialised bundle
+            inline size_t size() const { return m_size; }
+
+        private:
+
+            void begin_message(const char * path, const char * types);
+            void end_message();
+
+            void put_int32(uint32_t value);
+            void put_float(float value);
+            void put_string(const char * value);
+            void put_timetag(const lo_timetag & value);
+
+            //! \brief Makes room for given count of bytes, returns where to write them
+            char * reserve(size_t length);
+
+            std::vector<char> m_buffer;
+            size_t m_size;
+
+            //! \brief Offset of the size field of the message being written
+            size_t m_message_start;
+
+        }; // cls osc_encoder
+
+    } // ns internals
+} // ns libkerat
+
+#endif // KERAT_OSC_ENCODER_HPP
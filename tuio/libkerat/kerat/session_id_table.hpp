@@ -0,0 +1,162 @@
+/**
+ * \file      session_id_table.hpp
+ * \brief     Provides the open-addressing session id to session id map
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:47 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_SESSION_ID_TABLE_HPP
+#define KERAT_SESSION_ID_TABLE_HPP
+
+#include <kerat/typedefs.hpp>
+#include <vector>
+#include <cstddef>
+
+namespace libkerat {
+    namespace internals {
+
+        /**
+         * \brief Hash map from session id to session id
+         *
+         * Linear probing with backward shift deletion, thus no tombstones are
+         * left behind and the lookups stay short no matter how many ids have
+         * come and gone. The table allocates only when it grows, which happens
+         * when it gets half full.
+         */
+        class session_id_table {
+        public:
+
+            /**
+             * \brief Creates a new, empty table
+             * \param capacity - expected count of ids held, rounded up to power of two
+             */
+            explicit session_id_table(size_t capacity = 16)
+                :m_mask(0), m_shift(32), m_size(0)
+            {
+                size_t real_capacity = 2;
+                while (real_capacity < (capacity * 2)){ real_capacity <<= 1; }
+                allocate(real_capacity);
+            }
+
+            /**
+             * \brief Finds the value mapped to the key
+             * \param key - id to look up
+             * \param value - output, the mapped id if found
+             * \return true if found
+             */
+            bool find(session_id_t key, session_id_t & value) const {
+                for (size_t i = home(key); m_slots[i].used; i = (i + 1) & m_mask){
+                    if (m_slots[i].key == key){
+                        value = m_slots[i].value;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * \brief Maps the key to the value unless the key is already mapped
+             * \return true if inserted, false if the key was already present
+             */
+            bool insert(session_id_t key, session_id_t value){
+                if (((m_size + 1) * 2) > m_slots.size()){ grow(); }
+
+                size_t i = home(key);
+                for (; m_slots[i].used; i = (i + 1) & m_mask){
+                    if (m_slots[i].key == key){ return false; }
+                }
+
+                m_slots[i].key = key;
+                m_slots[i].value = value;
+                m_slots[i].used = true;
+                ++m_size;
+
+                return true;
+            }
+
+            /**
+             * \brief Removes the key
+             * \param key - id to remove
+             * \param value - output, the id the key was mapped to
+             * \return true if the key was present
+             */
+            bool erase(session_id_t key, session_id_t & value){
+                size_t hole = home(key);
+                for (; m_slots[hole].used; hole = (hole + 1) & m_mask){
+                    if (m_slots[hole].key == key){ break; }
+                }
+                if (!m_slots[hole].used){ return false; }
+
+                value = m_slots[hole].value;
+
+                // move back the entries that would not be reachable over the hole
+                for (size_t next = (hole + 1) & m_mask; m_slots[next].used; next = (next + 1) & m_mask){
+                    size_t wanted = home(m_slots[next].key);
+                    if (((next - wanted) & m_mask) >= ((next - hole) & m_mask)){
+                        m_slots[hole] = m_slots[next];
+                        hole = next;
+                    }
+                }
+
+                m_slots[hole].used = false;
+                --m_size;
+
+                return true;
+            }
+
+            //! \brief Gets the count of the mapped ids
+            inline size_t size() const { return m_size; }
+
+            //! \brief Removes all the ids, the memory is kept
+            void clear(){
+                for (size_t i = 0; i < m_slots.size(); ++i){ m_slots[i].used = false; }
+                m_size = 0;
+            }
+
+        private:
+
+            struct slot {
+                slot():key(0), value(0), used(false){ ; }
+
+                session_id_t key;
+                session_id_t value;
+                bool used;
+            };
+
+            typedef std::vector<slot> slot_vector;
+
+            //! \brief Fibonacci hashing, spreads the sequential ids well
+            inline size_t home(session_id_t key) const {
+                return (size_t)((uint32_t)(key * 2654435769U) >> m_shift) & m_mask;
+            }
+
+            void allocate(size_t capacity){
+                m_slots.assign(capacity, slot());
+                m_mask = capacity - 1;
+                m_shift = 32;
+                for (size_t i = capacity; i > 1; i >>= 1){ --m_shift; }
+                m_size = 0;
+            }
+
+            void grow(){
+                slot_vector original;
+                original.swap(m_slots);
+
+                allocate(original.size() * 2);
+                for (slot_vector::const_iterator i = original.begin(); i != original.end(); ++i){
+                    if (i->used){ insert(i->key, i->value); }
+                }
+            }
+
+            slot_vector m_slots;
+            size_t m_mask;
+            unsigned int m_shift;
+            size_t m_size;
+
+        }; // cls session_id_table
+
+    } // ns internals
+} // ns libkerat
+
+#endif // KERAT_SESSION_ID_TABLE_HPP
@@ -0,0 +1,161 @@
+/**
+ * \file      sharded_multiplexing_adaptor.hpp
+ * \brief     Provides the multiplexing adaptor processing the sources in parallel
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:51 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_SHARDED_MULTIPLEXING_ADAPTOR_HPP
+#define KERAT_SHARDED_MULTIPLEXING_ADAPTOR_HPP
+
+#include <kerat/typedefs.hpp>
+#include <kerat/adaptor.hpp>
+#include <kerat/session_manager.hpp>
+#include <kerat/multiplexing_adaptor.hpp>
+#include <pthread.h>
+#include <vector>
+#include <map>
+
+namespace libkerat {
+
+    namespace adaptors {
+
+        /**
+         * \brief Multiplexing adaptor that processes bundles of different sources concurrently
+         *
+         * The sources are split into shards by hashing the source address,
+         * instance and application name. Each shard is an ordinary
+         * \ref multiplexing_adaptor run by its own worker thread, so the
+         * bundles of single source are always processed by the same thread in
+         * the order received. Only the session id allocation and the merged
+         * alive and alive associations content are serialized.
+         *
+         * The output keeps the order of the input. Alive messages contain ids
+         * of all the sources as seen at the time of processing, thus ids of
+         * the concurrently processed bundles might already be in or not yet.
+         */
+        class sharded_multiplexing_adaptor: public adaptor, private internals::session_manager {
+        public:
+
+            //! \brief Default count of the shards
+            static const size_t DEFAULT_SHARDS = 4;
+
+            /**
+             * \brief Create a new sharded multiplexing adaptor and start the workers
+             *
+             * The notifying thread processes the first shard itself, so
+             * shards - 1 worker threads are started. If any of them fails to
+             * start, all the shards are processed by the notifying thread.
+             *
+             * \param shards - count of the shards, 0 is taken as 1
+             */
+            explicit sharded_multiplexing_adaptor(size_t shards = DEFAULT_SHARDS);
+
+            //! \brief Stops the workers
+            virtual ~sharded_multiplexing_adaptor();
+
+            void notify(const client * notifier);
+
+            void purge();
+
+            bundle_stack get_stack() const { return m_processed_frames; }
+
+            /**
+             * \brief Map session ids of the received bundle to this multiplexor scope
+             *
+             * Processed on the calling thread by the shard of the bundle source.
+             *
+             * \param to_process - received frame handle
+             * \param output_frame - mapped frame handle
+             * \return 0 if all contained session ids were remapped, negative number if an error has occured
+             */
+            int process_bundle(const bundle_handle & to_process, bundle_handle & output_frame);
+
+            //! \brief Gets the count of the shards
+            inline size_t get_shard_count() const { return m_shards.size(); }
+
+            //! \brief Checks whether the worker threads are running
+            inline bool is_parallel() const { return m_parallel; }
+
+        private:
+
+            //! \brief Multiplexor of single shard, shares the session ids with the others
+            class shard: public multiplexing_adaptor {
+            public:
+                shard(sharded_multiplexing_adaptor & owner, size_t index);
+
+            protected:
+                libkerat::session_id_t allocate_mapped_id();
+                void release_mapped_id(const libkerat::session_id_t mapped);
+                void merge_alives(message::alive & message) const;
+                void merge_associations(const source_index source, message::alive_associations & message);
+
+            private:
+                sharded_multiplexing_adaptor & m_owner;
+                size_t m_index;
+            };
+
+            //! \brief Worker thread context
+            struct worker {
+                sharded_multiplexing_adaptor * owner;
+                size_t shard;
+                pthread_t thread;
+            };
+
+            //! \brief Bundle to process along with its result
+            struct batch_item {
+                bundle_handle input;
+                bundle_handle * output;
+            };
+
+            typedef std::vector<shard *> shard_vector;
+            typedef std::vector<worker> worker_vector;
+            typedef std::vector<batch_item> batch_vector;
+            typedef std::vector<std::vector<size_t> > shard_items;
+
+            //! \brief Associations of single source, keyed by shard and interned source
+            typedef std::map<std::pair<size_t, size_t>, message::alive_associations::associated_ids> associations_map;
+
+            sharded_multiplexing_adaptor(const sharded_multiplexing_adaptor &);
+            sharded_multiplexing_adaptor & operator=(const sharded_multiplexing_adaptor &);
+
+            static void * worker_thread(void * context);
+
+            //! \brief Gets the shard processing the bundle source
+            size_t get_shard_index(const bundle_handle & bundle) const;
+
+            //! \brief Processes the items of the current batch assigned to the shard
+            void process_shard(size_t index);
+
+            //! \brief Stops and joins the workers started so far
+            void stop_workers();
+
+            shard_vector m_shards;
+            worker_vector m_workers;
+            bool m_parallel;
+
+            // the state shared by the shards
+            pthread_mutex_t m_shared_mutex;
+            libkerat::message::alive::alive_ids m_alives;
+            associations_map m_associations;
+
+            // the batch being processed, read-only for the workers
+            batch_vector m_batch;
+            shard_items m_shard_items;
+
+            pthread_mutex_t m_pool_mutex;
+            pthread_cond_t m_work_cond;
+            pthread_cond_t m_done_cond;
+            unsigned long m_generation;
+            size_t m_busy;
+            bool m_running;
+
+            bundle_stack m_processed_frames;
+
+        }; // cls sharded_multiplexing_adaptor
+    }
+
+} // ns libkerat
+
+#endif // KERAT_SHARDED_MULTIPLEXING_ADAPTOR_HPP
@@ -15,6 +15,8 @@
 #include <kerat/bundle.hpp>
 #include <kerat/utils.hpp>
 #include <kerat/parsers.hpp>
+#include <kerat/osc_decoder.hpp>
+#include <kerat/delta_encoding.hpp>
 
 #include <deque>
 #include <list>
@@ -121,6 +123,99 @@ namespace libkerat {
          */
         bool set_accept_unknown(bool flag);
 
+        /**
+         * \brief Enable or disable the batched receive mode
+         *
+         * In batched mode, every wakeup drains all datagrams pending on the
+         * socket using as few recvmmsg calls as possible and hands the raw
+         * buffers to the liblo dispatcher, instead of calling pselect and
+         * lo_server_recv_noblock for each datagram separately. Available only
+         * for UDP servers with accessible socket on systems providing recvmmsg.
+         *
+         * \param flag - true to enable batched receiving
+         * \return true if the requested mode is in effect, false if batched
+         * receiving is not supported for this client
+         */
+        bool set_batch_receive(bool flag);
+
+        /**
+         * \brief Check whether the batched receive mode is in effect
+         * \return true if so
+         */
+        inline bool get_batch_receive() const { return m_batch != NULL; }
+
+        /**
+         * \brief Gets the number of datagrams handled during the last wakeup
+         * of the batched reader
+         * \return datagrams handled during last wakeup, 0 if no wakeup occured yet
+         */
+        inline size_t get_last_wakeup_datagrams() const { return m_last_wakeup_datagrams; }
+
+        /**
+         * \brief Gets the total number of wakeups of the batched reader
+         * \return wakeups count since the batched mode has been enabled
+         */
+        inline uint64_t get_wakeups_count() const { return m_wakeups_count; }
+
+        /**
+         * \brief Gets the total number of datagrams handled by the batched reader
+         * \return datagrams count since the batched mode has been enabled
+         */
+        inline uint64_t get_datagrams_count() const { return m_datagrams_count; }
+
+        /**
+         * \brief Enable or disable the native OSC decoding
+         *
+         * With native decoding, the datagrams this client reads itself (in the
+         * batched mode) or is given through \ref dispatch_data are decoded in
+         * place by \ref libkerat::internals::osc_decoder instead of liblo, which
+         * avoids the liblo argument marshalling and the per-message allocations.
+         * The liblo driven receive keeps using the liblo dispatch.
+         *
+         * \note Bundle timetags are not honoured in native mode, the messages
+         * are always converted immediately.
+         * \param flag - true to enable native decoding
+         * \return previous setting
+         */
+        bool set_native_decoding(bool flag);
+
+        /**
+         * \brief Check whether the native OSC decoding is in effect
+         * \return true if so
+         */
+        inline bool get_native_decoding() const { return m_native; }
+
+        /**
+         * \brief Dispatch OSC packet received by other means to this client
+         *
+         * The results are stacked as if the packet was received by this client,
+         * see \ref set_native_decoding for how the packet is decoded.
+         * \note In native mode, the packet data are modified in place
+         * \param data - the OSC packet
+         * \param size - size of the OSC packet
+         * \return false if the packet is malformed
+         */
+        bool dispatch_data(void * data, size_t size);
+
+        /**
+         * \brief Enable or disable the delta frame reconstruction
+         *
+         * Servers using \ref simple_server::set_delta_encoding leave out the
+         * contacts that have not changed. With reconstruction enabled, such
+         * contacts are taken over from the previous bundle of the same source,
+         * so the listeners always receive the full frames.
+         *
+         * \param flag - true to enable the reconstruction
+         * \return previous setting
+         */
+        bool set_delta_reconstruction(bool flag);
+
+        /**
+         * \brief Check whether the delta frame reconstruction is in effect
+         * \return true if so
+         */
+        inline bool get_delta_reconstruction() const { return m_delta; }
+
         ~simple_client();
 
         bundle_stack get_stack() const ;
@@ -134,8 +229,27 @@ namespace libkerat {
         //! \brief Runs the convertor over the message received and integrates the result into the client's stack
         static int lo_message_handler(const char *path, const char *types, lo_arg **argv, int argc, lo_message msg __attribute__((unused)), void *user_data);
 
+        //! \brief Runs the convertor over the message decoded by the native decoder
+        static void native_message_handler(void * target, const char * path, const char * types, lo_arg ** argv, int argc, void * user_data);
+
+        //! \brief Converts the unknown message found by the native decoder, if accepted
+        static void native_unknown_handler(const char * path, void * message, size_t size, void * user_data);
+
+        //! \brief Converts unknown message to \ref libkerat::message::generic_osc_message
+        bool convert_unknown(const char * path, lo_message msg);
+
+        //! \brief Integrates the convertor results into the current bundle
+        void integrate_results();
+
         void read_socket_fd_existing(int count, timespec timeout);
         void read_socket_fd_nonexisting(int count, timespec timeout);
+        void read_socket_fd_batch(int count, timespec timeout);
+
+        //! \brief Selects the reader matching the current socket and receive mode
+        void select_reader();
+
+        //! \brief Preallocated datagram buffers for the batched reader
+        struct batch_buffers;
 
         //! \brief Initializes convertors for standard TUIO 2.0 messages
         void init_standard_convertors();
@@ -155,6 +269,18 @@ namespace libkerat {
         reader_func m_reader;
         int m_lo_fd;
 
+        batch_buffers * m_batch;
+        size_t m_last_wakeup_datagrams;
+        uint64_t m_wakeups_count;
+        uint64_t m_datagrams_count;
+
+        //! \brief Path lookup for both liblo and native dispatch, targets are the convertor entries
+        internals::osc_decoder m_decoder;
+        bool m_native;
+
+        internals::delta_decoder m_delta_decoder;
+        bool m_delta;
+
     }; // cls simple client
 
 } // ns libkerat
@@ -13,9 +13,13 @@
 #include <kerat/typedefs.hpp>
 #include <kerat/server.hpp>
 #include <kerat/stdout_listener.hpp>
+#include <kerat/osc_encoder.hpp>
+#include <kerat/delta_encoding.hpp>
+#include <sys/socket.h>
 #include <set>
 #include <map>
 #include <deque>
+#include <vector>
 #include <string>
 
 namespace libkerat {
@@ -51,18 +55,69 @@ namespace libkerat {
 
         ~simple_server();
 
+        //! \brief Delivery statistics of single target
+        struct target_stats {
+            target_stats();
+
+            //! \brief Count of bundles sent to the target
+            uint64_t bundles;
+            //! \brief Count of bytes sent to the target
+            uint64_t bytes;
+            //! \brief Count of bundles that have failed to be sent
+            uint64_t errors;
+        };
+
         /**
-         * \brief Set target TUIO client address
-         * \param target_client - address to send data to
+         * \brief Set target TUIO client address, replacing all the current targets
+         * \param target_client - address to send data to, NULL to remove all targets
          * \throw libkerat::exception::net_setup_error when an error has occured during target setup
          */
         void set_target(const lo_address target_client) throw (libkerat::exception::net_setup_error);
 
+        /**
+         * \brief Add another target TUIO client address
+         *
+         * Every bundle is serialised only once and sent to all the targets.
+         * UDP targets, including multicast groups, are sent to by single
+         * sendmmsg call, TCP targets are handled by liblo.
+         *
+         * \note The UDP targets share the socket, the multicast TTL
+         * in effect is the highest TTL set on any of the targets
+         * \param target_client - address to send data to
+         * \return false if such target is already present
+         * \throw libkerat::exception::net_setup_error when an error has occured during target setup
+         */
+        bool add_target(const lo_address target_client) throw (libkerat::exception::net_setup_error);
+
+        /**
+         * \brief Remove the target TUIO client address
+         * \param target_client - address to remove, matched by its url
+         * \return true if the target was found and removed
+         */
+        bool del_target(const lo_address target_client);
+
         /**
          * Get current target TUIO client setting
-         * \return NULL if not set
+         * \return the first target or NULL if not set
+         */
+        inline lo_address get_target() const { return m_targets.empty()?NULL:m_targets.front().address; }
+
+        /**
+         * \brief Get the target TUIO client address
+         * \param index - index of the target, less than \ref get_targets_count
+         * \return the target address
          */
-        inline lo_address get_target() const { return m_target; }
+        inline lo_address get_target(size_t index) const { return m_targets.at(index).address; }
+
+        //! \brief Gets the count of the targets
+        inline size_t get_targets_count() const { return m_targets.size(); }
+
+        /**
+         * \brief Get the delivery statistics of the target
+         * \param index - index of the target, less than \ref get_targets_count
+         * \return statistics since the target was added
+         */
+        inline const target_stats & get_target_stats(size_t index) const { return m_targets.at(index).stats; }
 
         /**
          * \brief Set the underlying OSC bundle timetag
@@ -101,16 +156,99 @@ namespace libkerat {
         //! \brief Cleans the added message stack (except frame message)
         void clear_message_stack();
 
+        /**
+         * \brief Enable or disable the direct OSC encoding
+         *
+         * With direct encoding, bundles consisting only of the messages
+         * supported by \ref libkerat::internals::osc_encoder are serialised
+         * straight into a reused buffer for the UDP targets, bypassing the
+         * liblo bundle construction. The datagram is byte identical to the
+         * one liblo would send. Other bundles are serialised by liblo, TCP
+         * targets are always sent to through liblo. Enabled by default.
+         *
+         * \param flag - true to enable direct encoding
+         * \return previous setting
+         */
+        bool set_direct_encoding(bool flag);
+
+        /**
+         * \brief Check whether the direct OSC encoding is enabled
+         * \return true if so
+         */
+        inline bool get_direct_encoding() const { return m_direct; }
+
+        /**
+         * \brief Enable or disable the delta frame encoding extension
+         *
+         * In delta mode, the pointer, token, bounds and symbol messages are
+         * sent only if the contact has changed since it was last sent, see
+         * \ref libkerat::internals::delta_unchanged. The alive message is
+         * always complete. Every keyframe_interval-th bundle, as well as the
+         * first bundle after a target is added, carries the full state.
+         * The clients should enable \ref simple_client::set_delta_reconstruction
+         * to receive full frames.
+         *
+         * \param flag - true to enable delta encoding
+         * \param epsilon - maximal change of position, angle, velocity or
+         * acceleration that is not considered a change
+         * \param keyframe_interval - count of bundles between the keyframes
+         */
+        void set_delta_encoding(bool flag, float epsilon = 0, unsigned int keyframe_interval = 30);
+
+        /**
+         * \brief Check whether the delta frame encoding is enabled
+         * \return true if so
+         */
+        inline bool get_delta_encoding() const { return m_delta != NULL; }
+
     private:
-        lo_address m_target;
         lo_timetag m_timetag;
         
         bool prepare_bundle();
         bool commit();
 
+        //! \brief Serialises the bundle by the direct encoder, false if not possible
+        bool encode_bundle();
+        //! \brief Sends the serialised bundle to the UDP targets
+        void send_datagrams(const void * data, size_t size);
+        //! \brief Sends the imprinted bundle to the liblo handled targets
+        void send_lo_bundle(lo_bundle bundle);
+
+        struct target_entry {
+            lo_address address;
+            //! \brief Socket to send the datagrams through, -1 if liblo sends to this target
+            int socket;
+            struct sockaddr_storage socket_address;
+            socklen_t socket_address_length;
+            target_stats stats;
+        };
+
+        typedef std::vector<target_entry> target_list;
+
+        //! \brief Resolves the UDP target and assigns it the shared socket
+        void setup_direct_target(target_entry & target);
+        void close_sockets();
+
+        //! \brief Count of the targets sent to by liblo
+        size_t count_lo_targets() const;
+
         message::frame m_frame_template;
         listeners::stdout_listener m_printer;
 
+        target_list m_targets;
+
+        internals::osc_encoder m_encoder;
+        //! \brief Shared sockets for IPv4 and IPv6 UDP targets
+        int m_socket_ipv4;
+        int m_socket_ipv6;
+        int m_multicast_ttl;
+        bool m_direct;
+
+        internals::delta_encoder * m_delta;
+
+        struct send_batch;
+        send_batch * m_batch;
+
     }; // cls simple_server
 
 } // ns libkerat
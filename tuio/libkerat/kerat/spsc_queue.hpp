@@ -0,0 +1,143 @@
+/**
+ * \file      spsc_queue.hpp
+ * \brief     Provides bounded lock-free queue for passing data between two threads
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:08 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_SPSC_QUEUE_HPP
+#define KERAT_SPSC_QUEUE_HPP
+
+#include <kerat/typedefs.hpp>
+#include <cstddef>
+
+namespace libkerat {
+    namespace internals {
+
+        /**
+         * \brief Bounded lock-free single producer, single consumer ring
+         *
+         * Besides the standard producer/consumer operation, the producer is
+         * allowed to \ref evict the oldest item to make room for a new one.
+         * Both the consumer and the producer claim the items by advancing the
+         * read counter with compare-and-swap, so each item is taken exactly once.
+         *
+         * \tparam T - item type, must be trivially copyable and no larger than
+         * the machine word (typically a pointer)
+         */
+        template <typename T>
+        class spsc_queue {
+        public:
+
+            /**
+             * \brief Creates a new, empty queue
+             * \param capacity - minimal capacity, rounded up to power of two
+             */
+            explicit spsc_queue(size_t capacity)
+                :m_slots(NULL), m_mask(0), m_head(0), m_tail(0)
+            {
+                size_t real_capacity = 1;
+                while (real_capacity < capacity){ real_capacity <<= 1; }
+                m_slots = new T[real_capacity];
+                m_mask = real_capacity - 1;
+            }
+
+            ~spsc_queue(){
+                delete [] m_slots;
+                m_slots = NULL;
+            }
+
+            /**
+             * \brief Appends the item to the queue, producer only
+             * \param item - item to append
+             * \return false if the queue is full
+             */
+            bool push(const T & item){
+                size_t head = load(m_head);
+                if ((head - load(m_tail)) > m_mask){ return false; }
+
+                m_slots[head & m_mask] = item;
+                // full barrier, the item is published before the head moves
+                __sync_fetch_and_add(&m_head, 1);
+
+                return true;
+            }
+
+            /**
+             * \brief Takes the oldest item out of the queue
+             *
+             * Meant for the consumer, yet can be called by the producer as
+             * well, see \ref evict
+             *
+             * \param item - output, the item taken
+             * \return false if the queue is empty
+             */
+            bool pop(T & item){
+                while (true){
+                    size_t tail = load(m_tail);
+                    size_t head = load(m_head);
+                    if (tail == head){ return false; }
+
+                    // make sure the slot is read after the head
+                    __sync_synchronize();
+                    T candidate = m_slots[tail & m_mask];
+
+                    // the item is ours only if nobody else claimed it meanwhile,
+                    // the slot can be reused by the producer only after such claim
+                    // and then the candidate read is discarded
+                    if (__sync_bool_compare_and_swap(&m_tail, tail, tail + 1)){
+                        item = candidate;
+                        return true;
+                    }
+                }
+            }
+
+            /**
+             * \brief Takes the oldest item out of the queue, producer only
+             * \param item - output, the item evicted
+             * \return false if the queue is empty
+             */
+            inline bool evict(T & item){ return pop(item); }
+
+            /**
+             * \brief Gets the count of items waiting in the queue
+             * \return approximate count of items, exact if called by producer
+             * or consumer while the other side is idle
+             */
+            inline size_t size() const { return load(m_head) - load(m_tail); }
+
+            //! \brief Checks whether the queue is empty
+            inline bool empty() const { return load(m_head) == load(m_tail); }
+
+            //! \brief Gets the maximal count of items the queue can hold
+            inline size_t capacity() const { return m_mask + 1; }
+
+        private:
+
+            spsc_queue(const spsc_queue &);
+            spsc_queue & operator=(const spsc_queue &);
+
+            //! \brief Reads the counter changed by the other thread, full barrier
+            static inline size_t load(const volatile size_t & counter){
+                return __sync_fetch_and_add(const_cast<volatile size_t *>(&counter), 0);
+            }
+
+            T * m_slots;
+            size_t m_mask;
+
+            //! \brief Write counter, changed by producer only
+            volatile size_t m_head;
+
+            // keep the counters on separate cache lines
+            char m_padding[64];
+
+            //! \brief Read counter, claimed by compare-and-swap
+            volatile size_t m_tail;
+
+        }; // cls spsc_queue
+
+    } // ns internals
+} // ns libkerat
+
+#endif // KERAT_SPSC_QUEUE_HPP
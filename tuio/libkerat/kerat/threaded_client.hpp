@@ -0,0 +1,188 @@
+/**
+ * \file      threaded_client.hpp
+ * \brief     Provides tuio client that receives the data on a dedicated thread.
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:08 UTC
+ * \copyright BSD
+ */
+
+#ifndef KERAT_THREADED_CLIENT_HPP
+#define KERAT_THREADED_CLIENT_HPP
+
+#include <kerat/typedefs.hpp>
+#include <kerat/client.hpp>
+#include <kerat/listener.hpp>
+#include <kerat/bundle.hpp>
+#include <kerat/spsc_queue.hpp>
+#include <kerat/delta_encoding.hpp>
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <string>
+
+namespace libkerat {
+
+    /**
+     * \brief TUIO 2.0 client that decouples the network receive from the processing
+     *
+     * The given network client is driven by a dedicated receiver thread,
+     * the bundles it produces are published through a bounded lock-free queue.
+     * The thread calling \ref load takes the bundles out of the queue and
+     * notifies the listeners, so the whole adaptor chain runs on the consumer
+     * thread while the socket keeps being drained.
+     *
+     * \note Once \ref start has been called, the receiving client must not be
+     * touched by any other thread until \ref stop returns.
+     */
+    class threaded_client: public client {
+    public:
+
+        //! \brief What to do when the queue is full
+        typedef enum {
+            //! \brief Oldest queued bundle is dropped to make room for the new one
+            OVERFLOW_DROP_OLDEST,
+            /**
+             * \brief Bundles that do not fit are kept aside, only the latest
+             * bundle per source is kept and published once the queue has room
+             */
+            OVERFLOW_COALESCE_PER_SOURCE
+        } overflow_policy;
+
+        //! \brief Default queue capacity
+        static const size_t DEFAULT_QUEUE_CAPACITY = 256;
+
+        /**
+         * \brief Create a new threaded client on top of given receiving client
+         * \param receiver - configured client to drive from the receiver thread
+         * \param queue_capacity - maximal count of bundles waiting for the consumer
+         * \param policy - overflow policy to apply when the consumer lags behind
+         */
+        threaded_client(client & receiver, size_t queue_capacity = DEFAULT_QUEUE_CAPACITY, overflow_policy policy = OVERFLOW_DROP_OLDEST);
+
+        //! \brief Stops the receiver thread and releases the bundles still queued
+        ~threaded_client();
+
+        /**
+         * \brief Starts the receiver thread
+         * \return true if the thread is running
+         */
+        bool start();
+
+        //! \brief Stops the receiver thread, waits for it to terminate
+        void stop();
+
+        //! \brief Checks whether the receiver thread is running
+        inline bool is_running() const { return m_running; }
+
+        /**
+         * \brief Takes up to count bundles out of the queue and notifies the listeners
+         *
+         * Calls \ref load with 2 second timeout
+         * \param count - maximal count of bundles to take
+         * \return true if any bundles were taken
+         */
+        bool load(int count = 1);
+
+        /**
+         * \brief Takes up to count bundles out of the queue and notifies the listeners
+         * \param count - maximal count of bundles to take
+         * \param timeout - maximal time to wait for the first bundle
+         * \return true if any bundles were taken
+         */
+        bool load(int count, struct timespec timeout);
+
+        void purge();
+
+        bundle_stack get_stack() const;
+
+        //! \brief Gets the count of bundles currently waiting in the queue
+        inline size_t get_queue_depth() const { return m_queue.size(); }
+
+        //! \brief Gets the greatest queue depth seen by the receiver thread
+        inline size_t get_max_queue_depth() const { return load_counter(m_max_depth); }
+
+        //! \brief Gets the queue capacity
+        inline size_t get_queue_capacity() const { return m_queue.capacity(); }
+
+        //! \brief Gets the count of bundles dropped due to queue overflow
+        inline uint64_t get_dropped_count() const { return load_counter(m_dropped); }
+
+        //! \brief Gets the count of bundles replaced by newer bundle of the same source
+        inline uint64_t get_coalesced_count() const { return load_counter(m_coalesced); }
+
+        //! \brief Gets the count of bundles published to the consumer
+        inline uint64_t get_published_count() const { return load_counter(m_published); }
+
+        //! \brief Gets the overflow policy in effect
+        inline overflow_policy get_overflow_policy() const { return m_policy; }
+
+    private:
+
+        //! \brief Collects the bundles loaded by the receiving client, runs on the receiver thread
+        class receiver_listener: public listener {
+        public:
+            receiver_listener(threaded_client & owner);
+            void notify(const client * notifier);
+        private:
+            threaded_client & m_owner;
+        };
+
+        //! \brief Identifies the TUIO source for the coalescing
+        typedef internals::source_key source_key_type;
+
+        typedef std::pair<source_key_type, bundle_handle *> pending_entry;
+        typedef std::list<pending_entry> pending_list;
+        typedef std::map<source_key_type, pending_list::iterator> pending_map;
+        typedef internals::spsc_queue<bundle_handle *> bundle_queue;
+
+        threaded_client(const threaded_client &);
+        threaded_client & operator=(const threaded_client &);
+
+        static void * receiver_thread(void * self);
+
+        //! \brief Publishes the bundle or applies the overflow policy
+        void publish(bundle_handle * bundle);
+
+        //! \brief Publishes the bundles kept aside by coalescing, as long as they fit
+        void flush_pending();
+
+        //! \brief Wakes the consumer if it waits for data
+        void wake_consumer();
+
+        //! \brief Raises the greatest seen queue depth, called by the receiver thread
+        void raise_max_depth(size_t depth);
+
+        //! \brief Reads the statistics counter changed by the other thread, full barrier
+        template <typename T>
+        static inline T load_counter(const volatile T & counter){
+            return __sync_fetch_and_add(const_cast<volatile T *>(&counter), 0);
+        }
+
+        client & m_receiver;
+        receiver_listener m_receiver_listener;
+
+        bundle_queue m_queue;
+        overflow_policy m_policy;
+
+        pending_list m_pending;
+        pending_map m_pending_sources;
+
+        pthread_t m_thread;
+        volatile bool m_running;
+
+        pthread_mutex_t m_wait_mutex;
+        pthread_cond_t m_wait_cond;
+        volatile bool m_consumer_waiting;
+
+        bundle_stack m_received_frames;
+
+        volatile size_t m_max_depth;
+        volatile uint64_t m_dropped;
+        volatile uint64_t m_coalesced;
+        volatile uint64_t m_published;
+
+    }; // cls threaded_client
+
+} // ns libkerat
+
+#endif // KERAT_THREADED_CLIENT_HPP
@@ -8,13 +8,47 @@
 #include <kerat/typedefs.hpp>
 #include <kerat/bundle.hpp>
 #include <deque>
+#include <vector>
+#include <typeinfo>
+#include <algorithm>
 #include <cstdio>
 #include <sstream>
 
 namespace libkerat {
 
+    namespace internals {
+
+        //! \brief Messages of the bundle grouped by their dynamic type, in single storage
+        struct message_type_index {
+            struct indexed_message {
+                //! \brief Dynamic type of the message, serves as the type tag
+                const std::type_info * type;
+                //! \brief Position of the message within the bundle
+                uint32_t position;
+                //! \brief The very message
+                const kerat_message * message;
+                //! \brief End of the run of messages of the same type
+                size_t run_end;
+            };
+
+            //! \brief Orders the messages by type, messages of the same type stay in bundle order
+            static bool type_order(const indexed_message & first, const indexed_message & second){
+                return first.type->before(*(second.type));
+            }
+
+            typedef std::vector<indexed_message> message_list;
+
+            //! \brief Maximal count of types merged in single lookup, more types take the linear scan
+            static const size_t MAX_MERGED = 16;
+
+            //! \brief Messages sorted by type, runs of each type in bundle order
+            message_list messages;
+        };
+
+    }
+
     bundle_handle::reference_bundle_handle::reference_bundle_handle()
-        :reference_count(1)
+        :reference_count(1), type_index(NULL)
     {
         ;
     }
@@ -26,10 +60,16 @@ namespace libkerat {
     void bundle_handle::reference_bundle_handle::clear(){
 
         for (message_list::iterator i = stored_messages.begin(); i != stored_messages.end(); i++){
-            delete *i;
+            bundle_handle::message_release(*i);
         }
 
         stored_messages.clear();
+        invalidate_index();
+    }
+
+    void bundle_handle::reference_bundle_handle::invalidate_index(){
+        delete type_index;
+        type_index = NULL;
     }
 
 
@@ -41,7 +81,7 @@ namespace libkerat {
 
     bundle_handle::bundle_handle(const bundle_handle& second){
         m_messages_held = second.m_messages_held;
-        ++(m_messages_held->reference_count);
+        __sync_add_and_fetch(&(m_messages_held->reference_count), 1);
     }
 
     bundle_handle::~bundle_handle(){
@@ -54,21 +94,178 @@ namespace libkerat {
         try_clear();
 
         m_messages_held = second.m_messages_held;
-        ++(m_messages_held->reference_count);
+        __sync_add_and_fetch(&(m_messages_held->reference_count), 1);
 
         return *this;
     }
 
     void bundle_handle::try_clear(){
         if (m_messages_held != NULL){
-            --(m_messages_held->reference_count);
-            if (m_messages_held->reference_count == 0){
+            // handles sharing the storage may be released by different threads
+            if (__sync_sub_and_fetch(&(m_messages_held->reference_count), 1) == 0){
                 delete m_messages_held;
-                m_messages_held = NULL;
             }
+            m_messages_held = NULL;
+        }
+    }
+
+    void bundle_handle::message_retain(const kerat_message * message){
+        __sync_add_and_fetch(&(message->m_references.count), 1);
+    }
+
+    void bundle_handle::message_release(kerat_message * message){
+        if (message == NULL){ return; }
+        if (__sync_sub_and_fetch(&(message->m_references.count), 1) == 0){
+            delete message;
+        }
+    }
+
+    bool bundle_handle::message_shared(const kerat_message * message){
+        return message->m_references.count > 1;
+    }
+
+    const internals::message_type_index & bundle_handle::get_type_index() const {
+        typedef internals::message_type_index::indexed_message indexed_message;
+        typedef internals::message_type_index::message_list message_list;
+
+        internals::message_type_index * index = m_messages_held->type_index;
+        if (index != NULL){ return *index; }
+
+        index = new internals::message_type_index;
+        message_list & messages = index->messages;
+        messages.reserve(m_messages_held->stored_messages.size());
+
+        uint32_t position = 0;
+        for (const_iterator i = begin(); i != end(); ++i, ++position){
+            if (*i == NULL){ continue; }
+
+            indexed_message current;
+            current.type = &typeid(**i);
+            current.position = position;
+            current.message = *i;
+            current.run_end = 0;
+            messages.push_back(current);
+        }
+
+        std::stable_sort(messages.begin(), messages.end(), internals::message_type_index::type_order);
+
+        // every message knows where the run of its type ends, so the runs can be skipped over
+        for (size_t i = messages.size(); i > 0; --i){
+            indexed_message & current = messages[i - 1];
+            bool same_type = (i < messages.size()) && (*(current.type) == *(messages[i].type));
+            current.run_end = same_type?messages[i].run_end:i;
+        }
+
+        // the bundle might be read by several threads at once, first index built wins
+        if (!__sync_bool_compare_and_swap(&(m_messages_held->type_index), NULL, index)){
+            delete index;
+            index = m_messages_held->type_index;
+        }
+
+        return *index;
+    }
+
+    const kerat_message * bundle_handle::find_message_of_type(const std::type_info & type, message_type_matcher matcher, uint32_t index) const {
+        typedef internals::message_type_index::message_list message_list;
+
+        const message_list & messages = get_type_index().messages;
+
+        size_t matching[internals::message_type_index::MAX_MERGED];
+        size_t matching_ends[internals::message_type_index::MAX_MERGED];
+        size_t matching_count = 0;
+
+        for (size_t run = 0; run < messages.size(); run = messages[run].run_end){
+            if ((*(messages[run].type) == type) || (*matcher)(messages[run].message)){
+                if (matching_count == internals::message_type_index::MAX_MERGED){
+                    // too many types, take the naive approach
+                    uint32_t current = 0;
+                    for (const_iterator i = begin(); i != end(); ++i){
+                        if ((*i != NULL) && (*matcher)(*i)){
+                            if (current == index){ return *i; }
+                            ++current;
+                        }
+                    }
+                    return NULL;
+                }
+                matching[matching_count] = run;
+                matching_ends[matching_count] = messages[run].run_end;
+                ++matching_count;
+            }
+        }
+
+        if (matching_count == 0){ return NULL; }
+
+        // single type, direct access
+        if (matching_count == 1){
+            size_t found = matching[0] + index;
+            return (found < matching_ends[0])?messages[found].message:NULL;
+        }
+
+        // several types match, merge by bundle position, the run starts serve as cursors
+        for (uint32_t current = 0; ; ++current){
+            size_t best = matching_count;
+            for (size_t k = 0; k < matching_count; ++k){
+                if (matching[k] >= matching_ends[k]){ continue; }
+                if ((best == matching_count) || (messages[matching[k]].position < messages[matching[best]].position)){
+                    best = k;
+                }
+            }
+
+            if (best == matching_count){ return NULL; }
+            if (current == index){ return messages[matching[best]].message; }
+            ++matching[best];
         }
     }
 
+    size_t bundle_handle::count_messages_of_type(const std::type_info & type, message_type_matcher matcher) const {
+        typedef internals::message_type_index::message_list message_list;
+
+        const message_list & messages = get_type_index().messages;
+
+        // each message belongs to single run, so the order does not matter here
+        size_t retval = 0;
+        for (size_t run = 0; run < messages.size(); run = messages[run].run_end){
+            if ((*(messages[run].type) == type) || (*matcher)(messages[run].message)){
+                retval += messages[run].run_end - run;
+            }
+        }
+        return retval;
+    }
+
+    size_t bundle_handle::collect_messages_of_type(const std::type_info & type, message_type_matcher matcher, std::vector<const kerat_message *> & output) const {
+        typedef internals::message_type_index::message_list message_list;
+
+        const message_list & messages = get_type_index().messages;
+
+        size_t single = 0;
+        size_t matching_count = 0;
+        for (size_t run = 0; run < messages.size(); run = messages[run].run_end){
+            if ((*(messages[run].type) == type) || (*matcher)(messages[run].message)){
+                single = run;
+                ++matching_count;
+            }
+        }
+
+        if (matching_count == 0){ return 0; }
+
+        if (matching_count == 1){
+            for (size_t i = single; i < messages[single].run_end; ++i){
+                output.push_back(messages[i].message);
+            }
+            return messages[single].run_end - single;
+        }
+
+        // several types match, keep the bundle order
+        size_t retval = 0;
+        for (const_iterator i = begin(); i != end(); ++i){
+            if ((*i != NULL) && (*matcher)(*i)){
+                output.push_back(*i);
+                ++retval;
+            }
+        }
+        return retval;
+    }
+
     void bundle_handle::clear(){
         //while (m_messages_held->stored_messages.begin() != m_messages_held->stored_messages.end()){
         //    delete m_messages_held->stored_messages.front();
@@ -88,6 +285,18 @@ namespace libkerat {
         return tmp;
     }
 
+    bundle_handle * bundle_handle::clone_shared() const {
+        bundle_handle * tmp = new bundle_handle;
+
+        typedef bundle_handle::reference_bundle_handle::message_list::const_iterator iterator;
+        for (iterator i = m_messages_held->stored_messages.begin(); i != m_messages_held->stored_messages.end(); i++){
+            message_retain(*i);
+            tmp->m_messages_held->stored_messages.push_back(*i);
+        }
+
+        return tmp;
+    }
+
     bundle_stack::bundle_stack(const bundle_stack& other){
         (*this) = other;
     }
@@ -149,15 +358,36 @@ namespace libkerat {
 
     namespace internals {
         bool bundle_manipulator::bm_handle_insert(bundle_handle & handle, bundle_manipulator::handle_iterator where, libkerat::kerat_message * message){
+            handle.m_messages_held->invalidate_index();
             handle.m_messages_held->stored_messages.insert(where, message);
             return true;
         }
 
         bool bundle_manipulator::bm_handle_erase(bundle_handle & handle, bundle_manipulator::handle_iterator where){
+            handle.m_messages_held->invalidate_index();
+            bundle_handle::message_release(*where);
             handle.m_messages_held->stored_messages.erase(where);
             return true;
         }
 
+        bool bundle_manipulator::bm_handle_insert_shared(bundle_handle & handle, bundle_manipulator::handle_iterator where, const libkerat::kerat_message * message){
+            handle.m_messages_held->invalidate_index();
+            bundle_handle::message_retain(message);
+            // the constness is guarded by the reference counter from now on
+            handle.m_messages_held->stored_messages.insert(where, const_cast<libkerat::kerat_message *>(message));
+            return true;
+        }
+
+        libkerat::kerat_message * bundle_manipulator::bm_handle_detach(bundle_handle & handle, bundle_manipulator::handle_iterator where){
+            libkerat::kerat_message * original = *where;
+            if ((original != NULL) && bundle_handle::message_shared(original)){
+                handle.m_messages_held->invalidate_index();
+                *where = original->clone();
+                bundle_handle::message_release(original);
+            }
+            return *where;
+        }
+
         bundle_manipulator::handle_iterator bundle_manipulator::bm_handle_begin(bundle_handle & handle){
             return handle.m_messages_held->stored_messages.begin();
         }
@@ -170,6 +400,20 @@ namespace libkerat {
             return handle.clone();
         }
 
+        bundle_handle * bundle_manipulator::bm_handle_clone_shared(const bundle_handle & handle){
+            return handle.clone_shared();
+        }
+
+        void bundle_manipulator::bm_handle_share(const bundle_handle & source, bundle_handle & destination){
+            if (source.m_messages_held == destination.m_messages_held){ return; }
+
+            destination.clear();
+            for (bundle_handle::const_iterator i = source.begin(); i != source.end(); ++i){
+                bundle_handle::message_retain(*i);
+                destination.m_messages_held->stored_messages.push_back(*i);
+            }
+        }
+
         void bundle_manipulator::bm_handle_copy(const bundle_handle & source, bundle_handle & destination){
             if (source.m_messages_held == destination.m_messages_held){ return; }
             
@@ -0,0 +1,313 @@
+/**
+ * \file      delta_encoding.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:31 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/typedefs.hpp>
+#include <kerat/delta_encoding.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <typeinfo>
+#include <cmath>
+
+namespace libkerat {
+    namespace internals {
+
+        typedef std::multimap<session_id_t, const kerat_message *> session_index;
+
+        source_key source_key::from_frame(const message::frame & frame){
+            source_key retval;
+            retval.addr = frame.get_address();
+            retval.instance = frame.get_instance();
+            retval.application = frame.get_app_name();
+            return retval;
+        }
+
+        bool source_key::operator<(const source_key & second) const {
+            if (addr != second.addr){ return addr < second.addr; }
+            if (instance != second.instance){ return instance < second.instance; }
+            return application < second.application;
+        }
+
+        static inline bool close_enough(double first, double second, float epsilon){
+            return std::fabs(first - second) <= epsilon;
+        }
+
+        static inline bool angle_close_enough(angle_t first, angle_t second, float epsilon){
+            // angles wrap around
+            double difference = std::fmod(std::fabs((double)first - second), 2*M_PI);
+            return (difference <= epsilon) || ((2*M_PI - difference) <= epsilon);
+        }
+
+        //! \brief Compares the attributes subject to epsilon, the messages are of the same type
+        static bool within_epsilon(const kerat_message * reference, const kerat_message * current, float epsilon){
+            const helpers::point_2d * point = dynamic_cast<const helpers::point_2d *>(reference);
+            if (point != NULL){
+                const helpers::point_2d * second = dynamic_cast<const helpers::point_2d *>(current);
+                if (!close_enough(point->get_x(), second->get_x(), epsilon)){ return false; }
+                if (!close_enough(point->get_y(), second->get_y(), epsilon)){ return false; }
+            }
+
+            const helpers::point_3d * point_3d = dynamic_cast<const helpers::point_3d *>(reference);
+            if (point_3d != NULL){
+                const helpers::point_3d * second = dynamic_cast<const helpers::point_3d *>(current);
+                if (!close_enough(point_3d->get_z(), second->get_z(), epsilon)){ return false; }
+            }
+
+            const helpers::angle_2d * angle = dynamic_cast<const helpers::angle_2d *>(reference);
+            if (angle != NULL){
+                const helpers::angle_2d * second = dynamic_cast<const helpers::angle_2d *>(current);
+                if (!angle_close_enough(angle->get_angle(), second->get_angle(), epsilon)){ return false; }
+            }
+
+            const helpers::angle_3d * angle_3d = dynamic_cast<const helpers::angle_3d *>(reference);
+            if (angle_3d != NULL){
+                const helpers::angle_3d * second = dynamic_cast<const helpers::angle_3d *>(current);
+                if (!angle_close_enough(angle_3d->get_pitch(), second->get_pitch(), epsilon)){ return false; }
+                if (!angle_close_enough(angle_3d->get_roll(), second->get_roll(), epsilon)){ return false; }
+            }
+
+            const helpers::velocity_2d * velocity = dynamic_cast<const helpers::velocity_2d *>(reference);
+            if (velocity != NULL){
+                const helpers::velocity_2d * second = dynamic_cast<const helpers::velocity_2d *>(current);
+                if (!close_enough(velocity->get_x_velocity(), second->get_x_velocity(), epsilon)){ return false; }
+                if (!close_enough(velocity->get_y_velocity(), second->get_y_velocity(), epsilon)){ return false; }
+            }
+
+            const helpers::velocity_3d * velocity_3d = dynamic_cast<const helpers::velocity_3d *>(reference);
+            if (velocity_3d != NULL){
+                const helpers::velocity_3d * second = dynamic_cast<const helpers::velocity_3d *>(current);
+                if (!close_enough(velocity_3d->get_z_velocity(), second->get_z_velocity(), epsilon)){ return false; }
+            }
+
+            const helpers::rotation_velocity_2d * rotation = dynamic_cast<const helpers::rotation_velocity_2d *>(reference);
+            if (rotation != NULL){
+                const helpers::rotation_velocity_2d * second = dynamic_cast<const helpers::rotation_velocity_2d *>(current);
+                if (!close_enough(rotation->get_rotation_velocity(), second->get_rotation_velocity(), epsilon)){ return false; }
+            }
+
+            const helpers::rotation_velocity_3d * rotation_3d = dynamic_cast<const helpers::rotation_velocity_3d *>(reference);
+            if (rotation_3d != NULL){
+                const helpers::rotation_velocity_3d * second = dynamic_cast<const helpers::rotation_velocity_3d *>(current);
+                if (!close_enough(rotation_3d->get_pitch_velocity(), second->get_pitch_velocity(), epsilon)){ return false; }
+                if (!close_enough(rotation_3d->get_roll_velocity(), second->get_roll_velocity(), epsilon)){ return false; }
+            }
+
+            const helpers::movement_acceleration * acceleration = dynamic_cast<const helpers::movement_acceleration *>(reference);
+            if (acceleration != NULL){
+                const helpers::movement_acceleration * second = dynamic_cast<const helpers::movement_acceleration *>(current);
+                if (!close_enough(acceleration->get_acceleration(), second->get_acceleration(), epsilon)){ return false; }
+            }
+
+            const helpers::rotation_acceleration * rotation_acceleration = dynamic_cast<const helpers::rotation_acceleration *>(reference);
+            if (rotation_acceleration != NULL){
+                const helpers::rotation_acceleration * second = dynamic_cast<const helpers::rotation_acceleration *>(current);
+                if (!close_enough(rotation_acceleration->get_rotation_acceleration(), second->get_rotation_acceleration(), epsilon)){ return false; }
+            }
+
+            return true;
+        }
+
+        //! \brief Copies the attributes subject to epsilon from source to target of the same type
+        static void take_over_epsilon_attributes(kerat_message * target, const kerat_message * source){
+            helpers::point_2d * point = dynamic_cast<helpers::point_2d *>(target);
+            if (point != NULL){
+                const helpers::point_2d * original = dynamic_cast<const helpers::point_2d *>(source);
+                point->set_x(original->get_x());
+                point->set_y(original->get_y());
+            }
+
+            helpers::point_3d * point_3d = dynamic_cast<helpers::point_3d *>(target);
+            if (point_3d != NULL){
+                point_3d->set_z(dynamic_cast<const helpers::point_3d *>(source)->get_z());
+            }
+
+            helpers::angle_2d * angle = dynamic_cast<helpers::angle_2d *>(target);
+            if (angle != NULL){
+                angle->set_angle(dynamic_cast<const helpers::angle_2d *>(source)->get_angle());
+            }
+
+            helpers::angle_3d * angle_3d = dynamic_cast<helpers::angle_3d *>(target);
+            if (angle_3d != NULL){
+                const helpers::angle_3d * original = dynamic_cast<const helpers::angle_3d *>(source);
+                angle_3d->set_pitch(original->get_pitch());
+                angle_3d->set_roll(original->get_roll());
+            }
+
+            helpers::velocity_2d * velocity = dynamic_cast<helpers::velocity_2d *>(target);
+            if (velocity != NULL){
+                const helpers::velocity_2d * original = dynamic_cast<const helpers::velocity_2d *>(source);
+                velocity->set_x_velocity(original->get_x_velocity());
+                velocity->set_y_velocity(original->get_y_velocity());
+            }
+
+            helpers::velocity_3d * velocity_3d = dynamic_cast<helpers::velocity_3d *>(target);
+            if (velocity_3d != NULL){
+                velocity_3d->set_z_velocity(dynamic_cast<const helpers::velocity_3d *>(source)->get_z_velocity());
+            }
+
+            helpers::rotation_velocity_2d * rotation = dynamic_cast<helpers::rotation_velocity_2d *>(target);
+            if (rotation != NULL){
+                rotation->set_rotation_velocity(dynamic_cast<const helpers::rotation_velocity_2d *>(source)->get_rotation_velocity());
+            }
+
+            helpers::rotation_velocity_3d * rotation_3d = dynamic_cast<helpers::rotation_velocity_3d *>(target);
+            if (rotation_3d != NULL){
+                const helpers::rotation_velocity_3d * original = dynamic_cast<const helpers::rotation_velocity_3d *>(source);
+                rotation_3d->set_pitch_velocity(original->get_pitch_velocity());
+                rotation_3d->set_roll_velocity(original->get_roll_velocity());
+            }
+
+            helpers::movement_acceleration * acceleration = dynamic_cast<helpers::movement_acceleration *>(target);
+            if (acceleration != NULL){
+                acceleration->set_acceleration(dynamic_cast<const helpers::movement_acceleration *>(source)->get_acceleration());
+            }
+
+            helpers::rotation_acceleration * rotation_acceleration = dynamic_cast<helpers::rotation_acceleration *>(target);
+            if (rotation_acceleration != NULL){
+                rotation_acceleration->set_rotation_acceleration(
+                    dynamic_cast<const helpers::rotation_acceleration *>(source)->get_rotation_acceleration()
+                );
+            }
+        }
+
+        //! \brief Compares the attributes not subject to epsilon, false if the messages are not of type T
+        template <typename T>
+        static bool same_except_epsilon(const kerat_message * reference, const kerat_message * current){
+            const T * typed_reference = dynamic_cast<const T *>(reference);
+            if (typed_reference == NULL){ return false; }
+
+            T probe(*dynamic_cast<const T *>(current));
+            take_over_epsilon_attributes(&probe, reference);
+            return probe == *typed_reference;
+        }
+
+        bool delta_encodable(const kerat_message * message){
+            return (dynamic_cast<const message::pointer *>(message) != NULL)
+                || (dynamic_cast<const message::token *>(message) != NULL)
+                || (dynamic_cast<const message::bounds *>(message) != NULL)
+                || (dynamic_cast<const message::symbol *>(message) != NULL);
+        }
+
+        bool delta_unchanged(const kerat_message * reference, const kerat_message * current, float epsilon){
+            if ((reference == NULL) || (current == NULL)){ return false; }
+            if (typeid(*reference) != typeid(*current)){ return false; }
+
+            if (!within_epsilon(reference, current, epsilon)){ return false; }
+
+            return same_except_epsilon<message::pointer>(reference, current)
+                || same_except_epsilon<message::token>(reference, current)
+                || same_except_epsilon<message::bounds>(reference, current)
+                || same_except_epsilon<message::symbol>(reference, current);
+        }
+
+        //! \brief Finds the message of the same session and type as given one
+        static const kerat_message * find_counterpart(const session_index & index, const kerat_message * message){
+            session_id_t session_id = dynamic_cast<const helpers::contact_session *>(message)->get_session_id();
+            std::pair<session_index::const_iterator, session_index::const_iterator> range = index.equal_range(session_id);
+
+            for (session_index::const_iterator i = range.first; i != range.second; ++i){
+                if (typeid(*i->second) == typeid(*message)){ return i->second; }
+            }
+
+            return NULL;
+        }
+
+        static void index_sessions(const bundle_handle & bundle, session_index & index){
+            for (bundle_handle::const_iterator i = bundle.begin(); i != bundle.end(); ++i){
+                if (!delta_encodable(*i)){ continue; }
+
+                session_id_t session_id = dynamic_cast<const helpers::contact_session *>(*i)->get_session_id();
+                index.insert(session_index::value_type(session_id, *i));
+            }
+        }
+
+        delta_encoder::delta_encoder(float epsilon, unsigned int keyframe_interval)
+            :m_epsilon(epsilon), m_keyframe_interval(keyframe_interval), m_since_keyframe(0), m_keyframe_pending(true)
+        { ; }
+
+        void delta_encoder::reset(){
+            bm_handle_clear(m_sent_state);
+            m_since_keyframe = 0;
+            m_keyframe_pending = true;
+        }
+
+        bool delta_encoder::encode(bundle_handle & bundle){
+            bool keyframe = m_keyframe_pending || ((m_since_keyframe + 1) >= m_keyframe_interval);
+
+            session_index sent;
+            if (!keyframe){ index_sessions(m_sent_state, sent); }
+
+            // what the clients know after this bundle
+            bundle_handle state;
+
+            handle_iterator end = bm_handle_end(bundle);
+            for (handle_iterator i = bm_handle_begin(bundle); i != end; ){
+                if (!delta_encodable(*i)){
+                    ++i;
+                    continue;
+                }
+
+                const kerat_message * reference = keyframe?NULL:find_counterpart(sent, *i);
+                if ((reference != NULL) && delta_unchanged(reference, *i, m_epsilon)){
+                    // the reference stays, so that slow drift is sent eventually
+                    bm_handle_insert_shared(state, bm_handle_end(state), reference);
+                    handle_iterator unchanged = i++;
+                    bm_handle_erase(bundle, unchanged);
+                } else {
+                    bm_handle_insert_shared(state, bm_handle_end(state), *i);
+                    ++i;
+                }
+            }
+
+            m_sent_state = state;
+
+            if (keyframe){
+                m_since_keyframe = 0;
+                m_keyframe_pending = false;
+            } else {
+                ++m_since_keyframe;
+            }
+
+            return keyframe;
+        }
+
+        void delta_decoder::reset(){
+            m_sources.clear();
+        }
+
+        size_t delta_decoder::decode(bundle_handle & bundle){
+            const message::frame * frame = bundle.get_frame();
+            const message::alive * alive = bundle.get_alive();
+            if ((frame == NULL) || (alive == NULL)){ return 0; }
+
+            bundle_handle & previous = m_sources[source_key::from_frame(*frame)];
+            size_t taken = 0;
+
+            if (!previous.empty()){
+                session_index present;
+                index_sessions(bundle, present);
+
+                handle_iterator alive_position = bm_handle_begin(bundle);
+                while ((alive_position != bm_handle_end(bundle)) && (*alive_position != alive)){ ++alive_position; }
+
+                const message::alive::alive_ids & alives = alive->get_alives();
+                for (bundle_handle::const_iterator i = previous.begin(); i != previous.end(); ++i){
+                    if (!delta_encodable(*i)){ continue; }
+
+                    session_id_t session_id = dynamic_cast<const helpers::contact_session *>(*i)->get_session_id();
+                    if (alives.find(session_id) == alives.end()){ continue; }
+                    if (find_counterpart(present, *i) != NULL){ continue; }
+
+                    bm_handle_insert_shared(bundle, alive_position, *i);
+                    ++taken;
+                }
+            }
+
+            bm_handle_share(bundle, previous);
+            return taken;
+        }
+
+    } // ns internals
+} // ns libkerat
@@ -0,0 +1,182 @@
+/**
+ * \file      message_pool.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 02:56 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/typedefs.hpp>
+#include <kerat/message_pool.hpp>
+#include <pthread.h>
+#include <new>
+
+namespace libkerat {
+    namespace internals {
+
+        //! \brief Size class step, also the alignment of pooled blocks
+        static const size_t POOL_GRANULARITY = 16;
+        //! \brief Count of size classes, blocks greater than POOL_GRANULARITY*POOL_CLASSES are not pooled
+        static const size_t POOL_CLASSES = 32;
+        //! \brief Maximal count of blocks cached per size class and thread
+        static const size_t POOL_CLASS_CAPACITY = 256;
+        //! \brief Count of blocks moved between the thread and the shared depot at once
+        static const size_t POOL_BATCH = 64;
+        //! \brief Maximal count of batches kept in the shared depot per size class
+        static const size_t POOL_DEPOT_CAPACITY = 64;
+
+        struct pool_free_block {
+            pool_free_block * next;
+            //! \brief Next batch in the depot, valid for the first block of a batch only
+            pool_free_block * next_batch;
+        };
+
+        struct pool_size_class {
+            pool_free_block * head;
+            size_t count;
+        };
+
+        struct pool_depot_class {
+            pool_free_block * batches;
+            size_t count;
+        };
+
+        // per-thread free lists, no locking required
+        static __thread pool_size_class pool_thread_classes[POOL_CLASSES];
+
+        // batches of blocks released by one thread and taken by another,
+        // e.g. bundles made by a receiving thread and released by a worker
+        static pool_depot_class pool_depot[POOL_CLASSES];
+        static pthread_mutex_t pool_depot_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+        static volatile bool pool_recycling = true;
+
+        //! \brief Refills the empty thread list by a batch from the depot
+        static bool pool_depot_take(size_t size_class, pool_size_class & cls){
+            pthread_mutex_lock(&pool_depot_mutex);
+            pool_depot_class & depot = pool_depot[size_class];
+            pool_free_block * batch = depot.batches;
+            if (batch != NULL){
+                depot.batches = batch->next_batch;
+                --depot.count;
+            }
+            pthread_mutex_unlock(&pool_depot_mutex);
+
+            if (batch == NULL){ return false; }
+
+            cls.head = batch;
+            cls.count = POOL_BATCH;
+            return true;
+        }
+
+        //! \brief Moves a batch from the full thread list to the depot, or to the system if the depot is full
+        static void pool_depot_give(size_t size_class, pool_size_class & cls){
+            pool_free_block * batch = cls.head;
+            pool_free_block * last = batch;
+            for (size_t i = 1; i < POOL_BATCH; ++i){ last = last->next; }
+            cls.head = last->next;
+            cls.count -= POOL_BATCH;
+            last->next = NULL;
+
+            pthread_mutex_lock(&pool_depot_mutex);
+            pool_depot_class & depot = pool_depot[size_class];
+            bool kept = depot.count < POOL_DEPOT_CAPACITY;
+            if (kept){
+                batch->next_batch = depot.batches;
+                depot.batches = batch;
+                ++depot.count;
+            }
+            pthread_mutex_unlock(&pool_depot_mutex);
+
+            while (!kept && (batch != NULL)){
+                pool_free_block * block = batch;
+                batch = block->next;
+                ::operator delete(block);
+            }
+        }
+
+        void * pool_allocate(size_t size){
+            if (size == 0){ size = 1; }
+            size_t size_class = (size - 1) / POOL_GRANULARITY;
+
+            if (size_class >= POOL_CLASSES){
+                return ::operator new(size);
+            }
+
+            pool_size_class & cls = pool_thread_classes[size_class];
+            if (pool_recycling && ((cls.head != NULL) || pool_depot_take(size_class, cls))){
+                pool_free_block * block = cls.head;
+                cls.head = block->next;
+                --cls.count;
+                return block;
+            }
+
+            // whole class size even with recycling disabled, the block
+            // may be released after it is enabled again and then reused
+            // by any request of this class
+            return ::operator new((size_class + 1) * POOL_GRANULARITY);
+        }
+
+        void pool_release(void * block, size_t size) throw () {
+            if (block == NULL){ return; }
+            if (size == 0){ size = 1; }
+            size_t size_class = (size - 1) / POOL_GRANULARITY;
+
+            if (pool_recycling && (size_class < POOL_CLASSES)){
+                pool_size_class & cls = pool_thread_classes[size_class];
+                if (cls.count >= POOL_CLASS_CAPACITY){
+                    pool_depot_give(size_class, cls);
+                }
+
+                pool_free_block * released = static_cast<pool_free_block *>(block);
+                released->next = cls.head;
+                cls.head = released;
+                ++cls.count;
+                return;
+            }
+
+            ::operator delete(block);
+        }
+
+        void pool_trim() throw () {
+            for (size_t i = 0; i < POOL_CLASSES; ++i){
+                pool_size_class & cls = pool_thread_classes[i];
+                while (cls.head != NULL){
+                    pool_free_block * block = cls.head;
+                    cls.head = block->next;
+                    ::operator delete(block);
+                }
+                cls.count = 0;
+            }
+        }
+
+        //! \brief Releases all batches kept in the depot
+        static void pool_depot_trim(){
+            pthread_mutex_lock(&pool_depot_mutex);
+            for (size_t i = 0; i < POOL_CLASSES; ++i){
+                pool_depot_class & depot = pool_depot[i];
+                while (depot.batches != NULL){
+                    pool_free_block * block = depot.batches;
+                    depot.batches = block->next_batch;
+                    while (block != NULL){
+                        pool_free_block * next = block->next;
+                        ::operator delete(block);
+                        block = next;
+                    }
+                }
+                depot.count = 0;
+            }
+            pthread_mutex_unlock(&pool_depot_mutex);
+        }
+
+        bool pool_set_recycling(bool enabled){
+            bool retval = pool_recycling;
+            pool_recycling = enabled;
+            if (!enabled){
+                pool_trim();
+                pool_depot_trim();
+            }
+            return retval;
+        }
+
+    } // ns internals
+} // ns libkerat
@@ -0,0 +1,432 @@
+/**
+ * \file      multi_client.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:13 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/typedefs.hpp>
+#include <kerat/multi_client.hpp>
+#include <kerat/utils.hpp>
+#include <lo/lo.h>
+#include <iostream>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+namespace libkerat {
+
+    //! \brief Maximal count of events handled per epoll_wait call
+    static const int MULTI_CLIENT_MAX_EVENTS = 16;
+    //! \brief Maximal size of single datagram, same as liblo uses
+    static const size_t MULTI_CLIENT_DATAGRAM_SIZE = 32768;
+    //! \brief Maximal count of packets read from one socket per wakeup, so no source starves the others
+    static const int MULTI_CLIENT_SOCKET_QUOTA = 64;
+    //! \brief Maximal size of OSC packet accepted from stream
+    static const uint32_t MULTI_CLIENT_STREAM_PACKET_LIMIT = 1 << 20;
+
+#ifdef HAVE_SYS_EPOLL_H
+
+    multi_client::multi_client(bool accept_unknown) throw (libkerat::exception::net_setup_error)
+        :m_epoll_fd(-1), m_accept_unknown(accept_unknown), m_native(false), m_delta(false), m_next_tag(0),
+        m_datagram_buffer(MULTI_CLIENT_DATAGRAM_SIZE)
+    {
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (m_epoll_fd < 0){
+            throw libkerat::exception::net_setup_error("Unable to create epoll instance!");
+        }
+    }
+
+    multi_client::~multi_client(){
+        for (source_map::iterator i = m_sources.begin(); i != m_sources.end(); ++i){
+            free_source(i->second);
+        }
+        m_sources.clear();
+        release_closed();
+
+        purge();
+
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+
+    multi_client::source_tag_t multi_client::add_port(uint16_t port, int protocol) throw (libkerat::exception::net_setup_error){
+        if ((protocol != LO_UDP) && (protocol != LO_TCP)){
+            throw libkerat::exception::net_setup_error("Only UDP and TCP sources are supported!");
+        }
+
+        char buffer[40];
+        sprintf(buffer, "%hu", port);
+
+        lo_server server = lo_server_new_with_proto(buffer, protocol, NULL);
+        if (server == NULL){
+            sprintf(buffer, "Unable to bind to port %u!", port);
+            throw libkerat::exception::net_setup_error(buffer);
+        }
+
+        int fd = lo_server_get_socket_fd(server);
+        if ((fd < 0) || (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == -1)){
+            lo_server_free(server);
+            sprintf(buffer, "Unable to access socket of port %u!", port);
+            throw libkerat::exception::net_setup_error(buffer);
+        }
+
+        source_entry * source = new source_entry;
+        source->tag = m_next_tag;
+        source->server = server;
+        source->parser = new simple_client(server, m_accept_unknown);
+        source->bundles = 0;
+        source->parser->set_native_decoding(m_native);
+        source->parser->set_delta_reconstruction(m_delta);
+
+        for (internals::convertor_list::const_iterator i = m_convertors.begin(); i != m_convertors.end(); ++i){
+            source->parser->enable_convertor(*i);
+        }
+
+        if (!watch_socket(source, fd, (protocol == LO_TCP)?socket_entry::LISTENER:socket_entry::DATAGRAM)){
+            free_source(source);
+            sprintf(buffer, "Unable to watch socket of port %u!", port);
+            throw libkerat::exception::net_setup_error(buffer);
+        }
+
+        m_sources.insert(source_map::value_type(source->tag, source));
+        return m_next_tag++;
+    }
+
+    bool multi_client::del_source(source_tag_t tag){
+        source_map::iterator found = m_sources.find(tag);
+        if (found == m_sources.end()){ return false; }
+
+        free_source(found->second);
+        m_sources.erase(found);
+        release_closed();
+
+        return true;
+    }
+
+    simple_client * multi_client::get_source_client(source_tag_t tag) const {
+        source_map::const_iterator found = m_sources.find(tag);
+        if (found == m_sources.end()){ return NULL; }
+        return found->second->parser;
+    }
+
+    uint64_t multi_client::get_source_bundles_count(source_tag_t tag) const {
+        source_map::const_iterator found = m_sources.find(tag);
+        if (found == m_sources.end()){ return 0; }
+        return found->second->bundles;
+    }
+
+    void multi_client::enable_convertor(const simple_client::message_convertor_entry & convertor){
+        m_convertors.push_back(convertor);
+        for (source_map::iterator i = m_sources.begin(); i != m_sources.end(); ++i){
+            i->second->parser->enable_convertor(convertor);
+        }
+    }
+
+    void multi_client::enable_convertors(const internals::convertor_list & convertors){
+        for (internals::convertor_list::const_iterator i = convertors.begin(); i != convertors.end(); ++i){
+            enable_convertor(*i);
+        }
+    }
+
+    bool multi_client::set_native_decoding(bool flag){
+        bool retval = m_native;
+        m_native = flag;
+        for (source_map::iterator i = m_sources.begin(); i != m_sources.end(); ++i){
+            i->second->parser->set_native_decoding(flag);
+        }
+        return retval;
+    }
+
+    bool multi_client::set_delta_reconstruction(bool flag){
+        bool retval = m_delta;
+        m_delta = flag;
+        for (source_map::iterator i = m_sources.begin(); i != m_sources.end(); ++i){
+            i->second->parser->set_delta_reconstruction(flag);
+        }
+        return retval;
+    }
+
+    bool multi_client::watch_socket(source_entry * source, int fd, socket_entry::socket_kind kind){
+        socket_entry * socket = new socket_entry;
+        socket->fd = fd;
+        socket->kind = kind;
+        socket->source = source;
+
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = socket;
+
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1){
+            delete socket;
+            return false;
+        }
+
+        source->sockets.push_back(socket);
+        return true;
+    }
+
+    void multi_client::close_socket(socket_entry * socket){
+        if (socket->fd < 0){ return; }
+
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, socket->fd, NULL);
+
+        // datagram and listening sockets belong to the lo_server
+        if (socket->kind == socket_entry::STREAM){ close(socket->fd); }
+        socket->fd = -1;
+
+        socket_list & sockets = socket->source->sockets;
+        sockets.erase(std::remove(sockets.begin(), sockets.end(), socket), sockets.end());
+        m_closed.push_back(socket);
+    }
+
+    void multi_client::release_closed(){
+        for (socket_list::iterator i = m_closed.begin(); i != m_closed.end(); ++i){
+            delete *i;
+        }
+        m_closed.clear();
+    }
+
+    void multi_client::free_source(source_entry * source){
+        while (!source->sockets.empty()){
+            close_socket(source->sockets.back());
+        }
+
+        delete source->parser;
+        source->parser = NULL;
+        lo_server_free(source->server);
+        source->server = NULL;
+
+        delete source;
+    }
+
+    int multi_client::read_socket(socket_entry * socket){
+        switch (socket->kind){
+            case socket_entry::DATAGRAM: {
+                return read_datagrams(socket);
+            }
+            case socket_entry::STREAM: {
+                return read_stream(socket);
+            }
+            case socket_entry::LISTENER: {
+                accept_connections(socket);
+                break;
+            }
+        }
+
+        return 0;
+    }
+
+    int multi_client::read_datagrams(socket_entry * socket){
+        int dispatched = 0;
+
+        for (int i = 0; i < MULTI_CLIENT_SOCKET_QUOTA; ++i){
+            // MSG_TRUNC makes recv return the real datagram size
+            ssize_t received = recv(socket->fd, &m_datagram_buffer[0], m_datagram_buffer.size(), MSG_DONTWAIT | MSG_TRUNC);
+
+            if (received < 0){
+                if (errno == EINTR){ continue; }
+                if ((errno != EAGAIN) && (errno != EWOULDBLOCK)){
+                    std::cerr << "Failed to read data from source " << socket->source->tag << std::endl;
+                }
+                break;
+            }
+
+            if ((size_t)received > m_datagram_buffer.size()){
+                std::cerr << "Datagram exceeds " << m_datagram_buffer.size() << " bytes, dropped" << std::endl;
+                continue;
+            }
+
+            socket->source->parser->dispatch_data(&m_datagram_buffer[0], received);
+            ++dispatched;
+        }
+
+        return dispatched;
+    }
+
+    int multi_client::read_stream(socket_entry * socket){
+        int dispatched = 0;
+
+        for (int i = 0; i < MULTI_CLIENT_SOCKET_QUOTA; ++i){
+            ssize_t received = recv(socket->fd, &m_datagram_buffer[0], m_datagram_buffer.size(), MSG_DONTWAIT);
+
+            if (received == 0){
+                // peer closed the connection
+                close_socket(socket);
+                break;
+            } else if (received < 0){
+                if (errno == EINTR){ continue; }
+                if ((errno != EAGAIN) && (errno != EWOULDBLOCK)){ close_socket(socket); }
+                break;
+            }
+
+            std::vector<char> & pending = socket->pending;
+            pending.insert(pending.end(), m_datagram_buffer.begin(), m_datagram_buffer.begin() + received);
+
+            // dispatch all complete packets, each prefixed by its size
+            size_t offset = 0;
+            while ((pending.size() - offset) >= sizeof(uint32_t)){
+                uint32_t packet_size = 0;
+                memcpy(&packet_size, &pending[offset], sizeof(uint32_t));
+                packet_size = ntohl(packet_size);
+
+                if (packet_size > MULTI_CLIENT_STREAM_PACKET_LIMIT){
+                    std::cerr << "Invalid packet size " << packet_size << " from source " << socket->source->tag << ", closing connection" << std::endl;
+                    close_socket(socket);
+                    return dispatched;
+                }
+
+                if ((pending.size() - offset - sizeof(uint32_t)) < packet_size){ break; }
+
+                socket->source->parser->dispatch_data(&pending[offset + sizeof(uint32_t)], packet_size);
+                offset += sizeof(uint32_t) + packet_size;
+                ++dispatched;
+            }
+            pending.erase(pending.begin(), pending.begin() + offset);
+        }
+
+        return dispatched;
+    }
+
+    void multi_client::accept_connections(socket_entry * socket){
+        for (int i = 0; i < MULTI_CLIENT_SOCKET_QUOTA; ++i){
+            int connection = accept4(socket->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (connection < 0){
+                if (errno == EINTR){ continue; }
+                break;
+            }
+
+            if (!watch_socket(socket->source, connection, socket_entry::STREAM)){
+                close(connection);
+            }
+        }
+    }
+
+    void multi_client::collect_bundles(source_entry * source){
+        bundle_stack stack = source->parser->get_stack();
+        while (stack.get_length() > 0){
+            bm_stack_append(m_received_frames, new bundle_handle(stack.get_update()));
+            m_received_sources.push_back(source->tag);
+            ++source->bundles;
+        }
+        source->parser->purge();
+    }
+
+    bool multi_client::load(int count){
+        struct timespec timeout;
+        timeout.tv_sec = 2;
+        timeout.tv_nsec = 0;
+        return load(count, timeout);
+    }
+
+    bool multi_client::load(int count, struct timespec timeout){
+        purge();
+
+        struct timespec currtime;
+        clock_gettime(CLOCK_MONOTONIC, &currtime);
+        struct timespec limit = nanotimeradd(currtime, timeout);
+
+        while ((int)m_received_frames.get_length() < count){
+
+            // check whether we're still supposed to be running
+            clock_gettime(CLOCK_MONOTONIC, &currtime);
+            struct timespec remaining = nanotimersub(limit, currtime);
+            if (remaining.tv_sec < 0){ break; }
+
+            // round up, so we don't spin for the last milisecond
+            int remaining_ms = remaining.tv_sec * 1000 + (remaining.tv_nsec + 999999) / 1000000;
+
+            struct epoll_event events[MULTI_CLIENT_MAX_EVENTS];
+            int ready = epoll_wait(m_epoll_fd, events, MULTI_CLIENT_MAX_EVENTS, remaining_ms);
+
+            if (ready == -1){
+                if (errno == EINTR){ continue; }
+                std::cerr << "Failed to wait for data" << std::endl;
+                break;
+            }
+
+            for (int i = 0; i < ready; ++i){
+                socket_entry * socket = static_cast<socket_entry *>(events[i].data.ptr);
+                // closed while handling preceding event
+                if (socket->fd < 0){ continue; }
+
+                if (read_socket(socket) > 0){ collect_bundles(socket->source); }
+            }
+
+            release_closed();
+        }
+
+        notify_listeners();
+
+        return m_received_frames.get_length() > 0;
+    }
+
+#else // HAVE_SYS_EPOLL_H
+
+    multi_client::multi_client(bool accept_unknown) throw (libkerat::exception::net_setup_error)
+        :m_epoll_fd(-1), m_accept_unknown(accept_unknown), m_native(false), m_delta(false), m_next_tag(0)
+    {
+        throw libkerat::exception::net_setup_error("epoll is not available on this system!");
+    }
+
+    multi_client::~multi_client(){ ; }
+
+    multi_client::source_tag_t multi_client::add_port(uint16_t port __attribute__((unused)), int protocol __attribute__((unused))) throw (libkerat::exception::net_setup_error){
+        throw libkerat::exception::net_setup_error("epoll is not available on this system!");
+    }
+
+    bool multi_client::del_source(source_tag_t tag __attribute__((unused))){ return false; }
+    simple_client * multi_client::get_source_client(source_tag_t tag __attribute__((unused))) const { return NULL; }
+    uint64_t multi_client::get_source_bundles_count(source_tag_t tag __attribute__((unused))) const { return 0; }
+    void multi_client::enable_convertor(const simple_client::message_convertor_entry & convertor){ m_convertors.push_back(convertor); }
+    void multi_client::enable_convertors(const internals::convertor_list & convertors){
+        m_convertors.insert(m_convertors.end(), convertors.begin(), convertors.end());
+    }
+
+    bool multi_client::load(int count){
+        struct timespec timeout;
+        timeout.tv_sec = 2;
+        timeout.tv_nsec = 0;
+        return load(count, timeout);
+    }
+
+    bool multi_client::set_native_decoding(bool flag){
+        bool retval = m_native;
+        m_native = flag;
+        return retval;
+    }
+
+    bool multi_client::set_delta_reconstruction(bool flag){
+        bool retval = m_delta;
+        m_delta = flag;
+        return retval;
+    }
+
+    bool multi_client::load(int count __attribute__((unused)), struct timespec timeout __attribute__((unused))){ return false; }
+
+#endif // HAVE_SYS_EPOLL_H
+
+    void multi_client::purge(){
+        bm_stack_clear(m_received_frames);
+        m_received_sources.clear();
+    }
+
+    bundle_stack multi_client::get_stack() const { return m_received_frames; }
+
+} // ns libkerat
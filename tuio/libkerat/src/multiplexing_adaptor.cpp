@@ -6,6 +6,7 @@
  */
 
 #include <iostream>
+#include <typeinfo>
 #include <kerat/typedefs.hpp>
 #include <kerat/multiplexing_adaptor.hpp>
 #include <kerat/tuio_messages.hpp>
@@ -29,53 +30,80 @@ namespace libkerat {
         
         void multiplexing_adaptor::purge(){ bm_stack_clear(m_processed_frames); }
 
-        session_id_t multiplexing_adaptor::get_mapped_id(const multiplexing_adaptor::source_key_type& source, const libkerat::session_id_t sid){
+        multiplexing_adaptor::multiplexing_adaptor(){
+            // bundles out of frame fall to the unknown source
+            m_source_indexes[source_key_type()] = 0;
+            m_sources.resize(1);
+        }
 
-            session_id_t retval;
+        multiplexing_adaptor::source_index multiplexing_adaptor::intern_source(const message::frame & frame){
+            source_key_type key;
+            key.addr = frame.get_address();
+            key.instance = frame.get_instance();
+            key.application = frame.get_app_name();
 
-            // if the mapping map is not present yet, create it
-            internal_session_id_map & srcmap = m_mapping[source];
-            // attempt to find mapped id
-            internal_session_id_map::const_iterator sval = srcmap.find(sid);
+            std::pair<source_index_map::iterator, bool> interned = m_source_indexes.insert(source_index_map::value_type(key, m_sources.size()));
+            if (interned.second){ m_sources.resize(m_sources.size() + 1); }
 
-            // if found return it, create new else
-            if (sval == srcmap.end()){
-                retval = get_next_session_id();
-                srcmap[sid] = retval;
-            } else {
-                retval = sval->second;
+            return interned.first->second;
+        }
+
+        session_id_t multiplexing_adaptor::get_mapped_id(const source_index source, const libkerat::session_id_t sid){
+            source_state & state = m_sources[source];
+
+            // attempt to find mapped id, create new if not found
+            session_id_t retval;
+            if (!state.mapping.find(sid, retval)){
+                retval = allocate_mapped_id();
+                state.mapping.insert(sid, retval);
+                state.fresh.push_back(sid);
             }
 
             return retval;
 
         }
 
-        void multiplexing_adaptor::update_alives(const source_key_type& source, const message::alive::alive_ids & update_full){
-            typedef message::alive::alive_ids alive_ids;
+        void multiplexing_adaptor::remove_mapping(source_state & state, const libkerat::session_id_t sid){
+            session_id_t mapped;
+            if (state.mapping.erase(sid, mapped)){ release_mapped_id(mapped); }
+        }
 
-            internal_session_id_map & srcmap = m_mapping[source];
+        void multiplexing_adaptor::update_alives(const source_index source, const message::alive::alive_ids & update){
+            typedef message::alive::alive_ids alive_ids;
 
-            // remove mappings for already-present nodes
-            // add mappings for yet unmapped id's
-            const internal_session_id_map srcmap_full(srcmap);
-            message::alive::alive_ids update(update_full);
+            source_state & state = m_sources[source];
 
-            for (internal_session_id_map::const_iterator current = srcmap_full.begin(); current != srcmap_full.end(); current++){
-                alive_ids::const_iterator cs = update_full.find(current->first);
-                if (cs == update_full.end()){
-                    srcmap.erase(current->first);
-//                } else {
-//                    update.erase(*cs);
+            // ids mapped since the last alive that did not make it to this one are dead already
+            for (std::vector<session_id_t>::const_iterator current = state.fresh.begin(); current != state.fresh.end(); ++current){
+                if (update.find(*current) == update.end()){ remove_mapping(state, *current); }
+            }
+            state.fresh.clear();
+
+            // both sets are ordered, walk them at once to find the differences
+            alive_ids::iterator previous = state.alive.begin();
+            alive_ids::const_iterator current = update.begin();
+            while ((previous != state.alive.end()) || (current != update.end())){
+                if ((current == update.end()) || ((previous != state.alive.end()) && (*previous < *current))){
+                    // died
+                    remove_mapping(state, *previous);
+                    state.alive.erase(previous++);
+                } else if ((previous == state.alive.end()) || (*current < *previous)){
+                    // born or mapped since the last alive already
+                    state.alive.insert(previous, *current);
+                    get_mapped_id(source, *current);
+                    ++current;
+                } else {
+                    ++previous;
+                    ++current;
                 }
             }
 
-            for (alive_ids::iterator current = update_full.begin(); current != update_full.end(); current++){
-                get_mapped_id(source, *current);
-            }
+            // the new mappings have just been confirmed
+            state.fresh.clear();
         }
 
-        void multiplexing_adaptor::update_associations(const source_key_type& source, const message::alive_associations::associated_ids& update){
-            m_associations[source] = update;
+        void multiplexing_adaptor::update_associations(const source_index source, const message::alive_associations::associated_ids& update){
+            m_sources[source].associations = update;
         }
 
         int multiplexing_adaptor::process_bundle(const bundle_handle& to_process, bundle_handle& output_frame){
@@ -85,55 +113,55 @@ namespace libkerat {
             const bundle_handle * input = &to_process;
             if (&to_process == &output_frame){
                 copy = true;
-                input = bm_handle_clone(output_frame);
+                input = bm_handle_clone_shared(output_frame);
             }
 
             bm_handle_clear(output_frame);
 
             // from now on, do the useful stuff
-            source_key_type source;
+            source_index source = 0;
             bool out_of_bundle = true;
 
-            // process intermediate messages
+            // process intermediate messages, messages are cloned only when they have to be changed
             typedef bundle_handle::const_iterator iterator;
             for (iterator i = input->begin(); i != input->end(); i++){
 
-                kerat_message * tmp = (*i)->clone();
+                const kerat_message * original = *i;
+                kerat_message * tmp = NULL;
+                // the messages below are leaf types, single type tag test each instead of the cast cascade
+                const std::type_info & type = typeid(*original);
 
                 { // frame
-                    message::frame * msg_frame = dynamic_cast<message::frame*>(tmp);
-                    if (msg_frame != NULL){
-                        source.addr = msg_frame->get_address();
-                        source.instance = msg_frame->get_instance();
-                        source.application = msg_frame->get_app_name();
+                    if (type == typeid(message::frame)){
+                        source = intern_source(*static_cast<const message::frame*>(original));
                         out_of_bundle = false;
                         goto msg_push;
                     }
                 }
 
                 { // alive
-                    message::alive * msg_alive = dynamic_cast<message::alive*>(tmp);
-                    if (msg_alive != NULL){
+                    if (type == typeid(message::alive)){
+                        tmp = original->clone();
+                        message::alive * msg_alive = static_cast<message::alive*>(tmp);
                         update_alives(source, msg_alive->get_alives());
-                        msg_alive->set_alives(get_alives());
+                        merge_alives(*msg_alive);
                         out_of_bundle = true;
                         goto msg_push;
                     }
                 }
 
                 { // alive associations
-                    message::alive_associations * msg_ala = dynamic_cast<message::alive_associations*>(tmp);
-                    if (msg_ala != NULL){
-                        update_associations(source, msg_ala->get_associations());
-                        msg_ala->set_associations(get_associations());
+                    if (type == typeid(message::alive_associations)){
+                        tmp = original->clone();
+                        merge_associations(source, *static_cast<message::alive_associations*>(tmp));
                         goto msg_push;
                     }
                 }
 
                 { // conatainer associations
-                    message::container_association * msg_coa = dynamic_cast<message::container_association*>(tmp);
-                    if (msg_coa != NULL){
-                        rempap_associated_ids(*msg_coa, source);
+                    if (type == typeid(message::container_association)){
+                        tmp = original->clone();
+                        rempap_associated_ids(*static_cast<message::container_association*>(tmp), source);
                         goto sid_remap;
                     }
                 }
@@ -141,23 +169,23 @@ namespace libkerat {
                 // do not use helper here, someone might utilize the link_topology
                 // helper as well but in incompatible way!
                 { // link association
-                    message::link_association * msg_lia = dynamic_cast<message::link_association*>(tmp);
-                    if (msg_lia != NULL){
-                        rempap_links(*msg_lia, source);
+                    if (type == typeid(message::link_association)){
+                        tmp = original->clone();
+                        rempap_links(*static_cast<message::link_association*>(tmp), source);
                         goto msg_push;
                     }
                 }
                 { // linked list association
-                    message::linked_list_association * msg_lla = dynamic_cast<message::linked_list_association*>(tmp);
-                    if (msg_lla != NULL){
-                        rempap_links(*msg_lla, source);
+                    if (type == typeid(message::linked_list_association)){
+                        tmp = original->clone();
+                        rempap_links(*static_cast<message::linked_list_association*>(tmp), source);
                         goto msg_push;
                     }
                 }
                 { // linked tree association
-                    message::linked_tree_association * msg_lta = dynamic_cast<message::linked_tree_association*>(tmp);
-                    if (msg_lta != NULL){
-                        rempap_links(*msg_lta, source);
+                    if (type == typeid(message::linked_tree_association)){
+                        tmp = original->clone();
+                        rempap_links(*static_cast<message::linked_tree_association*>(tmp), source);
                         goto msg_push;
                     }
                 }
@@ -166,15 +194,23 @@ namespace libkerat {
                 // allow jump to for coa-like messages
             sid_remap:
                 {
-                    helpers::contact_session * msg_session = dynamic_cast<helpers::contact_session*>(tmp);
+                    const helpers::contact_session * msg_session = dynamic_cast<const helpers::contact_session*>((tmp != NULL)?tmp:original);
                     if (msg_session != NULL) {
-                        msg_session->set_session_id(get_mapped_id(source, msg_session->get_session_id()));
+                        session_id_t mapped = get_mapped_id(source, msg_session->get_session_id());
+                        if (mapped != msg_session->get_session_id()){
+                            if (tmp == NULL){ tmp = original->clone(); }
+                            dynamic_cast<helpers::contact_session*>(tmp)->set_session_id(mapped);
+                        }
                     }
                 }
-                // all messages shall be pushed
+                // all messages shall be pushed, the unchanged ones are shared
             msg_push:
-                bm_handle_insert(output_frame, bm_handle_end(output_frame), tmp);
-                tmp = NULL;
+                if (tmp != NULL){
+                    bm_handle_insert(output_frame, bm_handle_end(output_frame), tmp);
+                    tmp = NULL;
+                } else {
+                    bm_handle_insert_shared(output_frame, bm_handle_end(output_frame), original);
+                }
             }
 
             // the input bundle handle was duplicated, erase it
@@ -188,29 +224,37 @@ namespace libkerat {
             }
         }
 
-        libkerat::message::alive::alive_ids multiplexing_adaptor::get_alives() const {
-            libkerat::message::alive::alive_ids alives;
-
-            for (session_id_map::const_iterator sr = m_mapping.begin(); sr != m_mapping.end(); sr++){
-                for (internal_session_id_map::const_iterator sid = sr->second.begin(); sid != sr->second.end(); sid++){
-                    alives.insert(sid->second);
-                }
-            }
-
-            return alives;
-        }
         libkerat::message::alive_associations::associated_ids multiplexing_adaptor::get_associations() const {
             typedef libkerat::message::alive_associations::associated_ids associated_ids;
             associated_ids associations;
 
-            for (associations_map::const_iterator sr = m_associations.begin(); sr != m_associations.end(); sr++){
-                associations.insert(sr->second.begin(), sr->second.end());
+            for (source_state_vector::const_iterator sr = m_sources.begin(); sr != m_sources.end(); sr++){
+                associations.insert(sr->associations.begin(), sr->associations.end());
             }
 
             return associations;
         }
 
-        template <class T> void multiplexing_adaptor::rempap_associated_ids(T& message, const source_key_type& source){
+        session_id_t multiplexing_adaptor::allocate_mapped_id(){
+            session_id_t retval = get_next_session_id();
+            m_alives.insert(retval);
+            return retval;
+        }
+
+        void multiplexing_adaptor::release_mapped_id(const libkerat::session_id_t mapped){
+            m_alives.erase(mapped);
+        }
+
+        void multiplexing_adaptor::merge_alives(message::alive & message) const {
+            message.set_alives(m_alives);
+        }
+
+        void multiplexing_adaptor::merge_associations(const source_index source, message::alive_associations & message){
+            update_associations(source, message.get_associations());
+            message.set_associations(get_associations());
+        }
+
+        template <class T> void multiplexing_adaptor::rempap_associated_ids(T& message, const source_index source){
             typename T::associated_ids ids_new;
             const typename T::associated_ids & originals = message.get_associations();
 
@@ -221,7 +265,7 @@ namespace libkerat {
             message.set_associations(ids_new);
         }
 
-        template <class T> void multiplexing_adaptor::rempap_links(T& message, const source_key_type& source){
+        template <class T> void multiplexing_adaptor::rempap_links(T& message, const source_index source){
             typedef libkerat::helpers::link_topology link_topology;
             link_topology::internal_link_graph link_graph = message.get_link_graph();
             for (typename link_topology::internal_link_graph::node_iterator node = link_graph.nodes_begin(); node != link_graph.nodes_end(); node++){
@@ -230,6 +274,10 @@ namespace libkerat {
             message.set_link_graph(link_graph);
         }
 
+        multiplexing_adaptor::source_key_type::source_key_type()
+            :addr(0), instance(0)
+        { ; }
+
         bool multiplexing_adaptor::source_key_type::operator<(const multiplexing_adaptor::source_key_type & second) const {
             if (addr < second.addr){
                 return true;
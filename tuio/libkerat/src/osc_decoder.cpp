@@ -0,0 +1,236 @@
+/**
+ * \file      osc_decoder.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:18 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/typedefs.hpp>
+#include <kerat/osc_decoder.hpp>
+#include <string.h>
+#include <arpa/inet.h>
+
+namespace libkerat {
+    namespace internals {
+
+        //! \brief Maximal nesting of OSC bundles accepted
+        static const unsigned int OSC_DECODER_MAX_DEPTH = 8;
+        //! \brief Minimal count of slots in the lookup table
+        static const size_t OSC_DECODER_MIN_SLOTS = 64;
+
+        static inline size_t osc_pad(size_t length){ return (length + 3) & ~((size_t)3); }
+
+        static inline uint32_t osc_read_uint32(const char * data){
+            uint32_t value = 0;
+            memcpy(&value, data, sizeof(value));
+            return ntohl(value);
+        }
+
+        static inline void osc_swap_uint32(char * data){
+            uint32_t value = osc_read_uint32(data);
+            memcpy(data, &value, sizeof(value));
+        }
+
+        static inline void osc_swap_uint64(char * data){
+            uint32_t high = osc_read_uint32(data);
+            uint32_t low = osc_read_uint32(data + sizeof(uint32_t));
+            uint64_t value = ((uint64_t)high << 32) | low;
+            memcpy(data, &value, sizeof(value));
+        }
+
+        osc_decoder::osc_decoder(message_handler handler, unknown_handler unknown, void * user_data)
+            :m_handler(handler), m_unknown(unknown), m_user_data(user_data), m_mask(0)
+        {
+            rebuild_table();
+        }
+
+        uint32_t osc_decoder::path_hash(const char * path){
+            // FNV-1a
+            uint32_t hash = 2166136261u;
+            for (; *path != '\0'; ++path){
+                hash ^= (unsigned char)*path;
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        void osc_decoder::set_target(const std::string & path, void * target){
+            // slots are never marked deleted, just fill in the target and rebuild
+            for (path_table::iterator slot = m_table.begin(); slot != m_table.end(); ++slot){
+                if ((slot->target != NULL) && (slot->path == path)){
+                    slot->target = target;
+                    rebuild_table();
+                    return;
+                }
+            }
+
+            if (target == NULL){ return; }
+
+            path_slot added;
+            added.hash = path_hash(path.c_str());
+            added.path = path;
+            added.target = target;
+            m_table.push_back(added);
+
+            rebuild_table();
+        }
+
+        void * osc_decoder::get_target(const char * path) const {
+            return find_target(path, path_hash(path));
+        }
+
+        void * osc_decoder::find_target(const char * path, uint32_t hash) const {
+            for (size_t index = hash & m_mask; ; index = (index + 1) & m_mask){
+                const path_slot & slot = m_table[index];
+                if (slot.target == NULL){ return NULL; }
+                if ((slot.hash == hash) && (slot.path == path)){ return slot.target; }
+            }
+        }
+
+        void osc_decoder::rebuild_table(){
+            path_table used;
+            for (path_table::iterator slot = m_table.begin(); slot != m_table.end(); ++slot){
+                if (slot->target != NULL){ used.push_back(*slot); }
+            }
+
+            size_t slots = OSC_DECODER_MIN_SLOTS;
+            while (slots < used.size() * 2){ slots <<= 1; }
+
+            path_slot empty;
+            empty.hash = 0;
+            empty.target = NULL;
+
+            m_table.assign(slots, empty);
+            m_mask = slots - 1;
+
+            for (path_table::iterator slot = used.begin(); slot != used.end(); ++slot){
+                size_t index = slot->hash & m_mask;
+                while (m_table[index].target != NULL){ index = (index + 1) & m_mask; }
+                m_table[index] = *slot;
+            }
+        }
+
+        bool osc_decoder::decode(void * packet, size_t size){
+            return decode_element(static_cast<char *>(packet), size, 0);
+        }
+
+        bool osc_decoder::decode_element(char * data, size_t size, unsigned int depth){
+            static const char bundle_tag[] = "#bundle";
+
+            if ((size < sizeof(bundle_tag)) || (memcmp(data, bundle_tag, sizeof(bundle_tag)) != 0)){
+                return decode_message(data, size);
+            }
+
+            // tag followed by the timetag
+            if ((depth >= OSC_DECODER_MAX_DEPTH) || (size < sizeof(bundle_tag) + 8)){ return false; }
+
+            size_t offset = sizeof(bundle_tag) + 8;
+            while (offset < size){
+                if ((size - offset) < sizeof(uint32_t)){ return false; }
+
+                uint32_t element_size = osc_read_uint32(data + offset);
+                offset += sizeof(uint32_t);
+                if ((element_size > (size - offset)) || ((element_size % 4) != 0)){ return false; }
+
+                if (!decode_element(data + offset, element_size, depth + 1)){ return false; }
+                offset += element_size;
+            }
+
+            return true;
+        }
+
+        bool osc_decoder::decode_message(char * data, size_t size){
+            if ((size == 0) || (data[0] != '/')){ return false; }
+
+            const char * path = data;
+            size_t path_length = strnlen(path, size);
+            if (path_length == size){ return false; }
+            size_t offset = osc_pad(path_length + 1);
+
+            uint32_t hash = path_hash(path);
+            void * target = find_target(path, hash);
+            if (target == NULL){
+                if (m_unknown != NULL){ (*m_unknown)(path, data, size, m_user_data); }
+                return true;
+            }
+
+            // messages without type tags have no arguments
+            const char * types = "";
+            if ((offset < size) && (data[offset] == ',')){
+                size_t types_length = strnlen(data + offset, size - offset);
+                if (types_length == (size - offset)){ return false; }
+                types = data + offset + 1;
+                offset = osc_pad(offset + types_length + 1);
+            }
+
+            int argc = strlen(types);
+            m_argv.resize(argc);
+
+            for (int i = 0; i < argc; ++i){
+                char * argument = data + offset;
+                size_t remaining = (offset < size)?(size - offset):0;
+                m_argv[i] = reinterpret_cast<lo_arg *>(argument);
+
+                switch (types[i]){
+                    case LO_INT32:
+                    case LO_FLOAT:
+                    case LO_CHAR:
+                    case LO_MIDI: {
+                        if (remaining < 4){ return false; }
+                        osc_swap_uint32(argument);
+                        offset += 4;
+                        break;
+                    }
+                    case LO_INT64:
+                    case LO_DOUBLE: {
+                        if (remaining < 8){ return false; }
+                        osc_swap_uint64(argument);
+                        offset += 8;
+                        break;
+                    }
+                    case LO_TIMETAG: {
+                        // seconds and fraction are separate 32-bit fields
+                        if (remaining < 8){ return false; }
+                        osc_swap_uint32(argument);
+                        osc_swap_uint32(argument + 4);
+                        offset += 8;
+                        break;
+                    }
+                    case LO_STRING:
+                    case LO_SYMBOL: {
+                        size_t length = strnlen(argument, remaining);
+                        if (length == remaining){ return false; }
+                        offset += osc_pad(length + 1);
+                        break;
+                    }
+                    case LO_BLOB: {
+                        if (remaining < 4){ return false; }
+                        uint32_t blob_size = osc_read_uint32(argument);
+                        if (blob_size > (remaining - 4)){ return false; }
+                        osc_swap_uint32(argument);
+                        offset += 4 + osc_pad(blob_size);
+                        break;
+                    }
+                    case LO_TRUE:
+                    case LO_FALSE:
+                    case LO_NIL:
+                    case LO_INFINITUM: {
+                        // no data
+                        break;
+                    }
+                    default: {
+                        // unknown size, skip the message, the enclosing bundle
+                        // knows where the next one starts
+                        return true;
+                    }
+                }
+            }
+
+            if (offset > size){ return false; }
+
+            (*m_handler)(target, path, types, (argc > 0)?&m_argv[0]:NULL, argc, m_user_data);
+            return true;
+        }
+
+    } // ns internals
+} // ns libkerat
@@ -0,0 +1,247 @@
+/**
+ * \file      osc_encoder.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:22 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/typedefs.hpp>
+#include <kerat/osc_encoder.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/utils.hpp>
+#include <string.h>
+#include <arpa/inet.h>
+
+namespace libkerat {
+    namespace internals {
+
+        static inline size_t osc_pad(size_t length){ return (length + 3) & ~((size_t)3); }
+
+        static inline bool output_2d(const helpers::message_output_mode & mode){
+            return testbit(mode.get_message_output_mode(), helpers::message_output_mode::OUTPUT_MODE_2D);
+        }
+
+        static inline bool output_3d(const helpers::message_output_mode & mode){
+            return testbit(mode.get_message_output_mode(), helpers::message_output_mode::OUTPUT_MODE_3D);
+        }
+
+        osc_encoder::osc_encoder(size_t initial_capacity)
+            :m_buffer((initial_capacity > 16)?initial_capacity:16), m_size(0), m_message_start(0)
+        { ; }
+
+        char * osc_encoder::reserve(size_t length){
+            if ((m_size + length) > m_buffer.size()){
+                size_t capacity = m_buffer.size() * 2;
+                while (capacity < (m_size + length)){ capacity *= 2; }
+                m_buffer.resize(capacity);
+            }
+
+            char * retval = &m_buffer[m_size];
+            m_size += length;
+            return retval;
+        }
+
+        void osc_encoder::put_int32(uint32_t value){
+            value = htonl(value);
+            memcpy(reserve(sizeof(value)), &value, sizeof(value));
+        }
+
+        void osc_encoder::put_float(float value){
+            uint32_t raw = 0;
+            memcpy(&raw, &value, sizeof(raw));
+            put_int32(raw);
+        }
+
+        void osc_encoder::put_string(const char * value){
+            size_t length = strlen(value);
+            size_t padded = osc_pad(length + 1);
+            char * target = reserve(padded);
+            memcpy(target, value, length);
+            memset(target + length, 0, padded - length);
+        }
+
+        void osc_encoder::put_timetag(const lo_timetag & value){
+            put_int32(value.sec);
+            put_int32(value.frac);
+        }
+
+        void osc_encoder::begin_bundle(const lo_timetag & timetag){
+            m_size = 0;
+            // "#bundle" including the terminating zero is exactly 8 bytes
+            put_string("#bundle");
+            put_timetag(timetag);
+        }
+
+        void osc_encoder::begin_message(const char * path, const char * types){
+            m_message_start = m_size;
+            put_int32(0);
+
+            put_string(path);
+
+            // type tag string begins with comma
+            size_t length = strlen(types) + 1;
+            size_t padded = osc_pad(length + 1);
+            char * target = reserve(padded);
+            target[0] = ',';
+            memcpy(target + 1, types, length - 1);
+            memset(target + length, 0, padded - length);
+        }
+
+        void osc_encoder::end_message(){
+            uint32_t length = htonl(m_size - m_message_start - sizeof(uint32_t));
+            memcpy(&m_buffer[m_message_start], &length, sizeof(length));
+        }
+
+        bool osc_encoder::supports(const kerat_message * message){
+            return (dynamic_cast<const message::frame *>(message) != NULL)
+                || (dynamic_cast<const message::alive *>(message) != NULL)
+                || (dynamic_cast<const message::pointer *>(message) != NULL)
+                || (dynamic_cast<const message::bounds *>(message) != NULL);
+        }
+
+        bool osc_encoder::append(const kerat_message * message){
+
+            // the argument order mirrors the respective imprint_lo_messages
+            const message::pointer * msg_pointer = dynamic_cast<const message::pointer *>(message);
+            if (msg_pointer != NULL){
+                tu_id_t tu_id = compile_tuid(msg_pointer->get_type_id(), msg_pointer->get_user_id());
+                bool extended = msg_pointer->is_extended();
+
+                if (output_2d(*msg_pointer)){
+                    begin_message(message::pointer::PATH_2D, extended?"iiifffffff":"iiiffff");
+                    put_int32(msg_pointer->get_session_id());
+                    put_int32(tu_id);
+                    put_int32(msg_pointer->get_component_id());
+                    put_float(msg_pointer->get_x());
+                    put_float(msg_pointer->get_y());
+                    put_float(msg_pointer->get_width());
+                    put_float(msg_pointer->get_pressure());
+                    if (extended){
+                        put_float(msg_pointer->get_x_velocity());
+                        put_float(msg_pointer->get_y_velocity());
+                        put_float(msg_pointer->get_acceleration());
+                    }
+                    end_message();
+                }
+
+                if (output_3d(*msg_pointer)){
+                    begin_message(message::pointer::PATH_3D, extended?"iiifffffffff":"iiifffff");
+                    put_int32(msg_pointer->get_session_id());
+                    put_int32(tu_id);
+                    put_int32(msg_pointer->get_component_id());
+                    put_float(msg_pointer->get_x());
+                    put_float(msg_pointer->get_y());
+                    put_float(msg_pointer->get_z());
+                    put_float(msg_pointer->get_width());
+                    put_float(msg_pointer->get_pressure());
+                    if (extended){
+                        put_float(msg_pointer->get_x_velocity());
+                        put_float(msg_pointer->get_y_velocity());
+                        put_float(msg_pointer->get_z_velocity());
+                        put_float(msg_pointer->get_acceleration());
+                    }
+                    end_message();
+                }
+
+                return true;
+            }
+
+            const message::bounds * msg_bounds = dynamic_cast<const message::bounds *>(message);
+            if (msg_bounds != NULL){
+                bool extended = msg_bounds->is_extended();
+
+                if (output_2d(*msg_bounds)){
+                    begin_message(message::bounds::PATH_2D, extended?"ifffffffffff":"iffffff");
+                    put_int32(msg_bounds->get_session_id());
+                    put_float(msg_bounds->get_x());
+                    put_float(msg_bounds->get_y());
+                    put_float(msg_bounds->get_angle());
+                    put_float(msg_bounds->get_width());
+                    put_float(msg_bounds->get_height());
+                    put_float(msg_bounds->get_area());
+                    if (extended){
+                        put_float(msg_bounds->get_x_velocity());
+                        put_float(msg_bounds->get_y_velocity());
+                        put_float(msg_bounds->get_rotation_velocity());
+                        put_float(msg_bounds->get_acceleration());
+                        put_float(msg_bounds->get_rotation_acceleration());
+                    }
+                    end_message();
+                }
+
+                if (output_3d(*msg_bounds)){
+                    begin_message(message::bounds::PATH_3D, extended?"iffffffffffffffffff":"iffffffffff");
+                    put_int32(msg_bounds->get_session_id());
+                    put_float(msg_bounds->get_x());
+                    put_float(msg_bounds->get_y());
+                    put_float(msg_bounds->get_z());
+                    put_float(msg_bounds->get_yaw());
+                    put_float(msg_bounds->get_pitch());
+                    put_float(msg_bounds->get_roll());
+                    put_float(msg_bounds->get_width());
+                    put_float(msg_bounds->get_height());
+                    put_float(msg_bounds->get_depth());
+                    put_float(msg_bounds->get_volume());
+                    if (extended){
+                        put_float(msg_bounds->get_x_velocity());
+                        put_float(msg_bounds->get_y_velocity());
+                        put_float(msg_bounds->get_z_velocity());
+                        put_float(msg_bounds->get_yaw_velocity());
+                        put_float(msg_bounds->get_pitch_velocity());
+                        put_float(msg_bounds->get_roll_velocity());
+                        put_float(msg_bounds->get_acceleration());
+                        put_float(msg_bounds->get_rotation_acceleration());
+                    }
+                    end_message();
+                }
+
+                return true;
+            }
+
+            const message::frame * msg_frame = dynamic_cast<const message::frame *>(message);
+            if (msg_frame != NULL){
+                bool extended = msg_frame->is_extended();
+
+                begin_message(message::frame::PATH, extended?"itsiii":"it");
+                put_int32(msg_frame->get_frame_id());
+                put_timetag(msg_frame->get_timestamp());
+                if (extended){
+                    put_string(msg_frame->get_app_name().c_str());
+                    put_int32(msg_frame->get_address());
+                    put_int32(msg_frame->get_instance());
+                    put_int32(compile_dimmensions(msg_frame->get_sensor_width(), msg_frame->get_sensor_height()));
+                }
+                end_message();
+
+                return true;
+            }
+
+            const message::alive * msg_alive = dynamic_cast<const message::alive *>(message);
+            if (msg_alive != NULL){
+                const message::alive::alive_ids & alives = msg_alive->get_alives();
+
+                // type tags are written in place, one per alive session
+                m_message_start = m_size;
+                put_int32(0);
+                put_string(message::alive::PATH);
+
+                size_t length = alives.size() + 1;
+                size_t padded = osc_pad(length + 1);
+                char * types = reserve(padded);
+                types[0] = ',';
+                memset(types + 1, LO_INT32, alives.size());
+                memset(types + length, 0, padded - length);
+
+                for (message::alive::alive_ids::const_iterator i = alives.begin(); i != alives.end(); ++i){
+                    put_int32(*i);
+                }
+                end_message();
+
+                return true;
+            }
+
+            return false;
+        }
+
+    } // ns internals
+} // ns libkerat
@@ -162,9 +162,11 @@ namespace libkerat {
 
             // process intermediate messages
             for (handle_iterator i = bm_handle_begin(to_process); i != bm_handle_end(to_process); ++i){
+                // the message may be shared with other bundles, scale private copy
+                kerat_message * current = bm_handle_detach(to_process, i);
 
                 // let's make sure first, that this message is not both being scaled and setting scaling
-                message::frame * msg_frame = dynamic_cast<message::frame *>(*i);
+                message::frame * msg_frame = dynamic_cast<message::frame *>(current);
                 if (msg_frame != NULL){
                     if (msg_frame->is_extended()){
                         // commit automatic configuration
@@ -181,9 +183,9 @@ namespace libkerat {
                     }
                 } else { // from now on, this is considered to be any other kind than msg_frame
 
-                    helpers::scalable_independent_2d * hp_2scalable_i = dynamic_cast<helpers::scalable_independent_2d*>(*i);
+                    helpers::scalable_independent_2d * hp_2scalable_i = dynamic_cast<helpers::scalable_independent_2d*>(current);
                     if (hp_2scalable_i != NULL){
-                        helpers::scalable_independent_3d * hp_3scalable_i = dynamic_cast<helpers::scalable_independent_3d*>(*i);
+                        helpers::scalable_independent_3d * hp_3scalable_i = dynamic_cast<helpers::scalable_independent_3d*>(current);
                         hp_2scalable_i->scale_x(m_x_scaling);
                         hp_2scalable_i->scale_y(m_y_scaling);
                         
@@ -192,13 +194,13 @@ namespace libkerat {
                         }
                     }
                     
-                    helpers::point_2d * hp_2point = dynamic_cast<helpers::point_2d*>(*i);
+                    helpers::point_2d * hp_2point = dynamic_cast<helpers::point_2d*>(current);
                     if (hp_2point != NULL) {
-                        helpers::point_3d * hp_3point = dynamic_cast<helpers::point_3d*>(*i);
+                        helpers::point_3d * hp_3point = dynamic_cast<helpers::point_3d*>(current);
 
-                        helpers::movable_2d * hp_2movable = dynamic_cast<helpers::movable_2d*>(*i);
+                        helpers::movable_2d * hp_2movable = dynamic_cast<helpers::movable_2d*>(current);
                         if (hp_2movable != NULL){
-                            helpers::movable_3d * hp_3movable = dynamic_cast<helpers::movable_3d*>(*i);
+                            helpers::movable_3d * hp_3movable = dynamic_cast<helpers::movable_3d*>(current);
                             hp_2movable->move_x(hp_2point->get_x()*(1-m_x_scaling));
                             hp_2movable->move_y(hp_2point->get_y()*(1-m_y_scaling));
 
@@ -207,9 +209,9 @@ namespace libkerat {
                             }
                         }
 
-                        helpers::scalable_2d * hp_2scalable = dynamic_cast<helpers::scalable_2d*>(*i);                        
+                        helpers::scalable_2d * hp_2scalable = dynamic_cast<helpers::scalable_2d*>(current);                        
                         if (hp_2scalable != NULL){
-                            helpers::scalable_3d * hp_3scalable = dynamic_cast<helpers::scalable_3d*>(*i);
+                            helpers::scalable_3d * hp_3scalable = dynamic_cast<helpers::scalable_3d*>(current);
                             hp_2scalable->scale_x(m_x_scaling, *hp_2point);
                             hp_2scalable->scale_y(m_y_scaling, *hp_2point);
                             
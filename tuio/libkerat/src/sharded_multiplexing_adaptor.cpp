@@ -0,0 +1,240 @@
+/**
+ * \file      sharded_multiplexing_adaptor.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:51 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/typedefs.hpp>
+#include <kerat/sharded_multiplexing_adaptor.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/message_pool.hpp>
+
+namespace libkerat {
+    namespace adaptors {
+
+        sharded_multiplexing_adaptor::shard::shard(sharded_multiplexing_adaptor & owner, size_t index)
+            :m_owner(owner), m_index(index)
+        { ; }
+
+        session_id_t sharded_multiplexing_adaptor::shard::allocate_mapped_id(){
+            pthread_mutex_lock(&m_owner.m_shared_mutex);
+            session_id_t retval = m_owner.get_next_session_id();
+            m_owner.m_alives.insert(retval);
+            pthread_mutex_unlock(&m_owner.m_shared_mutex);
+
+            return retval;
+        }
+
+        void sharded_multiplexing_adaptor::shard::release_mapped_id(const libkerat::session_id_t mapped){
+            pthread_mutex_lock(&m_owner.m_shared_mutex);
+            m_owner.m_alives.erase(mapped);
+            pthread_mutex_unlock(&m_owner.m_shared_mutex);
+        }
+
+        void sharded_multiplexing_adaptor::shard::merge_alives(message::alive & message) const {
+            pthread_mutex_lock(&m_owner.m_shared_mutex);
+            message.set_alives(m_owner.m_alives);
+            pthread_mutex_unlock(&m_owner.m_shared_mutex);
+        }
+
+        void sharded_multiplexing_adaptor::shard::merge_associations(const source_index source, message::alive_associations & message){
+            libkerat::message::alive_associations::associated_ids associations;
+
+            pthread_mutex_lock(&m_owner.m_shared_mutex);
+            m_owner.m_associations[associations_map::key_type(m_index, source)] = message.get_associations();
+            for (associations_map::const_iterator sr = m_owner.m_associations.begin(); sr != m_owner.m_associations.end(); ++sr){
+                associations.insert(sr->second.begin(), sr->second.end());
+            }
+            pthread_mutex_unlock(&m_owner.m_shared_mutex);
+
+            message.set_associations(associations);
+        }
+
+        sharded_multiplexing_adaptor::sharded_multiplexing_adaptor(size_t shards)
+            :m_parallel(false), m_generation(0), m_busy(0), m_running(true)
+        {
+            if (shards == 0){ shards = 1; }
+
+            pthread_mutex_init(&m_shared_mutex, NULL);
+            pthread_mutex_init(&m_pool_mutex, NULL);
+            pthread_cond_init(&m_work_cond, NULL);
+            pthread_cond_init(&m_done_cond, NULL);
+
+            for (size_t i = 0; i < shards; ++i){ m_shards.push_back(new shard(*this, i)); }
+            m_shard_items.resize(shards);
+
+            // the first shard is processed by the notifying thread
+            m_workers.reserve(shards - 1);
+            bool started = true;
+            for (size_t i = 1; (i < shards) && started; ++i){
+                worker current;
+                current.owner = this;
+                current.shard = i;
+
+                started = (pthread_create(&current.thread, NULL, &sharded_multiplexing_adaptor::worker_thread, &current) == 0);
+                if (started){
+                    m_workers.push_back(current);
+                    // the thread might have not read the context yet
+                    pthread_mutex_lock(&m_pool_mutex);
+                    while (m_busy < m_workers.size()){ pthread_cond_wait(&m_done_cond, &m_pool_mutex); }
+                    pthread_mutex_unlock(&m_pool_mutex);
+                }
+            }
+
+            if (started){
+                m_parallel = (shards > 1);
+            } else {
+                stop_workers();
+            }
+
+            m_busy = 0;
+        }
+
+        sharded_multiplexing_adaptor::~sharded_multiplexing_adaptor(){
+            stop_workers();
+
+            purge();
+            for (shard_vector::iterator i = m_shards.begin(); i != m_shards.end(); ++i){ delete *i; }
+            m_shards.clear();
+
+            pthread_cond_destroy(&m_done_cond);
+            pthread_cond_destroy(&m_work_cond);
+            pthread_mutex_destroy(&m_pool_mutex);
+            pthread_mutex_destroy(&m_shared_mutex);
+        }
+
+        void sharded_multiplexing_adaptor::stop_workers(){
+            pthread_mutex_lock(&m_pool_mutex);
+            m_running = false;
+            pthread_cond_broadcast(&m_work_cond);
+            pthread_mutex_unlock(&m_pool_mutex);
+
+            for (worker_vector::iterator i = m_workers.begin(); i != m_workers.end(); ++i){
+                pthread_join(i->thread, NULL);
+            }
+            m_workers.clear();
+            m_parallel = false;
+        }
+
+        void * sharded_multiplexing_adaptor::worker_thread(void * context){
+            worker * current = static_cast<worker *>(context);
+            sharded_multiplexing_adaptor * owner = current->owner;
+            size_t index = current->shard;
+
+            pthread_mutex_lock(&owner->m_pool_mutex);
+            unsigned long generation = owner->m_generation;
+            // let the constructor know the context is no longer needed
+            ++owner->m_busy;
+            pthread_cond_broadcast(&owner->m_done_cond);
+
+            while (true){
+                while (owner->m_running && (owner->m_generation == generation)){
+                    pthread_cond_wait(&owner->m_work_cond, &owner->m_pool_mutex);
+                }
+                if (!owner->m_running){ break; }
+                generation = owner->m_generation;
+                pthread_mutex_unlock(&owner->m_pool_mutex);
+
+                owner->process_shard(index);
+
+                pthread_mutex_lock(&owner->m_pool_mutex);
+                if (--owner->m_busy == 0){ pthread_cond_signal(&owner->m_done_cond); }
+            }
+
+            pthread_mutex_unlock(&owner->m_pool_mutex);
+
+            // the messages cloned here are released by other threads
+            internals::pool_trim();
+
+            return NULL;
+        }
+
+        size_t sharded_multiplexing_adaptor::get_shard_index(const bundle_handle & bundle) const {
+            const message::frame * msg_frame = bundle.get_frame();
+            if ((msg_frame == NULL) || (m_shards.size() == 1)){ return 0; }
+
+            // FNV-1a over the source identification
+            uint32_t hash = 2166136261U;
+            uint32_t numbers[2] = { msg_frame->get_address(), msg_frame->get_instance() };
+            for (size_t i = 0; i < 2; ++i){
+                for (size_t byte = 0; byte < 4; ++byte){
+                    hash = (hash ^ ((numbers[i] >> (byte * 8)) & 0xff)) * 16777619U;
+                }
+            }
+            const std::string & application = msg_frame->get_app_name();
+            for (std::string::const_iterator c = application.begin(); c != application.end(); ++c){
+                hash = (hash ^ (unsigned char)*c) * 16777619U;
+            }
+
+            return hash % m_shards.size();
+        }
+
+        void sharded_multiplexing_adaptor::process_shard(size_t index){
+            shard & current = *m_shards[index];
+            const std::vector<size_t> & items = m_shard_items[index];
+
+            for (std::vector<size_t>::const_iterator i = items.begin(); i != items.end(); ++i){
+                batch_item & item = m_batch[*i];
+                current.process_bundle(item.input, *item.output);
+            }
+        }
+
+        void sharded_multiplexing_adaptor::notify(const client * notifier){
+            purge();
+
+            bundle_stack data = notifier->get_stack();
+            size_t active_shards = 0;
+            size_t last_shard = 0;
+            while (data.get_length() > 0){
+                batch_item item;
+                item.input = data.get_update(bundle_stack::INDEX_OLDEST);
+                item.output = new bundle_handle;
+
+                size_t index = get_shard_index(item.input);
+                if (m_shard_items[index].empty()){ ++active_shards; }
+                m_shard_items[index].push_back(m_batch.size());
+                last_shard = index;
+
+                m_batch.push_back(item);
+            }
+
+            if (!m_parallel || (active_shards < 2)){
+                // nothing to run concurrently, spare the wake-ups
+                if (active_shards == 1){
+                    process_shard(last_shard);
+                } else {
+                    for (size_t i = 0; i < m_shards.size(); ++i){ process_shard(i); }
+                }
+            } else {
+                pthread_mutex_lock(&m_pool_mutex);
+                m_busy = m_workers.size();
+                ++m_generation;
+                pthread_cond_broadcast(&m_work_cond);
+                pthread_mutex_unlock(&m_pool_mutex);
+
+                process_shard(0);
+
+                pthread_mutex_lock(&m_pool_mutex);
+                while (m_busy > 0){ pthread_cond_wait(&m_done_cond, &m_pool_mutex); }
+                pthread_mutex_unlock(&m_pool_mutex);
+            }
+
+            // the output keeps the order of the input
+            for (batch_vector::iterator i = m_batch.begin(); i != m_batch.end(); ++i){
+                bm_stack_append(m_processed_frames, i->output);
+            }
+            m_batch.clear();
+            for (shard_items::iterator i = m_shard_items.begin(); i != m_shard_items.end(); ++i){ i->clear(); }
+
+            notify_listeners();
+        }
+
+        void sharded_multiplexing_adaptor::purge(){ bm_stack_clear(m_processed_frames); }
+
+        int sharded_multiplexing_adaptor::process_bundle(const bundle_handle & to_process, bundle_handle & output_frame){
+            return m_shards[get_shard_index(to_process)]->process_bundle(to_process, output_frame);
+        }
+
+    } // ns adaptors
+} // ns libkerat
@@ -15,16 +15,63 @@
 #include <stdio.h>
 #include <iostream>
 #include <algorithm>
+#include <errno.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_RECVMMSG
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif
 
 namespace libkerat {
 
     using namespace message;
 
+#ifdef HAVE_RECVMMSG
+    struct simple_client::batch_buffers {
+        //! \brief Maximal count of datagrams received by single recvmmsg call
+        static const unsigned int SLOTS = 32;
+        //! \brief Maximal size of single datagram, same as liblo uses
+        static const size_t SLOT_SIZE = 32768;
+
+        batch_buffers();
+        ~batch_buffers();
+
+        char * data;
+        struct mmsghdr headers[SLOTS];
+        struct iovec vectors[SLOTS];
+    };
+
+    simple_client::batch_buffers::batch_buffers(){
+        data = new char[SLOTS * SLOT_SIZE];
+        memset(headers, 0, sizeof(headers));
+        for (unsigned int i = 0; i < SLOTS; ++i){
+            vectors[i].iov_base = data + (i * SLOT_SIZE);
+            vectors[i].iov_len = SLOT_SIZE;
+            headers[i].msg_hdr.msg_iov = vectors + i;
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    simple_client::batch_buffers::~batch_buffers(){
+        delete [] data;
+        data = NULL;
+    }
+#else
+    struct simple_client::batch_buffers { };
+#endif
+
     int simple_client_lo_message_handler(const char *path, const char *types, lo_arg **argv, int argc, lo_message msg, void *user_data);
 
     simple_client::simple_client(uint16_t port, bool accept_unknown)
         throw (libkerat::exception::net_setup_error)
-        :m_foreign(false), m_accept_unknown(accept_unknown), m_last_events_count(0)
+        :m_foreign(false), m_accept_unknown(accept_unknown), m_last_events_count(0),
+        m_batch(NULL), m_last_wakeup_datagrams(0), m_wakeups_count(0), m_datagrams_count(0),
+        m_decoder(&native_message_handler, &native_unknown_handler, this), m_native(false),
+        m_delta(false)
     {
 
         char buffer[8]; //5 should be enough
@@ -47,14 +94,16 @@ namespace libkerat {
         }
         
         m_lo_fd = lo_server_get_socket_fd(m_lo_serv);
-
-        m_reader = (m_lo_fd > 0)?&simple_client::read_socket_fd_existing:&simple_client::read_socket_fd_nonexisting;
+        select_reader();
     }
 
     simple_client::simple_client(lo_server instance, bool accept_unknown)
         throw (libkerat::exception::net_setup_error)
         :m_lo_serv(instance), m_foreign(true), 
-        m_accept_unknown(accept_unknown), m_last_events_count(0)
+        m_accept_unknown(accept_unknown), m_last_events_count(0),
+        m_batch(NULL), m_last_wakeup_datagrams(0), m_wakeups_count(0), m_datagrams_count(0),
+        m_decoder(&native_message_handler, &native_unknown_handler, this), m_native(false),
+        m_delta(false)
     {
         if (m_lo_serv == NULL){
             throw libkerat::exception::net_setup_error("Given lo_server instance is NULL!");
@@ -69,10 +118,13 @@ namespace libkerat {
         }
 
         m_lo_fd = lo_server_get_socket_fd(m_lo_serv);
-        m_reader = (m_lo_fd > 0)?&simple_client::read_socket_fd_existing:&simple_client::read_socket_fd_nonexisting;
+        select_reader();
     }
 
     simple_client::~simple_client(){
+        delete m_batch;
+        m_batch = NULL;
+
         if (m_foreign){
             lo_server_del_method(m_lo_serv, "/tuio2/[!_]*", NULL);
         } else {
@@ -124,17 +176,13 @@ namespace libkerat {
 
         cl->m_results.clear();
 
-        convertor_map::const_iterator entry = cl->m_convertors.find(path);
+        message_convertor_entry * entry = static_cast<message_convertor_entry *>(cl->m_decoder.get_target(path));
         bool retval = false;
 
         // convertor for given message type not found!
-        if (entry == cl->m_convertors.end()){
+        if (entry == NULL){
             if (cl->m_accept_unknown){
-                kerat_message * rslt = NULL;
-                retval = internals::parsers::parse_generic_osc_message(&rslt, path, msg);
-                if (retval && (rslt != NULL)){
-                    cl->m_results.push_back(rslt);
-                }
+                retval = cl->convert_unknown(path, msg);
             } else {
                 if (!cl->m_foreign){
                     lo_server_del_method(cl->m_lo_serv, path, types);
@@ -142,13 +190,53 @@ namespace libkerat {
                 return -2;
             }
         } else {
-            message_convertor ptr = entry->second->m_callback;
-            retval = (*ptr)(cl->m_results, path, types, argv, argc, entry->second->m_user_data);
+            message_convertor ptr = entry->m_callback;
+            retval = (*ptr)(cl->m_results, path, types, argv, argc, entry->m_user_data);
+        }
+
+        cl->integrate_results();
+
+        return !retval;
+    }
+
+    void simple_client::native_message_handler(void * target, const char * path, const char * types, lo_arg ** argv, int argc, void * user_data){
+        simple_client * cl = static_cast<simple_client *>(user_data);
+        message_convertor_entry * entry = static_cast<message_convertor_entry *>(target);
+
+        cl->m_results.clear();
+        (*entry->m_callback)(cl->m_results, path, types, argv, argc, entry->m_user_data);
+        cl->integrate_results();
+    }
+
+    void simple_client::native_unknown_handler(const char * path, void * message, size_t size, void * user_data){
+        simple_client * cl = static_cast<simple_client *>(user_data);
+        if (!cl->m_accept_unknown){ return; }
+
+        // rare enough to afford the liblo representation
+        int result = 0;
+        lo_message msg = lo_message_deserialise(message, size, &result);
+        if (msg == NULL){ return; }
+
+        cl->m_results.clear();
+        cl->convert_unknown(path, msg);
+        cl->integrate_results();
+
+        lo_message_free(msg);
+    }
+
+    bool simple_client::convert_unknown(const char * path, lo_message msg){
+        kerat_message * rslt = NULL;
+        bool retval = internals::parsers::parse_generic_osc_message(&rslt, path, msg);
+        if (retval && (rslt != NULL)){
+            m_results.push_back(rslt);
         }
-            
-        bool accept_this_message = !cl->m_current_bundle.empty();
+        return retval;
+    }
 
-        for (internals::convertor_output_container::iterator result = cl->m_results.begin(); result != cl->m_results.end(); ++result){
+    void simple_client::integrate_results(){
+        bool accept_this_message = !m_current_bundle.empty();
+
+        for (internals::convertor_output_container::iterator result = m_results.begin(); result != m_results.end(); ++result){
 
             const libkerat::message::frame * frm = dynamic_cast<const libkerat::message::frame *>(*result);
 
@@ -156,25 +244,42 @@ namespace libkerat {
             // current budle is empty only if the previous bundle was ended with alive message
             // There for, incomplete bundle leaves mess and has to be cleared
             if (frm != NULL){
-                bm_handle_clear(cl->m_current_bundle);
+                bm_handle_clear(m_current_bundle);
                 accept_this_message = true;
             }
 
             if (accept_this_message) {
-                bm_handle_insert(cl->m_current_bundle, bm_handle_end(cl->m_current_bundle), *result);
+                bm_handle_insert(m_current_bundle, bm_handle_end(m_current_bundle), *result);
                 const libkerat::message::alive * alv = dynamic_cast<const libkerat::message::alive *>(*result);
                 if (alv != NULL){
-                    bm_stack_append(cl->m_received_frames, bm_handle_clone(cl->m_current_bundle));
-                    bm_handle_clear(cl->m_current_bundle);
+                    if (m_delta){ m_delta_decoder.decode(m_current_bundle); }
+                    bm_stack_append(m_received_frames, bm_handle_clone_shared(m_current_bundle));
+                    bm_handle_clear(m_current_bundle);
                 }
                 *result = NULL;
             }
 
             if (*result != NULL){ delete *result; }
         }
-        cl->m_results.clear();
-        
-        return !retval;
+        m_results.clear();
+    }
+
+    bool simple_client::set_native_decoding(bool flag){
+        bool retval = m_native;
+        m_native = flag;
+        return retval;
+    }
+
+    bool simple_client::set_delta_reconstruction(bool flag){
+        bool retval = m_delta;
+        m_delta = flag;
+        if (!m_delta){ m_delta_decoder.reset(); }
+        return retval;
+    }
+
+    bool simple_client::dispatch_data(void * data, size_t size){
+        if (m_native){ return m_decoder.decode(data, size); }
+        return lo_server_dispatch_data(m_lo_serv, data, size) >= 0;
     }
 
     simple_client::message_convertor_entry simple_client::enable_convertor(const message_convertor_entry& convertor){
@@ -189,6 +294,7 @@ namespace libkerat {
             if (i == m_convertors.end()){
                 conv->m_osc_paths.push_back(*path);
                 m_convertors.insert(convertor_map::value_type(*path, conv));
+                m_decoder.set_target(*path, conv);
                 lo_server_add_method(m_lo_serv, path->c_str(), NULL, &lo_message_handler, this);
             }
         }
@@ -206,6 +312,7 @@ namespace libkerat {
 
             // cleanup
             if (i->second->m_osc_paths.empty()){ delete i->second; }
+            m_decoder.set_target(path, NULL);
             lo_server_del_method(m_lo_serv, path.c_str(), NULL);
             m_convertors.erase(i);
         }
@@ -227,19 +334,53 @@ namespace libkerat {
 
     bundle_stack simple_client::get_stack() const { return m_received_frames; }
 
+    bool simple_client::set_batch_receive(bool flag){
+        if (!flag){
+            delete m_batch;
+            m_batch = NULL;
+            select_reader();
+            return true;
+        }
+
+#ifdef HAVE_RECVMMSG
+        if ((m_lo_fd > 0) && (lo_server_get_protocol(m_lo_serv) == LO_UDP)){
+            if (m_batch == NULL){
+                m_batch = new batch_buffers;
+                m_last_wakeup_datagrams = 0;
+                m_wakeups_count = 0;
+                m_datagrams_count = 0;
+            }
+            select_reader();
+            return true;
+        }
+#endif
+
+        return false;
+    }
+
+    void simple_client::select_reader(){
+        if (m_lo_fd <= 0){
+            m_reader = &simple_client::read_socket_fd_nonexisting;
+        } else if (m_batch != NULL){
+            m_reader = &simple_client::read_socket_fd_batch;
+        } else {
+            m_reader = &simple_client::read_socket_fd_existing;
+        }
+    }
+
     void simple_client::read_socket_fd_existing(int count, timespec timeout){
 
         bool keep = true;
         m_last_events_count = 0;
 
         struct timespec currtime;
-        clock_gettime(CLOCK_REALTIME, &currtime);
+        clock_gettime(CLOCK_MONOTONIC, &currtime);
         struct timespec limit = nanotimeradd(currtime, timeout);
 
         while (keep){
 
             // check whether we're still supposed to be running
-            clock_gettime(CLOCK_REALTIME, &currtime);
+            clock_gettime(CLOCK_MONOTONIC, &currtime);
             struct timespec remaining = nanotimersub(limit, currtime);
             if (((count - m_last_events_count) <= 0) || (remaining.tv_sec < 0)){ keep = false; continue; }
 
@@ -291,6 +432,66 @@ namespace libkerat {
         }
     }
 
+#ifdef HAVE_RECVMMSG
+    void simple_client::read_socket_fd_batch(int count, timespec timeout){
+
+        m_last_events_count = 0;
+
+        struct timespec currtime;
+        clock_gettime(CLOCK_MONOTONIC, &currtime);
+        struct timespec limit = nanotimeradd(currtime, timeout);
+
+        while ((count - m_last_events_count) > 0){
+
+            // check whether we're still supposed to be running
+            clock_gettime(CLOCK_MONOTONIC, &currtime);
+            struct timespec remaining = nanotimersub(limit, currtime);
+            if (remaining.tv_sec < 0){ break; }
+
+            fd_set keeper;
+            FD_ZERO(&keeper);
+            FD_SET(m_lo_fd, &keeper);
+
+            int retval = pselect(m_lo_fd + 1, &keeper, NULL, NULL, &remaining, NULL);
+
+            if (retval == -1) {
+                if (errno != EINTR){ std::cerr << "Failed to read data from lo_fd" << std::endl; }
+                continue;
+            } else if ((retval == 0) || !FD_ISSET(m_lo_fd, &keeper)){
+                continue;
+            }
+
+            // drain everything that is pending, full batch means there might be more
+            size_t handled = 0;
+            int received = 0;
+            do {
+                received = recvmmsg(m_lo_fd, m_batch->headers, batch_buffers::SLOTS, MSG_DONTWAIT, NULL);
+
+                for (int i = 0; i < received; ++i){
+                    struct mmsghdr & header = m_batch->headers[i];
+                    if ((header.msg_hdr.msg_flags & MSG_TRUNC) != 0){
+                        std::cerr << "Datagram exceeds " << batch_buffers::SLOT_SIZE << " bytes, dropped" << std::endl;
+                    } else {
+                        dispatch_data(header.msg_hdr.msg_iov->iov_base, header.msg_len);
+                    }
+                }
+
+                if (received > 0){ handled += received; }
+            } while (received == (int)batch_buffers::SLOTS);
+
+            m_last_wakeup_datagrams = handled;
+            m_datagrams_count += handled;
+            ++m_wakeups_count;
+            m_last_events_count += handled;
+        }
+    }
+#else
+    void simple_client::read_socket_fd_batch(int count, timespec timeout){
+        // unreachable, set_batch_receive refuses to enable batched mode
+        read_socket_fd_existing(count, timeout);
+    }
+#endif
+
     void simple_client::init_standard_convertors(){
         internals::convertor_list convertors(internals::get_libkerat_convertors());
         std::for_each(convertors.begin(), convertors.end(), get_enabler_functor());
@@ -10,18 +10,47 @@
 #include <lo/lo.h>
 #include <string>
 #include <iostream>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
 
 namespace libkerat {
 
+    struct simple_server::send_batch {
+        struct iovec vector;
+#ifdef HAVE_SENDMMSG
+        std::vector<struct mmsghdr> headers;
+        //! \brief Index of the target each header is addressed to
+        std::vector<size_t> targets;
+#endif
+    };
+
+    simple_server::target_stats::target_stats()
+        :bundles(0), bytes(0), errors(0)
+    { ; }
+
     simple_server::simple_server()
-        :m_target(NULL), m_frame_template(OUT_OF_ORDER_ID), m_printer(std::cerr)
+        :m_frame_template(OUT_OF_ORDER_ID), m_printer(std::cerr),
+        m_socket_ipv4(-1), m_socket_ipv6(-1), m_multicast_ttl(0), m_direct(true),
+        m_delta(NULL), m_batch(new send_batch)
     {
         m_timetag.sec = 0;
         m_timetag.frac = 1;
     }
     
     simple_server::simple_server(lo_address target_client) throw (libkerat::exception::net_setup_error)
-        :m_target(NULL), m_frame_template(OUT_OF_ORDER_ID), m_printer(std::cerr)
+        :m_frame_template(OUT_OF_ORDER_ID), m_printer(std::cerr),
+        m_socket_ipv4(-1), m_socket_ipv6(-1), m_multicast_ttl(0), m_direct(true),
+        m_delta(NULL), m_batch(new send_batch)
     {
         m_timetag.sec = 0;
         m_timetag.frac = 1;
@@ -32,20 +61,35 @@ namespace libkerat {
     simple_server::simple_server(std::string target_url, std::string appname, addr_ipv4_t address,
             instance_id_t instance, dimmension_t sensor_width, dimmension_t sensor_height
     ) throw (libkerat::exception::net_setup_error)
-        :m_target(NULL), m_frame_template(OUT_OF_ORDER_ID), m_printer(std::cerr)
+        :m_frame_template(OUT_OF_ORDER_ID), m_printer(std::cerr),
+        m_socket_ipv4(-1), m_socket_ipv6(-1), m_multicast_ttl(0), m_direct(true),
+        m_delta(NULL), m_batch(new send_batch)
     {
+        m_timetag.sec = 0;
+        m_timetag.frac = 1;
+
         size_t proto = target_url.find("://");
         if ((proto == std::string::npos) || (proto > target_url.find_first_of(":/"))){
             target_url = std::string("osc.udp://").append(target_url);
         }
-        m_target = lo_address_new_from_url(target_url.c_str());
+        lo_address target = lo_address_new_from_url(target_url.c_str());
 
-        if (m_target == NULL){
+        if (target == NULL){
+            delete m_batch;
             std::string error_message = "Failed to create OSC client for url: ";
             error_message.append(target_url);
             throw libkerat::exception::net_setup_error(error_message);
         }
-        
+
+        try {
+            add_target(target);
+        } catch (const libkerat::exception::net_setup_error &){
+            lo_address_free(target);
+            delete m_batch;
+            throw;
+        }
+        lo_address_free(target);
+
         m_frame_template.set_app_name(appname);
         m_frame_template.set_address(address);
         m_frame_template.set_instance(instance);
@@ -56,33 +100,191 @@ namespace libkerat {
 
 
     simple_server::~simple_server(){
-        if (m_target != NULL){
-            lo_address_free(m_target);
-            m_target = NULL;
+        for (target_list::iterator i = m_targets.begin(); i != m_targets.end(); ++i){
+            lo_address_free(i->address);
         }
+        m_targets.clear();
+
+        close_sockets();
+
+        delete m_delta;
+        m_delta = NULL;
+
+        delete m_batch;
+        m_batch = NULL;
     }
 
     void simple_server::set_target(const lo_address target_client)
         throw (libkerat::exception::net_setup_error)
     {
-        if (m_target != NULL){
-            lo_address_free(m_target);
-            m_target = NULL;
+        for (target_list::iterator i = m_targets.begin(); i != m_targets.end(); ++i){
+            lo_address_free(i->address);
         }
+        m_targets.clear();
+
+        close_sockets();
 
         if (target_client != NULL){
-            m_target = lo_address_new_with_proto(
-                lo_address_get_protocol(target_client),
-                lo_address_get_hostname(target_client),
-                lo_address_get_port(target_client)
-            );
-
-            if (m_target == NULL){
-                throw libkerat::exception::net_setup_error("Failed to create OSC client");
+            add_target(target_client);
+        }
+    }
+
+    bool simple_server::add_target(const lo_address target_client)
+        throw (libkerat::exception::net_setup_error)
+    {
+        if (target_client == NULL){ return false; }
+
+        target_entry target;
+        target.address = lo_address_new_with_proto(
+            lo_address_get_protocol(target_client),
+            lo_address_get_hostname(target_client),
+            lo_address_get_port(target_client)
+        );
+
+        if (target.address == NULL){
+            throw libkerat::exception::net_setup_error("Failed to create OSC client");
+        }
+
+        lo_address_set_ttl(target.address, lo_address_get_ttl(target_client));
+
+        // avoid sending the same data twice
+        char * url = lo_address_get_url(target.address);
+        bool present = false;
+        for (target_list::const_iterator i = m_targets.begin(); (i != m_targets.end()) && !present; ++i){
+            char * present_url = lo_address_get_url(i->address);
+            present = (strcmp(url, present_url) == 0);
+            free(present_url);
+        }
+        free(url);
+
+        if (present){
+            lo_address_free(target.address);
+            return false;
+        }
+
+        setup_direct_target(target);
+        m_targets.push_back(target);
+
+        // the new target knows nothing yet
+        if (m_delta != NULL){ m_delta->reset(); }
+
+        return true;
+    }
+
+    bool simple_server::del_target(const lo_address target_client){
+        if (target_client == NULL){ return false; }
+
+        char * url = lo_address_get_url(target_client);
+        bool deleted = false;
+        for (target_list::iterator i = m_targets.begin(); i != m_targets.end(); ++i){
+            char * present_url = lo_address_get_url(i->address);
+            bool matches = (strcmp(url, present_url) == 0);
+            free(present_url);
+
+            if (matches){
+                lo_address_free(i->address);
+                // the iterator is invalid from now on
+                m_targets.erase(i);
+                deleted = true;
+                break;
             }
+        }
+        free(url);
+
+        return deleted;
+    }
+
+    bool simple_server::set_direct_encoding(bool flag){
+        bool retval = m_direct;
+        m_direct = flag;
+        return retval;
+    }
+
+    void simple_server::set_delta_encoding(bool flag, float epsilon, unsigned int keyframe_interval){
+        delete m_delta;
+        m_delta = NULL;
 
-            lo_address_set_ttl(m_target, lo_address_get_ttl(target_client));
+        if (flag){ m_delta = new internals::delta_encoder(epsilon, keyframe_interval); }
+    }
+
+    void simple_server::setup_direct_target(target_entry & target){
+        target.socket = -1;
+        target.socket_address_length = 0;
+
+        // TCP streams need liblo's framing, only UDP is sent directly
+        if (lo_address_get_protocol(target.address) != LO_UDP){ return; }
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+
+        struct addrinfo * resolved = NULL;
+        if (getaddrinfo(lo_address_get_hostname(target.address), lo_address_get_port(target.address), &hints, &resolved) != 0){
+            // let liblo handle (and report) it
+            return;
         }
+
+        int & fd = (resolved->ai_family == AF_INET6)?m_socket_ipv6:m_socket_ipv4;
+        if (fd == -1){
+            fd = socket(resolved->ai_family, resolved->ai_socktype, resolved->ai_protocol);
+
+            if (fd != -1){
+                // same socket setup as liblo does
+                int opt = 1;
+                setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &opt, sizeof(opt));
+
+                if (m_multicast_ttl > 0){
+                    if (resolved->ai_family == AF_INET6){
+                        setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &m_multicast_ttl, sizeof(m_multicast_ttl));
+                    } else {
+                        unsigned char ttl_byte = m_multicast_ttl;
+                        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl_byte, sizeof(ttl_byte));
+                    }
+                }
+            }
+        }
+
+        if (fd != -1){
+            memcpy(&target.socket_address, resolved->ai_addr, resolved->ai_addrlen);
+            target.socket_address_length = resolved->ai_addrlen;
+            target.socket = fd;
+
+            // the sockets are shared, so the highest TTL wins
+            int ttl = lo_address_get_ttl(target.address);
+            if (ttl > m_multicast_ttl){
+                m_multicast_ttl = ttl;
+                unsigned char ttl_byte = ttl;
+                if (m_socket_ipv4 != -1){
+                    setsockopt(m_socket_ipv4, IPPROTO_IP, IP_MULTICAST_TTL, &ttl_byte, sizeof(ttl_byte));
+                }
+                if (m_socket_ipv6 != -1){
+                    setsockopt(m_socket_ipv6, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &ttl, sizeof(ttl));
+                }
+            }
+        }
+
+        freeaddrinfo(resolved);
+    }
+
+    void simple_server::close_sockets(){
+        if (m_socket_ipv4 != -1){
+            close(m_socket_ipv4);
+            m_socket_ipv4 = -1;
+        }
+        if (m_socket_ipv6 != -1){
+            close(m_socket_ipv6);
+            m_socket_ipv6 = -1;
+        }
+        m_multicast_ttl = 0;
+    }
+
+    size_t simple_server::count_lo_targets() const {
+        size_t retval = 0;
+        for (target_list::const_iterator i = m_targets.begin(); i != m_targets.end(); ++i){
+            if (i->socket == -1){ ++retval; }
+        }
+        return retval;
     }
 
     bool simple_server::append_clone(const kerat_message* msg){
@@ -103,11 +305,7 @@ namespace libkerat {
     }
 
     void simple_server::clear_message_stack(){
-        for (handle_iterator i = bm_handle_begin(m_bundle); i != bm_handle_end(m_bundle); i++){
-            delete *i;
-            *i = NULL;
-        }
-
+        // messages might be shared with other bundles, clearing releases them properly
         bm_handle_clear(m_bundle);
     }
     
@@ -138,29 +336,50 @@ namespace libkerat {
 
         bool retval = true;
 
-        // setup bundle
-        lo_bundle bundle = lo_bundle_new(m_timetag);
+        if (m_delta != NULL){ m_delta->encode(m_bundle); }
 
-        // setup & append frame message
-        for (bundle_handle::const_iterator i = m_bundle.begin(); i != m_bundle.end(); i++){
-            bool tmpretval = imprint_bundle(bundle, *i);
-            // if an error has occured, print the message which failed
-            if (!tmpretval){ 
-                std::cerr << "libkerat::simple_server::send: Failed to imprint message: ";
-                m_printer.print(*i);
-                std::cerr << std::endl;
-            }
-            retval &= tmpretval;
+        size_t lo_targets = count_lo_targets();
+        bool datagram_targets = lo_targets < m_targets.size();
+
+        bool encoded = datagram_targets && m_direct && encode_bundle();
+        if (encoded){
+            send_datagrams(m_encoder.data(), m_encoder.size());
         }
 
-        if (m_target != NULL){
-            // send bundle
-            lo_send_bundle(m_target, bundle);
+        if (!encoded || (lo_targets > 0)){
+            // setup bundle
+            lo_bundle bundle = lo_bundle_new(m_timetag);
+
+            for (bundle_handle::const_iterator i = m_bundle.begin(); i != m_bundle.end(); i++){
+                bool tmpretval = imprint_bundle(bundle, *i);
+                // if an error has occured, print the message which failed
+                if (!tmpretval){ 
+                    std::cerr << "libkerat::simple_server::send: Failed to imprint message: ";
+                    m_printer.print(*i);
+                    std::cerr << std::endl;
+                }
+                retval &= tmpretval;
+            }
+
+            // serialised once for all the UDP targets
+            if (!encoded && datagram_targets){
+                size_t size = 0;
+                void * data = lo_bundle_serialise(bundle, NULL, &size);
+                if (data != NULL){
+                    send_datagrams(data, size);
+                    free(data);
+                }
+            }
+
+            if (lo_targets > 0){
+                send_lo_bundle(bundle);
+            }
+
+            // cleanup
+            lo_bundle_free_messages(bundle);
+            bundle = NULL;
         }
 
-        // cleanup
-        lo_bundle_free_messages(bundle);
-        bundle = NULL;
         clear_message_stack();
 
         // next bundle timetag setup
@@ -169,6 +388,96 @@ namespace libkerat {
 
         return retval;
     }
-    
+
+    bool simple_server::encode_bundle(){
+        for (bundle_handle::const_iterator i = m_bundle.begin(); i != m_bundle.end(); i++){
+            if (!internals::osc_encoder::supports(*i)){ return false; }
+        }
+
+        m_encoder.begin_bundle(m_timetag);
+        for (bundle_handle::const_iterator i = m_bundle.begin(); i != m_bundle.end(); i++){
+            m_encoder.append(*i);
+        }
+
+        return true;
+    }
+
+    void simple_server::send_datagrams(const void * data, size_t size){
+        m_batch->vector.iov_base = const_cast<void *>(data);
+        m_batch->vector.iov_len = size;
+
+        const int sockets[2] = { m_socket_ipv4, m_socket_ipv6 };
+        for (int s = 0; s < 2; ++s){
+            if (sockets[s] == -1){ continue; }
+
+#ifdef HAVE_SENDMMSG
+            m_batch->headers.clear();
+            m_batch->targets.clear();
+
+            for (size_t i = 0; i < m_targets.size(); ++i){
+                target_entry & target = m_targets[i];
+                if (target.socket != sockets[s]){ continue; }
+
+                struct mmsghdr header;
+                memset(&header, 0, sizeof(header));
+                header.msg_hdr.msg_name = &target.socket_address;
+                header.msg_hdr.msg_namelen = target.socket_address_length;
+                header.msg_hdr.msg_iov = &m_batch->vector;
+                header.msg_hdr.msg_iovlen = 1;
+
+                m_batch->headers.push_back(header);
+                m_batch->targets.push_back(i);
+            }
+
+            size_t sent = 0;
+            while (sent < m_batch->headers.size()){
+                int retval = sendmmsg(sockets[s], &m_batch->headers[sent], m_batch->headers.size() - sent, 0);
+
+                if (retval <= 0){
+                    if ((retval == -1) && (errno == EINTR)){ continue; }
+                    // sendmmsg stops at the first failing datagram, skip the target
+                    ++m_targets[m_batch->targets[sent]].stats.errors;
+                    ++sent;
+                    continue;
+                }
+
+                for (int i = 0; i < retval; ++i, ++sent){
+                    target_stats & stats = m_targets[m_batch->targets[sent]].stats;
+                    ++stats.bundles;
+                    stats.bytes += m_batch->headers[sent].msg_len;
+                }
+            }
+#else
+            for (target_list::iterator target = m_targets.begin(); target != m_targets.end(); ++target){
+                if (target->socket != sockets[s]){ continue; }
+
+                ssize_t retval = sendto(sockets[s], data, size, 0,
+                    reinterpret_cast<struct sockaddr *>(&target->socket_address), target->socket_address_length
+                );
+
+                if (retval == -1){
+                    ++target->stats.errors;
+                } else {
+                    ++target->stats.bundles;
+                    target->stats.bytes += retval;
+                }
+            }
+#endif
+        }
+    }
+
+    void simple_server::send_lo_bundle(lo_bundle bundle){
+        for (target_list::iterator target = m_targets.begin(); target != m_targets.end(); ++target){
+            if (target->socket != -1){ continue; }
+
+            int retval = lo_send_bundle(target->address, bundle);
+            if (retval == -1){
+                ++target->stats.errors;
+            } else {
+                ++target->stats.bundles;
+                target->stats.bytes += retval;
+            }
+        }
+    }
     
 } // ns libkerat
@@ -0,0 +1,236 @@
+/**
+ * \file      threaded_client.cpp
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:08 UTC
+ * \copyright BSD
+ */
+
+#include <kerat/typedefs.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/threaded_client.hpp>
+#include <kerat/message_pool.hpp>
+#include <kerat/utils.hpp>
+#include <errno.h>
+#include <time.h>
+
+namespace libkerat {
+
+    threaded_client::receiver_listener::receiver_listener(threaded_client & owner)
+        :m_owner(owner)
+    { ; }
+
+    void threaded_client::receiver_listener::notify(const client * notifier){
+        bundle_stack stack = notifier->get_stack();
+        while (stack.get_length() > 0){
+            m_owner.publish(new bundle_handle(stack.get_update()));
+        }
+    }
+
+    threaded_client::threaded_client(client & receiver, size_t queue_capacity, overflow_policy policy)
+        :m_receiver(receiver), m_receiver_listener(*this), m_queue(queue_capacity), m_policy(policy),
+        m_running(false), m_consumer_waiting(false),
+        m_max_depth(0), m_dropped(0), m_coalesced(0), m_published(0)
+    {
+        pthread_mutex_init(&m_wait_mutex, NULL);
+
+        // wait timeouts are computed from the monotonic clock
+        pthread_condattr_t attributes;
+        pthread_condattr_init(&attributes);
+        pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+        pthread_cond_init(&m_wait_cond, &attributes);
+        pthread_condattr_destroy(&attributes);
+
+        m_receiver.add_listener(&m_receiver_listener);
+    }
+
+    threaded_client::~threaded_client(){
+        stop();
+        m_receiver.del_listener(&m_receiver_listener);
+
+        bundle_handle * bundle = NULL;
+        while (m_queue.pop(bundle)){ delete bundle; }
+
+        for (pending_list::iterator i = m_pending.begin(); i != m_pending.end(); ++i){
+            delete i->second;
+        }
+        m_pending.clear();
+        m_pending_sources.clear();
+
+        purge();
+
+        pthread_cond_destroy(&m_wait_cond);
+        pthread_mutex_destroy(&m_wait_mutex);
+    }
+
+    bool threaded_client::start(){
+        if (m_running){ return true; }
+
+        m_running = true;
+        if (pthread_create(&m_thread, NULL, &threaded_client::receiver_thread, this) != 0){
+            m_running = false;
+        }
+
+        return m_running;
+    }
+
+    void threaded_client::stop(){
+        if (!m_running){ return; }
+
+        m_running = false;
+        pthread_join(m_thread, NULL);
+    }
+
+    void * threaded_client::receiver_thread(void * self){
+        threaded_client * owner = static_cast<threaded_client *>(self);
+
+        // short timeout so the stop request is noticed in time
+        struct timespec timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_nsec = 100000000;
+
+        while (owner->m_running){
+            owner->flush_pending();
+            owner->m_receiver.load(1, timeout);
+        }
+
+        // unpublished bundles would never be taken now
+        owner->m_receiver.purge();
+        internals::pool_trim();
+
+        return NULL;
+    }
+
+    void threaded_client::publish(bundle_handle * bundle){
+        // keep the bundles in order, older pending bundles go first
+        if (!m_pending.empty()){ flush_pending(); }
+
+        if (m_pending.empty() && m_queue.push(bundle)){
+            __sync_add_and_fetch(&m_published, 1);
+            size_t depth = m_queue.size();
+            raise_max_depth(depth);
+            wake_consumer();
+            return;
+        }
+
+        switch (m_policy){
+            case OVERFLOW_COALESCE_PER_SOURCE: {
+                const message::frame * frame = bundle->get_frame();
+                if (frame == NULL){
+                    delete bundle;
+                    __sync_add_and_fetch(&m_dropped, 1);
+                    return;
+                }
+
+                source_key_type key = source_key_type::from_frame(*frame);
+
+                pending_map::iterator found = m_pending_sources.find(key);
+                if (found != m_pending_sources.end()){
+                    // newer state of the same source supersedes the pending one
+                    delete found->second->second;
+                    found->second->second = bundle;
+                    __sync_add_and_fetch(&m_coalesced, 1);
+                } else {
+                    m_pending.push_back(pending_entry(key, bundle));
+                    m_pending_sources.insert(pending_map::value_type(key, --m_pending.end()));
+                }
+                break;
+            }
+            case OVERFLOW_DROP_OLDEST:
+            default: {
+                bundle_handle * oldest = NULL;
+                if (m_queue.evict(oldest)){
+                    delete oldest;
+                    __sync_add_and_fetch(&m_dropped, 1);
+                }
+
+                // the consumer might have emptied the queue meanwhile, push must succeed now
+                if (m_queue.push(bundle)){
+                    __sync_add_and_fetch(&m_published, 1);
+                    raise_max_depth(m_queue.capacity());
+                    wake_consumer();
+                } else {
+                    delete bundle;
+                    __sync_add_and_fetch(&m_dropped, 1);
+                }
+                break;
+            }
+        }
+    }
+
+    void threaded_client::flush_pending(){
+        bool published = false;
+
+        while (!m_pending.empty() && m_queue.push(m_pending.front().second)){
+            m_pending_sources.erase(m_pending.front().first);
+            m_pending.pop_front();
+            __sync_add_and_fetch(&m_published, 1);
+            published = true;
+        }
+
+        if (published){
+            size_t depth = m_queue.size();
+            raise_max_depth(depth);
+            wake_consumer();
+        }
+    }
+
+    void threaded_client::raise_max_depth(size_t depth){
+        size_t seen = load_counter(m_max_depth);
+        while ((depth > seen) && !__sync_bool_compare_and_swap(&m_max_depth, seen, depth)){
+            seen = load_counter(m_max_depth);
+        }
+    }
+
+    void threaded_client::wake_consumer(){
+        // pairs with the barrier in load, either the consumer sees the item or we see it waiting
+        __sync_synchronize();
+        if (m_consumer_waiting){
+            pthread_mutex_lock(&m_wait_mutex);
+            pthread_cond_signal(&m_wait_cond);
+            pthread_mutex_unlock(&m_wait_mutex);
+        }
+    }
+
+    bool threaded_client::load(int count){
+        struct timespec timeout;
+        timeout.tv_sec = 2;
+        timeout.tv_nsec = 0;
+        return load(count, timeout);
+    }
+
+    bool threaded_client::load(int count, struct timespec timeout){
+        purge();
+
+        if (m_queue.empty()){
+            struct timespec limit;
+            clock_gettime(CLOCK_MONOTONIC, &limit);
+            limit = nanotimeradd(limit, timeout);
+
+            pthread_mutex_lock(&m_wait_mutex);
+            m_consumer_waiting = true;
+            __sync_synchronize();
+
+            int waited = 0;
+            while (m_queue.empty() && (waited == 0)){
+                waited = pthread_cond_timedwait(&m_wait_cond, &m_wait_mutex, &limit);
+            }
+
+            m_consumer_waiting = false;
+            pthread_mutex_unlock(&m_wait_mutex);
+        }
+
+        bundle_handle * bundle = NULL;
+        for (int taken = 0; (taken < count) && m_queue.pop(bundle); ++taken){
+            bm_stack_append(m_received_frames, bundle);
+        }
+
+        notify_listeners();
+
+        return m_received_frames.get_length() > 0;
+    }
+
+    void threaded_client::purge(){ bm_stack_clear(m_received_frames); }
+
+    bundle_stack threaded_client::get_stack() const { return m_received_frames; }
+
+} // ns libkerat
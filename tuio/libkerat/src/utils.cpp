@@ -169,7 +169,7 @@ namespace libkerat {
         result.tv_nsec = a.tv_nsec + b.tv_nsec;
         if (result.tv_nsec >= 1000000000) {
           ++result.tv_sec;
-          result.tv_sec -= 1000000000;
+          result.tv_nsec -= 1000000000;
         }
         return result;
     }
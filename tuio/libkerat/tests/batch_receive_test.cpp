@@ -0,0 +1,150 @@
+/**
+ * \file      batch_receive_test.cpp
+ * \brief     Test the batched receiving of the datagram bursts
+ * \author    agent <agent@local>
+ * \date      2026-10-17 06:06 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <vector>
+#include <kerat/typedefs.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/simple_client.hpp>
+#include <kerat/osc_encoder.hpp>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+using namespace libkerat::message;
+
+static const uint16_t PORT = 33451;
+static const size_t BURST = 100;
+static const size_t OVERSIZED = 40000;
+
+//! \brief Multiple of the batch size, so the last recvmmsg call finds nothing pending
+static const size_t FULL_BATCHES = 64;
+
+//! \brief Serialises single frame of one pointer, the way simple_server does
+static void encode_frame(libkerat::internals::osc_encoder & encoder, libkerat::frame_id_t frame_id){
+    lo_timetag timetag;
+    lo_timetag_now(&timetag);
+
+    frame msg_frame(frame_id);
+    pointer msg_pointer(1, 0, 0, 0, frame_id, frame_id, 1, 1, 0, 0, 0);
+    alive::alive_ids ids; ids.insert(1);
+    alive msg_alive(ids);
+
+    encoder.begin_bundle(timetag);
+    encoder.append(&msg_frame);
+    encoder.append(&msg_pointer);
+    encoder.append(&msg_alive);
+}
+
+//! \brief Does nothing, the signal just interrupts the waiting reader
+static void interrupt_handler(int signal __attribute__((unused))){ ; }
+
+static bool send_burst(int sender, const struct sockaddr_in & address, libkerat::frame_id_t first, size_t count, size_t oversized_after){
+    libkerat::internals::osc_encoder encoder;
+    std::vector<char> oversized(OVERSIZED, 0);
+    bool result = true;
+
+    for (size_t i = 0; i < count; ++i){
+        encode_frame(encoder, first + i);
+        result &= (sendto(sender, encoder.data(), encoder.size(), 0, reinterpret_cast<const struct sockaddr *>(&address), sizeof(address)) == (ssize_t)encoder.size());
+        if ((i + 1) == oversized_after){
+            result &= (sendto(sender, &oversized[0], oversized.size(), 0, reinterpret_cast<const struct sockaddr *>(&address), sizeof(address)) == (ssize_t)oversized.size());
+        }
+    }
+
+    return result;
+}
+
+//! \brief Checks that the stack holds count bundles of consecutive frames
+static bool check_stack(libkerat::bundle_stack stack, libkerat::frame_id_t first, size_t count){
+    bool result = (stack.get_length() == count);
+    for (libkerat::frame_id_t expected = first; stack.get_length() > 0; ++expected){
+        libkerat::bundle_handle bundle = stack.get_update(libkerat::bundle_stack::INDEX_OLDEST);
+        result &= (bundle.get_frame() != NULL) && (bundle.get_frame()->get_frame_id() == expected);
+        result &= (bundle.get_message_of_type<pointer>(0) != NULL);
+    }
+    return result;
+}
+
+int main(){
+
+    libkerat::simple_client client(PORT);
+    client.set_native_decoding(true);
+    bool result = client.set_batch_receive(true) && client.get_batch_receive();
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+    if (!result){ return 1; }
+
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // whole burst is pending before the client wakes up, oversized datagram in the middle
+    result &= send_burst(sender, address, 1, BURST, BURST / 2);
+
+    struct timespec timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_nsec = 0;
+    client.load(BURST + 1, timeout);
+
+    // every bundle arrives in order, the oversized datagram is dropped
+    result &= check_stack(client.get_stack(), 1, BURST);
+    cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+
+    // the burst took fewer wakeups than datagrams
+    result &= (client.get_datagrams_count() == (BURST + 1));
+    result &= (client.get_wakeups_count() < BURST);
+    cout << "Wakeups: " << client.get_wakeups_count() << ", datagrams: " << client.get_datagrams_count() << endl;
+    cout << "Test 3: " << (result?"OK":"FAIL") << endl;
+
+    // full batches only, draining ends on the empty socket
+    result &= send_burst(sender, address, BURST + 1, FULL_BATCHES, 0);
+    client.load(FULL_BATCHES, timeout);
+    result &= check_stack(client.get_stack(), BURST + 1, FULL_BATCHES);
+    result &= (client.get_last_wakeup_datagrams() == FULL_BATCHES);
+    cout << "Test 4: " << (result?"OK":"FAIL") << endl;
+
+    // nothing pending, the interrupted reader keeps waiting until the timeout
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = interrupt_handler;
+    sigaction(SIGALRM, &action, NULL);
+
+    struct itimerval interval;
+    memset(&interval, 0, sizeof(interval));
+    interval.it_value.tv_usec = 10000;
+    interval.it_interval.tv_usec = 10000;
+    setitimer(ITIMER_REAL, &interval, NULL);
+
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = 100000000;
+    struct timespec started, finished;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    result &= !client.load(1, timeout);
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+
+    memset(&interval, 0, sizeof(interval));
+    setitimer(ITIMER_REAL, &interval, NULL);
+
+    struct timespec elapsed = libkerat::nanotimersub(finished, started);
+    result &= (elapsed.tv_sec > 0) || (elapsed.tv_nsec >= timeout.tv_nsec);
+    cout << "Test 5: " << (result?"OK":"FAIL") << endl;
+
+    close(sender);
+    return result?0:1;
+}
@@ -0,0 +1,180 @@
+/**
+ * \file      bundle_allocation_test.cpp
+ * \brief     Microbenchmark of the allocations per received frame
+ * \author    agent <agent@local>
+ * \date      2026-10-17 02:56 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <kerat/typedefs.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/bundle.hpp>
+#include <kerat/message_pool.hpp>
+#include <kerat/utils.hpp>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <vector>
+#include <pthread.h>
+
+using std::cout;
+using std::endl;
+
+static unsigned long allocations_count = 0;
+static size_t last_allocation_size = 0;
+
+void * operator new(size_t size) throw (std::bad_alloc) {
+    ++allocations_count;
+    last_allocation_size = size;
+    void * retval = malloc((size > 0)?size:1);
+    if (retval == NULL){ throw std::bad_alloc(); }
+    return retval;
+}
+
+void operator delete(void * block) throw () { free(block); }
+
+//! \brief Mimics the way simple_client assembles and delivers the received bundles
+class frame_source: protected libkerat::internals::bundle_manipulator {
+public:
+    frame_source(size_t pointers):m_pointers(pointers), m_frame_id(0){ ; }
+
+    void run_frame(){
+        bm_handle_insert(m_current, bm_handle_end(m_current), new libkerat::message::frame(++m_frame_id));
+
+        libkerat::message::alive::alive_ids alives;
+        for (size_t i = 0; i < m_pointers; ++i){
+            libkerat::session_id_t sid = i + 1;
+            bm_handle_insert(m_current, bm_handle_end(m_current), new libkerat::message::pointer(sid, 0, 0, 0, i, i, 1, 1, 0, 0, 0));
+            alives.insert(sid);
+        }
+
+        bm_handle_insert(m_current, bm_handle_end(m_current), new libkerat::message::alive(alives));
+
+        // as in client, bundle is passed to the stack and the stack is purged on next load
+        bm_stack_append(m_stack, bm_handle_clone_shared(m_current));
+        bm_handle_clear(m_current);
+        bm_stack_clear(m_stack);
+    }
+
+private:
+    size_t m_pointers;
+    libkerat::frame_id_t m_frame_id;
+    libkerat::bundle_handle m_current;
+    libkerat::bundle_stack m_stack;
+};
+
+static double measure(bool recycling, size_t frames, size_t pointers, double & usec_per_frame){
+    libkerat::internals::pool_set_recycling(recycling);
+
+    frame_source source(pointers);
+
+    // warm up the pools
+    for (size_t i = 0; i < 16; ++i){ source.run_frame(); }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned long before = allocations_count;
+
+    for (size_t i = 0; i < frames; ++i){ source.run_frame(); }
+
+    unsigned long after = allocations_count;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    struct timespec elapsed = libkerat::nanotimersub(end, start);
+    usec_per_frame = (elapsed.tv_sec * 1e6 + elapsed.tv_nsec / 1e3) / frames;
+
+    return static_cast<double>(after - before) / frames;
+}
+
+/**
+ * Test 2 - block allocated with recycling disabled is safely reused after enabling it
+ */
+static bool run_test_2(){
+    libkerat::internals::pool_set_recycling(false);
+    void * block = libkerat::internals::pool_allocate(20);
+    // whole class is allocated, 32 bytes for the 17-32 class
+    bool result = (last_allocation_size == 32);
+
+    libkerat::internals::pool_set_recycling(true);
+    libkerat::internals::pool_release(block, 20);
+
+    // larger request of the same class gets the very block
+    void * reused = libkerat::internals::pool_allocate(30);
+    result &= (reused == block);
+    libkerat::internals::pool_release(reused, 30);
+
+    return result;
+}
+
+static const size_t HANDED_OVER = 1024;
+static const size_t HANDED_OVER_SIZE = 40;
+
+static void * release_blocks(void * blocks){
+    std::vector<void *> & handed = *static_cast<std::vector<void *> *>(blocks);
+    for (size_t i = 0; i < handed.size(); ++i){
+        libkerat::internals::pool_release(handed[i], HANDED_OVER_SIZE);
+    }
+    libkerat::internals::pool_trim();
+    return NULL;
+}
+
+/**
+ * Test 3 - blocks released by another thread are reused by the allocating thread
+ */
+static bool run_test_3(unsigned long & allocations){
+    libkerat::internals::pool_set_recycling(true);
+
+    std::vector<void *> handed;
+    for (size_t i = 0; i < HANDED_OVER; ++i){
+        handed.push_back(libkerat::internals::pool_allocate(HANDED_OVER_SIZE));
+    }
+
+    pthread_t releaser;
+    if (pthread_create(&releaser, NULL, release_blocks, &handed) != 0){ return false; }
+    pthread_join(releaser, NULL);
+
+    unsigned long before = allocations_count;
+    for (size_t i = 0; i < HANDED_OVER; ++i){
+        handed[i] = libkerat::internals::pool_allocate(HANDED_OVER_SIZE);
+    }
+    allocations = allocations_count - before;
+
+    for (size_t i = 0; i < HANDED_OVER; ++i){
+        libkerat::internals::pool_release(handed[i], HANDED_OVER_SIZE);
+    }
+    libkerat::internals::pool_set_recycling(false);
+
+    return allocations < HANDED_OVER;
+}
+
+int main(){
+
+    const size_t frames = 10000;
+    const size_t pointers = 20;
+
+    double plain_time = 0;
+    double pooled_time = 0;
+    double plain = measure(false, frames, pointers, plain_time);
+    double pooled = measure(true, frames, pointers, pooled_time);
+
+    cout << "Frames: " << frames << ", pointers per frame: " << pointers << endl;
+    cout << "Allocations per frame without recycling: " << plain << " (" << plain_time << " us/frame)" << endl;
+    cout << "Allocations per frame with recycling:    " << pooled << " (" << pooled_time << " us/frame)" << endl;
+
+    bool result = pooled < plain;
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+
+    bool current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    unsigned long allocations = 0;
+    current = run_test_3(allocations);
+    cout << "Blocks allocated again after released by another thread: " << allocations << " of " << HANDED_OVER << endl;
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result?0:1;
+}
@@ -0,0 +1,132 @@
+/**
+ * \file      bundle_type_index_test.cpp
+ * \brief     Test the typed message lookup of the bundle handle
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:03 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <kerat/typedefs.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/bundle.hpp>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using namespace libkerat::message;
+
+class index_tester: protected libkerat::internals::bundle_manipulator {
+public:
+
+    /**
+     * Test 1 - exact type lookup matches the naive scan
+     */
+    bool run_test_1(){
+        libkerat::bundle_handle handle;
+        fill(handle);
+
+        bool result = (handle.get_frame() != NULL) && (handle.get_alive() != NULL);
+        result &= (handle.get_message_of_type<pointer>(0)->get_session_id() == 1);
+        result &= (handle.get_message_of_type<pointer>(2)->get_session_id() == 5);
+        result &= (handle.get_message_of_type<pointer>(3) == NULL);
+        result &= (handle.get_message_of_type<bounds>(0) == NULL);
+        result &= (handle.get_message_count_of_type<pointer>() == 3);
+
+        cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+    /**
+     * Test 2 - helper type lookup keeps the bundle order across message types
+     */
+    bool run_test_2(){
+        libkerat::bundle_handle handle;
+        fill(handle);
+
+        std::vector<const libkerat::helpers::contact_session *> sessions;
+        handle.get_messages_of_type<libkerat::helpers::contact_session>(sessions);
+
+        bool result = (sessions.size() == 5);
+        for (size_t i = 0; result && (i < sessions.size()); ++i){
+            const libkerat::helpers::contact_session * indexed = handle.get_message_of_type<libkerat::helpers::contact_session>(i);
+            result &= (indexed == sessions[i]);
+            result &= (indexed->get_session_id() == (i + 1));
+        }
+
+        cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+    /**
+     * Test 3 - the index follows the bundle modifications
+     */
+    bool run_test_3(){
+        libkerat::bundle_handle handle;
+        fill(handle);
+
+        bool result = (handle.get_message_count_of_type<token>() == 2);
+
+        bm_handle_erase(handle, ++bm_handle_begin(handle));
+        result &= (handle.get_message_of_type<pointer>(0)->get_session_id() == 3);
+        result &= (handle.get_message_count_of_type<pointer>() == 2);
+
+        bm_handle_clear(handle);
+        result &= (handle.get_frame() == NULL);
+
+        cout << "Test 3: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+    /**
+     * Test 4 - iterating the bundle keeps the index built
+     */
+    bool run_test_4(){
+        libkerat::bundle_handle handle;
+        fill(handle);
+
+        const pointer * first = handle.get_message_of_type<pointer>(0);
+        bool result = true;
+        size_t tokens = 0;
+        for (handle_iterator i = bm_handle_begin(handle); i != bm_handle_end(handle); ++i){
+            if (dynamic_cast<token *>(*i) != NULL){ ++tokens; }
+            result &= (handle.get_message_of_type<pointer>(0) == first);
+            result &= (handle.get_message_count_of_type<token>() == 2);
+        }
+        result &= (tokens == 2);
+
+        cout << "Test 4: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+private:
+
+    //! \brief frame, ptr 1, tok 2, ptr 3, tok 4, ptr 5, alive
+    void fill(libkerat::bundle_handle & handle){
+        alive::alive_ids alives;
+
+        bm_handle_insert(handle, bm_handle_end(handle), new frame(1));
+        for (libkerat::session_id_t sid = 1; sid <= 5; ++sid){
+            if (sid % 2){
+                bm_handle_insert(handle, bm_handle_end(handle), new pointer(sid, 0, 0, 0, sid, sid, 1, 1, 0, 0, 0));
+            } else {
+                bm_handle_insert(handle, bm_handle_end(handle), new token(sid, 0, 0, 0, sid, sid, 0));
+            }
+            alives.insert(sid);
+        }
+        bm_handle_insert(handle, bm_handle_end(handle), new alive(alives));
+    }
+
+};
+
+int main(){
+
+    index_tester tester;
+
+    bool t1r = tester.run_test_1();
+    bool t2r = tester.run_test_2();
+    bool t3r = tester.run_test_3();
+    bool t4r = tester.run_test_4();
+
+    return (t1r && t2r && t3r && t4r)?0:1;
+}
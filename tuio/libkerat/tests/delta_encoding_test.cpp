@@ -0,0 +1,161 @@
+/**
+ * \file      delta_encoding_test.cpp
+ * \brief     Test the delta frame encoding and its reconstruction
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:31 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <kerat/typedefs.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/bundle.hpp>
+#include <kerat/delta_encoding.hpp>
+
+using std::cout;
+using std::endl;
+
+static const float EPSILON = 0.5;
+static const unsigned int KEYFRAME_INTERVAL = 4;
+
+//! \brief Builds the full bundles as the server would and passes them through encoder and decoder
+class delta_tester: protected libkerat::internals::bundle_manipulator {
+public:
+    delta_tester()
+        :m_encoder(EPSILON, KEYFRAME_INTERVAL), m_frame_id(0)
+    { ; }
+
+    /**
+     * Test 1 - unchanged contacts and changes within epsilon are left out
+     */
+    bool run_test_1(){
+        libkerat::bundle_handle bundle;
+
+        build(bundle, 10, 10, 10);
+        bool result = m_encoder.encode(bundle);
+        result &= (count_pointers(bundle) == 3);
+
+        // first moves within epsilon, second does not move, third moves
+        build(bundle, 10.2, 10, 20);
+        result &= !m_encoder.encode(bundle);
+        result &= (count_pointers(bundle) == 1);
+        result &= (bundle.get_frame() != NULL) && (bundle.get_alive() != NULL);
+        result &= (bundle.get_alive()->get_alives().size() == 3);
+
+        // the drift is compared against the sent state, not the last one
+        build(bundle, 10.6, 10, 20);
+        result &= !m_encoder.encode(bundle);
+        result &= (count_pointers(bundle) == 1);
+
+        cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+    /**
+     * Test 2 - every keyframe_interval-th bundle and the bundle after reset are full
+     */
+    bool run_test_2(){
+        libkerat::internals::delta_encoder encoder(EPSILON, KEYFRAME_INTERVAL);
+        libkerat::bundle_handle bundle;
+
+        build(bundle, 10, 10, 10);
+        bool result = encoder.encode(bundle);
+
+        for (unsigned int i = 0; i < KEYFRAME_INTERVAL; ++i){
+            build(bundle, 10, 10, 10);
+            bool keyframe = encoder.encode(bundle);
+            bool last = (i == (KEYFRAME_INTERVAL - 1));
+            result &= (keyframe == last);
+            result &= (count_pointers(bundle) == (last?3:0));
+        }
+
+        encoder.reset();
+        build(bundle, 10, 10, 10);
+        result &= encoder.encode(bundle);
+        result &= (count_pointers(bundle) == 3);
+
+        cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+    /**
+     * Test 3 - decoder takes the missing contacts over from the previous bundle
+     */
+    bool run_test_3(){
+        libkerat::internals::delta_encoder encoder(EPSILON, KEYFRAME_INTERVAL);
+        libkerat::internals::delta_decoder decoder;
+        libkerat::bundle_handle bundle;
+
+        build(bundle, 10, 10, 10);
+        encoder.encode(bundle);
+        bool result = (decoder.decode(bundle) == 0);
+
+        build(bundle, 10, 10, 30);
+        encoder.encode(bundle);
+        result &= (decoder.decode(bundle) == 2);
+        result &= (count_pointers(bundle) == 3);
+        result &= check_x(bundle, 3, 30);
+        result &= check_x(bundle, 1, 10);
+
+        // contacts that are not alive anymore are not taken over
+        build(bundle, 10, 10, 30, false);
+        encoder.encode(bundle);
+        result &= (decoder.decode(bundle) == 2);
+        result &= (count_pointers(bundle) == 2);
+
+        // other sources do not mix in
+        build(bundle, 10, 10, 10, true, 2);
+        encoder.reset();
+        encoder.encode(bundle);
+        result &= (decoder.decode(bundle) == 0);
+        result &= (count_pointers(bundle) == 3);
+
+        cout << "Test 3: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+private:
+    void build(libkerat::bundle_handle & bundle, float x1, float x2, float x3, bool first_alive = true, libkerat::instance_id_t instance = 1){
+        libkerat::bundle_handle fresh;
+        bundle = fresh;
+
+        bm_handle_insert(bundle, bm_handle_end(bundle), new libkerat::message::frame(++m_frame_id, LO_TT_IMMEDIATE, "Delta test", 0x7f000001, instance, 1920, 1080));
+
+        float xs[3] = { x1, x2, x3 };
+        libkerat::message::alive::alive_ids alives;
+        for (libkerat::session_id_t i = 0; i < 3; ++i){
+            if ((i == 0) && !first_alive){ continue; }
+
+            bm_handle_insert(bundle, bm_handle_end(bundle), new libkerat::message::pointer(i + 1, 0, 0, 0, xs[i], 10, 1, 1, 0, 0, 0));
+            alives.insert(i + 1);
+        }
+
+        bm_handle_insert(bundle, bm_handle_end(bundle), new libkerat::message::alive(alives));
+    }
+
+    static size_t count_pointers(const libkerat::bundle_handle & bundle){
+        return bundle.get_message_count_of_type<libkerat::message::pointer>();
+    }
+
+    static bool check_x(const libkerat::bundle_handle & bundle, libkerat::session_id_t session_id, float x){
+        for (libkerat::bundle_handle::const_iterator i = bundle.begin(); i != bundle.end(); ++i){
+            const libkerat::message::pointer * ptr = dynamic_cast<const libkerat::message::pointer *>(*i);
+            if ((ptr != NULL) && (ptr->get_session_id() == session_id)){ return ptr->get_x() == x; }
+        }
+        return false;
+    }
+
+    libkerat::internals::delta_encoder m_encoder;
+    libkerat::frame_id_t m_frame_id;
+};
+
+int main(){
+
+    delta_tester tester;
+
+    bool t1r = tester.run_test_1();
+    bool t2r = tester.run_test_2();
+    bool t3r = tester.run_test_3();
+
+    return (t1r && t2r && t3r)?0:1;
+}
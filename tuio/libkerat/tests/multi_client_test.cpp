@@ -0,0 +1,80 @@
+/**
+ * \file      multi_client_test.cpp
+ * \brief     Test receiving from multiple UDP and TCP sources in one client
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:13 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <kerat/typedefs.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/multi_client.hpp>
+#include <kerat/simple_server.hpp>
+
+using std::cout;
+using std::endl;
+
+static const uint16_t BASE_PORT = 33431;
+static const size_t SOURCES = 3;
+
+int main(){
+
+    libkerat::multi_client client;
+    std::map<std::string, libkerat::multi_client::source_tag_t> expected;
+
+    const char * urls[SOURCES] = {"osc.udp://localhost:33431", "osc.udp://localhost:33432", "osc.tcp://localhost:33433"};
+    const char * names[SOURCES] = {"first", "second", "third"};
+    const int protocols[SOURCES] = {LO_UDP, LO_UDP, LO_TCP};
+
+    try {
+        for (size_t i = 0; i < SOURCES; ++i){
+            expected[names[i]] = client.add_port(BASE_PORT + i, protocols[i]);
+        }
+    } catch (const libkerat::exception::net_setup_error & ex){
+        cout << "Unable to setup sources: " << ex.what() << endl;
+        return 1;
+    }
+
+    bool result = (client.get_source_count() == SOURCES);
+
+    for (size_t i = 0; i < SOURCES; ++i){
+        libkerat::simple_server server(urls[i], names[i], 0, i, 640, 480);
+        libkerat::message::pointer contact(i + 1, 0, 0, 0, 10, 10, 1, 1, 0, 0, 0);
+        server.append_clone(&contact);
+        server.send();
+
+        // wait for the connection to be accepted and the data to arrive
+        struct timespec timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_nsec = 0;
+        client.load(1, timeout);
+
+        libkerat::bundle_stack stack = client.get_stack();
+        libkerat::multi_client::source_tag_list tags = client.get_source_tags();
+
+        bool received = (stack.get_length() == 1) && (tags.size() == 1);
+        if (received){
+            libkerat::bundle_handle bundle = stack.get_update();
+            const libkerat::message::frame * frame = bundle.get_frame();
+            received &= (frame != NULL) && (expected[frame->get_app_name()] == tags.front());
+            received &= (bundle.get_message_of_type<libkerat::message::pointer>(0) != NULL);
+        }
+
+        cout << "Source " << names[i] << ": " << (received?"OK":"FAIL") << endl;
+        result &= received;
+    }
+
+    for (size_t i = 0; i < SOURCES; ++i){
+        result &= (client.get_source_bundles_count(expected[names[i]]) == 1);
+    }
+
+    result &= client.del_source(expected[names[0]]);
+    result &= (client.get_source_count() == (SOURCES - 1));
+    result &= (client.get_source_client(expected[names[0]]) == NULL);
+
+    cout << "Test: " << (result?"OK":"FAIL") << endl;
+    return result?0:1;
+}
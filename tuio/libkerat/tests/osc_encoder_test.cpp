@@ -0,0 +1,415 @@
+/**
+ * \file      osc_encoder_test.cpp
+ * \brief     Test the direct OSC encoder and decoder against golden bytes and liblo serialisation
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:22 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <kerat/kerat.hpp>
+#include <kerat/parsers.hpp>
+#include <kerat/osc_encoder.hpp>
+#include <kerat/osc_decoder.hpp>
+#include <lo/lo.h>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+using std::cout;
+using std::endl;
+using namespace libkerat::message;
+
+/*
+ * Golden single-message bundles, timetag 5.6, laid out by the OSC 1.0
+ * specification (big endian arguments, strings zero padded to 4 bytes with at
+ * least one zero) in the argument order of the imprint_lo_messages methods.
+ * This is the same byte stream lo_bundle_serialise produces.
+ */
+static const unsigned char FRAME_SHORT[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x1c, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x66, 0x72, 0x6d, 0x00, 0x00,
+    0x2c, 0x69, 0x74, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x08
+};
+
+static const unsigned char FRAME_EXTENDED[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x30, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x66, 0x72, 0x6d, 0x00, 0x00,
+    0x2c, 0x69, 0x74, 0x73, 0x69, 0x69, 0x69, 0x00, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x07,
+    0x00, 0x00, 0x00, 0x08, 0x45, 0x6e, 0x63, 0x00, 0x7f, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+    0x02, 0x80, 0x01, 0xe0
+};
+
+static const unsigned char POINTER_2D[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x34, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x70, 0x74, 0x72, 0x00, 0x00,
+    0x2c, 0x69, 0x69, 0x69, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1e,
+    0x00, 0x03, 0x00, 0x1d, 0x00, 0x00, 0x00, 0x04, 0x41, 0x28, 0x00, 0x00, 0x41, 0xa2, 0x00, 0x00,
+    0x40, 0x00, 0x00, 0x00, 0x3f, 0x80, 0x00, 0x00
+};
+
+static const unsigned char POINTER_2D_EXTENDED[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x40, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x70, 0x74, 0x72, 0x00, 0x00,
+    0x2c, 0x69, 0x69, 0x69, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00, 0x1f,
+    0x00, 0x03, 0x00, 0x1d, 0x00, 0x00, 0x00, 0x04, 0x41, 0x28, 0x00, 0x00, 0x41, 0xa2, 0x00, 0x00,
+    0x40, 0x00, 0x00, 0x00, 0x3f, 0x80, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00, 0xbf, 0x00, 0x00, 0x00,
+    0x40, 0x80, 0x00, 0x00
+};
+
+static const unsigned char POINTER_3D_EXTENDED[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x4c, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x70, 0x33, 0x64, 0x00, 0x00,
+    0x2c, 0x69, 0x69, 0x69, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x20, 0x00, 0x03, 0x00, 0x1d, 0x00, 0x00, 0x00, 0x04, 0x3f, 0xc0, 0x00, 0x00,
+    0x40, 0x20, 0x00, 0x00, 0x40, 0x60, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x3f, 0x80, 0x00, 0x00,
+    0x3e, 0x80, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00, 0x3f, 0x40, 0x00, 0x00, 0x41, 0x00, 0x00, 0x00
+};
+
+static const unsigned char BOUNDS_2D[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x34, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x62, 0x6e, 0x64, 0x00, 0x00,
+    0x2c, 0x69, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x28,
+    0x41, 0xa4, 0x00, 0x00, 0x42, 0x44, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00, 0x41, 0x20, 0x00, 0x00,
+    0x41, 0x40, 0x00, 0x00, 0x42, 0xc8, 0x00, 0x00
+};
+
+static const unsigned char BOUNDS_3D_EXTENDED[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x70, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x62, 0x33, 0x64, 0x00, 0x00,
+    0x2c, 0x69, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0x41, 0x30, 0x00, 0x00,
+    0x41, 0x40, 0x00, 0x00, 0x41, 0x60, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00, 0x3e, 0x80, 0x00, 0x00,
+    0x3e, 0x00, 0x00, 0x00, 0x41, 0x20, 0x00, 0x00, 0x41, 0xa0, 0x00, 0x00, 0x41, 0xf0, 0x00, 0x00,
+    0x45, 0xbb, 0x80, 0x00, 0x3f, 0x00, 0x00, 0x00, 0x3e, 0x80, 0x00, 0x00, 0x3f, 0x40, 0x00, 0x00,
+    0x3f, 0xc0, 0x00, 0x00, 0x3f, 0xa0, 0x00, 0x00, 0x3f, 0x80, 0x00, 0x00, 0x44, 0x7a, 0x00, 0x00,
+    0x42, 0xc8, 0x00, 0x00
+};
+
+static const unsigned char ALIVE[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x20, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x61, 0x6c, 0x76, 0x00, 0x00,
+    0x2c, 0x69, 0x69, 0x69, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x28,
+    0x00, 0x00, 0x00, 0x29
+};
+
+static const unsigned char ALIVE_EMPTY[] = {
+    0x23, 0x62, 0x75, 0x6e, 0x64, 0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x06,
+    0x00, 0x00, 0x00, 0x10, 0x2f, 0x74, 0x75, 0x69, 0x6f, 0x32, 0x2f, 0x61, 0x6c, 0x76, 0x00, 0x00,
+    0x2c, 0x00, 0x00, 0x00
+};
+
+struct encoder_tester: protected libkerat::server {
+
+    struct route {
+        libkerat::internals::message_convertor convertor;
+        encoder_tester * tester;
+    };
+
+    encoder_tester(){
+        m_timetag.sec = 5;
+        m_timetag.frac = 6;
+
+        libkerat::message::alive::alive_ids alives;
+        alives.insert(30);
+        alives.insert(40);
+        alives.insert(41);
+
+        m_messages.push_back(new frame(12, m_timetag, "Encoder test", 0x7f000001, 2, 1920, 1080));
+        m_messages.push_back(new frame(13));
+
+        pointer * ptr = new pointer(30, libkerat::helpers::contact_type_user::TYPEID_HEAD, 3, 4, 10.2, 10.3, 10, 1.0, 10.0, 11.1, 13.0);
+        ptr->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_2D);
+        m_messages.push_back(ptr);
+
+        ptr = new pointer(31, libkerat::helpers::contact_type_user::TYPEID_HEAD, 3, 4, 10.2, 10.3, 10, 1.0);
+        ptr->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_2D);
+        m_messages.push_back(ptr);
+
+        ptr = new pointer(32, libkerat::helpers::contact_type_user::TYPEID_HEAD, 3, 4, 10.2, 10.3, 10.3, 10, 1.0, 10, 11.1, 11.2, 13);
+        ptr->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_3D);
+        m_messages.push_back(ptr);
+
+        bounds * bnd = new bounds(40, 20.3, 49.0, 3.14, 10, 10, 100, 0.5, 0.5, 0.2, 1, 3);
+        bnd->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_2D);
+        m_messages.push_back(bnd);
+
+        bnd = new bounds(41, 11, 12, 14, 1.0, 1.2, 1.3, 10, 20, 30, 6000, 0.2, 0.3, 0.4, 1.4, 1.5, 1.6, 1000, 10000);
+        bnd->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_3D);
+        m_messages.push_back(bnd);
+
+        m_messages.push_back(new alive(alives));
+        m_messages.push_back(new alive());
+    }
+
+    ~encoder_tester(){
+        clean();
+        for (message_list::iterator i = m_messages.begin(); i != m_messages.end(); ++i){
+            delete *i;
+        }
+    }
+
+    /**
+     * Test 1 - each message type is encoded to the golden bytes
+     */
+    bool run_test_1(){
+        struct fixture {
+            const unsigned char * data;
+            size_t size;
+        };
+
+        const fixture fixtures[] = {
+            { FRAME_SHORT, sizeof(FRAME_SHORT) },
+            { FRAME_EXTENDED, sizeof(FRAME_EXTENDED) },
+            { POINTER_2D, sizeof(POINTER_2D) },
+            { POINTER_2D_EXTENDED, sizeof(POINTER_2D_EXTENDED) },
+            { POINTER_3D_EXTENDED, sizeof(POINTER_3D_EXTENDED) },
+            { BOUNDS_2D, sizeof(BOUNDS_2D) },
+            { BOUNDS_3D_EXTENDED, sizeof(BOUNDS_3D_EXTENDED) },
+            { ALIVE, sizeof(ALIVE) },
+            { ALIVE_EMPTY, sizeof(ALIVE_EMPTY) }
+        };
+
+        libkerat::timetag_t frame_time;
+        frame_time.sec = 7;
+        frame_time.frac = 8;
+
+        libkerat::message::alive::alive_ids alives;
+        alives.insert(30);
+        alives.insert(40);
+        alives.insert(41);
+
+        message_list golden;
+        golden.push_back(new frame(12, frame_time));
+        golden.push_back(new frame(13, frame_time, "Enc", 0x7f000001, 2, 640, 480));
+
+        pointer * ptr = new pointer(30, libkerat::helpers::contact_type_user::TYPEID_HEAD, 3, 4, 10.5, 20.25, 2.0, 1.0);
+        ptr->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_2D);
+        golden.push_back(ptr);
+
+        ptr = new pointer(31, libkerat::helpers::contact_type_user::TYPEID_HEAD, 3, 4, 10.5, 20.25, 2.0, 1.0, 0.5, -0.5, 4.0);
+        ptr->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_2D);
+        golden.push_back(ptr);
+
+        ptr = new pointer(32, libkerat::helpers::contact_type_user::TYPEID_HEAD, 3, 4, 1.5, 2.5, 3.5, 2.0, 1.0, 0.25, 0.5, 0.75, 8.0);
+        ptr->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_3D);
+        golden.push_back(ptr);
+
+        bounds * bnd = new bounds(40, 20.5, 49.0, 0.5, 10, 12, 100);
+        bnd->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_2D);
+        golden.push_back(bnd);
+
+        bnd = new bounds(41, 11, 12, 14, 0.5, 0.25, 0.125, 10, 20, 30, 6000, 0.5, 0.25, 0.75, 1.5, 1.25, 1.0, 1000, 100);
+        bnd->set_message_output_mode(libkerat::helpers::message_output_mode::OUTPUT_MODE_3D);
+        golden.push_back(bnd);
+
+        golden.push_back(new alive(alives));
+        golden.push_back(new alive());
+
+        bool result = (golden.size() == (sizeof(fixtures)/sizeof(fixture)));
+
+        // the buffer has to grow on the way
+        libkerat::internals::osc_encoder encoder(16);
+        for (size_t i = 0; result && (i < golden.size()); ++i){
+            encoder.begin_bundle(m_timetag);
+            bool matches = encoder.append(golden[i])
+                && (encoder.size() == fixtures[i].size)
+                && (memcmp(encoder.data(), fixtures[i].data, fixtures[i].size) == 0);
+
+            if (!matches){
+                cout << "Message " << i << " differs from the golden bytes" << endl;
+            }
+            result &= matches;
+        }
+
+        for (message_list::iterator i = golden.begin(); i != golden.end(); ++i){
+            delete *i;
+        }
+
+        cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+    /**
+     * Test 2 - the encoded messages are parsed back to equal messages
+     */
+    bool run_test_2(){
+        clean();
+
+        libkerat::internals::osc_encoder encoder;
+        bool result = encode(encoder);
+
+        route routes[6] = {
+            { libkerat::internals::parsers::parse_frm, this },
+            { libkerat::internals::parsers::parse_alv, this },
+            { libkerat::internals::parsers::parse_ptr_2d, this },
+            { libkerat::internals::parsers::parse_ptr_3d, this },
+            { libkerat::internals::parsers::parse_bnd_2d, this },
+            { libkerat::internals::parsers::parse_bnd_3d, this }
+        };
+
+        libkerat::internals::osc_decoder decoder(message_handler, NULL, NULL);
+        decoder.set_target(frame::PATH, &routes[0]);
+        decoder.set_target(alive::PATH, &routes[1]);
+        decoder.set_target(pointer::PATH_2D, &routes[2]);
+        decoder.set_target(pointer::PATH_3D, &routes[3]);
+        decoder.set_target(bounds::PATH_2D, &routes[4]);
+        decoder.set_target(bounds::PATH_3D, &routes[5]);
+
+        // the decoder works in place
+        std::vector<char> packet(encoder.data(), encoder.data() + encoder.size());
+        result &= decoder.decode(&packet[0], packet.size());
+        result &= (m_results.size() == m_messages.size());
+
+        for (size_t i = 0; result && (i < m_messages.size()); ++i){
+            result &= equal<frame>(m_messages[i], m_results[i])
+                || equal<alive>(m_messages[i], m_results[i])
+                || equal<pointer>(m_messages[i], m_results[i])
+                || equal<bounds>(m_messages[i], m_results[i]);
+        }
+
+        cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+    /**
+     * Test 3 - the whole bundle is byte identical to lo_bundle_serialise
+     */
+    bool run_test_3(){
+        lo_bundle bundle = lo_bundle_new(m_timetag);
+        for (message_list::const_iterator i = m_messages.begin(); i != m_messages.end(); ++i){
+            libkerat::server::imprint_bundle(bundle, *i);
+        }
+
+        size_t size = 0;
+        void * expected = lo_bundle_serialise(bundle, NULL, &size);
+        lo_bundle_free_messages(bundle);
+
+        // the buffer has to grow on the way
+        libkerat::internals::osc_encoder encoder(16);
+        bool result = encode(encoder);
+        result &= (expected != NULL) && (encoder.size() == size);
+        result &= result && (memcmp(encoder.data(), expected, size) == 0);
+
+        // reused buffer yields the same output
+        result &= encode(encoder);
+        result &= result && (encoder.size() == size) && (memcmp(encoder.data(), expected, size) == 0);
+
+        free(expected);
+
+        cout << "Test 3: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+    /**
+     * Test 4 - a message with unsupported argument types is skipped, the rest
+     * of the bundle is still delivered
+     */
+    bool run_test_4(){
+        clean();
+
+        frame * frm = new frame(14, m_timetag);
+        alive * alv = new alive();
+        message_list expected;
+        expected.push_back(frm);
+        expected.push_back(alv);
+
+        libkerat::internals::osc_encoder encoder;
+        encoder.begin_bundle(m_timetag);
+        bool result = encoder.append(frm);
+        std::vector<char> packet(encoder.data(), encoder.data() + encoder.size());
+
+        // pointer carrying an OSC array, which the native decoder cannot size
+        static const unsigned char unsupported[] = {
+            0x00, 0x00, 0x00, 0x1c,
+            '/', 't', 'u', 'i', 'o', '2', '/', 'p', 't', 'r', 0x00, 0x00,
+            ',', 'i', '[', 'i', ']', 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x1f
+        };
+        packet.insert(packet.end(), unsupported, unsupported + sizeof(unsupported));
+
+        // just the element of the alive, without the bundle header
+        encoder.begin_bundle(m_timetag);
+        result &= encoder.append(alv);
+        packet.insert(packet.end(), encoder.data() + 16, encoder.data() + encoder.size());
+
+        route routes[3] = {
+            { libkerat::internals::parsers::parse_frm, this },
+            { libkerat::internals::parsers::parse_alv, this },
+            { libkerat::internals::parsers::parse_ptr_2d, this }
+        };
+
+        libkerat::internals::osc_decoder decoder(message_handler, NULL, NULL);
+        decoder.set_target(frame::PATH, &routes[0]);
+        decoder.set_target(alive::PATH, &routes[1]);
+        decoder.set_target(pointer::PATH_2D, &routes[2]);
+
+        result &= decoder.decode(&packet[0], packet.size());
+        result &= (m_results.size() == expected.size());
+        result &= result && equal<frame>(expected[0], m_results[0]);
+        result &= result && equal<alive>(expected[1], m_results[1]);
+
+        for (message_list::iterator i = expected.begin(); i != expected.end(); ++i){
+            delete *i;
+        }
+
+        cout << "Test 4: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+private:
+    typedef std::vector<libkerat::kerat_message *> message_list;
+
+    bool encode(libkerat::internals::osc_encoder & encoder){
+        bool result = true;
+        encoder.begin_bundle(m_timetag);
+        for (message_list::const_iterator i = m_messages.begin(); i != m_messages.end(); ++i){
+            result &= libkerat::internals::osc_encoder::supports(*i);
+            result &= encoder.append(*i);
+        }
+        return result;
+    }
+
+    template <typename T>
+    static bool equal(const libkerat::kerat_message * expected, const libkerat::kerat_message * decoded){
+        const T * typed_expected = dynamic_cast<const T *>(expected);
+        const T * typed_decoded = dynamic_cast<const T *>(decoded);
+        return (typed_expected != NULL) && (typed_decoded != NULL) && (*typed_expected == *typed_decoded);
+    }
+
+    static void message_handler(void * target, const char * path, const char * types, lo_arg ** argv, int argc, void * user_data __attribute__((unused))){
+        route * dest = static_cast<route *>(target);
+        (*dest->convertor)(dest->tester->m_results, path, types, argv, argc, NULL);
+    }
+
+    void clean(){
+        for (message_list::iterator i = m_results.begin(); i != m_results.end(); ++i){
+            delete *i;
+        }
+        m_results.clear();
+    }
+
+    // just dummies
+    virtual bool append_clone(const libkerat::kerat_message* msg __attribute__((unused))){ return true; }
+    virtual bool prepare_bundle(){ return true; }
+    virtual bool commit(){ return true; }
+    virtual bool run_adaptors(bool paranoid __attribute__((unused)) = false){ return true; }
+    virtual bool output_check(){ return true; }
+
+    lo_timetag m_timetag;
+    message_list m_messages;
+    message_list m_results;
+
+};
+
+int main(){
+
+    encoder_tester tester;
+
+    bool t1r = tester.run_test_1();
+    bool t2r = tester.run_test_2();
+    bool t3r = tester.run_test_3();
+    bool t4r = tester.run_test_4();
+
+    return (t1r && t2r && t3r && t4r)?0:1;
+}
@@ -8,8 +8,10 @@
 #include <iostream>
 #include <kerat/kerat.hpp>
 #include <kerat/parsers.hpp>
+#include <kerat/osc_decoder.hpp>
 #include <lo/lo.h>
 #include <cassert>
+#include <cstdlib>
 #include "../config.h"
 
 using std::cout;
@@ -18,7 +20,7 @@ using std::endl;
 
 struct testsuite: protected libkerat::server {
     testsuite()
-        :m_result(false), m_convertor(NULL, NULL)
+        :m_result(false), m_native(false), m_convertor(NULL, NULL)
     { ; }
     
     static int lo_message_handler(
@@ -35,6 +37,29 @@ struct testsuite: protected libkerat::server {
         return cb->m_result;
     }
     
+    static void native_message_handler(void * target, const char *path, const char *types, lo_arg **argv, int argc, void *user_data __attribute__((unused))){
+        lo_message_handler(path, types, argv, argc, NULL, target);
+    }
+
+    //! \brief Sends the bundle through liblo or passes it to the native decoder
+    void deliver(lo_address client, lo_server server, lo_bundle bundle, const char * path){
+        if (!m_native){
+            lo_send_bundle(client, bundle);
+            lo_server_recv(server);
+            return;
+        }
+
+        size_t size = 0;
+        void * data = lo_bundle_serialise(bundle, NULL, &size);
+        assert(data != NULL);
+
+        libkerat::internals::osc_decoder decoder(native_message_handler, NULL, NULL);
+        decoder.set_target(path, this);
+        assert(decoder.decode(data, size));
+
+        free(data);
+    }
+
     static lo_address local_lo_address(lo_server server){
         lo_address tmp = lo_address_new_from_url(lo_server_get_url(server));
         const char * port = lo_address_get_port(tmp);
@@ -54,9 +79,11 @@ struct testsuite: protected libkerat::server {
 
     std::list<libkerat::kerat_message *> m_convertor_result;
     bool m_result;
+    bool m_native;
     libkerat::internals::callback_setting<libkerat::simple_client::message_convertor> m_convertor;
 
     int run();
+    bool run_all();
 
     // just dummies
     virtual bool append_clone(const libkerat::kerat_message* msg __attribute__((unused))){ return true; }
@@ -110,6 +137,20 @@ struct testsuite: protected libkerat::server {
 
 int testsuite::run(){
     bool retval = true;
+
+    cout << "liblo decoding:" << endl;
+    m_native = false;
+    retval &= run_all();
+
+    cout << "native decoding:" << endl;
+    m_native = true;
+    retval &= run_all();
+
+    return !retval;
+}
+
+bool testsuite::run_all(){
+    bool retval = true;
     retval &= test_frame();
     retval &= test_alive();
 
@@ -142,7 +183,7 @@ int testsuite::run(){
     retval &= test_linked_list_association();
     retval &= test_linked_tree_association();
 
-    return !retval;
+    return retval;
 }
 
 bool testsuite::test_alive(){
@@ -172,8 +213,7 @@ bool testsuite::test_alive(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -213,8 +253,7 @@ bool testsuite::test_frame(){
     
     libkerat::server::imprint_bundle(bundle, &msg);
 
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -257,8 +296,7 @@ bool testsuite::test_control(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -300,8 +338,7 @@ bool testsuite::test_data_blob(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -347,8 +384,7 @@ bool testsuite::test_data_string(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -393,8 +429,7 @@ bool testsuite::test_signal(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -438,8 +473,7 @@ bool testsuite::test_alive_associations(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -483,8 +517,7 @@ bool testsuite::test_container_association(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -527,8 +560,7 @@ bool testsuite::test_skeleton_volume(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -571,8 +603,7 @@ bool testsuite::test_convex_hull(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -615,8 +646,7 @@ bool testsuite::test_outer_contour(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -668,8 +698,7 @@ bool testsuite::test_inner_contour(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -714,8 +743,7 @@ bool testsuite::test_area(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -757,8 +785,7 @@ bool testsuite::test_raw(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -802,8 +829,7 @@ bool testsuite::test_pointer_3d(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH_3D);
     
     // the parser result is now available
     assert(m_result);
@@ -851,8 +877,7 @@ bool testsuite::test_pointer_2d(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH_2D);
     
     // the parser result is now available
     assert(m_result);
@@ -901,8 +926,7 @@ bool testsuite::test_bounds_3d(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH_3D);
     
     // the parser result is now available
     assert(m_result);
@@ -953,8 +977,7 @@ bool testsuite::test_bounds_2d(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH_2D);
     
     // the parser result is now available
     assert(m_result);
@@ -1001,8 +1024,7 @@ bool testsuite::test_token_3d(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH_3D);
     
     // the parser result is now available
     assert(m_result);
@@ -1050,8 +1072,7 @@ bool testsuite::test_token_2d(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH_2D);
     
     // the parser result is now available
     assert(m_result);
@@ -1094,8 +1115,7 @@ bool testsuite::test_symbol_blob(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -1140,8 +1160,7 @@ bool testsuite::test_symbol_string(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -1189,8 +1208,7 @@ bool testsuite::test_skeleton_2d(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH_2D);
     
     // the parser result is now available
     assert(m_result);
@@ -1239,8 +1257,7 @@ bool testsuite::test_skeleton_3d(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH_3D);
     
     // the parser result is now available
     assert(m_result);
@@ -1292,8 +1309,7 @@ bool testsuite::test_link_association(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -1344,8 +1360,7 @@ bool testsuite::test_linked_list_association(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -1401,8 +1416,7 @@ bool testsuite::test_linked_tree_association(){
     assert(bundle != NULL);
     
     libkerat::server::imprint_bundle(bundle, &msg);
-    lo_send_bundle(client, bundle);
-    lo_server_recv(server);
+    deliver(client, server, bundle, msg_type::PATH);
     
     // the parser result is now available
     assert(m_result);
@@ -0,0 +1,55 @@
+/**
+ * \file      scaling_adaptor_test.cpp
+ * \brief     Test the in-place scaling of the bundles sharing the messages
+ * \author    agent <agent@local>
+ * \date      2026-10-17 05:37 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <memory>
+#include <kerat/typedefs.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/bundle.hpp>
+#include <kerat/scaling_adaptor.hpp>
+
+using std::cout;
+using std::endl;
+using namespace libkerat::message;
+
+class scaling_tester: protected libkerat::internals::bundle_manipulator {
+public:
+
+    /**
+     * Test 1 - scaling the shared copy leaves the original bundle untouched
+     */
+    bool run_test_1(){
+        libkerat::bundle_handle original;
+        bm_handle_insert(original, bm_handle_end(original), new frame(1));
+        bm_handle_insert(original, bm_handle_end(original), new pointer(1, 0, 0, 0, 10, 20, 1, 1, 0, 0, 0));
+
+        std::auto_ptr<libkerat::bundle_handle> shared(bm_handle_clone_shared(original));
+
+        libkerat::adaptors::scaling_adaptor scaler(2.0, 3.0);
+        bool result = (scaler.process_bundle(*shared) == 0);
+
+        const pointer * scaled = shared->get_message_of_type<pointer>(0);
+        const pointer * kept = original.get_message_of_type<pointer>(0);
+        result &= (scaled != kept);
+        result &= (scaled->get_x() != 10) && (scaled->get_y() != 20);
+        result &= (kept->get_x() == 10) && (kept->get_y() == 20);
+
+        cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+        return result;
+    }
+
+};
+
+int main(){
+
+    scaling_tester tester;
+
+    bool t1r = tester.run_test_1();
+
+    return t1r?0:1;
+}
@@ -0,0 +1,112 @@
+/**
+ * \file      server_targets_test.cpp
+ * \brief     Test sending to multiple targets from single simple_server
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:26 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <vector>
+#include <kerat/typedefs.hpp>
+#include <kerat/tuio_messages.hpp>
+#include <kerat/simple_server.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using std::cout;
+using std::endl;
+
+static const uint16_t BASE_PORT = 33441;
+static const size_t TARGETS = 3;
+
+static int bind_receiver(uint16_t port){
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1){ return -1; }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) == -1){
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int main(){
+
+    int receivers[TARGETS];
+    lo_address targets[TARGETS];
+    libkerat::simple_server server;
+
+    bool result = true;
+    for (size_t i = 0; i < TARGETS; ++i){
+        char port[8];
+        snprintf(port, sizeof(port), "%u", (unsigned int)(BASE_PORT + i));
+
+        receivers[i] = bind_receiver(BASE_PORT + i);
+        targets[i] = lo_address_new_with_proto(LO_UDP, "127.0.0.1", port);
+        result &= (receivers[i] != -1) && server.add_target(targets[i]);
+    }
+
+    // duplicate targets are refused
+    result &= !server.add_target(targets[0]);
+    result &= (server.get_targets_count() == TARGETS);
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+
+    // every target receives the very same datagram
+    for (int round = 0; round < 2; ++round){
+        // the second round falls back to liblo serialisation
+        server.set_direct_encoding(round == 0);
+
+        libkerat::message::pointer contact(1, 0, 0, 0, 10, 10, 1, 1, 0, 0, 0);
+        server.append_clone(&contact);
+        result &= server.send();
+
+        std::vector<char> first;
+        for (size_t i = 0; i < TARGETS; ++i){
+            std::vector<char> buffer(65536);
+            ssize_t length = recv(receivers[i], &buffer[0], buffer.size(), 0);
+            result &= (length > 0);
+            if (length <= 0){ continue; }
+
+            buffer.resize(length);
+            if (i == 0){ first = buffer; }
+            result &= (buffer == first);
+            result &= (server.get_target_stats(i).bundles == (uint64_t)(round + 1));
+            result &= (server.get_target_stats(i).errors == 0);
+        }
+    }
+    cout << "Test 2: " << (result?"OK":"FAIL") << endl;
+
+    // removed target receives nothing more
+    result &= server.del_target(targets[1]);
+    result &= !server.del_target(targets[1]);
+    result &= (server.get_targets_count() == (TARGETS - 1));
+
+    libkerat::message::pointer contact(1, 0, 0, 0, 10, 10, 1, 1, 0, 0, 0);
+    server.append_clone(&contact);
+    server.send();
+
+    char buffer[8];
+    result &= (recv(receivers[0], buffer, sizeof(buffer), 0) > 0);
+    result &= (recv(receivers[1], buffer, sizeof(buffer), MSG_DONTWAIT) == -1);
+    cout << "Test 3: " << (result?"OK":"FAIL") << endl;
+
+    for (size_t i = 0; i < TARGETS; ++i){
+        lo_address_free(targets[i]);
+        if (receivers[i] != -1){ close(receivers[i]); }
+    }
+
+    return result?0:1;
+}
@@ -0,0 +1,115 @@
+/**
+ * \file      session_id_table_test.cpp
+ * \brief     Test the open-addressing session id map used by the multiplexing adaptor
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:47 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <kerat/typedefs.hpp>
+#include <kerat/session_id_table.hpp>
+
+using std::cout;
+using std::endl;
+
+using libkerat::session_id_t;
+typedef libkerat::internals::session_id_table table_type;
+typedef std::map<session_id_t, session_id_t> reference_type;
+
+/**
+ * Test 1 - basic insert, find and erase
+ */
+static bool run_test_1(){
+    table_type table(4);
+    session_id_t value = 0;
+
+    bool result = (table.size() == 0) && !table.find(1, value);
+    result &= table.insert(1, 100) && table.insert(2, 200);
+    result &= !table.insert(1, 300);
+    result &= table.find(1, value) && (value == 100);
+    result &= (table.size() == 2);
+
+    result &= table.erase(1, value) && (value == 100);
+    result &= !table.erase(1, value) && !table.find(1, value);
+    result &= table.find(2, value) && (value == 200);
+
+    // zero is ordinary key
+    result &= table.insert(0, 5) && table.find(0, value) && (value == 5);
+
+    table.clear();
+    result &= (table.size() == 0) && !table.find(2, value);
+
+    return result;
+}
+
+/**
+ * Test 2 - growth keeps the entries
+ */
+static bool run_test_2(){
+    table_type table(1);
+    session_id_t value = 0;
+    bool result = true;
+
+    for (session_id_t i = 1; i <= 10000; ++i){ result &= table.insert(i, i * 3); }
+    result &= (table.size() == 10000);
+    for (session_id_t i = 1; i <= 10000; ++i){ result &= table.find(i, value) && (value == i * 3); }
+
+    return result;
+}
+
+/**
+ * Test 3 - random churn against std::map, checks the backward shift deletion
+ */
+static bool run_test_3(){
+    table_type table;
+    reference_type reference;
+    session_id_t value = 0;
+    bool result = true;
+
+    srand(42);
+    for (size_t i = 0; (i < 200000) && result; ++i){
+        // small key range collides a lot
+        session_id_t key = rand() % 64;
+        if (rand() % 2){
+            bool inserted = table.insert(key, i);
+            result &= (inserted == reference.insert(reference_type::value_type(key, i)).second);
+        } else {
+            bool erased = table.erase(key, value);
+            reference_type::iterator found = reference.find(key);
+            result &= (erased == (found != reference.end()));
+            if (erased && (found != reference.end())){
+                result &= (value == found->second);
+                reference.erase(found);
+            }
+        }
+    }
+
+    result &= (table.size() == reference.size());
+    for (reference_type::const_iterator i = reference.begin(); i != reference.end(); ++i){
+        result &= table.find(i->first, value) && (value == i->second);
+    }
+
+    return result;
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    current = run_test_1();
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_3();
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result?0:1;
+}
@@ -0,0 +1,240 @@
+/**
+ * \file      sharded_multiplexing_adaptor_test.cpp
+ * \brief     Test the source-sharded multiplexing adaptor against the serial one
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:51 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <map>
+#include <set>
+#include <kerat/kerat.hpp>
+
+using std::cout;
+using std::endl;
+
+using libkerat::session_id_t;
+using libkerat::frame_id_t;
+using libkerat::instance_id_t;
+
+static const size_t SOURCES = 12;
+static const size_t FRAMES = 500;
+static const size_t CONTACTS = 8;
+
+//! \brief Client that hands whole batches of bundles to its listeners
+class batch_client: public libkerat::client {
+public:
+    ~batch_client(){ purge(); }
+
+    void add_bundle(frame_id_t frame_id, instance_id_t instance, const std::vector<session_id_t> & ids, const std::vector<session_id_t> & alive){
+        libkerat::bundle_handle * bundle = new libkerat::bundle_handle;
+        bm_handle_insert(*bundle, bm_handle_end(*bundle), new libkerat::message::frame(frame_id, LO_TT_IMMEDIATE, "Sharding test", 0x7f000001, instance, 1920, 1080));
+        for (size_t i = 0; i < ids.size(); ++i){
+            bm_handle_insert(*bundle, bm_handle_end(*bundle), new libkerat::message::pointer(ids[i], 0, 0, 0, 10, 10, 1, 1));
+        }
+        bm_handle_insert(*bundle, bm_handle_end(*bundle), new libkerat::message::alive(libkerat::message::alive::alive_ids(alive.begin(), alive.end())));
+        bm_stack_append(m_stack, bundle);
+    }
+
+    void flush(){
+        notify_listeners();
+        purge();
+    }
+
+    libkerat::bundle_stack get_stack() const { return m_stack; }
+    void purge(){ bm_stack_clear(m_stack); }
+    bool load(int count __attribute__((unused))){ return true; }
+    bool load(int count __attribute__((unused)), struct timespec timeout __attribute__((unused))){ return true; }
+
+private:
+    libkerat::bundle_stack m_stack;
+};
+
+//! \brief Remembers all the bundles received
+class collecting_listener: public libkerat::listener {
+public:
+    void notify(const libkerat::client * notifier){
+        libkerat::bundle_stack data = notifier->get_stack();
+        while (data.get_length() > 0){ bundles.push_back(data.get_update(libkerat::bundle_stack::INDEX_OLDEST)); }
+    }
+
+    std::vector<libkerat::bundle_handle> bundles;
+};
+
+//! \brief Random contacts of single source, the alive set is a subset of the ids present
+static void random_frame(std::vector<session_id_t> & ids, std::vector<session_id_t> & alive){
+    ids.clear();
+    alive.clear();
+    for (size_t i = 0; i < CONTACTS; ++i){
+        session_id_t id = rand() % 24;
+        ids.push_back(id);
+        if (rand() % 4){ alive.push_back(id); }
+    }
+}
+
+/**
+ * Test 1 - single source gives the same output as the serial multiplexor
+ */
+static bool run_test_1(){
+    batch_client serial_input, sharded_input;
+    libkerat::adaptors::multiplexing_adaptor serial;
+    libkerat::adaptors::sharded_multiplexing_adaptor sharded(4);
+    collecting_listener serial_output, sharded_output;
+
+    serial_input.add_listener(&serial);
+    sharded_input.add_listener(&sharded);
+    serial.add_listener(&serial_output);
+    sharded.add_listener(&sharded_output);
+
+    srand(1);
+    std::vector<session_id_t> ids, alive;
+    for (frame_id_t frame = 1; frame <= FRAMES; ++frame){
+        random_frame(ids, alive);
+        serial_input.add_bundle(frame, 1, ids, alive);
+        sharded_input.add_bundle(frame, 1, ids, alive);
+        if ((frame % 3) == 0){
+            serial_input.flush();
+            sharded_input.flush();
+        }
+    }
+    serial_input.flush();
+    sharded_input.flush();
+
+    bool result = (serial_output.bundles.size() == FRAMES) && (sharded_output.bundles.size() == FRAMES);
+    for (size_t i = 0; (i < serial_output.bundles.size()) && result; ++i){
+        const libkerat::bundle_handle & expected = serial_output.bundles[i];
+        const libkerat::bundle_handle & received = sharded_output.bundles[i];
+
+        libkerat::bundle_handle::const_iterator e = expected.begin();
+        libkerat::bundle_handle::const_iterator r = received.begin();
+        for (; (e != expected.end()) && (r != received.end()); ++e, ++r){
+            const libkerat::message::pointer * e_ptr = dynamic_cast<const libkerat::message::pointer *>(*e);
+            const libkerat::message::pointer * r_ptr = dynamic_cast<const libkerat::message::pointer *>(*r);
+            if (e_ptr != NULL){ result &= (r_ptr != NULL) && (r_ptr->get_session_id() == e_ptr->get_session_id()); }
+        }
+        result &= (e == expected.end()) && (r == received.end());
+        result &= (expected.get_alive()->get_alives() == received.get_alive()->get_alives());
+    }
+
+    return result;
+}
+
+/**
+ * Test 2 - many sources, order and mapping consistency
+ */
+static bool run_test_2(){
+    batch_client input;
+    libkerat::adaptors::sharded_multiplexing_adaptor sharded(4);
+    collecting_listener output;
+
+    input.add_listener(&sharded);
+    sharded.add_listener(&output);
+
+    bool result = (sharded.get_shard_count() == 4) && sharded.is_parallel();
+
+    srand(2);
+    typedef std::vector<std::vector<std::vector<session_id_t> > > ids_log;
+    ids_log sent_ids(SOURCES, std::vector<std::vector<session_id_t> >(FRAMES));
+    ids_log sent_alives(SOURCES, std::vector<std::vector<session_id_t> >(FRAMES));
+    for (frame_id_t frame = 0; frame < FRAMES; ++frame){
+        for (instance_id_t source = 0; source < SOURCES; ++source){
+            random_frame(sent_ids[source][frame], sent_alives[source][frame]);
+            input.add_bundle(frame + 1, source, sent_ids[source][frame], sent_alives[source][frame]);
+        }
+        input.flush();
+    }
+
+    result &= (output.bundles.size() == (SOURCES * FRAMES));
+
+    // source + original id -> mapped id, valid until the id dies
+    typedef std::map<std::pair<instance_id_t, session_id_t>, session_id_t> mapping_type;
+    mapping_type mapping;
+
+    for (size_t i = 0; (i < output.bundles.size()) && result; ++i){
+        const libkerat::bundle_handle & bundle = output.bundles[i];
+        const libkerat::message::frame * msg_frame = bundle.get_frame();
+        instance_id_t source = i % SOURCES;
+        size_t frame = i / SOURCES;
+
+        // order of the input is kept
+        result &= (msg_frame != NULL) && (msg_frame->get_instance() == source) && (msg_frame->get_frame_id() == frame + 1);
+
+        size_t contact = 0;
+        for (libkerat::bundle_handle::const_iterator m = bundle.begin(); m != bundle.end(); ++m){
+            const libkerat::message::pointer * msg_ptr = dynamic_cast<const libkerat::message::pointer *>(*m);
+            if (msg_ptr == NULL){ continue; }
+
+            mapping_type::key_type key(source, sent_ids[source][frame][contact++]);
+            std::pair<mapping_type::iterator, bool> inserted = mapping.insert(mapping_type::value_type(key, msg_ptr->get_session_id()));
+            result &= (inserted.first->second == msg_ptr->get_session_id());
+        }
+
+        // the alive ids of this source are in the merged alive message
+        const libkerat::message::alive::alive_ids & alives = bundle.get_alive()->get_alives();
+        std::set<session_id_t> source_alive(sent_alives[source][frame].begin(), sent_alives[source][frame].end());
+        for (mapping_type::iterator m = mapping.lower_bound(mapping_type::key_type(source, 0)); (m != mapping.end()) && (m->first.first == source); ){
+            if (source_alive.find(m->first.second) == source_alive.end()){
+                mapping.erase(m++);
+            } else {
+                result &= (alives.find(m->second) != alives.end());
+                ++m;
+            }
+        }
+    }
+
+    // no two live contacts share the mapped id
+    std::set<session_id_t> mapped;
+    for (mapping_type::const_iterator m = mapping.begin(); m != mapping.end(); ++m){
+        result &= mapped.insert(m->second).second;
+    }
+
+    return result;
+}
+
+/**
+ * Test 3 - single shard runs serially, direct processing
+ */
+static bool run_test_3(){
+    libkerat::adaptors::sharded_multiplexing_adaptor sharded(0);
+    bool result = (sharded.get_shard_count() == 1) && !sharded.is_parallel();
+
+    batch_client input;
+    collecting_listener output;
+    input.add_listener(&sharded);
+    sharded.add_listener(&output);
+
+    std::vector<session_id_t> ids(1, 5);
+    input.add_bundle(1, 1, ids, ids);
+    input.add_bundle(1, 2, ids, ids);
+    input.flush();
+
+    result &= (output.bundles.size() == 2);
+    if (result){
+        const libkerat::message::alive::alive_ids & alives = output.bundles[1].get_alive()->get_alives();
+        result &= (alives.size() == 2);
+    }
+
+    return result;
+}
+
+int main(){
+    bool result = true;
+    bool current = false;
+
+    current = run_test_1();
+    cout << "Test 1: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_2();
+    cout << "Test 2: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    current = run_test_3();
+    cout << "Test 3: " << (current?"OK":"FAIL") << endl;
+    result &= current;
+
+    return result?0:1;
+}
@@ -0,0 +1,102 @@
+/**
+ * \file      spsc_queue_test.cpp
+ * \brief     Test the lock-free queue used by the threaded client
+ * \author    agent <agent@local>
+ * \date      2026-10-17 03:08 UTC
+ * \copyright BSD
+ */
+
+#include <iostream>
+#include <kerat/typedefs.hpp>
+#include <kerat/spsc_queue.hpp>
+#include <pthread.h>
+
+using std::cout;
+using std::endl;
+
+typedef libkerat::internals::spsc_queue<size_t> queue_type;
+
+static const size_t STRESS_ITEMS = 1000000;
+
+struct stress_data {
+    stress_data():queue(64), evicted(0){ ; }
+
+    queue_type queue;
+    size_t evicted;
+};
+
+//! \brief Producer keeps pushing increasing sequence, evicting the oldest items when full
+static void * producer(void * arg){
+    stress_data * data = static_cast<stress_data *>(arg);
+
+    for (size_t i = 1; i <= STRESS_ITEMS; ++i){
+        while (!data->queue.push(i)){
+            size_t oldest = 0;
+            if (data->queue.evict(oldest)){ ++data->evicted; }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Test 1 - basic push, pop and evict in a single thread
+ */
+static bool run_test_1(){
+    queue_type queue(5);
+
+    bool result = (queue.capacity() == 8) && queue.empty();
+    for (size_t i = 0; i < 8; ++i){ result &= queue.push(i); }
+    result &= !queue.push(8);
+    result &= (queue.size() == 8);
+
+    size_t item = 0;
+    result &= queue.evict(item) && (item == 0);
+    result &= queue.push(8);
+    for (size_t i = 1; i <= 8; ++i){
+        result &= queue.pop(item) && (item == i);
+    }
+    result &= !queue.pop(item) && queue.empty();
+
+    cout << "Test 1: " << (result?"OK":"FAIL") << endl;
+    return result;
+}
+
+/**
+ * Test 2 - concurrent producer and consumer, each item is taken exactly once and in order
+ */
+static bool run_test_2(){
+    stress_data data;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &producer, &data) != 0){
+        cout << "Test 2: FAIL (thread)" << endl;
+        return false;
+    }
+
+    bool result = true;
+    size_t last = 0;
+    size_t consumed = 0;
+    while (last < STRESS_ITEMS){
+        size_t item = 0;
+        if (data.queue.pop(item)){
+            result &= (item > last);
+            last = item;
+            ++consumed;
+        }
+    }
+
+    pthread_join(thread, NULL);
+    result &= (consumed + data.evicted == STRESS_ITEMS) && data.queue.empty();
+
+    cout << "Test 2: " << (result?"OK":"FAIL") << " (evicted " << data.evicted << ")" << endl;
+    return result;
+}
+
+int main(){
+
+    bool t1r = run_test_1();
+    bool t2r = run_test_2();
+
+    return (t1r && t2r)?0:1;
+}
@@ -52,8 +52,6 @@ struct mirror_config {
     string_list commandline_commands;
 };
 
-typedef std::list<libkerat::simple_server *> servers_list;
-
 // ============================================ globals
 #ifdef HAVE_MUSE
 static muse::module_service::module_chain muse_modules;
@@ -61,7 +59,7 @@ static muse::module_service::module_chain muse_modules;
 static libkerat::simple_client * raw_client = NULL;
 static libkerat::adaptors::multiplexing_adaptor * multiplexing_adaptor = NULL;
 static libkerat::listeners::forwarding_listener * forwarding_listener = NULL;
-static servers_list servers;
+static libkerat::simple_server * server = NULL;
 static bool running = true;
 mirror_config config;
 
@@ -397,24 +395,29 @@ static bool process_commands(string_list commands, std::string & reply){
                         continue;
                     }
                 
-                    libkerat::simple_server * new_server = NULL;
+                    lo_address target = lo_address_new_from_url(uri.c_str());
+                    if (target == NULL){
+                        report << "Failed to add target \"" << uri << "\"!" << endl;
+                        retval &= false;
+                        continue;
+                    }
+
+                    bool added = false;
                     try {
-                        new_server = new libkerat::simple_server(
-                            uri, 
-                            "MUSE mirror", 
-                            config.ip,
-                            config.port,
-                            1920,
-                            1080
-                        );
+                        added = server->add_target(target);
                     } catch (const libkerat::exception::net_setup_error & e){
                         report << "Failed to add target \"" << uri << "\"!" << endl;
                         std::cerr << e.what() << std::endl;
+                        lo_address_free(target);
                         continue;
                     }
-                    servers.push_back(new_server);
-                    new_server->add_adaptor(forwarding_listener->get_server_adaptor());
-                    
+                    lo_address_free(target);
+
+                    if (!added){
+                        report << "Target " << uri << " is already present." << std::endl;
+                        continue;
+                    }
+
                     report << "Added " << uri << std::endl;
                 }
                 break;
@@ -434,18 +437,8 @@ static bool process_commands(string_list commands, std::string & reply){
                     lo_address tmp = lo_address_new_from_url(seek_for.c_str());
                     char * url_tmp  = lo_address_get_url(tmp);
 
-                    bool deleted = false;
-                    for (servers_list::iterator s = servers.begin(); (s != servers.end()) && !deleted; ++s){
-                        char * url_orig = lo_address_get_url((*s)->get_target());
-                        if (strcmp(url_orig, url_tmp) == 0){
-                            // disconnect from the stream
-                            (*s)->del_adaptor(forwarding_listener->get_server_adaptor());
-                            servers.erase(s);
-                            deleted = true;
-                        }
-                        free(url_orig);
-                    }
-                    
+                    bool deleted = server->del_target(tmp);
+
                     if (deleted){
                         report << "Target " << url_tmp << " successfully disabled." << std::endl;
                     } else {
@@ -459,13 +452,15 @@ static bool process_commands(string_list commands, std::string & reply){
                 break;
             }
             case COMMAND_SHOW: {
-                for (servers_list::const_iterator s = servers.begin(); s != servers.end(); ++s){
-                    char * url = lo_address_get_url((*s)->get_target());
-                    report << "Target: " << url << std::endl;
+                for (size_t i = 0; i < server->get_targets_count(); ++i){
+                    char * url = lo_address_get_url(server->get_target(i));
+                    const libkerat::simple_server::target_stats & stats = server->get_target_stats(i);
+                    report << "Target: " << url << " (bundles: " << stats.bundles
+                        << ", bytes: " << stats.bytes << ", errors: " << stats.errors << ")" << std::endl;
                     free(url);
                 }
-                
-                if (servers.empty()){
+
+                if (server->get_targets_count() == 0){
                     report << "No targets set!" << std::endl;
                 }
                 break;
@@ -657,6 +652,14 @@ static int run(){
 
     forwarding_listener = new libkerat::listeners::forwarding_listener(true, true);
     last_client->add_listener(forwarding_listener);
+
+    // single server serialises each bundle once for all the targets
+    server = new libkerat::simple_server;
+    {
+        libkerat::message::frame frame_template(0, LO_TT_IMMEDIATE, "MUSE mirror", config.ip, config.port, 1920, 1080);
+        server->append_clone(&frame_template);
+    }
+    server->add_adaptor(forwarding_listener->get_server_adaptor());
     
     // clients initalized, everything is ok - open socket & fork
 
@@ -722,11 +725,11 @@ static int run(){
     // cleanup
     close(command_socket);
     unlink(command_socket_path.c_str());
-    for (servers_list::iterator l = servers.begin(); l != servers.end(); ++l){
-        delete *l;
-        *l = NULL;
+    if (server != NULL){
+        server->del_adaptor(forwarding_listener->get_server_adaptor());
+        delete server;
+        server = NULL;
     }
-    servers.clear();
     
 #ifdef HAVE_MUSE
     if (!muse_modules.empty()){